@@ -54,29 +54,15 @@
 #include <SPTK.h>
 #endif
 
-/* workspace */
-static int dct_table_size = 0;
-static double *dct_workspace = NULL;
-static double *pLocalReal = NULL;
-static double *pLocalImag = NULL;
-static double *pWeightReal = NULL;
-static double *pWeightImag = NULL;
-
-static int dct_table_size_fft = 0;
-static double *dct_workspace2 = NULL;
-static double *pLocalReal2 = NULL;
-static double *pLocalImag2 = NULL;
-static double *pWeightReal2 = NULL;
-static double *pWeightImag2 = NULL;
+/* workspace of dct_create_table() and dct_based_on_*() */
+static DCTWORK dct_table;
+static DCTWORK dct_table_fft;
 
-
-int dft(double *pReal, double *pImag, const int nDFTLength)
+static void dft_r(double *pReal, double *pImag, const int nDFTLength,
+                  double *pTempReal, double *pTempImag)
 {
    int k, n;
-   double *pTempReal, *pTempImag, TempReal, TempImag;
-
-   pTempReal = dgetmem(nDFTLength);
-   pTempImag = dgetmem(nDFTLength);
+   double TempReal, TempImag;
 
    memcpy(pTempReal, pReal, sizeof(double) * nDFTLength);
    memcpy(pTempImag, pImag, sizeof(double) * nDFTLength);
@@ -93,148 +79,151 @@ int dft(double *pReal, double *pImag, const int nDFTLength)
       pReal[k] = TempReal;
       pImag[k] = TempImag;
    }
+
+   return;
+}
+
+int dft(double *pReal, double *pImag, const int nDFTLength)
+{
+   double *pTempReal, *pTempImag;
+
+   if ((pTempReal = adgetmem(NULL, 2 * nDFTLength)) == NULL)
+      return (-1);
+   pTempImag = pTempReal + nDFTLength;
+
+   dft_r(pReal, pImag, nDFTLength, pTempReal, pTempImag);
+
    free(pTempReal);
-   free(pTempImag);
 
    return (0);
 }
 
-int dct_create_table_fft(const int nSize)
+static Boolean is_power_of_two(const int n)
 {
-   register int k;
+   int j;
 
-   if (nSize == dct_table_size_fft) {
-      /* no needs to resize workspace. */
-      return (0);
-   } else {
-      /* release resources to resize workspace. */
-      if (dct_workspace2 != NULL) {
-         free(dct_workspace2);
-         dct_workspace2 = NULL;
-      }
-      pLocalReal2 = NULL;
-      pLocalImag2 = NULL;
-      pWeightReal2 = NULL;
-      pWeightImag2 = NULL;
-   }
+   for (j = 1; j < n; j <<= 1);
 
-   /* getting resources. */
-   if (nSize <= 0) {
-      dct_table_size_fft = 0;
-      return (0);
-   } else {
-      dct_table_size_fft = nSize;
-      dct_workspace2 = dgetmem(dct_table_size_fft * 6);
-      pWeightReal2 = dct_workspace2;
-      pWeightImag2 = dct_workspace2 + dct_table_size_fft;
-      pLocalReal2 = dct_workspace2 + (2 * dct_table_size_fft);
-      pLocalImag2 = dct_workspace2 + (4 * dct_table_size_fft);
-
-      for (k = 0; k < dct_table_size_fft; k++) {
-         pWeightReal2[k] =
-             cos(k * PI / (2.0 * dct_table_size_fft)) /
-             sqrt(2.0 * dct_table_size_fft);
-         pWeightImag2[k] =
-             -sin(k * PI / (2.0 * dct_table_size_fft)) /
-             sqrt(2.0 * dct_table_size_fft);
-      }
-      pWeightReal2[0] /= sqrt(2.0);
-      pWeightImag2[0] /= sqrt(2.0);
-   }
+   return ((j == n) ? TR : FA);
+}
+
+int alloc_DCTWORK(DCTWORK * w, const int size, const Boolean dftmode)
+{
+   w->size = size;
+   w->dftmode = (dftmode || !is_power_of_two(size)) ? TR : FA;
+   w->weight = acquire_TWIDDLE(TWIDDLE_DCT, size);
+   w->pWeightReal = w->weight->table;
+   w->pWeightImag = w->weight->table + size;
+   w->pLocalReal = dgetmem(size * 10);
+   w->pLocalImag = w->pLocalReal + (2 * size);
+   w->x = w->pLocalReal + (4 * size);
+   w->y = w->pLocalReal + (6 * size);
+   w->pReal = w->pLocalReal + (8 * size);
+   w->pImag = w->pLocalReal + (9 * size);
 
    return (0);
 }
 
-int dct_create_table(const int nSize)
+int free_DCTWORK(DCTWORK * w)
 {
-   register int k;
+   release_TWIDDLE(w->weight);
+   free(w->pLocalReal);
+   w->size = 0;
+   w->dftmode = FA;
+   w->weight = NULL;
+   w->pWeightReal = w->pWeightImag = NULL;
+   w->pLocalReal = w->pLocalImag = NULL;
+   w->x = w->y = w->pReal = w->pImag = NULL;
+
+   return (0);
+}
 
-   if (nSize == dct_table_size) {
+static int dct_table_resize(DCTWORK * w, const int nSize, const Boolean dftmode)
+{
+   if (nSize == w->size) {
       /* no needs to resize workspace. */
       return (0);
-   } else {
+   } else if (w->pLocalReal != NULL) {
       /* release resources to resize workspace. */
-      if (dct_workspace != NULL) {
-         free(dct_workspace);
-         dct_workspace = NULL;
-      }
-      pLocalReal = NULL;
-      pLocalImag = NULL;
-      pWeightReal = NULL;
-      pWeightImag = NULL;
+      free_DCTWORK(w);
    }
 
    /* getting resources. */
-   if (nSize <= 0) {
-      dct_table_size = 0;
+   if (nSize <= 0)
       return (0);
-   } else {
-      dct_table_size = nSize;
-      dct_workspace = dgetmem(dct_table_size * 6);
-      pWeightReal = dct_workspace;
-      pWeightImag = dct_workspace + dct_table_size;
-      pLocalReal = dct_workspace + (2 * dct_table_size);
-      pLocalImag = dct_workspace + (4 * dct_table_size);
-
-      for (k = 0; k < dct_table_size; k++) {
-         pWeightReal[k] =
-             cos(k * PI / (2.0 * dct_table_size)) / sqrt(2.0 * dct_table_size);
-         pWeightImag[k] =
-             -sin(k * PI / (2.0 * dct_table_size)) / sqrt(2.0 * dct_table_size);
-      }
-      pWeightReal[0] /= sqrt(2.0);
-      pWeightImag[0] /= sqrt(2.0);
-   }
 
-   return (0);
+   return (alloc_DCTWORK(w, nSize, dftmode));
 }
 
-int dct_based_on_fft(double *pReal, double *pImag, const double *pInReal,
-                     const double *pInImag)
+int dct_create_table_fft(const int nSize)
 {
-   register int n, k;
-
+   return (dct_table_resize(&dct_table_fft, nSize, FA));
+}
 
-   for (n = 0; n < dct_table_size_fft; n++) {
-      pLocalReal2[n] = pInReal[n];
-      pLocalImag2[n] = pInImag[n];
-      pLocalReal2[dct_table_size_fft + n] = pInReal[dct_table_size_fft - 1 - n];
-      pLocalImag2[dct_table_size_fft + n] = pInImag[dct_table_size_fft - 1 - n];
-   }
+int dct_create_table(const int nSize)
+{
+   return (dct_table_resize(&dct_table, nSize, TR));
+}
 
+static int dct_r_core(DCTWORK * w, double *pReal, double *pImag,
+                      const double *pInReal, const double *pInImag)
+{
+   register int n, k;
+   const int size = w->size;
 
-   fft(pLocalReal2, pLocalImag2, dct_table_size_fft * 2);       /* double input */
+   for (n = 0; n < size; n++) {
+      w->pLocalReal[n] = pInReal[n];
+      w->pLocalImag[n] = pInImag[n];
+      w->pLocalReal[size + n] = pInReal[size - 1 - n];
+      w->pLocalImag[size + n] = pInImag[size - 1 - n];
+   }
 
+   if (w->dftmode)
+      dft_r(w->pLocalReal, w->pLocalImag, size * 2, w->x, w->y);
+   else
+      fft(w->pLocalReal, w->pLocalImag, size * 2);      /* double input */
 
-   for (k = 0; k < dct_table_size_fft; k++) {
+   for (k = 0; k < size; k++) {
       pReal[k] =
-          pLocalReal2[k] * pWeightReal2[k] - pLocalImag2[k] * pWeightImag2[k];
+          w->pLocalReal[k] * w->pWeightReal[k] -
+          w->pLocalImag[k] * w->pWeightImag[k];
       pImag[k] =
-          pLocalReal2[k] * pWeightImag2[k] + pLocalImag2[k] * pWeightReal2[k];
+          w->pLocalReal[k] * w->pWeightImag[k] +
+          w->pLocalImag[k] * w->pWeightReal[k];
    }
 
    return (0);
 }
 
+int dct_based_on_fft(double *pReal, double *pImag, const double *pInReal,
+                     const double *pInImag)
+{
+   return (dct_r_core(&dct_table_fft, pReal, pImag, pInReal, pInImag));
+}
+
 int dct_based_on_dft(double *pReal, double *pImag, const double *pInReal,
                      const double *pInImag)
 {
-   register int n, k;
+   return (dct_r_core(&dct_table, pReal, pImag, pInReal, pInImag));
+}
+
+int dct_r(DCTWORK * w, double *in, double *out, const int size, const int m,
+          const Boolean compmode)
+{
+   int k;
 
-   for (n = 0; n < dct_table_size; n++) {
-      pLocalReal[n] = pInReal[n];
-      pLocalImag[n] = pInImag[n];
-      pLocalReal[dct_table_size + n] = pInReal[dct_table_size - 1 - n];
-      pLocalImag[dct_table_size + n] = pInImag[dct_table_size - 1 - n];
+   if (size != w->size) {
+      fprintf(stderr, "dct : working area does not match the size!\n");
+      return (-1);
    }
 
-   dft(pLocalReal, pLocalImag, dct_table_size * 2);
+   dct_r_core(w, w->pReal, w->pImag, in, in + size);
 
-   for (k = 0; k < dct_table_size; k++) {
-      pReal[k] =
-          pLocalReal[k] * pWeightReal[k] - pLocalImag[k] * pWeightImag[k];
-      pImag[k] =
-          pLocalReal[k] * pWeightImag[k] + pLocalImag[k] * pWeightReal[k];
+   for (k = 0; k < m; k++) {
+      out[k] = w->pReal[k];
+      if (compmode == TR) {
+         out[k + size] = w->pImag[k];
+      }
    }
 
    return (0);
@@ -243,50 +232,11 @@ int dct_based_on_dft(double *pReal, double *pImag, const double *pInReal,
 void dct(double *in, double *out, const int size, const int m,
          const Boolean dftmode, const Boolean compmode)
 {
-   int k, i, j, iter;
-   double *pReal, *pImag;
-   double *x, *y;
-   double *x2, *y2;
-
-   x = dgetmem(2 * size);
-   y = x + size;
-   pReal = dgetmem(2 * size);
-   pImag = pReal + size;
-   x2 = dgetmem(2 * size);
-   y2 = x2 + size;
-
-   for (k = 0; k < size; k++) {
-      x[k] = in[k];
-      y[k] = in[k + size];
-      x2[k] = x[k];
-      y2[k] = y[k];
-   }
-
-   iter = 0;
-   i = size;
-   while ((i /= 2) != 0) {
-      iter++;
-   }
-   j = 1;
-   for (i = 1; i <= iter; i++) {
-      j *= 2;
-   }
-   if (size != j || dftmode) {
-      dct_create_table(size);
-      dct_based_on_dft(pReal, pImag, x2, y2);
-   } else {
-      dct_create_table_fft(size);
-      dct_based_on_fft(pReal, pImag, x2, y2);
-   }
-
-   for (k = 0; k < m; k++) {
-      out[k] = pReal[k];
-      if (compmode == TR) {
-         out[k + size] = pImag[k];
-      }
-   }
+   DCTWORK w;
 
-   free(x);
-   free(x2);
-   free(pReal);
+   /* the weights are shared through the twiddle cache, so only the
+      local buffers are allocated per call */
+   alloc_DCTWORK(&w, size, dftmode);
+   dct_r(&w, in, out, size, m, compmode);
+   free_DCTWORK(&w);
 }
@@ -52,6 +52,14 @@
                 double   x[];   real part      
                 double   y[];   imaginary part      
                 int      m;     data size      
+
+                sizes other than powers of 2 are transformed by
+                the mixed-radix fft (see _fftplan.c)
+
+                int   fftf(x, y, m);
+
+                float    x[], y[];  single precision version
+                                    (m must be a power of 2)
    
                 return : success = 0
                          fault   = -1
@@ -68,8 +76,13 @@
 #include <SPTK.h>
 #endif
 
-double *_sintbl = 0;
-int maxfftsize = 0;
+int fftsimd_bfly(double *x, double *y, const double *sinp,
+                 const double *cosp, const int m, const int lmx, const int lf);
+int fftsimd_pair(double *x, double *y, const int m);
+int fftsimd_bflyf(float *x, float *y, const double *sinp,
+                  const double *cosp, const int m, const int lmx,
+                  const int lf);
+int fftsimd_pairf(float *x, float *y, const int m);
 
 static int checkm(const int m)
 {
@@ -79,7 +92,9 @@ static int checkm(const int m)
       if (k == m)
          return (0);
    }
-   fprintf(stderr, "fft : m must be a integer of power of 2!\n");
+   if (m >= 1)
+      return (1);
+   fprintf(stderr, "fft : m must be a positive integer!\n");
 
    return (-1);
 }
@@ -89,37 +104,38 @@ int fft(double *x, double *y, const int m)
    int j, lmx, li;
    double *xp, *yp;
    double *sinp, *cosp;
-   int lf, lix, tblsize;
+   int lf, lix;
    int mv2, mm1;
    double t1, t2;
-   double arg;
-   int checkm(const int);
+   double *sintbl;
+   FFTPLAN *plan;
+   TWIDDLE *tw;
 
    /**************
    * RADIX-2 FFT *
    **************/
 
-   if (checkm(m))
+   switch (checkm(m)) {
+   case 0:
+      break;
+   case 1:                     /* not a power of 2: mixed-radix fft */
+      if ((plan = acquire_FFTPLAN(m)) == NULL)
+         return (-1);
+      fft_plan(plan, x, y);
+      release_FFTPLAN(plan);
+      return (0);
+   default:
       return (-1);
+   }
 
    /***********************
    * SIN table generation *
    ***********************/
 
-   if ((_sintbl == 0) || (maxfftsize < m)) {
-      tblsize = m - m / 4 + 1;
-      arg = PI / m * 2;
-      if (_sintbl != 0)
-         free(_sintbl);
-      _sintbl = sinp = dgetmem(tblsize);
-      *sinp++ = 0;
-      for (j = 1; j < tblsize; j++)
-         *sinp++ = sin(arg * (double) j);
-      _sintbl[m / 2] = 0;
-      maxfftsize = m;
-   }
+   tw = shared_TWIDDLE(m);
+   sintbl = tw->table;
 
-   lf = maxfftsize / m;
+   lf = 1;
    lmx = m;
 
    for (;;) {
@@ -127,8 +143,12 @@ int fft(double *x, double *y, const int m)
       lmx /= 2;
       if (lmx <= 1)
          break;
-      sinp = _sintbl;
-      cosp = _sintbl + maxfftsize / 4;
+      sinp = sintbl;
+      cosp = sintbl + m / 4;
+      if (fftsimd_bfly(x, y, sinp, cosp, m, lmx, lf) == 0) {
+         lf += lf;
+         continue;
+      }
       for (j = 0; j < lmx; j++) {
          xp = &x[j];
          yp = &y[j];
@@ -150,7 +170,11 @@ int fft(double *x, double *y, const int m)
 
    xp = x;
    yp = y;
-   for (li = m / 2; li--; xp += 2, yp += 2) {
+   if (fftsimd_pair(x, y, m) == 0)
+      li = 0;
+   else
+      li = m / 2;
+   for (; li--; xp += 2, yp += 2) {
       t1 = *(xp) - *(xp + 1);
       t2 = *(yp) - *(yp + 1);
       *(xp) += *(xp + 1);
@@ -188,3 +212,100 @@ int fft(double *x, double *y, const int m)
 
    return (0);
 }
+
+int fftf(float *x, float *y, const int m)
+{
+   int j, lmx, li;
+   float *xp, *yp;
+   double *sinp, *cosp;
+   int lf, lix;
+   int mv2, mm1;
+   float t1, t2, c, s;
+   double *sintbl;
+   TWIDDLE *tw;
+
+   if (checkm(m) != 0) {
+      if (m >= 1)
+         fprintf(stderr, "fftf : m must be a integer of power of 2!\n");
+      return (-1);
+   }
+
+   tw = shared_TWIDDLE(m);
+   sintbl = tw->table;
+
+   lf = 1;
+   lmx = m;
+
+   for (;;) {
+      lix = lmx;
+      lmx /= 2;
+      if (lmx <= 1)
+         break;
+      sinp = sintbl;
+      cosp = sintbl + m / 4;
+      if (fftsimd_bflyf(x, y, sinp, cosp, m, lmx, lf) == 0) {
+         lf += lf;
+         continue;
+      }
+      for (j = 0; j < lmx; j++) {
+         xp = &x[j];
+         yp = &y[j];
+         c = (float) *cosp;
+         s = (float) *sinp;
+         for (li = lix; li <= m; li += lix) {
+            t1 = *(xp) - *(xp + lmx);
+            t2 = *(yp) - *(yp + lmx);
+            *(xp) += *(xp + lmx);
+            *(yp) += *(yp + lmx);
+            *(xp + lmx) = c * t1 + s * t2;
+            *(yp + lmx) = c * t2 - s * t1;
+            xp += lix;
+            yp += lix;
+         }
+         sinp += lf;
+         cosp += lf;
+      }
+      lf += lf;
+   }
+
+   xp = x;
+   yp = y;
+   if (fftsimd_pairf(x, y, m) == 0)
+      li = 0;
+   else
+      li = m / 2;
+   for (; li--; xp += 2, yp += 2) {
+      t1 = *(xp) - *(xp + 1);
+      t2 = *(yp) - *(yp + 1);
+      *(xp) += *(xp + 1);
+      *(yp) += *(yp + 1);
+      *(xp + 1) = t1;
+      *(yp + 1) = t2;
+   }
+
+   j = 0;
+   xp = x;
+   yp = y;
+   mv2 = m / 2;
+   mm1 = m - 1;
+   for (lmx = 0; lmx < mm1; lmx++) {
+      if ((li = lmx - j) < 0) {
+         t1 = *(xp);
+         t2 = *(yp);
+         *(xp) = *(xp + li);
+         *(yp) = *(yp + li);
+         *(xp + li) = t1;
+         *(yp + li) = t2;
+      }
+      li = mv2;
+      while (li <= j) {
+         j -= li;
+         li /= 2;
+      }
+      j += li;
+      xp = x + j;
+      yp = y + j;
+   }
+
+   return (0);
+}
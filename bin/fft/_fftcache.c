@@ -0,0 +1,306 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/********************************************************
+   $Id$
+
+       NAME:
+                fftcache - shared twiddle tables and fft plans
+       SYNOPSIS:
+                TWIDDLE  *acquire_TWIDDLE(type, size);
+                int      release_TWIDDLE(t);
+                TWIDDLE  *shared_TWIDDLE(size);
+                FFTPLAN  *acquire_FFTPLAN(n);
+                int      release_FFTPLAN(p);
+                int      clear_fft_cache();
+
+                TwiddleType  type;  TWIDDLE_FFT : sin table of fft
+                                    TWIDDLE_DCT : weights of dct
+                int          size;  transform size
+                TWIDDLE      *t;    table returned by acquire_TWIDDLE
+                int          n;     transform size
+                FFTPLAN      *p;    plan returned by acquire_FFTPLAN
+
+       Twiddle tables are built once per (type, size) and are
+       never modified afterwards, so any number of threads may
+       read the same table.  A table is counted as in use
+       between acquire_TWIDDLE() and release_TWIDDLE(), and
+       clear_fft_cache() frees only the tables and plans that
+       are not in use.
+
+       shared_TWIDDLE() returns the TWIDDLE_FFT table of a
+       power-of-2 size for fft() and fftr().  The table is
+       kept until exit, so it needs no release, and once it
+       exists it is found without taking the lock.
+
+       An FFTPLAN carries its own working area, so a plan is
+       lent to one caller at a time; concurrent callers with
+       the same size get separate plans.
+
+       TWIDDLE_FFT table (size - size / 4 + 1 values):
+                sin(2 pi k / size), cos(2 pi k / size) starts at
+                table + size / 4
+       TWIDDLE_DCT table (2 * size values):
+                real and imaginary part of
+                exp(-j pi k / (2 size)) / sqrt(2 size)
+                (k = 0 term is divided by sqrt(2))
+********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#include "../sptk_thread.h"
+
+typedef struct _PLANNODE {
+   FFTPLAN plan;                /* must be the first member */
+   int busy;
+   struct _PLANNODE *next;
+} PLANNODE;
+
+static sptk_mutex_t cache_lock = SPTK_MUTEX_INITIALIZER;
+static TWIDDLE *twiddle_list = NULL;
+static PLANNODE *plan_list = NULL;
+
+/* TWIDDLE_FFT tables of shared_TWIDDLE() by log2 of the size; a slot is
+   written once, under the lock, after its table is complete */
+#define FFT_NSLOT 31
+static TWIDDLE *fft_slot[FFT_NSLOT];
+
+static double *make_table(const TwiddleType type, const int size)
+{
+   int k, tblsize;
+   double *table, arg;
+
+   switch (type) {
+   case TWIDDLE_FFT:
+      tblsize = size - size / 4 + 1;
+      arg = PI / size * 2;
+      table = dgetmem(tblsize);
+      table[0] = 0;
+      for (k = 1; k < tblsize; k++)
+         table[k] = sin(arg * (double) k);
+      table[size / 2] = 0;
+      break;
+   case TWIDDLE_DCT:
+      table = dgetmem(2 * size);
+      for (k = 0; k < size; k++) {
+         table[k] = cos(k * PI / (2.0 * size)) / sqrt(2.0 * size);
+         table[size + k] = -sin(k * PI / (2.0 * size)) / sqrt(2.0 * size);
+      }
+      table[0] /= sqrt(2.0);
+      table[size] /= sqrt(2.0);
+      break;
+   default:
+      table = NULL;
+      break;
+   }
+
+   return (table);
+}
+
+/* find or build the table; called with cache_lock held */
+static TWIDDLE *find_TWIDDLE(const TwiddleType type, const int size)
+{
+   TWIDDLE *t;
+
+   for (t = twiddle_list; t != NULL; t = t->next)
+      if (t->type == type && t->size == size)
+         return (t);
+
+   /* built under the lock, so it is complete before anyone sees it */
+   t = (TWIDDLE *) getmem(1, sizeof(TWIDDLE));
+   t->type = type;
+   t->size = size;
+   t->nref = 0;
+   t->table = make_table(type, size);
+   t->next = twiddle_list;
+   twiddle_list = t;
+
+   return (t);
+}
+
+TWIDDLE *acquire_TWIDDLE(const TwiddleType type, const int size)
+{
+   TWIDDLE *t;
+
+   if (size < 1)
+      return (NULL);
+
+   sptk_mutex_lock(&cache_lock);
+   t = find_TWIDDLE(type, size);
+   t->nref++;
+   sptk_mutex_unlock(&cache_lock);
+
+   return (t);
+}
+
+TWIDDLE *shared_TWIDDLE(const int size)
+{
+   int k;
+   TWIDDLE *t;
+
+   for (k = 0; k < FFT_NSLOT - 1 && (1 << k) < size; k++);
+   if ((1 << k) != size)
+      return (NULL);
+
+#if defined(sptk_load_ptr)
+   if ((t = (TWIDDLE *) sptk_load_ptr(&fft_slot[k])) != NULL)
+      return (t);
+#endif
+
+   sptk_mutex_lock(&cache_lock);
+   if ((t = fft_slot[k]) == NULL) {
+      t = find_TWIDDLE(TWIDDLE_FFT, size);
+      t->nref++;                /* held by the slot until exit */
+#if defined(sptk_store_ptr)
+      sptk_store_ptr(&fft_slot[k], t);
+#else
+      fft_slot[k] = t;
+#endif
+   }
+   sptk_mutex_unlock(&cache_lock);
+
+   return (t);
+}
+
+int release_TWIDDLE(TWIDDLE * t)
+{
+   if (t == NULL)
+      return (-1);
+
+   sptk_mutex_lock(&cache_lock);
+   t->nref--;
+   sptk_mutex_unlock(&cache_lock);
+
+   return (0);
+}
+
+FFTPLAN *acquire_FFTPLAN(const int n)
+{
+   PLANNODE *node;
+
+   sptk_mutex_lock(&cache_lock);
+
+   for (node = plan_list; node != NULL; node = node->next)
+      if (!node->busy && node->plan.n == n)
+         break;
+
+   if (node != NULL) {
+      node->busy = 1;
+      sptk_mutex_unlock(&cache_lock);
+      return (&node->plan);
+   }
+
+   sptk_mutex_unlock(&cache_lock);
+
+   /* no idle plan of this size: build a new one outside the lock */
+   node = (PLANNODE *) getmem(1, sizeof(PLANNODE));
+   if (alloc_FFTPLAN(&node->plan, n) == -1) {
+      free(node);
+      return (NULL);
+   }
+   node->busy = 1;
+
+   sptk_mutex_lock(&cache_lock);
+   node->next = plan_list;
+   plan_list = node;
+   sptk_mutex_unlock(&cache_lock);
+
+   return (&node->plan);
+}
+
+int release_FFTPLAN(FFTPLAN * p)
+{
+   if (p == NULL)
+      return (-1);
+
+   sptk_mutex_lock(&cache_lock);
+   ((PLANNODE *) p)->busy = 0;
+   sptk_mutex_unlock(&cache_lock);
+
+   return (0);
+}
+
+int clear_fft_cache(void)
+{
+   TWIDDLE *t, **tp;
+   PLANNODE *node, **np;
+   int nbusy = 0;
+
+   sptk_mutex_lock(&cache_lock);
+
+   for (tp = &twiddle_list; (t = *tp) != NULL;) {
+      if (t->nref > 0) {
+         nbusy++;
+         tp = &t->next;
+      } else {
+         *tp = t->next;
+         free(t->table);
+         free(t);
+      }
+   }
+
+   for (np = &plan_list; (node = *np) != NULL;) {
+      if (node->busy) {
+         nbusy++;
+         np = &node->next;
+      } else {
+         *np = node->next;
+         free_FFTPLAN(&node->plan);
+         free(node);
+      }
+   }
+
+   sptk_mutex_unlock(&cache_lock);
+
+   /* number of entries kept because they are still in use */
+   return (nbusy);
+}
@@ -0,0 +1,564 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------- */
+/* The factorization, the butterflies and the recursive driver of    */
+/* this file are derived from KISS FFT:                              */
+/*                                                                   */
+/* Copyright (c) 2003-2010, Mark Borgerding                          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the author nor the names of any contributors may be     */
+/*   used to endorse or promote products derived from this software  */
+/*   without specific prior written permission.                      */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/********************************************************
+   $Id$
+
+       NAME:
+                fft_plan - plan-based mixed-radix fast fourier transform
+       SYNOPSIS:
+                int   alloc_FFTPLAN(p, n);
+                int   free_FFTPLAN(p);
+                int   fft_plan(p, x, y);
+                int   ifft_plan(p, x, y);
+                int   fftr_plan(p, x, y);
+                int   ifftr_plan(p, x, y);
+
+                FFTPLAN  *p;    plan for n-point transform
+                int      n;     data size (any positive integer)
+                double   x[];   real part
+                double   y[];   imaginary part (working area for fftr_plan)
+
+                return : success = 0
+                         fault   = -1
+
+       The transform size is factored into radix-4, 2, 3 and 5
+       stages (other prime factors are handled by a generic
+       butterfly), so that sizes such as 480 or 960 need not
+       be padded to a power of 2.  The plan holds the twiddle
+       factors and the working area for one size; fftr_plan()
+       computes the n-point real transform with one n/2-point
+       complex transform when n is even.
+********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+static int factorize(const int n, int *factor)
+{
+   int p = 4, m = n, nfactor = 0;
+   double floor_sqrt;
+
+   floor_sqrt = floor(sqrt((double) n));
+
+   /* factor out powers of 4, powers of 2, then any remaining primes */
+   do {
+      while (m % p) {
+         switch (p) {
+         case 4:
+            p = 2;
+            break;
+         case 2:
+            p = 3;
+            break;
+         default:
+            p += 2;
+            break;
+         }
+         if (p > floor_sqrt)
+            p = m;              /* no more factors, skip to end */
+      }
+      m /= p;
+      factor[2 * nfactor] = p;
+      factor[2 * nfactor + 1] = m;
+      nfactor++;
+   } while (m > 1);
+
+   return (nfactor);
+}
+
+static int max_radix(const int *factor, const int nfactor)
+{
+   int i, p = 0;
+
+   for (i = 0; i < nfactor; i++)
+      if (factor[2 * i] > p)
+         p = factor[2 * i];
+
+   return (p);
+}
+
+int alloc_FFTPLAN(FFTPLAN * p, const int n)
+{
+   int k, nbuf;
+   double arg;
+
+   if (n < 1) {
+      fprintf(stderr, "fft_plan : n must be a positive integer!\n");
+      return (-1);
+   }
+
+   p->n = n;
+   p->nfactor = factorize(n, p->factor);
+   if (n % 2 == 0)
+      p->nhfactor = factorize(n / 2, p->hfactor);
+   else
+      p->nhfactor = 0;
+
+   nbuf = max_radix(p->factor, p->nfactor);
+   if (p->nhfactor > 0 && max_radix(p->hfactor, p->nhfactor) > nbuf)
+      nbuf = max_radix(p->hfactor, p->nhfactor);
+
+   p->tw = (Complex *) getmem(n + n + n + nbuf, sizeof(Complex));
+   p->in = p->tw + n;
+   p->out = p->in + n;
+   p->scratch = p->out + n;
+
+   arg = PI2 / n;
+   for (k = 0; k < n; k++) {
+      p->tw[k].re = cos(arg * k);
+      p->tw[k].im = -sin(arg * k);
+   }
+
+   return (0);
+}
+
+int free_FFTPLAN(FFTPLAN * p)
+{
+   free(p->tw);
+   p->n = 0;
+   p->nfactor = 0;
+   p->nhfactor = 0;
+   p->tw = p->in = p->out = p->scratch = NULL;
+
+   return (0);
+}
+
+/* butterflies */
+
+static void bfly2(Complex * out, const int fstride, const FFTPLAN * p,
+                  const int m)
+{
+   int k;
+   Complex *out2, *tw, t;
+
+   out2 = out + m;
+   tw = p->tw;
+   for (k = 0; k < m; k++) {
+      t.re = out2->re * tw->re - out2->im * tw->im;
+      t.im = out2->re * tw->im + out2->im * tw->re;
+      tw += fstride;
+      out2->re = out->re - t.re;
+      out2->im = out->im - t.im;
+      out->re += t.re;
+      out->im += t.im;
+      out++;
+      out2++;
+   }
+}
+
+static void bfly3(Complex * out, const int fstride, const FFTPLAN * p,
+                  const int m)
+{
+   int k;
+   const int m2 = 2 * m;
+   Complex *tw1, *tw2, s0, s1, s2, s3;
+   double epi3;
+
+   tw1 = tw2 = p->tw;
+   epi3 = p->tw[fstride * m].im;
+
+   for (k = 0; k < m; k++) {
+      s1.re = out[m].re * tw1->re - out[m].im * tw1->im;
+      s1.im = out[m].re * tw1->im + out[m].im * tw1->re;
+      s2.re = out[m2].re * tw2->re - out[m2].im * tw2->im;
+      s2.im = out[m2].re * tw2->im + out[m2].im * tw2->re;
+
+      s3.re = s1.re + s2.re;
+      s3.im = s1.im + s2.im;
+      s0.re = (s1.re - s2.re) * epi3;
+      s0.im = (s1.im - s2.im) * epi3;
+      tw1 += fstride;
+      tw2 += 2 * fstride;
+
+      out[m].re = out->re - 0.5 * s3.re;
+      out[m].im = out->im - 0.5 * s3.im;
+
+      out->re += s3.re;
+      out->im += s3.im;
+
+      out[m2].re = out[m].re + s0.im;
+      out[m2].im = out[m].im - s0.re;
+
+      out[m].re -= s0.im;
+      out[m].im += s0.re;
+
+      out++;
+   }
+}
+
+static void bfly4(Complex * out, const int fstride, const FFTPLAN * p,
+                  const int m)
+{
+   int k;
+   const int m2 = 2 * m, m3 = 3 * m;
+   Complex *tw1, *tw2, *tw3, s0, s1, s2, s3, s4, s5;
+
+   tw1 = tw2 = tw3 = p->tw;
+
+   for (k = 0; k < m; k++) {
+      s0.re = out[m].re * tw1->re - out[m].im * tw1->im;
+      s0.im = out[m].re * tw1->im + out[m].im * tw1->re;
+      s1.re = out[m2].re * tw2->re - out[m2].im * tw2->im;
+      s1.im = out[m2].re * tw2->im + out[m2].im * tw2->re;
+      s2.re = out[m3].re * tw3->re - out[m3].im * tw3->im;
+      s2.im = out[m3].re * tw3->im + out[m3].im * tw3->re;
+
+      s5.re = out->re - s1.re;
+      s5.im = out->im - s1.im;
+      out->re += s1.re;
+      out->im += s1.im;
+      s3.re = s0.re + s2.re;
+      s3.im = s0.im + s2.im;
+      s4.re = s0.re - s2.re;
+      s4.im = s0.im - s2.im;
+
+      out[m2].re = out->re - s3.re;
+      out[m2].im = out->im - s3.im;
+      tw1 += fstride;
+      tw2 += 2 * fstride;
+      tw3 += 3 * fstride;
+      out->re += s3.re;
+      out->im += s3.im;
+
+      out[m].re = s5.re + s4.im;
+      out[m].im = s5.im - s4.re;
+      out[m3].re = s5.re - s4.im;
+      out[m3].im = s5.im + s4.re;
+
+      out++;
+   }
+}
+
+static void bfly5(Complex * out, const int fstride, const FFTPLAN * p,
+                  const int m)
+{
+   int u;
+   Complex *out0, *out1, *out2, *out3, *out4, *tw;
+   Complex s[13], ya, yb;
+
+   ya = p->tw[fstride * m];
+   yb = p->tw[fstride * 2 * m];
+
+   out0 = out;
+   out1 = out0 + m;
+   out2 = out0 + 2 * m;
+   out3 = out0 + 3 * m;
+   out4 = out0 + 4 * m;
+
+   tw = p->tw;
+   for (u = 0; u < m; u++) {
+      s[0] = *out0;
+
+      s[1].re = out1->re * tw[u * fstride].re - out1->im * tw[u * fstride].im;
+      s[1].im = out1->re * tw[u * fstride].im + out1->im * tw[u * fstride].re;
+      s[2].re =
+          out2->re * tw[2 * u * fstride].re - out2->im * tw[2 * u * fstride].im;
+      s[2].im =
+          out2->re * tw[2 * u * fstride].im + out2->im * tw[2 * u * fstride].re;
+      s[3].re =
+          out3->re * tw[3 * u * fstride].re - out3->im * tw[3 * u * fstride].im;
+      s[3].im =
+          out3->re * tw[3 * u * fstride].im + out3->im * tw[3 * u * fstride].re;
+      s[4].re =
+          out4->re * tw[4 * u * fstride].re - out4->im * tw[4 * u * fstride].im;
+      s[4].im =
+          out4->re * tw[4 * u * fstride].im + out4->im * tw[4 * u * fstride].re;
+
+      s[7].re = s[1].re + s[4].re;
+      s[7].im = s[1].im + s[4].im;
+      s[10].re = s[1].re - s[4].re;
+      s[10].im = s[1].im - s[4].im;
+      s[8].re = s[2].re + s[3].re;
+      s[8].im = s[2].im + s[3].im;
+      s[9].re = s[2].re - s[3].re;
+      s[9].im = s[2].im - s[3].im;
+
+      out0->re += s[7].re + s[8].re;
+      out0->im += s[7].im + s[8].im;
+
+      s[5].re = s[0].re + s[7].re * ya.re + s[8].re * yb.re;
+      s[5].im = s[0].im + s[7].im * ya.re + s[8].im * yb.re;
+
+      s[6].re = s[10].im * ya.im + s[9].im * yb.im;
+      s[6].im = -s[10].re * ya.im - s[9].re * yb.im;
+
+      out1->re = s[5].re - s[6].re;
+      out1->im = s[5].im - s[6].im;
+      out4->re = s[5].re + s[6].re;
+      out4->im = s[5].im + s[6].im;
+
+      s[11].re = s[0].re + s[7].re * yb.re + s[8].re * ya.re;
+      s[11].im = s[0].im + s[7].im * yb.re + s[8].im * ya.re;
+      s[12].re = -s[10].im * yb.im + s[9].im * ya.im;
+      s[12].im = s[10].re * yb.im - s[9].re * ya.im;
+
+      out2->re = s[11].re + s[12].re;
+      out2->im = s[11].im + s[12].im;
+      out3->re = s[11].re - s[12].re;
+      out3->im = s[11].im - s[12].im;
+
+      out0++;
+      out1++;
+      out2++;
+      out3++;
+      out4++;
+   }
+}
+
+/* butterfly for radices other than 2, 3, 4 and 5 */
+static void bfly_generic(Complex * out, const int fstride, const FFTPLAN * p,
+                         const int m, const int radix)
+{
+   int u, k, q1, q, twidx;
+   Complex *scratch = p->scratch, t;
+
+   for (u = 0; u < m; u++) {
+      for (q1 = 0, k = u; q1 < radix; q1++, k += m)
+         scratch[q1] = out[k];
+
+      for (q1 = 0, k = u; q1 < radix; q1++, k += m) {
+         twidx = 0;
+         out[k] = scratch[0];
+         for (q = 1; q < radix; q++) {
+            twidx += fstride * k;
+            if (twidx >= p->n)
+               twidx -= p->n;
+            t.re = scratch[q].re * p->tw[twidx].re
+                - scratch[q].im * p->tw[twidx].im;
+            t.im = scratch[q].re * p->tw[twidx].im
+                + scratch[q].im * p->tw[twidx].re;
+            out[k].re += t.re;
+            out[k].im += t.im;
+         }
+      }
+   }
+}
+
+/* f is read with stride fstride, twiddle factors are taken with
+   stride fstride * tstride */
+static void work(Complex * out, const Complex * f, const int fstride,
+                 const int tstride, const int *factor, const FFTPLAN * p)
+{
+   Complex *out_beg = out, *out_end;
+   const int radix = factor[0], m = factor[1];
+
+   out_end = out + radix * m;
+
+   if (m == 1) {
+      do {
+         *out = *f;
+         f += fstride;
+      } while (++out != out_end);
+   } else {
+      do {
+         /* recursive call: DFT of size m * radix performed by doing
+            radix instances of smaller DFTs of size m */
+         work(out, f, fstride * radix, tstride, factor + 2, p);
+         f += fstride;
+      } while ((out += m) != out_end);
+   }
+
+   out = out_beg;
+
+   switch (radix) {
+   case 2:
+      bfly2(out, fstride * tstride, p, m);
+      break;
+   case 3:
+      bfly3(out, fstride * tstride, p, m);
+      break;
+   case 4:
+      bfly4(out, fstride * tstride, p, m);
+      break;
+   case 5:
+      bfly5(out, fstride * tstride, p, m);
+      break;
+   default:
+      bfly_generic(out, fstride * tstride, p, m, radix);
+      break;
+   }
+}
+
+int fft_plan(FFTPLAN * p, double *x, double *y)
+{
+   int k;
+   const int n = p->n;
+
+   for (k = 0; k < n; k++) {
+      p->in[k].re = x[k];
+      p->in[k].im = y[k];
+   }
+
+   work(p->out, p->in, 1, 1, p->factor, p);
+
+   for (k = 0; k < n; k++) {
+      x[k] = p->out[k].re;
+      y[k] = p->out[k].im;
+   }
+
+   return (0);
+}
+
+int ifft_plan(FFTPLAN * p, double *x, double *y)
+{
+   int k;
+   const int n = p->n;
+
+   if (fft_plan(p, y, x) == -1)
+      return (-1);
+
+   for (k = 0; k < n; k++) {
+      x[k] /= n;
+      y[k] /= n;
+   }
+
+   return (0);
+}
+
+int fftr_plan(FFTPLAN * p, double *x, double *y)
+{
+   int k;
+   const int n = p->n, nh = p->n / 2;
+   Complex *z, *tw, f1, f2, t;
+
+   if (p->nhfactor == 0) {      /* odd size: use complex transform */
+      fillz(y, sizeof(*y), n);
+      return (fft_plan(p, x, y));
+   }
+
+   /* pack even and odd samples into n/2 complex samples */
+   for (k = 0; k < nh; k++) {
+      p->in[k].re = x[2 * k];
+      p->in[k].im = x[2 * k + 1];
+   }
+
+   /* n/2 point complex fft with stride-2 twiddle factors */
+   work(p->out, p->in, 1, 2, p->hfactor, p);
+
+   z = p->out;
+   tw = p->tw;
+
+   x[0] = z[0].re + z[0].im;
+   y[0] = 0.0;
+   x[nh] = z[0].re - z[0].im;
+   y[nh] = 0.0;
+
+   for (k = 1; k < nh; k++) {
+      f1.re = 0.5 * (z[k].re + z[nh - k].re);
+      f1.im = 0.5 * (z[k].im - z[nh - k].im);
+      f2.re = 0.5 * (z[k].im + z[nh - k].im);
+      f2.im = -0.5 * (z[k].re - z[nh - k].re);
+
+      t.re = f2.re * tw[k].re - f2.im * tw[k].im;
+      t.im = f2.re * tw[k].im + f2.im * tw[k].re;
+
+      x[k] = f1.re + t.re;
+      y[k] = f1.im + t.im;
+      x[n - k] = x[k];
+      y[n - k] = -y[k];
+   }
+
+   return (0);
+}
+
+int ifftr_plan(FFTPLAN * p, double *x, double *y)
+{
+   int k;
+   const int n = p->n;
+
+   if (fftr_plan(p, x, y) == -1)
+      return (-1);
+
+   for (k = 0; k < n; k++) {
+      x[k] /= n;
+      y[k] /= -n;
+   }
+
+   return (0);
+}
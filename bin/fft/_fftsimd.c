@@ -0,0 +1,626 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/********************************************************
+   $Id$
+
+       NAME:
+                fftsimd - vectorized kernels for fft and fftr
+       SYNOPSIS:
+                int   fftsimd_level();
+                int   fftsimd_bfly(x, y, sinp, cosp, m, lmx, lf);
+                int   fftsimd_pair(x, y, m);
+                int   fftsimd_split(x, y, sinp, cosp, m, n);
+                int   fftsimd_bflyf(x, y, sinp, cosp, m, lmx, lf);
+                int   fftsimd_pairf(x, y, m);
+
+                double  x[];    real part
+                double  y[];    imaginary part
+                double  *sinp;  sin table
+                double  *cosp;  cos table
+                int     m;      data size
+                int     lmx;    butterfly span of the stage
+                int     lf;     stride of the sin/cos table
+                int     n;      stride of the sin/cos table
+
+                return : done by SIMD = 0
+                         not done     = -1 (caller runs scalar code)
+
+       The instruction set is chosen at run time: AVX2 or SSE2
+       on x86, NEON on AArch64.  The kernels perform the same
+       operations in the same order as the scalar code, so the
+       results do not depend on the selected instruction set.
+       fftsimd_bflyf() and fftsimd_pairf() are the single
+       precision versions used by fftf().
+********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#include "../sptk_thread.h"
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define FFTSIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define FFTSIMD_NEON
+#include <arm_neon.h>
+#endif
+
+static int detect(void)
+{
+#if defined(FFTSIMD_X86)
+#if defined(_MSC_VER)
+   int info[4];
+   unsigned long long xcr0;
+
+   __cpuid(info, 0);
+   if (info[0] >= 7) {
+      __cpuid(info, 1);
+      /* OSXSAVE and AVX, and the OS saves the YMM registers */
+      if ((info[2] & (1 << 27)) && (info[2] & (1 << 28))) {
+         xcr0 = _xgetbv(0);
+         if ((xcr0 & 6) == 6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+               return (SPTK_SIMD_AVX2);
+         }
+      }
+   }
+   __cpuid(info, 1);
+   if (info[3] & (1 << 26))
+      return (SPTK_SIMD_SSE2);
+#else
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx2"))
+      return (SPTK_SIMD_AVX2);
+   if (__builtin_cpu_supports("sse2"))
+      return (SPTK_SIMD_SSE2);
+#endif
+#elif defined(FFTSIMD_NEON)
+   return (SPTK_SIMD_SSE2);
+#endif
+   return (SPTK_SIMD_NONE);
+}
+
+static sptk_once_t level_once = SPTK_ONCE_INIT;
+static int level = SPTK_SIMD_NONE;
+
+static SPTK_ONCE_PROC(init_level)
+{
+   level = detect();
+   SPTK_ONCE_RETURN;
+}
+
+int fftsimd_level(void)
+{
+   /* detected by the first caller; the others wait for it */
+   sptk_once(&level_once, init_level);
+
+   return (level);
+}
+
+#if defined(FFTSIMD_X86)
+
+/* one radix-2 stage: x[k] + x[k + lmx] and (x[k] - x[k + lmx]) * w */
+TARGET_SSE2 static void bfly_sse2(double *x, double *y, const double *sinp,
+                                  const double *cosp, const int m,
+                                  const int lmx, const int lf)
+{
+   int j, k;
+   const int lix = lmx + lmx;
+   __m128d c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 2) {
+      c = _mm_set_pd(cosp[(j + 1) * lf], cosp[j * lf]);
+      s = _mm_set_pd(sinp[(j + 1) * lf], sinp[j * lf]);
+      for (k = j; k < m; k += lix) {
+         xa = _mm_loadu_pd(x + k);
+         xb = _mm_loadu_pd(x + k + lmx);
+         ya = _mm_loadu_pd(y + k);
+         yb = _mm_loadu_pd(y + k + lmx);
+         t1 = _mm_sub_pd(xa, xb);
+         t2 = _mm_sub_pd(ya, yb);
+         _mm_storeu_pd(x + k, _mm_add_pd(xa, xb));
+         _mm_storeu_pd(y + k, _mm_add_pd(ya, yb));
+         _mm_storeu_pd(x + k + lmx,
+                       _mm_add_pd(_mm_mul_pd(c, t1), _mm_mul_pd(s, t2)));
+         _mm_storeu_pd(y + k + lmx,
+                       _mm_sub_pd(_mm_mul_pd(c, t2), _mm_mul_pd(s, t1)));
+      }
+   }
+}
+
+TARGET_AVX2 static void bfly_avx2(double *x, double *y, const double *sinp,
+                                  const double *cosp, const int m,
+                                  const int lmx, const int lf)
+{
+   int j, k;
+   const int lix = lmx + lmx;
+   __m256d c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 4) {
+      c = _mm256_set_pd(cosp[(j + 3) * lf], cosp[(j + 2) * lf],
+                        cosp[(j + 1) * lf], cosp[j * lf]);
+      s = _mm256_set_pd(sinp[(j + 3) * lf], sinp[(j + 2) * lf],
+                        sinp[(j + 1) * lf], sinp[j * lf]);
+      for (k = j; k < m; k += lix) {
+         xa = _mm256_loadu_pd(x + k);
+         xb = _mm256_loadu_pd(x + k + lmx);
+         ya = _mm256_loadu_pd(y + k);
+         yb = _mm256_loadu_pd(y + k + lmx);
+         t1 = _mm256_sub_pd(xa, xb);
+         t2 = _mm256_sub_pd(ya, yb);
+         _mm256_storeu_pd(x + k, _mm256_add_pd(xa, xb));
+         _mm256_storeu_pd(y + k, _mm256_add_pd(ya, yb));
+         _mm256_storeu_pd(x + k + lmx,
+                          _mm256_add_pd(_mm256_mul_pd(c, t1),
+                                        _mm256_mul_pd(s, t2)));
+         _mm256_storeu_pd(y + k + lmx,
+                          _mm256_sub_pd(_mm256_mul_pd(c, t2),
+                                        _mm256_mul_pd(s, t1)));
+      }
+   }
+}
+
+/* last stage: (x[2i], x[2i+1]) -> (x[2i] + x[2i+1], x[2i] - x[2i+1]) */
+TARGET_SSE2 static void pair_sse2(double *x, double *y, const int m)
+{
+   int k;
+   __m128d v, w;
+
+   for (k = 0; k < m; k += 2) {
+      v = _mm_loadu_pd(x + k);
+      w = _mm_shuffle_pd(v, v, 1);
+      _mm_storeu_pd(x + k,
+                    _mm_shuffle_pd(_mm_add_pd(v, w), _mm_sub_pd(v, w), 0));
+      v = _mm_loadu_pd(y + k);
+      w = _mm_shuffle_pd(v, v, 1);
+      _mm_storeu_pd(y + k,
+                    _mm_shuffle_pd(_mm_add_pd(v, w), _mm_sub_pd(v, w), 0));
+   }
+}
+
+/* real-input split of fftr(), i = 1, ..., m/2 - 1 */
+TARGET_SSE2 static int split_sse2(double *x, double *y, const double *sinp,
+                                  const double *cosp, const int m,
+                                  const int n)
+{
+   int i;
+   const int mv2 = m / 2;
+   const __m128d half = _mm_set1_pd(0.5);
+   __m128d c, s, xa, xb, ya, yb, xt, yt, u, v;
+
+   for (i = 1; i + 1 < mv2; i += 2) {
+      c = _mm_set_pd(cosp[(i + 1) * n], cosp[i * n]);
+      s = _mm_set_pd(sinp[(i + 1) * n], sinp[i * n]);
+      xa = _mm_loadu_pd(x + i);
+      ya = _mm_loadu_pd(y + i);
+      xb = _mm_loadu_pd(x + mv2 - i - 1);
+      xb = _mm_shuffle_pd(xb, xb, 1);
+      yb = _mm_loadu_pd(y + mv2 - i - 1);
+      yb = _mm_shuffle_pd(yb, yb, 1);
+      yt = _mm_add_pd(ya, yb);
+      xt = _mm_sub_pd(xa, xb);
+      u = _mm_mul_pd(_mm_sub_pd(_mm_add_pd(_mm_add_pd(xa, xb),
+                                           _mm_mul_pd(c, yt)),
+                                _mm_mul_pd(s, xt)), half);
+      v = _mm_mul_pd(_mm_add_pd(_mm_add_pd(_mm_sub_pd(yb, ya),
+                                           _mm_mul_pd(s, yt)),
+                                _mm_mul_pd(c, xt)), half);
+      _mm_storeu_pd(x + m - i - 1, _mm_shuffle_pd(u, u, 1));
+      _mm_storeu_pd(y + m - i - 1, _mm_shuffle_pd(v, v, 1));
+   }
+
+   return (i);
+}
+
+TARGET_AVX2 static int split_avx2(double *x, double *y, const double *sinp,
+                                  const double *cosp, const int m,
+                                  const int n)
+{
+   int i;
+   const int mv2 = m / 2;
+   const __m256d half = _mm256_set1_pd(0.5);
+   __m256d c, s, xa, xb, ya, yb, xt, yt, u, v;
+
+   for (i = 1; i + 3 < mv2; i += 4) {
+      c = _mm256_set_pd(cosp[(i + 3) * n], cosp[(i + 2) * n],
+                        cosp[(i + 1) * n], cosp[i * n]);
+      s = _mm256_set_pd(sinp[(i + 3) * n], sinp[(i + 2) * n],
+                        sinp[(i + 1) * n], sinp[i * n]);
+      xa = _mm256_loadu_pd(x + i);
+      ya = _mm256_loadu_pd(y + i);
+      xb = _mm256_permute4x64_pd(_mm256_loadu_pd(x + mv2 - i - 3), 0x1b);
+      yb = _mm256_permute4x64_pd(_mm256_loadu_pd(y + mv2 - i - 3), 0x1b);
+      yt = _mm256_add_pd(ya, yb);
+      xt = _mm256_sub_pd(xa, xb);
+      u = _mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(_mm256_add_pd(xa, xb),
+                                                    _mm256_mul_pd(c, yt)),
+                                      _mm256_mul_pd(s, xt)), half);
+      v = _mm256_mul_pd(_mm256_add_pd(_mm256_add_pd(_mm256_sub_pd(yb, ya),
+                                                    _mm256_mul_pd(s, yt)),
+                                      _mm256_mul_pd(c, xt)), half);
+      _mm256_storeu_pd(x + m - i - 3, _mm256_permute4x64_pd(u, 0x1b));
+      _mm256_storeu_pd(y + m - i - 3, _mm256_permute4x64_pd(v, 0x1b));
+   }
+
+   return (i);
+}
+
+TARGET_SSE2 static void bflyf_sse2(float *x, float *y, const double *sinp,
+                                   const double *cosp, const int m,
+                                   const int lmx, const int lf)
+{
+   int j, k;
+   const int lix = lmx + lmx;
+   __m128 c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 4) {
+      c = _mm_set_ps((float) cosp[(j + 3) * lf], (float) cosp[(j + 2) * lf],
+                     (float) cosp[(j + 1) * lf], (float) cosp[j * lf]);
+      s = _mm_set_ps((float) sinp[(j + 3) * lf], (float) sinp[(j + 2) * lf],
+                     (float) sinp[(j + 1) * lf], (float) sinp[j * lf]);
+      for (k = j; k < m; k += lix) {
+         xa = _mm_loadu_ps(x + k);
+         xb = _mm_loadu_ps(x + k + lmx);
+         ya = _mm_loadu_ps(y + k);
+         yb = _mm_loadu_ps(y + k + lmx);
+         t1 = _mm_sub_ps(xa, xb);
+         t2 = _mm_sub_ps(ya, yb);
+         _mm_storeu_ps(x + k, _mm_add_ps(xa, xb));
+         _mm_storeu_ps(y + k, _mm_add_ps(ya, yb));
+         _mm_storeu_ps(x + k + lmx,
+                       _mm_add_ps(_mm_mul_ps(c, t1), _mm_mul_ps(s, t2)));
+         _mm_storeu_ps(y + k + lmx,
+                       _mm_sub_ps(_mm_mul_ps(c, t2), _mm_mul_ps(s, t1)));
+      }
+   }
+}
+
+TARGET_AVX2 static void bflyf_avx2(float *x, float *y, const double *sinp,
+                                   const double *cosp, const int m,
+                                   const int lmx, const int lf)
+{
+   int j, k;
+   const int lix = lmx + lmx;
+   __m256 c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 8) {
+      c = _mm256_set_ps((float) cosp[(j + 7) * lf],
+                        (float) cosp[(j + 6) * lf],
+                        (float) cosp[(j + 5) * lf],
+                        (float) cosp[(j + 4) * lf],
+                        (float) cosp[(j + 3) * lf],
+                        (float) cosp[(j + 2) * lf],
+                        (float) cosp[(j + 1) * lf], (float) cosp[j * lf]);
+      s = _mm256_set_ps((float) sinp[(j + 7) * lf],
+                        (float) sinp[(j + 6) * lf],
+                        (float) sinp[(j + 5) * lf],
+                        (float) sinp[(j + 4) * lf],
+                        (float) sinp[(j + 3) * lf],
+                        (float) sinp[(j + 2) * lf],
+                        (float) sinp[(j + 1) * lf], (float) sinp[j * lf]);
+      for (k = j; k < m; k += lix) {
+         xa = _mm256_loadu_ps(x + k);
+         xb = _mm256_loadu_ps(x + k + lmx);
+         ya = _mm256_loadu_ps(y + k);
+         yb = _mm256_loadu_ps(y + k + lmx);
+         t1 = _mm256_sub_ps(xa, xb);
+         t2 = _mm256_sub_ps(ya, yb);
+         _mm256_storeu_ps(x + k, _mm256_add_ps(xa, xb));
+         _mm256_storeu_ps(y + k, _mm256_add_ps(ya, yb));
+         _mm256_storeu_ps(x + k + lmx,
+                          _mm256_add_ps(_mm256_mul_ps(c, t1),
+                                        _mm256_mul_ps(s, t2)));
+         _mm256_storeu_ps(y + k + lmx,
+                          _mm256_sub_ps(_mm256_mul_ps(c, t2),
+                                        _mm256_mul_ps(s, t1)));
+      }
+   }
+}
+
+TARGET_SSE2 static void pairf_sse2(float *x, float *y, const int m)
+{
+   int k;
+   __m128 v, w;
+
+   for (k = 0; k < m; k += 4) {
+      v = _mm_loadu_ps(x + k);
+      w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+      /* (sum0, sum2, diff0, diff2) -> (sum0, diff0, sum2, diff2) */
+      v = _mm_shuffle_ps(_mm_add_ps(v, w), _mm_sub_ps(v, w),
+                         _MM_SHUFFLE(2, 0, 2, 0));
+      _mm_storeu_ps(x + k, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 2, 0)));
+      v = _mm_loadu_ps(y + k);
+      w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shuffle_ps(_mm_add_ps(v, w), _mm_sub_ps(v, w),
+                         _MM_SHUFFLE(2, 0, 2, 0));
+      _mm_storeu_ps(y + k, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 1, 2, 0)));
+   }
+}
+
+#elif defined(FFTSIMD_NEON)
+
+static void bfly_neon(double *x, double *y, const double *sinp,
+                      const double *cosp, const int m, const int lmx,
+                      const int lf)
+{
+   int j, k;
+   const int lix = lmx + lmx;
+   double tc[2], ts[2];
+   float64x2_t c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 2) {
+      tc[0] = cosp[j * lf];
+      tc[1] = cosp[(j + 1) * lf];
+      ts[0] = sinp[j * lf];
+      ts[1] = sinp[(j + 1) * lf];
+      c = vld1q_f64(tc);
+      s = vld1q_f64(ts);
+      for (k = j; k < m; k += lix) {
+         xa = vld1q_f64(x + k);
+         xb = vld1q_f64(x + k + lmx);
+         ya = vld1q_f64(y + k);
+         yb = vld1q_f64(y + k + lmx);
+         t1 = vsubq_f64(xa, xb);
+         t2 = vsubq_f64(ya, yb);
+         vst1q_f64(x + k, vaddq_f64(xa, xb));
+         vst1q_f64(y + k, vaddq_f64(ya, yb));
+         vst1q_f64(x + k + lmx, vaddq_f64(vmulq_f64(c, t1), vmulq_f64(s, t2)));
+         vst1q_f64(y + k + lmx, vsubq_f64(vmulq_f64(c, t2), vmulq_f64(s, t1)));
+      }
+   }
+}
+
+static void pair_neon(double *x, double *y, const int m)
+{
+   int k;
+   float64x2_t v, w;
+
+   for (k = 0; k < m; k += 2) {
+      v = vld1q_f64(x + k);
+      w = vextq_f64(v, v, 1);
+      vst1q_f64(x + k, vzip1q_f64(vaddq_f64(v, w), vsubq_f64(v, w)));
+      v = vld1q_f64(y + k);
+      w = vextq_f64(v, v, 1);
+      vst1q_f64(y + k, vzip1q_f64(vaddq_f64(v, w), vsubq_f64(v, w)));
+   }
+}
+
+static int split_neon(double *x, double *y, const double *sinp,
+                      const double *cosp, const int m, const int n)
+{
+   int i;
+   const int mv2 = m / 2;
+   double tc[2], ts[2];
+   const float64x2_t half = vdupq_n_f64(0.5);
+   float64x2_t c, s, xa, xb, ya, yb, xt, yt, u, v;
+
+   for (i = 1; i + 1 < mv2; i += 2) {
+      tc[0] = cosp[i * n];
+      tc[1] = cosp[(i + 1) * n];
+      ts[0] = sinp[i * n];
+      ts[1] = sinp[(i + 1) * n];
+      c = vld1q_f64(tc);
+      s = vld1q_f64(ts);
+      xa = vld1q_f64(x + i);
+      ya = vld1q_f64(y + i);
+      xb = vld1q_f64(x + mv2 - i - 1);
+      xb = vextq_f64(xb, xb, 1);
+      yb = vld1q_f64(y + mv2 - i - 1);
+      yb = vextq_f64(yb, yb, 1);
+      yt = vaddq_f64(ya, yb);
+      xt = vsubq_f64(xa, xb);
+      u = vmulq_f64(vsubq_f64(vaddq_f64(vaddq_f64(xa, xb), vmulq_f64(c, yt)),
+                              vmulq_f64(s, xt)), half);
+      v = vmulq_f64(vaddq_f64(vaddq_f64(vsubq_f64(yb, ya), vmulq_f64(s, yt)),
+                              vmulq_f64(c, xt)), half);
+      vst1q_f64(x + m - i - 1, vextq_f64(u, u, 1));
+      vst1q_f64(y + m - i - 1, vextq_f64(v, v, 1));
+   }
+
+   return (i);
+}
+
+static void bflyf_neon(float *x, float *y, const double *sinp,
+                       const double *cosp, const int m, const int lmx,
+                       const int lf)
+{
+   int j, k, l;
+   const int lix = lmx + lmx;
+   float tc[4], ts[4];
+   float32x4_t c, s, xa, xb, ya, yb, t1, t2;
+
+   for (j = 0; j < lmx; j += 4) {
+      for (l = 0; l < 4; l++) {
+         tc[l] = (float) cosp[(j + l) * lf];
+         ts[l] = (float) sinp[(j + l) * lf];
+      }
+      c = vld1q_f32(tc);
+      s = vld1q_f32(ts);
+      for (k = j; k < m; k += lix) {
+         xa = vld1q_f32(x + k);
+         xb = vld1q_f32(x + k + lmx);
+         ya = vld1q_f32(y + k);
+         yb = vld1q_f32(y + k + lmx);
+         t1 = vsubq_f32(xa, xb);
+         t2 = vsubq_f32(ya, yb);
+         vst1q_f32(x + k, vaddq_f32(xa, xb));
+         vst1q_f32(y + k, vaddq_f32(ya, yb));
+         vst1q_f32(x + k + lmx, vaddq_f32(vmulq_f32(c, t1), vmulq_f32(s, t2)));
+         vst1q_f32(y + k + lmx, vsubq_f32(vmulq_f32(c, t2), vmulq_f32(s, t1)));
+      }
+   }
+}
+
+#endif
+
+int fftsimd_bfly(double *x, double *y, const double *sinp, const double *cosp,
+                 const int m, const int lmx, const int lf)
+{
+   switch (fftsimd_level()) {
+#if defined(FFTSIMD_X86)
+   case SPTK_SIMD_AVX2:
+      if (lmx >= 4) {
+         bfly_avx2(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      /* fall through */
+   case SPTK_SIMD_SSE2:
+      if (lmx >= 2) {
+         bfly_sse2(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      break;
+#elif defined(FFTSIMD_NEON)
+   case SPTK_SIMD_SSE2:
+      if (lmx >= 2) {
+         bfly_neon(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      break;
+#endif
+   default:
+      break;
+   }
+
+   return (-1);
+}
+
+int fftsimd_pair(double *x, double *y, const int m)
+{
+   if (fftsimd_level() == SPTK_SIMD_NONE)
+      return (-1);
+
+#if defined(FFTSIMD_X86)
+   pair_sse2(x, y, m);
+   return (0);
+#elif defined(FFTSIMD_NEON)
+   pair_neon(x, y, m);
+   return (0);
+#else
+   return (-1);
+#endif
+}
+
+/* returns the first index i left for the scalar loop */
+int fftsimd_split(double *x, double *y, const double *sinp,
+                  const double *cosp, const int m, const int n)
+{
+   switch (fftsimd_level()) {
+#if defined(FFTSIMD_X86)
+   case SPTK_SIMD_AVX2:
+      return (split_avx2(x, y, sinp, cosp, m, n));
+   case SPTK_SIMD_SSE2:
+      return (split_sse2(x, y, sinp, cosp, m, n));
+#elif defined(FFTSIMD_NEON)
+   case SPTK_SIMD_SSE2:
+      return (split_neon(x, y, sinp, cosp, m, n));
+#endif
+   default:
+      break;
+   }
+
+   return (1);
+}
+
+int fftsimd_bflyf(float *x, float *y, const double *sinp,
+                  const double *cosp, const int m, const int lmx,
+                  const int lf)
+{
+   switch (fftsimd_level()) {
+#if defined(FFTSIMD_X86)
+   case SPTK_SIMD_AVX2:
+      if (lmx >= 8) {
+         bflyf_avx2(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      /* fall through */
+   case SPTK_SIMD_SSE2:
+      if (lmx >= 4) {
+         bflyf_sse2(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      break;
+#elif defined(FFTSIMD_NEON)
+   case SPTK_SIMD_SSE2:
+      if (lmx >= 4) {
+         bflyf_neon(x, y, sinp, cosp, m, lmx, lf);
+         return (0);
+      }
+      break;
+#endif
+   default:
+      break;
+   }
+
+   return (-1);
+}
+
+int fftsimd_pairf(float *x, float *y, const int m)
+{
+#if defined(FFTSIMD_X86)
+   if (fftsimd_level() != SPTK_SIMD_NONE && m % 4 == 0) {
+      pairf_sse2(x, y, m);
+      return (0);
+   }
+#endif
+   return (-1);
+}
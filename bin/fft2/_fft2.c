@@ -74,22 +74,12 @@ $Id: _fft2.c,v 1.19 2016/12/22 10:53:03 fjst15124 Exp $
 int fft2(double x[], double y[], const int n)
 {
    double *xq, *yq;
-   static double *xb = NULL, *yb;
+   double *xb, *yb;
    double *xp, *yp;
    int i, j;
-   static int size_f;
 
-   if (xb == NULL) {
-      size_f = 2 * n;
-      xb = dgetmem(size_f);
-      yb = xb + n;
-   }
-   if (2 * n > size_f) {
-      free(xb);
-      size_f = 2 * n;
-      xb = dgetmem(size_f);
-      yb = xb + n;
-   }
+   xb = dgetmem(2 * n);
+   yb = xb + n;
 
    for (i = 0; i < n; i++) {
       xp = xb;
@@ -101,8 +91,10 @@ int fft2(double x[], double y[], const int n)
          *yp++ = *yq;
       }
 
-      if (fft(xb, yb, n) < 0)
+      if (fft(xb, yb, n) < 0) {
+         free(xb);
          return (-1);
+      }
 
       xp = xb;
       xq = x + i;
@@ -114,6 +106,8 @@ int fft2(double x[], double y[], const int n)
       }
    }
 
+   free(xb);
+
    for (i = n, xp = x, yp = y; --i >= 0; xp += n, yp += n) {
       if (fft(xp, yp, n) < 0)
          return (-1);
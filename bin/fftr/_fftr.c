@@ -52,7 +52,13 @@
                      
         double  x[];   real part of data      
         double  y[];   working area         
-        int     m;     number of data(radix 2)      
+        int     m;     number of data (radix 2, otherwise the
+                       mixed-radix fft is used)
+
+        int   fftrf(x, y, m)
+
+        float   x[], y[];  single precision version (m must be
+                           a power of 2 and at least 8)
                 Naohiro Isshiki    Dec.1995   modified
 ********************************************************/
 
@@ -66,17 +72,32 @@
 #include <SPTK.h>
 #endif
 
-extern double *_sintbl;
-extern int maxfftsize;
+int fftsimd_split(double *x, double *y, const double *sinp,
+                  const double *cosp, const int m, const int n);
 
 int fftr(double *x, double *y, const int m)
 {
-   int i, j;
+   int i;
    double *xp, *yp, *xq;
    double *yq;
-   int mv2, n, tblsize;
+   int mv2, n;
    double xt, yt, *sinp, *cosp;
-   double arg;
+   FFTPLAN *plan;
+   TWIDDLE *tw;
+
+   /* sizes other than powers of 2 use the mixed-radix real fft */
+   for (i = 4; i < m; i <<= 1);
+   if (i != m) {
+      if (m < 1) {
+         fprintf(stderr, "fftr : m must be a positive integer!\n");
+         return (-1);
+      }
+      if ((plan = acquire_FFTPLAN(m)) == NULL)
+         return (-1);
+      fftr_plan(plan, x, y);
+      release_FFTPLAN(plan);
+      return (0);
+   }
 
    mv2 = m / 2;
 
@@ -96,40 +117,83 @@ int fftr(double *x, double *y, const int m)
    * SIN table generation *
    ***********************/
 
-   if ((_sintbl == 0) || (maxfftsize < m)) {
-      tblsize = m - m / 4 + 1;
-      arg = PI / m * 2;
-      if (_sintbl != 0)
-         free(_sintbl);
-      _sintbl = sinp = dgetmem(tblsize);
-      *sinp++ = 0;
-      for (j = 1; j < tblsize; j++)
-         *sinp++ = sin(arg * (double) j);
-      _sintbl[m / 2] = 0;
-      maxfftsize = m;
+   tw = shared_TWIDDLE(m);
+   n = 1;
+   sinp = tw->table;
+   cosp = tw->table + m / 4;
+
+   x[mv2] = x[0] - y[0];
+   x[0] = x[0] + y[0];
+   y[mv2] = y[0] = 0;
+
+   /* X(i) and X(m-i) from the m / 2 point spectrum, i = 1, ..., m/2 - 1 */
+   for (i = fftsimd_split(x, y, sinp, cosp, m, n); i < mv2; i++) {
+      yt = y[i] + y[mv2 - i];
+      xt = x[i] - x[mv2 - i];
+      x[m - i] = (x[i] + x[mv2 - i] + cosp[i * n] * yt - sinp[i * n] * xt)
+          * 0.5;
+      y[m - i] = (y[mv2 - i] - y[i] + sinp[i * n] * yt + cosp[i * n] * xt)
+          * 0.5;
+   }
+
+   xp = x + 1;
+   yp = y + 1;
+   xq = x + m;
+   yq = y + m;
+
+   for (i = mv2; --i;) {
+      *xp++ = *(--xq);
+      *yp++ = -(*(--yq));
+   }
+
+   return (0);
+}
+
+int fftrf(float *x, float *y, const int m)
+{
+   int i;
+   float *xp, *yp, *xq;
+   float *yq;
+   int mv2, n;
+   float xt, yt;
+   double *sinp, *cosp;
+   TWIDDLE *tw;
+
+   for (i = 8; i < m; i <<= 1);
+   if (i != m) {
+      fprintf(stderr, "fftrf : m must be a power of 2 and at least 8!\n");
+      return (-1);
    }
 
-   n = maxfftsize / m;
-   sinp = _sintbl;
-   cosp = _sintbl + maxfftsize / 4;
+   mv2 = m / 2;
 
-   xp = x;
+   /* separate even and odd  */
+   xq = xp = x;
    yp = y;
-   xq = xp + m;
-   yq = yp + m;
-   *(xp + mv2) = *xp - *yp;
-   *xp = *xp + *yp;
-   *(yp + mv2) = *yp = 0;
-
-   for (i = mv2, j = mv2 - 2; --i; j -= 2) {
-      ++xp;
-      ++yp;
-      sinp += n;
-      cosp += n;
-      yt = *yp + *(yp + j);
-      xt = *xp - *(xp + j);
-      *(--xq) = (*xp + *(xp + j) + *cosp * yt - *sinp * xt) * 0.5;
-      *(--yq) = (*(yp + j) - *yp + *sinp * yt + *cosp * xt) * 0.5;
+   for (i = mv2; --i >= 0;) {
+      *xp++ = *xq++;
+      *yp++ = *xq++;
+   }
+
+   if (fftf(x, y, mv2) == -1)   /* m / 2 point fft */
+      return (-1);
+
+   tw = shared_TWIDDLE(m);
+   n = 1;
+   sinp = tw->table;
+   cosp = tw->table + m / 4;
+
+   x[mv2] = x[0] - y[0];
+   x[0] = x[0] + y[0];
+   y[mv2] = y[0] = 0;
+
+   for (i = 1; i < mv2; i++) {
+      yt = y[i] + y[mv2 - i];
+      xt = x[i] - x[mv2 - i];
+      x[m - i] = (x[i] + x[mv2 - i] + (float) cosp[i * n] * yt
+                  - (float) sinp[i * n] * xt) * 0.5f;
+      y[m - i] = (y[mv2 - i] - y[i] + (float) sinp[i * n] * yt
+                  + (float) cosp[i * n] * xt) * 0.5f;
    }
 
    xp = x + 1;
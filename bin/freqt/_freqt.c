@@ -49,12 +49,14 @@
     Frequency Transformation
 
         void   freqt(c1, m1, c2, m2, a)
+        void   freqt_r(c1, m1, c2, m2, a, wk)
 
         double   *c1   : minimum phase sequence
         int      m1    : order of minimum phase sequence
         double   *c2   : warped sequence
         int      m2    : order of warped sequence
         double   a     : all-pass constant
+        double   *wk   : working area of 2*m2+2 doubles
 
 ***************************************************************/
 
@@ -67,25 +69,14 @@
 #include <SPTK.h>
 #endif
 
-void freqt(double *c1, const int m1, double *c2, const int m2, const double a)
+void freqt_r(double *c1, const int m1, double *c2, const int m2,
+             const double a, double *wk)
 {
    int i, j;
-   double b;
-   static double *d = NULL, *g;
-   static int size;
-
-   if (d == NULL) {
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
+   double b, *d, *g;
 
-   if (m2 > size) {
-      free(d);
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
+   d = wk;
+   g = d + m2 + 1;
 
    b = 1 - a * a;
    fillz(g, sizeof(*g), m2 + 1);
@@ -103,3 +94,24 @@ void freqt(double *c1, const int m1, double *c2, const int m2, const double a)
 
    return;
 }
+
+void freqt(double *c1, const int m1, double *c2, const int m2, const double a)
+{
+   static double *d = NULL;
+   static int size;
+
+   if (d == NULL) {
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+
+   if (m2 > size) {
+      free(d);
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+
+   freqt_r(c1, m1, c2, m2, a, d);
+
+   return;
+}
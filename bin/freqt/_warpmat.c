@@ -0,0 +1,210 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/***************************************************************
+
+    Frequency Warping Operator
+
+        int  alloc_WARPMAT(w, type, m1, m2, a)
+        int  free_WARPMAT(w)
+        void warpmat(w, c1, c2)
+        void warpmat_batch(w, c1, stride1, c2, stride2, n)
+
+        WARPMAT  *w      : warping operator
+        WarpType type    : WARP_FREQT -> freqt()
+                           WARP_FRQTR -> frqtr()
+                           WARP_B2C   -> b2c()
+        int      m1      : order of input sequence
+        int      m2      : order of output sequence
+        double   a       : all-pass constant
+        double   *c1     : input sequence(s)
+        double   *c2     : output sequence(s), must not overlap c1
+        int      stride1 : distance between input sequences
+        int      stride2 : distance between output sequences
+        int      n       : number of sequences
+
+    freqt(), frqtr() and b2c() are linear in their input, so for
+    a fixed (m1, m2, a) they are a (m2+1) x (m1+1) matrix.  The
+    matrix is built once from the all-pass recursion; warpmat()
+    is then a blocked matrix-vector product and warpmat_batch()
+    a matrix-matrix product over n sequences.
+
+***************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+int alloc_WARPMAT(WARPMAT * w, const WarpType type, const int m1,
+                  const int m2, const double a)
+{
+   int i, j;
+   double *e, *col, *wk;
+
+   w->type = type;
+   w->m1 = m1;
+   w->m2 = m2;
+   w->a = a;
+   w->mat = dgetmem((m1 + 1) * (m2 + 1));
+
+   e = dgetmem((m1 + 1) + (m2 + 1) + (2 * m2 + 2));
+   col = e + m1 + 1;
+   wk = col + m2 + 1;
+
+   /* column j is the response to the j-th unit vector */
+   for (j = 0; j <= m1; j++) {
+      e[j] = 1.0;
+      switch (type) {
+      case WARP_FREQT:
+         freqt_r(e, m1, col, m2, a, wk);
+         break;
+      case WARP_FRQTR:
+         frqtr_r(e, m1, col, m2, a, wk);
+         break;
+      case WARP_B2C:
+         b2c_r(e, m1, col, m2, a, wk);
+         break;
+      default:
+         fprintf(stderr, "warpmat : unknown type of warping!\n");
+         free(e);
+         free_WARPMAT(w);
+         return (-1);
+      }
+      e[j] = 0.0;
+      for (i = 0; i <= m2; i++)
+         w->mat[i * (m1 + 1) + j] = col[i];
+   }
+
+   free(e);
+
+   return (0);
+}
+
+int free_WARPMAT(WARPMAT * w)
+{
+   if (w->mat != NULL)
+      free(w->mat);
+   w->m1 = w->m2 = 0;
+   w->a = 0.0;
+   w->mat = NULL;
+
+   return (0);
+}
+
+void warpmat(const WARPMAT * w, const double *c1, double *c2)
+{
+   int i, j;
+   const int n1 = w->m1 + 1, n2 = w->m2 + 1;
+   const double *r0, *r1, *r2, *r3;
+   double s0, s1, s2, s3;
+
+   /* four rows at a time so that each c1[j] is loaded once per block */
+   for (i = 0; i + 3 < n2; i += 4) {
+      r0 = w->mat + i * n1;
+      r1 = r0 + n1;
+      r2 = r1 + n1;
+      r3 = r2 + n1;
+      s0 = s1 = s2 = s3 = 0.0;
+      for (j = 0; j < n1; j++) {
+         s0 += r0[j] * c1[j];
+         s1 += r1[j] * c1[j];
+         s2 += r2[j] * c1[j];
+         s3 += r3[j] * c1[j];
+      }
+      c2[i] = s0;
+      c2[i + 1] = s1;
+      c2[i + 2] = s2;
+      c2[i + 3] = s3;
+   }
+   for (; i < n2; i++) {
+      r0 = w->mat + i * n1;
+      s0 = 0.0;
+      for (j = 0; j < n1; j++)
+         s0 += r0[j] * c1[j];
+      c2[i] = s0;
+   }
+
+   return;
+}
+
+void warpmat_batch(const WARPMAT * w, const double *c1, const int stride1,
+                   double *c2, const int stride2, const int n)
+{
+   int i, j, t;
+   const int n1 = w->m1 + 1, n2 = w->m2 + 1;
+   const double *r, *x0, *x1, *x2, *x3;
+   double s0, s1, s2, s3;
+
+   /* four sequences at a time so that each matrix row is loaded once
+      per block */
+   for (t = 0; t + 3 < n; t += 4) {
+      x0 = c1 + t * stride1;
+      x1 = x0 + stride1;
+      x2 = x1 + stride1;
+      x3 = x2 + stride1;
+      for (i = 0; i < n2; i++) {
+         r = w->mat + i * n1;
+         s0 = s1 = s2 = s3 = 0.0;
+         for (j = 0; j < n1; j++) {
+            s0 += r[j] * x0[j];
+            s1 += r[j] * x1[j];
+            s2 += r[j] * x2[j];
+            s3 += r[j] * x3[j];
+         }
+         c2[t * stride2 + i] = s0;
+         c2[(t + 1) * stride2 + i] = s1;
+         c2[(t + 2) * stride2 + i] = s2;
+         c2[(t + 3) * stride2 + i] = s3;
+      }
+   }
+   for (; t < n; t++)
+      warpmat(w, c1 + t * stride1, c2 + t * stride2);
+
+   return;
+}
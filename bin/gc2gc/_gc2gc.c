@@ -48,6 +48,7 @@
     Generalized Cepstral Transformation   
 
         void gc2gc(c1, m1, g1, c2, m2, g2)
+        void gc2gc_r(c1, m1, g1, c2, m2, g2, wk)
 
         double   *c1   : normalized generalized cepstrum (input)
         int      m1    : order of gc1
@@ -55,6 +56,7 @@
         double   *c2   : normalized generalized cepstrum (output)
         int      m2    : order of gc2
         double   g2    : gamma of gc2
+        double   *wk   : working area of m1+1 doubles
 
 *****************************************************************/
 
@@ -67,24 +69,13 @@
 #include <SPTK.h>
 #endif
 
-void gc2gc(double *c1, const int m1, const double g1, double *c2, const int m2,
-           const double g2)
+void gc2gc_r(double *c1, const int m1, const double g1, double *c2,
+             const int m2, const double g2, double *wk)
 {
    int i, min, k, mk;
-   double ss1, ss2, cc;
-   static double *ca = NULL;
-   static int size;
-
-   if (ca == NULL) {
-      ca = dgetmem(m1 + 1);
-      size = m1;
-   }
-   if (m1 > size) {
-      free(ca);
-      ca = dgetmem(m1 + 1);
-      size = m1;
-   }
+   double ss1, ss2, cc, *ca;
 
+   ca = wk;
    movem(c1, ca, sizeof(*c1), m1 + 1);
 
    c2[0] = ca[0];
@@ -106,3 +97,24 @@ void gc2gc(double *c1, const int m1, const double g1, double *c2, const int m2,
 
    return;
 }
+
+void gc2gc(double *c1, const int m1, const double g1, double *c2, const int m2,
+           const double g2)
+{
+   static double *ca = NULL;
+   static int size;
+
+   if (ca == NULL) {
+      ca = dgetmem(m1 + 1);
+      size = m1;
+   }
+   if (m1 > size) {
+      free(ca);
+      ca = dgetmem(m1 + 1);
+      size = m1;
+   }
+
+   gc2gc_r(c1, m1, g1, c2, m2, g2, ca);
+
+   return;
+}
@@ -49,6 +49,9 @@
     Generalized Cepstral Analysis
 
         int gcep(xw, flng, gc, m, g, itr1, itr2, d, etype, e, f, itype);
+        int gcep_r(w, xw, flng, gc, m, g, itr1, itr2, d, etype, e, f, itype);
+
+        GCEPWORK  *w    : working area allocated by alloc_GCEPWORK()
 
         double    *xw   : input sequence
         int       flng  : frame length
@@ -72,6 +75,7 @@
                           1 -> invalid etype
                           2 -> invalid itype
                           3 -> failed to compute generalized cepstrum
+                          5 -> working area is too small
 
 *****************************************************************/
 
@@ -85,14 +89,44 @@
 #include <SPTK.h>
 #endif
 
-int gcep(double *xw, const int flng, double *gc, const int m, const double g,
-         const int itr1, const int itr2, const double d, const int etype,
-         const double e, const double f, const int itype)
+int alloc_GCEPWORK(GCEPWORK * w, const int flng, const int m)
+{
+   w->flng = flng;
+   w->m = m;
+   w->x = dgetmem(9 * flng + (m + 1) + THEQ_WORKSIZE(m));
+   w->y = w->x + flng;
+   w->cr = w->y + flng;
+   w->ci = w->cr + flng;
+   w->rr = w->ci + flng;
+   w->hr = w->rr + flng;
+   w->hi = w->hr + flng;
+   w->er = w->hi + flng;
+   w->ei = w->er + flng;
+   w->wk = w->ei + flng;
+   w->tq = w->wk + (m + 1);
+
+   return (0);
+}
+
+int free_GCEPWORK(GCEPWORK * w)
+{
+   free(w->x);
+   w->flng = 0;
+   w->m = 0;
+   w->x = w->y = w->cr = w->ci = w->rr = NULL;
+   w->hr = w->hi = w->er = w->ei = NULL;
+   w->wk = w->tq = NULL;
+
+   return (0);
+}
+
+int gcep_r(GCEPWORK * w, double *xw, const int flng, double *gc, const int m,
+           const double g, const int itr1, const int itr2, const double d,
+           const int etype, const double e, const double f, const int itype)
 {
    int i, j, flag = 0;
    double t, s, eps = 0.0, min, max, dd = 0.0;
-   static double *x = NULL, *y, *cr, *ci, *rr, *hr, *hi, *er, *ei;
-   static int size;
+   double *x, *y, *cr, *ci, *rr, *hr, *hi, *er, *ei;
 
    if (etype == 1 && e < 0.0) {
       fprintf(stderr, "gcep : value of e must be e>=0!\n");
@@ -108,34 +142,20 @@ int gcep(double *xw, const int flng, double *gc, const int m, const double g,
       eps = e;
    }
 
-   if (x == NULL) {
-      x = dgetmem(9 * flng);
-      size = flng;
-
-      y = x + flng;
-      cr = y + flng;
-      ci = cr + flng;
-      rr = ci + flng;
-      hr = rr + flng;
-      hi = hr + flng;
-      er = hi + flng;
-      ei = er + flng;
+   if (flng > w->flng || m > w->m) {
+      fprintf(stderr, "gcep : working area is too small!\n");
+      return 5;
    }
 
-   if (flng > size) {
-      free(x);
-      x = dgetmem(9 * flng);
-      size = flng;
-
-      y = x + flng;
-      cr = y + flng;
-      ci = cr + flng;
-      rr = ci + flng;
-      hr = rr + flng;
-      hi = hr + flng;
-      er = hi + flng;
-      ei = er + flng;
-   }
+   x = w->x;
+   y = w->y;
+   cr = w->cr;
+   ci = w->ci;
+   rr = w->rr;
+   hr = w->hr;
+   hi = w->hi;
+   er = w->er;
+   ei = w->ei;
 
    movem(xw, x, sizeof(*x), flng);
 
@@ -198,7 +218,7 @@ int gcep(double *xw, const int flng, double *gc, const int m, const double g,
    /*  initial value of generalized cepstrum  */
    ifftr(cr, y, flng);          /*  x : IFFT[x]  */
    cr[0] = exp(cr[0] / 2);
-   gc2gc(cr, m, 0.0, gc, m, g); /*  gc : generalized cepstrum  */
+   gc2gc_r(cr, m, 0.0, gc, m, g, w->wk);        /*  gc : gen. cepstrum  */
 
    /*  Newton-Raphson method  */
    for (j = 1; j <= itr2; j++) {
@@ -240,7 +260,7 @@ int gcep(double *xw, const int flng, double *gc, const int m, const double g,
       for (i = 2; i <= m + m; i++)
          hr[i] *= 1 + g;
 
-      if (theq(rr, &hr[2], &y[1], &er[1], m, f)) {
+      if (theq_r(rr, &hr[2], &y[1], &er[1], m, f, w->tq)) {
          fprintf(stderr, "gcep : Error in theq() at %dth iteration!\n", j);
          return 3;
       }
@@ -256,3 +276,21 @@ int gcep(double *xw, const int flng, double *gc, const int m, const double g,
    else
       return (-1);
 }
+
+int gcep(double *xw, const int flng, double *gc, const int m, const double g,
+         const int itr1, const int itr2, const double d, const int etype,
+         const double e, const double f, const int itype)
+{
+   static GCEPWORK w;
+   int size_x, size_c;
+
+   if (w.x == NULL || flng > w.flng || m > w.m) {
+      size_x = (flng > w.flng) ? flng : w.flng;
+      size_c = (m > w.m) ? m : w.m;
+      if (w.x != NULL)
+         free_GCEPWORK(&w);
+      alloc_GCEPWORK(&w, size_x, size_c);
+   }
+
+   return (gcep_r(&w, xw, flng, gc, m, g, itr1, itr2, d, etype, e, f, itype));
+}
@@ -61,34 +61,25 @@
 #endif
 
 int choleski(double **cov, double **S, const int L);
+int choleski_packed(double **cov, double *S, const int L);
+
+/* largest dimension for which log_wgd() needs no heap memory */
+#define LOG_WGD_STACK 128
 
 double cal_ldet(double **var, const int D)
 {
-   int i, j, l;
-   double ldet = 0.0, **tri;
-
-   tri = (double **) malloc(sizeof(double *) * D);
-   for (l = 0; l < D; l++)
-      tri[l] = dgetmem(D);
+   int l;
+   double ldet = 0.0, *tri;
 
-   for (i = 0; i < D; i++)
-      for (j = 0; j < D; j++)
-         tri[i][j] = 0.0;
+   tri = dgetmem(D * (D + 1) / 2);
 
-   if (choleski(var, tri, D)) {
+   if (choleski_packed(var, tri, D)) {
       for (l = 0; l < D; l++)
-         ldet += log(tri[l][l]);
-
-      for (l = 0; l < D; l++) {
-         free(tri[l]);
-      }
+         ldet += log(tri[l * (l + 1) / 2 + l]);
       free(tri);
 
       return (2.0 * ldet);
    } else {
-      for (l = 0; l < D; l++) {
-         free(tri[l]);
-      }
       free(tri);
 
       return LZERO;
@@ -159,47 +150,106 @@ int choleski(double **cov, double **S, const int L)
    return 1;
 }
 
-void cal_inv(double **cov, double **inv, const int L)
+/* choleski() into a packed lower triangle, row i starting at S + i(i+1)/2 */
+int choleski_packed(double **cov, double *S, const int L)
 {
    int i, j, k;
-   double **S, **S_inv;
-
-   S = (double **) malloc(sizeof(double *) * L);
-   S_inv = (double **) malloc(sizeof(double *) * L);
+   double tmp, *si, *sj;
 
-   for (i = 0; i < L; i++) {
-      S[i] = dgetmem(L);
-      S_inv[i] = dgetmem(L);
+   for (i = 0, si = S; i < L; si += ++i) {
+      for (j = 0, sj = S; j < i; sj += ++j) {
+         tmp = cov[i][j];
+         for (k = 0; k < j; k++)
+            tmp -= si[k] * sj[k];
+         si[j] = tmp / sj[j];
+      }
+      tmp = cov[i][i];
+      for (k = 0; k < i; k++)
+         tmp -= si[k] * si[k];
+      if (tmp <= 0) {
+         return 0;
+      }
+      si[i] = sqrt(tmp);
    }
+   return 1;
+}
 
-   for (i = 0; i < L; i++) {
-      for (j = 0; j < L; j++) {
-         S[i][j] = 0.0;
-         S_inv[i][j] = 0.0;
-         inv[i][j] = 0.0;
-      }
+/* inverse of a packed lower triangle by forward substitution, row i of
+   S_inv being a combination of the rows above it */
+void cal_tri_inv_packed(const double *S, double *S_inv, const int L)
+{
+   int i, j, k;
+   const double *si;
+   double *ri, *rk;
+
+   for (i = 0, si = S, ri = S_inv; i < L; i++, si += i, ri += i) {
+      for (j = 0; j < i; j++)
+         ri[j] = 0.0;
+      for (k = 0, rk = S_inv; k < i; rk += ++k)
+         for (j = 0; j <= k; j++)
+            ri[j] += si[k] * rk[j];
+      for (j = 0; j < i; j++)
+         ri[j] = -ri[j] / si[i];
+      ri[i] = 1.0 / si[i];
    }
+}
 
-   if (choleski(cov, S, L) == 0)
-      return;
-   cal_tri_inv(S, S_inv, L);
+/* inverse of cov via Cholesky decomposition, with the working memory
+   taken from arena (NULL: heap); returns 1 if cov is not positive
+   definite (inv is then zero) and -1 if memory runs out */
+int cal_inv_r(double **cov, double **inv, const int L, ARENA * arena)
+{
+   int i, j, k, ret = 0;
+   size_t mark = 0;
+   double **S, **S_inv;
 
    for (i = 0; i < L; i++)
-      for (j = 0; j < L; j++) {
-         if (i > j)
-            for (k = i; k < L; k++)
-               inv[i][j] = inv[i][j] + S_inv[k][i] * S_inv[k][j];
-         else
-            for (k = j; k < L; k++)
-               inv[i][j] = inv[i][j] + S_inv[k][i] * S_inv[k][j];
-      }
+      for (j = 0; j < L; j++)
+         inv[i][j] = 0.0;
 
-   for (i = 0; i < L; i++) {
-      free(S[i]);
-      free(S_inv[i]);
+   if (arena != NULL)
+      mark = mark_ARENA(arena);
+   S = addgetmem(arena, L, L);
+   S_inv = addgetmem(arena, L, L);
+
+   if (S == NULL || S_inv == NULL) {
+      ret = -1;
+   } else if (choleski(cov, S, L) == 0) {
+      ret = 1;
+   } else {
+      cal_tri_inv(S, S_inv, L);
+
+      for (i = 0; i < L; i++)
+         for (j = 0; j < L; j++) {
+            if (i > j)
+               for (k = i; k < L; k++)
+                  inv[i][j] = inv[i][j] + S_inv[k][i] * S_inv[k][j];
+            else
+               for (k = j; k < L; k++)
+                  inv[i][j] = inv[i][j] + S_inv[k][i] * S_inv[k][j];
+         }
+   }
+
+   if (arena != NULL) {
+      rewind_ARENA(arena, mark);
+   } else {
+      if (S != NULL) {
+         free(S[0]);
+         free(S);
+      }
+      if (S_inv != NULL) {
+         free(S_inv[0]);
+         free(S_inv);
+      }
    }
-   free(S);
-   free(S_inv);
+
+   return (ret);
+}
+
+void cal_inv(double **cov, double **inv, const int L)
+{
+   if (cal_inv_r(cov, inv, L, NULL) < 0)
+      exit(3);
 }
 
 void fillz_GMM(GMM * gmm)
@@ -231,7 +281,7 @@ void maskCov_GMM(GMM * gmm, const int *dim_list, const int cov_dim,
 
    int row, col, i, k, l, m, *offset;
 
-   offset = (int *) malloc(sizeof(int) * cov_dim + 1);
+   offset = (int *) malloc(sizeof(int) * (cov_dim + 1));
 
    offset[0] = 0;
    for (i = 1; i < cov_dim + 1; i++) {
@@ -299,7 +349,7 @@ double log_wgd(const GMM * gmm, const int m, const int l1, const int l2,
                const double *dat)
 {
    int l, ll;
-   double sum, *diff = NULL, tmp, lwgd;
+   double sum, *diff = NULL, tmp, lwgd, buf[LOG_WGD_STACK];
 
    sum = gmm->gauss[m].gconst;
 
@@ -309,7 +359,8 @@ double log_wgd(const GMM * gmm, const int m, const int l1, const int l2,
          sum += (tmp * tmp) / gmm->gauss[m].var[l];
       }
    } else {
-      diff = dgetmem(l2);
+      /* diff lives on the stack unless the dimension is large */
+      diff = (l2 <= LOG_WGD_STACK) ? buf : dgetmem(l2);
       for (l = l1; l < l2; l++) {
          diff[l] = dat[l] - gmm->gauss[m].mean[l];
       }
@@ -319,7 +370,8 @@ double log_wgd(const GMM * gmm, const int m, const int l1, const int l2,
          }
          sum += tmp * diff[l];
       }
-      free(diff);
+      if (diff != buf)
+         free(diff);
    }
 
    lwgd = log(gmm->weight[m]) - 0.5 * sum;
@@ -327,36 +379,21 @@ double log_wgd(const GMM * gmm, const int m, const int l1, const int l2,
    return (lwgd);
 }
 
-static double log_add_gmm(double logx, double logy)
-{
-   double swap, diff, minLogExp, z;
-
-   if (logx < logy) {
-      swap = logx;
-      logx = logy;
-      logy = swap;
-   }
-
-   diff = logy - logx;
-   minLogExp = -log(-LZERO);
-
-   if (diff < minLogExp)
-      return ((logx < LSMALL) ? LZERO : logx);
-   else {
-      z = exp(diff);
-      return (logx + log(1.0 + z));
-   }
-}
-
 double log_outp(const GMM * gmm, const int l1, const int l2, const double *dat)
 {
    int m;
-   double logwgd, logb;
+   double *lwgd, logb, buf[LOG_WGD_STACK];
+
+   if (gmm->nmix <= 0)
+      return (LZERO);
+
+   lwgd = (gmm->nmix <= LOG_WGD_STACK) ? buf : dgetmem(gmm->nmix);
+   for (m = 0; m < gmm->nmix; m++)
+      lwgd[m] = log_wgd(gmm, m, l1, l2, dat);
+   logb = log_sum_exp(lwgd, gmm->nmix, NULL);
+   if (lwgd != buf)
+      free(lwgd);
 
-   for (m = 0, logb = LZERO; m < gmm->nmix; m++) {
-      logwgd = log_wgd(gmm, m, l1, l2, dat);
-      logb = log_add_gmm(logb, logwgd);
-   }
    return (logb);
 }
 
@@ -460,6 +497,93 @@ int prepareGconst_GMM(GMM * gmm)
    return (0);
 }
 
+/* arguments shared by the jobs of prepare_GMM() */
+typedef struct _GMMPREPJOB {
+   GMM *gmm;
+   double *white;
+   double *work;
+} GMMPREPJOB;
+
+static void prepare_GMM_job(void *arg, const int thread, const int m)
+{
+   GMMPREPJOB *j = (GMMPREPJOB *) arg;
+   GMM *gmm = j->gmm;
+   const int D = gmm->dim, P = D * (D + 1) / 2;
+   int i, k, l;
+   double *S, *S_inv, *row, ldet;
+   Gauss *g = &gmm->gauss[m];
+
+   if (gmm->full != TR) {
+      g->gconst = cal_gconst(g->var, D);
+      if (j->white != NULL)
+         for (i = 0; i < D; i++)
+            j->white[(size_t) m * D + i] = 1.0 / sqrt(g->var[i]);
+      return;
+   }
+
+   S = j->work + (size_t) thread * 2 * P;
+   S_inv = (j->white != NULL) ? j->white + (size_t) m * P : S + P;
+
+   if (choleski_packed(g->cov, S, D) == 0) {
+      g->gconst = LZERO;
+      for (i = 0; i < D; i++)
+         for (l = 0; l < D; l++)
+            g->inv[i][l] = 0.0;
+      return;
+   }
+
+   for (i = 0, ldet = 0.0; i < D; i++)
+      ldet += log(S[i * (i + 1) / 2 + i]);
+   g->gconst = D * log(M_2PI) + 2.0 * ldet;
+
+   /* inv = S_inv' S_inv, a sum of outer products of the rows */
+   cal_tri_inv_packed(S, S_inv, D);
+   for (i = 0; i < D; i++)
+      for (l = 0; l <= i; l++)
+         g->inv[i][l] = 0.0;
+   for (k = 0, row = S_inv; k < D; row += ++k)
+      for (i = 0; i <= k; i++)
+         for (l = 0; l <= i; l++)
+            g->inv[i][l] += row[i] * row[l];
+   for (i = 0; i < D; i++)
+      for (l = 0; l < i; l++)
+         g->inv[l][i] = g->inv[i][l];
+}
+
+/* gconst and, for full covariance, inv of every mixture from a single
+   Cholesky factor per covariance, one job per mixture on pool (NULL:
+   serial); if white is not NULL the whitening transforms are stored
+   there, the packed lower triangles [nmix][dim(dim+1)/2] of the inverse
+   factors (full covariance) or 1/sqrt(var) [nmix][dim] (diagonal).
+   returns 1 if a covariance is not positive definite and -1 if memory
+   runs out */
+int prepare_GMM(GMM * gmm, double *white, THREADPOOL * pool)
+{
+   const int D = gmm->dim, P = D * (D + 1) / 2;
+   int m, nthread = (pool != NULL && pool->nthread > 1) ? pool->nthread : 1;
+   GMMPREPJOB j;
+
+   j.gmm = gmm;
+   j.white = white;
+   j.work = NULL;
+   if (gmm->full == TR
+       && (j.work = adgetmem(NULL, (size_t) nthread * 2 * P)) == NULL)
+      return (-1);
+
+   run_THREADPOOL(pool, gmm->nmix, prepare_GMM_job, &j);
+   free(j.work);
+
+   for (m = 0; m < gmm->nmix; m++)
+      if (gmm->gauss[m].gconst == LZERO) {
+         fprintf(stderr,
+                 "prepare_GMM : covariance of mixture %d is not positive definite!\n",
+                 m);
+         return (1);
+      }
+
+   return (0);
+}
+
 int floorWeight_GMM(GMM * gmm, double floor)
 {
    int m;
@@ -0,0 +1,384 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+/****************************************************************
+
+    $Id$
+
+    Packed GMM and batched log-likelihood
+
+        int alloc_PGMM(p, gmm)
+        int free_PGMM(p)
+        int log_wgd_batch(p, x, T, lwgd)
+        int log_outp_batch(p, x, T, out)
+
+        PGMM   *p    : packed GMM
+        GMM    *gmm  : GMM (gconst and inv are not used)
+        double *x    : input vectors, [T][dim]
+        int    T     : number of input vectors
+        double *lwgd : log weighted Gaussians, [T][nmix]
+        double *out  : log output probabilities, [T]
+
+        return value of alloc_PGMM() :
+                   0 -> success
+                   1 -> a covariance is not positive definite
+                  -1 -> out of memory
+        return value of log_wgd_batch() and log_outp_batch() :
+                   0 -> success
+                  -1 -> out of memory
+
+        alloc_PGMM() copies weights, means and covariances (or
+        variances) of gmm into one block: log weights with the
+        Gaussian constants folded in, an [nmix][ld] mean matrix and
+        the inverse Cholesky factors of the covariances, so that
+        the quadratic form is the squared norm of L^{-1}(x - mu).
+        Rows are padded to ld, a multiple of PGMM_ALIGN doubles,
+        and every row starts on a cache line.  The kernel for the
+        instruction set is chosen on each call by fftsimd_level().
+        Nothing writes to a PGMM after alloc_PGMM() or load_PGMM(),
+        so one PGMM may be scored from several threads at once.
+
+        The batch functions transpose PGMM_FRAMES input vectors at
+        a time and evaluate each mixture on all of them at once, so
+        every row of a factor is loaded once per block and the inner
+        loops run over frames with a fixed trip count.  The results
+        agree with log_wgd() and log_outp() up to rounding.
+
+****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define GMM_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GMM_NEON
+#include <arm_neon.h>
+#endif
+
+int choleski_packed(double **cov, double *S, const int L);
+void cal_tri_inv_packed(const double *S, double *S_inv, const int L);
+void pgmm_unmap(PGMM * p);
+
+static int pgmm_round(const int n)
+{
+   return ((n + PGMM_ALIGN - 1) / PGMM_ALIGN * PGMM_ALIGN);
+}
+
+int alloc_PGMM(PGMM * p, const GMM * gmm)
+{
+   int m, i, j, D = gmm->dim, ret = 0;
+   size_t addr, size;
+   double *S = NULL, *S_inv = NULL, ldet, *row;
+
+   p->nmix = gmm->nmix;
+   p->dim = D;
+   p->ld = pgmm_round(D);
+   p->full = gmm->full;
+   p->mapped = 0;
+
+   size = pgmm_round(p->nmix) + (size_t) p->nmix * p->ld
+       * ((p->full == TR) ? D + 1 : 2);
+   if ((p->block = adgetmem(NULL, size + PGMM_ALIGN)) == NULL)
+      return (-1);
+   addr = (size_t) p->block % (PGMM_ALIGN * sizeof(double));
+   p->lconst = p->block + (addr == 0 ? 0 : PGMM_ALIGN - addr / sizeof(double));
+   p->mean = p->lconst + pgmm_round(p->nmix);
+   p->prec = p->mean + (size_t) p->nmix * p->ld;
+
+   if (p->full == TR) {
+      if ((S = adgetmem(NULL, (size_t) D * (D + 1))) == NULL)
+         ret = -1;
+      S_inv = S + D * (D + 1) / 2;
+   }
+
+   for (m = 0; ret == 0 && m < p->nmix; m++) {
+      for (i = 0; i < D; i++)
+         p->mean[(size_t) m * p->ld + i] = gmm->gauss[m].mean[i];
+      if (p->full == TR) {
+         if (choleski_packed(gmm->gauss[m].cov, S, D) == 0) {
+            fprintf(stderr,
+                    "alloc_PGMM : covariance of mixture %d is not positive definite!\n",
+                    m);
+            ret = 1;
+            break;
+         }
+         cal_tri_inv_packed(S, S_inv, D);
+         for (i = 0, ldet = 0.0; i < D; i++) {
+            ldet += log(S[i * (i + 1) / 2 + i]);
+            row = p->prec + ((size_t) m * D + i) * p->ld;
+            for (j = 0; j <= i; j++)
+               row[j] = S_inv[i * (i + 1) / 2 + j];
+         }
+         p->lconst[m] = log(gmm->weight[m])
+             - 0.5 * (D * log(M_2PI) + 2.0 * ldet);
+      } else {
+         row = p->prec + (size_t) m * p->ld;
+         for (i = 0; i < D; i++)
+            row[i] = 1.0 / sqrt(gmm->gauss[m].var[i]);
+         p->lconst[m] = log(gmm->weight[m])
+             - 0.5 * cal_gconst(gmm->gauss[m].var, D);
+      }
+   }
+
+   if (S != NULL)
+      free(S);
+   if (ret != 0) {
+      free(p->block);
+      p->block = NULL;
+   }
+
+   return (ret);
+}
+
+int free_PGMM(PGMM * p)
+{
+   if (p->mapped != 0)
+      pgmm_unmap(p);
+   else
+      free(p->block);
+   p->block = NULL;
+   p->mapped = 0;
+   p->nmix = 0;
+   p->dim = 0;
+
+   return (0);
+}
+
+/* kernels of PGMM_FRAMES vectors, one per instruction set */
+#define VW 1
+#define VEC double
+#define VLOAD(p) (*(p))
+#define VSTORE(p, v) (*(p) = (v))
+#define VSET1(s) (s)
+#define VZERO 0.0
+#define VADD(x, y) ((x) + (y))
+#define VSUB(x, y) ((x) - (y))
+#define VMUL(x, y) ((x) * (y))
+#define KNAME(name) name##_scalar
+#define KATTR
+#include "gmmbatch_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+
+#if defined(GMM_X86)
+#define VW 2
+#define VEC __m128d
+#define VLOAD(p) _mm_loadu_pd(p)
+#define VSTORE(p, v) _mm_storeu_pd((p), (v))
+#define VSET1(s) _mm_set1_pd(s)
+#define VZERO _mm_setzero_pd()
+#define VADD(x, y) _mm_add_pd((x), (y))
+#define VSUB(x, y) _mm_sub_pd((x), (y))
+#define VMUL(x, y) _mm_mul_pd((x), (y))
+#define KNAME(name) name##_sse2
+#define KATTR TARGET_SSE2
+#include "gmmbatch_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+
+#define VW 4
+#define VEC __m256d
+#define VLOAD(p) _mm256_loadu_pd(p)
+#define VSTORE(p, v) _mm256_storeu_pd((p), (v))
+#define VSET1(s) _mm256_set1_pd(s)
+#define VZERO _mm256_setzero_pd()
+#define VADD(x, y) _mm256_add_pd((x), (y))
+#define VSUB(x, y) _mm256_sub_pd((x), (y))
+#define VMUL(x, y) _mm256_mul_pd((x), (y))
+#define KNAME(name) name##_avx2
+#define KATTR TARGET_AVX2
+#include "gmmbatch_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+#elif defined(GMM_NEON)
+#define VW 2
+#define VEC float64x2_t
+#define VLOAD(p) vld1q_f64(p)
+#define VSTORE(p, v) vst1q_f64((p), (v))
+#define VSET1(s) vdupq_n_f64(s)
+#define VZERO vdupq_n_f64(0.0)
+#define VADD(x, y) vaddq_f64((x), (y))
+#define VSUB(x, y) vsubq_f64((x), (y))
+#define VMUL(x, y) vmulq_f64((x), (y))
+#define KNAME(name) name##_neon
+#define KATTR
+#include "gmmbatch_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+#endif
+
+/* log weighted Gaussians of PGMM_FRAMES vectors xs, transposed to
+   [dim][PGMM_FRAMES], into lwgd[l * ldw + m]; diff holds
+   dim * PGMM_FRAMES values */
+static void log_wgd_block(const PGMM * p, const double *xs, double *diff,
+                          double *lwgd, const int ldw)
+{
+#if defined(GMM_X86)
+   if (fftsimd_level() == SPTK_SIMD_AVX2) {
+      log_wgd_block_avx2(p, xs, diff, lwgd, ldw);
+      return;
+   }
+   if (fftsimd_level() == SPTK_SIMD_SSE2) {
+      log_wgd_block_sse2(p, xs, diff, lwgd, ldw);
+      return;
+   }
+#elif defined(GMM_NEON)
+   log_wgd_block_neon(p, xs, diff, lwgd, ldw);
+   return;
+#endif
+   log_wgd_block_scalar(p, xs, diff, lwgd, ldw);
+}
+
+/* transpose vectors t0, ..., t0 + n - 1 of x into xs, zero padded */
+static void pgmm_transpose(const PGMM * p, const double *x, const int t0,
+                           const int n, double *xs)
+{
+   const int F = PGMM_FRAMES;
+   int i, l;
+
+   for (i = 0; i < p->dim; i++)
+      for (l = 0; l < F; l++)
+         xs[i * F + l] = (l < n) ? x[(size_t) (t0 + l) * p->dim + i] : 0.0;
+}
+
+int log_wgd_batch(const PGMM * p, const double *x, const int T, double *lwgd)
+{
+   const int F = PGMM_FRAMES;
+   int t, n, l, m;
+   double *xs, *buf;
+
+   if ((xs = adgetmem(NULL, (size_t) 2 * p->dim * F
+                      + (size_t) F * p->nmix)) == NULL)
+      return (-1);
+   buf = xs + (size_t) 2 * p->dim * F;
+
+   for (t = 0; t < T; t += F) {
+      n = (T - t < F) ? T - t : F;
+      pgmm_transpose(p, x, t, n, xs);
+      log_wgd_block(p, xs, xs + p->dim * F, buf, p->nmix);
+      for (l = 0; l < n; l++)
+         for (m = 0; m < p->nmix; m++)
+            lwgd[(size_t) (t + l) * p->nmix + m] = buf[l * p->nmix + m];
+   }
+
+   free(xs);
+
+   return (0);
+}
+
+int log_outp_batch(const PGMM * p, const double *x, const int T, double *out)
+{
+   const int F = PGMM_FRAMES;
+   int t, n, l;
+   double *xs, *buf;
+
+   if ((xs = adgetmem(NULL, (size_t) 2 * p->dim * F
+                      + (size_t) F * p->nmix)) == NULL)
+      return (-1);
+   buf = xs + (size_t) 2 * p->dim * F;
+
+   for (t = 0; t < T; t += F) {
+      n = (T - t < F) ? T - t : F;
+      pgmm_transpose(p, x, t, n, xs);
+      log_wgd_block(p, xs, xs + p->dim * F, buf, p->nmix);
+      for (l = 0; l < n; l++)
+         out[t + l] = log_sum_exp(buf + l * p->nmix, p->nmix, NULL);
+   }
+
+   free(xs);
+
+   return (0);
+}
@@ -0,0 +1,359 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+/****************************************************************
+
+    $Id$
+
+    EM training of GMM
+
+        int alloc_GMMSTATS(s, nmix, dim, full)
+        int free_GMMSTATS(s)
+        int reset_GMMSTATS(s)
+        int accum_GMMSTATS(s, p, x, T)
+        int add_GMMSTATS(s, t)
+
+        int alloc_GMMEM(e, gmm, nshard)
+        int free_GMMEM(e)
+        int update_GMM(e, gmm)
+        int em_GMM(e, gmm, x, T, pool, loglik)
+
+        GMMSTATS   *s, *t  : sufficient statistics
+        int        nmix    : number of mixture components
+        int        dim     : dimension of vectors
+        Boolean    full    : full covariance
+        PGMM       *p      : packed current model (see _gmmbatch.c)
+        double     *x      : training vectors, [T][dim]
+        int        T       : number of training vectors
+        GMMEM      *e      : trainer
+        GMM        *gmm    : model, updated in place
+        int        nshard  : number of shards of the training data
+        THREADPOOL *pool   : threads (NULL: serial)
+        double     *loglik : total log-likelihood of x under the
+                             model before the update (may be NULL)
+
+        return value of accum_GMMSTATS(), update_GMM() and em_GMM() :
+                   0 -> success
+                   1 -> a covariance is not positive definite
+                  -1 -> out of memory
+
+        accum_GMMSTATS() adds the occupancies, first order and
+        second order statistics of x to s.  add_GMMSTATS() adds t
+        to s, so statistics of a corpus too large for memory can
+        be gathered file by file and merged.
+
+        em_GMM() performs one iteration: the vectors are split into
+        nshard contiguous shards, the statistics of each shard are
+        accumulated as one job of pool, and the shards are summed
+        pairwise in a binary tree.  The result therefore depends
+        on nshard but not on the number of threads or on the order
+        in which the jobs run.  update_GMM() then sets
+
+            weight = occ / sum of occ
+            mean   = sum / occ
+            cov    = sqr / occ - mean mean'
+
+        leaving components without occupancy as they were, and
+        applies floorWeight_GMM(), maskCov_GMM() and floorVar_GMM()
+        as configured in e before preparing gconst (and inv).
+
+****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+/* vectors scored by one call of log_wgd_batch() */
+#define GMMEM_CHUNK 256
+
+int alloc_GMMSTATS(GMMSTATS * s, const int nmix, const int dim,
+                   const Boolean full)
+{
+   s->nmix = nmix;
+   s->dim = dim;
+   s->full = full;
+   s->occ = dgetmem(nmix + nmix * dim + nmix * dim * ((full == TR) ? dim : 1));
+   s->sum = s->occ + nmix;
+   s->sqr = s->sum + nmix * dim;
+   s->loglik = 0.0;
+
+   return (0);
+}
+
+int free_GMMSTATS(GMMSTATS * s)
+{
+   free(s->occ);
+   s->occ = s->sum = s->sqr = NULL;
+
+   return (0);
+}
+
+int reset_GMMSTATS(GMMSTATS * s)
+{
+   int i, n;
+
+   n = s->nmix + s->nmix * s->dim
+       + s->nmix * s->dim * ((s->full == TR) ? s->dim : 1);
+   for (i = 0; i < n; i++)
+      s->occ[i] = 0.0;
+   s->loglik = 0.0;
+
+   return (0);
+}
+
+int accum_GMMSTATS(GMMSTATS * s, const PGMM * p, const double *x,
+                   const int T)
+{
+   const int M = s->nmix, D = s->dim;
+   int t, t0, n, m, i, j;
+   double *lw, *lwt, g, gx, *sm, *sq;
+   const double *xt;
+
+   if ((lw = adgetmem(NULL, (size_t) GMMEM_CHUNK * M)) == NULL)
+      return (-1);
+
+   for (t0 = 0; t0 < T; t0 += GMMEM_CHUNK) {
+      n = (T - t0 < GMMEM_CHUNK) ? T - t0 : GMMEM_CHUNK;
+      if (log_wgd_batch(p, x + (size_t) t0 * D, n, lw) != 0) {
+         free(lw);
+         return (-1);
+      }
+      for (t = 0; t < n; t++) {
+         xt = x + (size_t) (t0 + t) * D;
+         lwt = lw + (size_t) t * M;
+
+         /* posterior probabilities of the components, in place */
+         s->loglik += log_sum_exp(lwt, M, lwt);
+
+         for (m = 0; m < M; m++) {
+            g = lwt[m];
+            if (g == 0.0)
+               continue;
+            s->occ[m] += g;
+            sm = s->sum + m * D;
+            for (i = 0; i < D; i++)
+               sm[i] += g * xt[i];
+            if (s->full == TR) {
+               /* lower triangle */
+               sq = s->sqr + m * D * D;
+               for (i = 0; i < D; i++) {
+                  gx = g * xt[i];
+                  for (j = 0; j <= i; j++)
+                     sq[i * D + j] += gx * xt[j];
+               }
+            } else {
+               sq = s->sqr + m * D;
+               for (i = 0; i < D; i++)
+                  sq[i] += g * xt[i] * xt[i];
+            }
+         }
+      }
+   }
+
+   free(lw);
+
+   return (0);
+}
+
+int add_GMMSTATS(GMMSTATS * s, const GMMSTATS * t)
+{
+   int i, n;
+
+   n = s->nmix + s->nmix * s->dim
+       + s->nmix * s->dim * ((s->full == TR) ? s->dim : 1);
+   for (i = 0; i < n; i++)
+      s->occ[i] += t->occ[i];
+   s->loglik += t->loglik;
+
+   return (0);
+}
+
+int alloc_GMMEM(GMMEM * e, const GMM * gmm, const int nshard)
+{
+   int i;
+
+   e->nshard = (nshard > 0) ? nshard : 1;
+   e->stats = (GMMSTATS *) getmem(e->nshard, sizeof(GMMSTATS));
+   for (i = 0; i < e->nshard; i++)
+      alloc_GMMSTATS(&e->stats[i], gmm->nmix, gmm->dim, gmm->full);
+   e->weight_floor = 0.0;
+   e->var_floor = 0.0;
+   e->dim_list = NULL;
+   e->cov_dim = 0;
+   e->block_full = FA;
+   e->block_corr = FA;
+
+   return (0);
+}
+
+int free_GMMEM(GMMEM * e)
+{
+   int i;
+
+   for (i = 0; i < e->nshard; i++)
+      free_GMMSTATS(&e->stats[i]);
+   free(e->stats);
+   e->stats = NULL;
+   e->nshard = 0;
+
+   return (0);
+}
+
+int update_GMM(GMMEM * e, GMM * gmm)
+{
+   const GMMSTATS *s = &e->stats[0];
+   const int M = s->nmix, D = s->dim;
+   int m, i, j;
+   double total = 0.0, *mean;
+
+   for (m = 0; m < M; m++)
+      total += s->occ[m];
+   if (total <= 0.0)
+      return (0);
+
+   for (m = 0; m < M; m++) {
+      gmm->weight[m] = s->occ[m] / total;
+      if (s->occ[m] <= 0.0)
+         continue;
+      mean = gmm->gauss[m].mean;
+      for (i = 0; i < D; i++)
+         mean[i] = s->sum[m * D + i] / s->occ[m];
+      if (gmm->full == TR) {
+         for (i = 0; i < D; i++)
+            for (j = 0; j <= i; j++) {
+               gmm->gauss[m].cov[i][j] =
+                   s->sqr[(m * D + i) * D + j] / s->occ[m] - mean[i] * mean[j];
+               gmm->gauss[m].cov[j][i] = gmm->gauss[m].cov[i][j];
+            }
+      } else {
+         for (i = 0; i < D; i++)
+            gmm->gauss[m].var[i] =
+                s->sqr[m * D + i] / s->occ[m] - mean[i] * mean[i];
+      }
+   }
+
+   if (e->weight_floor > 0.0)
+      floorWeight_GMM(gmm, e->weight_floor);
+   if (gmm->full == TR && e->dim_list != NULL)
+      maskCov_GMM(gmm, e->dim_list, e->cov_dim, e->block_full, e->block_corr);
+   if (e->var_floor > 0.0)
+      floorVar_GMM(gmm, e->var_floor);
+
+   return (prepare_GMM(gmm, NULL, NULL));
+}
+
+/* arguments shared by the jobs of em_GMM() */
+typedef struct _GMMEMJOB {
+   GMMEM *e;
+   const PGMM *p;
+   const double *x;
+   int T;
+   int stride;                  /* distance of the shards summed (tree) */
+   int *status;
+} GMMEMJOB;
+
+static void em_accum_job(void *arg, const int thread, const int job)
+{
+   GMMEMJOB *j = (GMMEMJOB *) arg;
+   int t0, t1;
+
+   t0 = (int) ((double) j->T * job / j->e->nshard);
+   t1 = (int) ((double) j->T * (job + 1) / j->e->nshard);
+   reset_GMMSTATS(&j->e->stats[job]);
+   j->status[job] = accum_GMMSTATS(&j->e->stats[job], j->p,
+                                   j->x + (size_t) t0 * j->p->dim, t1 - t0);
+}
+
+static void em_reduce_job(void *arg, const int thread, const int job)
+{
+   GMMEMJOB *j = (GMMEMJOB *) arg;
+   int k = 2 * j->stride * job;
+
+   add_GMMSTATS(&j->e->stats[k], &j->e->stats[k + j->stride]);
+}
+
+int em_GMM(GMMEM * e, GMM * gmm, const double *x, const int T,
+           THREADPOOL * pool, double *loglik)
+{
+   int i, ret;
+   PGMM p;
+   GMMEMJOB j;
+
+   if ((ret = alloc_PGMM(&p, gmm)) != 0)
+      return (ret);
+   if ((j.status = (int *) agetmem(NULL, e->nshard, sizeof(int))) == NULL) {
+      free_PGMM(&p);
+      return (-1);
+   }
+   j.e = e;
+   j.p = &p;
+   j.x = x;
+   j.T = T;
+
+   /* E-step, one job per shard */
+   run_THREADPOOL(pool, e->nshard, em_accum_job, &j);
+   for (i = 0, ret = 0; i < e->nshard; i++)
+      if (j.status[i] != 0)
+         ret = -1;
+   free(j.status);
+   free_PGMM(&p);
+   if (ret != 0)
+      return (ret);
+
+   /* stats[k] += stats[k + stride] for k = 0, 2 stride, 4 stride, ... */
+   for (j.stride = 1; j.stride < e->nshard; j.stride *= 2)
+      run_THREADPOOL(pool, (e->nshard + j.stride - 1) / (2 * j.stride),
+                     em_reduce_job, &j);
+
+   if (loglik != NULL)
+      *loglik = e->stats[0].loglik;
+
+   /* M-step */
+   return (update_GMM(e, gmm));
+}
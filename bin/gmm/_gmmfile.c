@@ -0,0 +1,288 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+/****************************************************************
+
+    $Id$
+
+    Binary container of packed GMM
+
+        int save_PGMM(p, fp)
+        int load_PGMM(p, fp)
+
+        PGMM *p  : packed GMM
+        FILE *fp : file, positioned at the start of the container
+                   for load_PGMM()
+
+        return value :
+                   0 -> success
+                   1 -> not a container of this version
+                  -1 -> failed to read, write or allocate
+
+        The container holds a PGMM as it lies in memory, with the
+        log weights with Gaussian constants folded in, the padded
+        mean matrix and the inverse Cholesky factors (or 1 / sqrt
+        of the variances) already computed.  All numbers are little
+        endian.  A header of PGMM_HEADER bytes
+
+            char   magic[8]    "SPTKPGMM"
+            int    version     PGMM_VERSION
+            int    header      PGMM_HEADER
+            int    nmix, dim, ld, full
+            double one         1.0, to check the number format
+
+        padded with zeros is followed by lconst, mean and prec,
+        each padded to a multiple of PGMM_ALIGN doubles, so every
+        row starts on a cache line of the file.
+
+        load_PGMM() maps a regular file read-only into memory and
+        points p at the mapping, so processes loading the same
+        model share one copy of it in the page cache and nothing
+        is read or converted until it is used.  The mapping is
+        read-only, so a loaded PGMM must not be written to.  Pipes,
+        big endian hosts and Windows read the file into the heap
+        instead.  free_PGMM() unmaps or frees the storage as
+        appropriate.
+
+****************************************************************/
+
+#if !defined(WIN32)
+#define _POSIX_C_SOURCE 200112L /* fileno() */
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#define PGMM_MAGIC "SPTKPGMM"
+#define PGMM_VERSION 1
+#define PGMM_HEADER 64
+
+void SPTK_byte_swap(void *p, size_t size, size_t num);
+
+static int pgmm_round(const int n)
+{
+   return ((n + PGMM_ALIGN - 1) / PGMM_ALIGN * PGMM_ALIGN);
+}
+
+/* number of doubles after the header */
+static size_t pgmm_size(const PGMM * p)
+{
+   return ((size_t) pgmm_round(p->nmix) + (size_t) p->nmix * p->ld
+           * ((p->full == TR) ? p->dim + 1 : 2));
+}
+
+/* little endian 32-bit integer at b */
+static int pgmm_get_int(const unsigned char *b)
+{
+   return ((int) ((unsigned long) b[0] | (unsigned long) b[1] << 8
+                  | (unsigned long) b[2] << 16 | (unsigned long) b[3] << 24));
+}
+
+static void pgmm_put_int(unsigned char *b, const int v)
+{
+   b[0] = (unsigned char) (v & 0xff);
+   b[1] = (unsigned char) ((v >> 8) & 0xff);
+   b[2] = (unsigned char) ((v >> 16) & 0xff);
+   b[3] = (unsigned char) ((v >> 24) & 0xff);
+}
+
+/* fill p from a header; returns 1 if it is not a valid one */
+static int pgmm_parse(PGMM * p, const unsigned char *h)
+{
+   double one;
+
+   if (memcmp(h, PGMM_MAGIC, 8) != 0 || pgmm_get_int(h + 8) != PGMM_VERSION
+       || pgmm_get_int(h + 12) != PGMM_HEADER)
+      return (1);
+   p->nmix = pgmm_get_int(h + 16);
+   p->dim = pgmm_get_int(h + 20);
+   p->ld = pgmm_get_int(h + 24);
+   p->full = (pgmm_get_int(h + 28) != 0) ? TR : FA;
+   memcpy(&one, h + 32, sizeof(one));
+#ifdef WORDS_BIGENDIAN
+   SPTK_byte_swap(&one, sizeof(one), 1);
+#endif
+   if (one != 1.0 || p->nmix <= 0 || p->dim <= 0 || p->ld != pgmm_round(p->dim))
+      return (1);
+   p->mapped = 0;
+
+   return (0);
+}
+
+/* point lconst, mean and prec into data */
+static void pgmm_point(PGMM * p, double *data)
+{
+   p->lconst = data;
+   p->mean = p->lconst + pgmm_round(p->nmix);
+   p->prec = p->mean + (size_t) p->nmix * p->ld;
+}
+
+int save_PGMM(const PGMM * p, FILE * fp)
+{
+   unsigned char h[PGMM_HEADER];
+   double one = 1.0;
+   size_t size = pgmm_size(p);
+#ifdef WORDS_BIGENDIAN
+   size_t i;
+   double d;
+#endif
+
+   memset(h, 0, sizeof(h));
+   memcpy(h, PGMM_MAGIC, 8);
+   pgmm_put_int(h + 8, PGMM_VERSION);
+   pgmm_put_int(h + 12, PGMM_HEADER);
+   pgmm_put_int(h + 16, p->nmix);
+   pgmm_put_int(h + 20, p->dim);
+   pgmm_put_int(h + 24, p->ld);
+   pgmm_put_int(h + 28, (p->full == TR) ? 1 : 0);
+#ifdef WORDS_BIGENDIAN
+   SPTK_byte_swap(&one, sizeof(one), 1);
+#endif
+   memcpy(h + 32, &one, sizeof(one));
+
+   if (fwrite(h, 1, PGMM_HEADER, fp) != PGMM_HEADER) {
+      fprintf(stderr, "save_PGMM : cannot write the header!\n");
+      return (-1);
+   }
+#ifdef WORDS_BIGENDIAN
+   for (i = 0; i < size; i++) {
+      d = p->lconst[i];
+      if (fwrite_little_endian(&d, sizeof(d), 1, fp) != 1)
+         break;
+   }
+   if (i != size) {
+#else
+   if (fwrite(p->lconst, sizeof(*p->lconst), size, fp) != size) {
+#endif
+      fprintf(stderr, "save_PGMM : cannot write the model!\n");
+      return (-1);
+   }
+
+   return (0);
+}
+
+/* map the container in fp, which must be at offset 0 of a regular file;
+   returns 1 if that is not possible */
+static int pgmm_map(PGMM * p, FILE * fp)
+{
+#if defined(WIN32) || defined(WORDS_BIGENDIAN)
+   return (1);
+#else
+   struct stat st;
+   size_t bytes;
+   void *addr;
+
+   if (ftell(fp) != 0 || fstat(fileno(fp), &st) != 0 || !S_ISREG(st.st_mode)
+       || st.st_size < PGMM_HEADER)
+      return (1);
+   bytes = (size_t) st.st_size;
+   addr = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fileno(fp), 0);
+   if (addr == MAP_FAILED)
+      return (1);
+   if (pgmm_parse(p, (unsigned char *) addr) != 0
+       || bytes < PGMM_HEADER + pgmm_size(p) * sizeof(double)) {
+      munmap(addr, bytes);
+      return (1);
+   }
+
+   p->block = (double *) addr;
+   p->mapped = bytes;
+   pgmm_point(p, p->block + PGMM_HEADER / sizeof(double));
+
+   return (0);
+#endif
+}
+
+int load_PGMM(PGMM * p, FILE * fp)
+{
+   unsigned char h[PGMM_HEADER];
+   size_t addr, size;
+
+   if (pgmm_map(p, fp) == 0)
+      return (0);
+
+   if (fread(h, 1, PGMM_HEADER, fp) != PGMM_HEADER) {
+      fprintf(stderr, "load_PGMM : cannot read the header!\n");
+      return (-1);
+   }
+   if (pgmm_parse(p, h) != 0) {
+      fprintf(stderr, "load_PGMM : not a packed GMM of version %d!\n",
+              PGMM_VERSION);
+      return (1);
+   }
+
+   size = pgmm_size(p);
+   if ((p->block = adgetmem(NULL, size + PGMM_ALIGN)) == NULL)
+      return (-1);
+   addr = (size_t) p->block % (PGMM_ALIGN * sizeof(double));
+   pgmm_point(p, p->block + (addr == 0 ? 0 : PGMM_ALIGN - addr / sizeof(double)));
+   if (fread(p->lconst, sizeof(*p->lconst), size, fp) != size) {
+      fprintf(stderr, "load_PGMM : cannot read the model!\n");
+      free(p->block);
+      p->block = NULL;
+      return (-1);
+   }
+#ifdef WORDS_BIGENDIAN
+   SPTK_byte_swap(p->lconst, sizeof(*p->lconst), size);
+#endif
+
+   return (0);
+}
+
+/* release storage obtained by pgmm_map() */
+void pgmm_unmap(PGMM * p)
+{
+#if !defined(WIN32)
+   munmap((void *) p->block, p->mapped);
+#endif
+}
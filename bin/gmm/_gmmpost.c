@@ -0,0 +1,331 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+/****************************************************************
+
+    $Id$
+
+    Frame posteriors of GMM with Gaussian selection
+
+        int alloc_GMMPOST(g, p, topk, nclust, nsel)
+        int free_GMMPOST(g)
+        int reset_GMMPOST(g)
+        int gmmpost_push(g, x, index, post, logp)
+
+        GMMPOST *g      : state
+        PGMM    *p      : packed GMM, kept by pointer
+        int     topk    : number of posteriors returned per frame (>= 1)
+        int     nclust  : number of clusters of mixture components
+                          (0: no selection, every component is scored)
+        int     nsel    : number of clusters scored per frame
+        double  *x      : input vector
+        int     *index  : components of the largest posteriors,
+                          in decreasing order of posterior
+        double  *post   : their posteriors
+        double  *logp   : approximate log output probability of x
+                          (may be NULL)
+
+        return value of alloc_GMMPOST() :
+                    0 -> success
+                   -1 -> topk is less than 1
+
+        return value of gmmpost_push() :
+                    number of posteriors written (<= topk)
+
+        alloc_GMMPOST() clusters the means of the components by
+        k-means in a space scaled by the average precision of each
+        dimension.  For every frame gmmpost_push() scores the
+        nsel clusters nearest to x and the topk components of the
+        previous frame, and evaluates only their members.  Their
+        log-sum-exp is an approximation of log_outp() from below,
+        and the posteriors are normalized by it.
+
+****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+/* iterations of k-means over the means */
+#define GMMPOST_KMEANS 10
+
+/* log weighted Gaussian of component m at x, diff holds dim values */
+static double pgmm_log_wgd(const PGMM * p, const int m, const double *x,
+                           double *diff)
+{
+   const int D = p->dim;
+   int i, j;
+   double quad = 0.0, acc, z;
+   const double *mu = p->mean + (size_t) m * p->ld, *row;
+
+   if (p->full == TR) {
+      for (i = 0; i < D; i++)
+         diff[i] = x[i] - mu[i];
+      for (i = 0; i < D; i++) {
+         row = p->prec + ((size_t) m * D + i) * p->ld;
+         for (j = 0, acc = 0.0; j <= i; j++)
+            acc += row[j] * diff[j];
+         quad += acc * acc;
+      }
+   } else {
+      row = p->prec + (size_t) m * p->ld;
+      for (i = 0; i < D; i++) {
+         z = (x[i] - mu[i]) * row[i];
+         quad += z * z;
+      }
+   }
+
+   return (p->lconst[m] - 0.5 * quad);
+}
+
+/* squared distance of scaled vector z and centroid c */
+static double gmmpost_dist(const GMMPOST * g, const double *z, const int c)
+{
+   int i;
+   double d = 0.0, e;
+   const double *cent = g->centroid + (size_t) c * g->p->dim;
+
+   for (i = 0; i < g->p->dim; i++) {
+      e = z[i] - cent[i];
+      d += e * e;
+   }
+
+   return (d);
+}
+
+int alloc_GMMPOST(GMMPOST * g, const PGMM * p, const int topk,
+                  const int nclust, const int nsel)
+{
+   const int M = p->nmix, D = p->dim;
+   int m, i, c, it, best, *count;
+   double d, dmin, *cm;
+
+   if (topk < 1) {
+      fprintf(stderr, "alloc_GMMPOST : topk must be at least 1!\n");
+      return (-1);
+   }
+
+   g->p = p;
+   g->topk = (topk < M) ? topk : M;
+   g->nclust = (nclust < M) ? nclust : M;
+   g->nsel = (nsel < g->nclust) ? nsel : g->nclust;
+   if (g->nsel < 1)
+      g->nsel = 1;
+   g->nlist = 0;
+   g->stamp = 0;
+   g->list = (int *) getmem(M + g->topk, sizeof(int));
+   g->prev = g->list + M;
+   g->mark = (long *) getmem(M, sizeof(long));
+   g->lw = dgetmem(M + 2 * D);
+   g->z = g->lw + M;
+   g->diff = g->z + D;
+   g->scale = dgetmem(D);
+   g->centroid = NULL;
+   g->cluster = NULL;
+   g->member = NULL;
+   g->cdist = NULL;
+   g->csel = NULL;
+
+   /* average precision of each dimension */
+   for (m = 0; m < M; m++)
+      for (i = 0; i < D; i++)
+         g->scale[i] += (p->full == TR)
+             ? p->prec[((size_t) m * D + i) * p->ld + i]
+             : p->prec[(size_t) m * p->ld + i];
+   for (i = 0; i < D; i++)
+      g->scale[i] /= M;
+
+   if (g->nclust <= 0)
+      return (0);
+
+   /* k-means of the scaled means, started from evenly spaced components */
+   g->centroid = dgetmem(g->nclust * D + M * D + g->nclust);
+   cm = g->centroid + g->nclust * D;
+   g->cdist = cm + M * D;
+   g->cluster = (int *) getmem(M + g->nclust + 1 + g->nclust, sizeof(int));
+   g->first = g->cluster + M;
+   g->csel = g->first + g->nclust + 1;
+   g->member = (int *) getmem(M, sizeof(int));
+   count = g->member;
+   for (m = 0; m < M; m++)
+      for (i = 0; i < D; i++)
+         cm[m * D + i] = p->mean[(size_t) m * p->ld + i] * g->scale[i];
+   for (c = 0; c < g->nclust; c++)
+      for (i = 0; i < D; i++)
+         g->centroid[c * D + i] = cm[(c * M / g->nclust) * D + i];
+   for (it = 0; it < GMMPOST_KMEANS; it++) {
+      for (m = 0; m < M; m++) {
+         for (c = 0, best = 0, dmin = 0.0; c < g->nclust; c++) {
+            d = gmmpost_dist(g, cm + m * D, c);
+            if (c == 0 || d < dmin) {
+               dmin = d;
+               best = c;
+            }
+         }
+         g->cluster[m] = best;
+      }
+      for (c = 0; c < g->nclust; c++)
+         count[c] = 0;
+      for (m = 0; m < M; m++)
+         count[g->cluster[m]]++;
+      for (c = 0; c < g->nclust; c++)
+         if (count[c] > 0)
+            for (i = 0; i < D; i++)
+               g->centroid[c * D + i] = 0.0;
+      for (m = 0; m < M; m++)
+         for (i = 0; i < D; i++)
+            g->centroid[g->cluster[m] * D + i] += cm[m * D + i] / count[g->cluster[m]];
+   }
+
+   /* members of cluster c are member[first[c]], ..., member[first[c + 1] - 1] */
+   for (c = 0; c <= g->nclust; c++)
+      g->first[c] = 0;
+   for (m = 0; m < M; m++)
+      g->first[g->cluster[m] + 1]++;
+   for (c = 0; c < g->nclust; c++)
+      g->first[c + 1] += g->first[c];
+   for (c = 0; c < g->nclust; c++)
+      g->csel[c] = g->first[c];
+   for (m = 0; m < M; m++)
+      g->member[g->csel[g->cluster[m]]++] = m;
+
+   return (0);
+}
+
+int free_GMMPOST(GMMPOST * g)
+{
+   free(g->list);
+   free(g->mark);
+   free(g->lw);
+   free(g->scale);
+   if (g->centroid != NULL) {
+      free(g->centroid);
+      free(g->cluster);
+      free(g->member);
+   }
+   g->centroid = g->lw = g->scale = NULL;
+   g->list = NULL;
+
+   return (0);
+}
+
+int reset_GMMPOST(GMMPOST * g)
+{
+   g->nlist = 0;
+
+   return (0);
+}
+
+/* add component m to the candidates of this frame */
+static void gmmpost_add(GMMPOST * g, const int m, int *n)
+{
+   if (g->mark[m] != g->stamp) {
+      g->mark[m] = g->stamp;
+      g->list[(*n)++] = m;
+   }
+}
+
+int gmmpost_push(GMMPOST * g, const double *x, int *index, double *post,
+                 double *logp)
+{
+   const PGMM *p = g->p;
+   int i, k, c, m, n = 0, nk = 0;
+   double lp;
+
+   g->stamp++;
+
+   /* candidates: previous shortlist and members of the nearest clusters */
+   for (k = 0; k < g->nlist; k++)
+      gmmpost_add(g, g->prev[k], &n);
+   if (g->nclust > 0) {
+      for (i = 0; i < p->dim; i++)
+         g->z[i] = x[i] * g->scale[i];
+      for (c = 0; c < g->nclust; c++)
+         g->cdist[c] = gmmpost_dist(g, g->z, c);
+      for (k = 0; k < g->nsel; k++) {
+         /* k-th nearest cluster by selection */
+         for (c = 0, i = -1; c < g->nclust; c++)
+            if (g->cdist[c] >= 0.0 && (i < 0 || g->cdist[c] < g->cdist[i]))
+               i = c;
+         g->cdist[i] = -1.0;
+         for (m = g->first[i]; m < g->first[i + 1]; m++)
+            gmmpost_add(g, g->member[m], &n);
+      }
+   } else {
+      for (m = 0; m < p->nmix; m++)
+         gmmpost_add(g, m, &n);
+   }
+
+   /* log-sum-exp over the candidates */
+   for (k = 0; k < n; k++)
+      g->lw[k] = pgmm_log_wgd(p, g->list[k], x, g->diff);
+   lp = log_sum_exp(g->lw, n, NULL);
+   if (logp != NULL)
+      *logp = lp;
+
+   /* topk largest by insertion, ties to the earlier candidate */
+   for (k = 0; k < n; k++) {
+      if (nk == g->topk && g->lw[k] <= post[nk - 1])
+         continue;
+      for (i = (nk < g->topk) ? nk++ : nk - 1; i > 0 && post[i - 1] < g->lw[k];
+           i--) {
+         post[i] = post[i - 1];
+         index[i] = index[i - 1];
+      }
+      post[i] = g->lw[k];
+      index[i] = g->list[k];
+   }
+   for (k = 0; k < nk; k++) {
+      post[k] = exp(post[k] - lp);
+      g->prev[k] = index[k];
+   }
+   g->nlist = nk;
+
+   return (nk);
+}
@@ -0,0 +1,266 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+/****************************************************************
+
+    $Id$
+
+    Log-sum-exp of an array
+
+        double log_sum_exp(x, n, w)
+
+        double *x  : log values
+        int    n   : number of values
+        double *w  : exp(x[i] - result), i.e. normalized weights
+                     such as posteriors (may be NULL, may be x)
+
+        return value : log(sum of exp(x[i])), LZERO (and w all
+                       zero) if n <= 0 or every x[i] is below LSMALL
+
+        The maximum is subtracted first, then the exponentials are
+        evaluated several at a time with a polynomial after
+        Cody-Waite reduction, 2^k being built directly in the
+        exponent bits (AVX2, SSE2 or NEON; exp() otherwise), and
+        log() is called once.  The relative error of each
+        exponential is within a few units in the last place, so the
+        result agrees with pairwise log_add() to rounding while
+        needing no exp(), log() or branch per element.
+
+****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define LSE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LSE_NEON
+#include <arm_neon.h>
+#endif
+
+/* terms more than 708 below the maximum count as 0 on every path */
+#define LSE_XMIN (-708.0)
+#define LSE_LOG2E 1.4426950408889634074
+#define LSE_LN2HI 6.93147180369123816490e-01
+#define LSE_LN2LO 1.90821492927058770002e-10
+#define LSE_MAGIC 6755399441055744.0    /* 1.5 * 2^52 */
+
+/* exp(x) for x <= 0, 0 below LSE_XMIN like the vector kernels */
+static double lse_exp(const double x)
+{
+   return ((x >= LSE_XMIN) ? exp(x) : 0.0);
+}
+
+#if defined(LSE_X86)
+#define VW 2
+#define VEC __m128d
+#define VLOAD(p) _mm_loadu_pd(p)
+#define VSTORE(p, v) _mm_storeu_pd((p), (v))
+#define VSET1(s) _mm_set1_pd(s)
+#define VZERO _mm_setzero_pd()
+#define VADD(x, y) _mm_add_pd((x), (y))
+#define VSUB(x, y) _mm_sub_pd((x), (y))
+#define VMUL(x, y) _mm_mul_pd((x), (y))
+#define VMAX(x, y) _mm_max_pd((x), (y))
+#define VMASKGE(v, x, y) _mm_and_pd((v), _mm_cmpge_pd((x), (y)))
+#define VPOW2(t) _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64( \
+        _mm_castpd_si128(t), _mm_set1_epi64x(1023)), 52))
+#define KNAME(name) name##_sse2
+#define KATTR TARGET_SSE2
+#include "logsumexp_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VMAX
+#undef VMASKGE
+#undef VPOW2
+#undef KNAME
+#undef KATTR
+
+#define VW 4
+#define VEC __m256d
+#define VLOAD(p) _mm256_loadu_pd(p)
+#define VSTORE(p, v) _mm256_storeu_pd((p), (v))
+#define VSET1(s) _mm256_set1_pd(s)
+#define VZERO _mm256_setzero_pd()
+#define VADD(x, y) _mm256_add_pd((x), (y))
+#define VSUB(x, y) _mm256_sub_pd((x), (y))
+#define VMUL(x, y) _mm256_mul_pd((x), (y))
+#define VMAX(x, y) _mm256_max_pd((x), (y))
+#define VMASKGE(v, x, y) \
+        _mm256_and_pd((v), _mm256_cmp_pd((x), (y), _CMP_GE_OQ))
+#define VPOW2(t) _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64( \
+        _mm256_castpd_si256(t), _mm256_set1_epi64x(1023)), 52))
+#define KNAME(name) name##_avx2
+#define KATTR TARGET_AVX2
+#include "logsumexp_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VMAX
+#undef VMASKGE
+#undef VPOW2
+#undef KNAME
+#undef KATTR
+#elif defined(LSE_NEON)
+#define VW 2
+#define VEC float64x2_t
+#define VLOAD(p) vld1q_f64(p)
+#define VSTORE(p, v) vst1q_f64((p), (v))
+#define VSET1(s) vdupq_n_f64(s)
+#define VZERO vdupq_n_f64(0.0)
+#define VADD(x, y) vaddq_f64((x), (y))
+#define VSUB(x, y) vsubq_f64((x), (y))
+#define VMUL(x, y) vmulq_f64((x), (y))
+#define VMAX(x, y) vmaxq_f64((x), (y))
+#define VMASKGE(v, x, y) vreinterpretq_f64_u64(vandq_u64( \
+        vreinterpretq_u64_f64(v), vcgeq_f64((x), (y))))
+#define VPOW2(t) vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64( \
+        vreinterpretq_s64_f64(t), vdupq_n_s64(1023)), 52))
+#define KNAME(name) name##_neon
+#define KATTR
+#include "logsumexp_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef VMAX
+#undef VMASKGE
+#undef VPOW2
+#undef KNAME
+#undef KATTR
+#endif
+
+static double sum_exp_scalar(const double *x, const int n, const double max,
+                             double *e)
+{
+   int i;
+   double sum = 0.0, d;
+
+   for (i = 0; i < n; i++) {
+      d = lse_exp(x[i] - max);
+      if (e != NULL)
+         e[i] = d;
+      sum += d;
+   }
+
+   return (sum);
+}
+
+double log_sum_exp(const double *x, const int n, double *w)
+{
+   int i;
+#if defined(LSE_X86)
+   int simd;
+#endif
+   double max, sum, lse;
+
+   if (n <= 0)
+      return (LZERO);
+
+   for (i = 1, max = x[0]; i < n; i++)
+      if (x[i] > max)
+         max = x[i];
+
+   if (max < LSMALL) {
+      if (w != NULL)
+         for (i = 0; i < n; i++)
+            w[i] = 0.0;
+      return (LZERO);
+   }
+
+#if defined(LSE_X86)
+   simd = fftsimd_level();
+   if (simd == SPTK_SIMD_AVX2)
+      sum = sum_exp_avx2(x, n, max, w);
+   else if (simd == SPTK_SIMD_SSE2)
+      sum = sum_exp_sse2(x, n, max, w);
+   else
+      sum = sum_exp_scalar(x, n, max, w);
+#elif defined(LSE_NEON)
+   sum = sum_exp_neon(x, n, max, w);
+#else
+   sum = sum_exp_scalar(x, n, max, w);
+#endif
+
+   if (w != NULL)
+      for (i = 0; i < n; i++)
+         w[i] /= sum;
+
+   lse = max + log(sum);
+
+   return (lse);
+}
@@ -0,0 +1,67 @@
+/*--------------------------------------------------------------------------*/
+/*  Blocked kernel of log_wgd_batch() and log_outp_batch() (see            */
+/*  _gmmbatch.c)                                                            */
+/*                                                                          */
+/*  This file is included once per instruction set with the macros          */
+/*    VW                  : number of lanes in a vector                     */
+/*    VEC                 : vector type                                     */
+/*    VLOAD, VSTORE       : unaligned load and store                        */
+/*    VSET1, VZERO        : broadcast and zero                              */
+/*    VADD, VSUB, VMUL    : arithmetic                                      */
+/*    KNAME(name)         : name of the kernel for this instruction set     */
+/*    KATTR               : function attributes                             */
+/*  Element i of frame l of a block is at i * PGMM_FRAMES + l.              */
+/*--------------------------------------------------------------------------*/
+
+KATTR static void KNAME(log_wgd_block) (const PGMM * p, const double *xs,
+                                        double *diff, double *lwgd,
+                                        const int ldw) {
+   const int F = PGMM_FRAMES, D = p->dim;
+   int m, i, j, g, l;
+   double q[PGMM_FRAMES];
+   const double *mu, *row, *dj;
+   VEC q0, q1, a0, a1, r, s, z;
+
+   for (m = 0; m < p->nmix; m++) {
+      mu = p->mean + (size_t) m * p->ld;
+      if (p->full == TR) {
+         for (i = 0; i < D; i++) {
+            r = VSET1(mu[i]);
+            for (g = 0; g < F; g += VW)
+               VSTORE(diff + i * F + g, VSUB(VLOAD(xs + i * F + g), r));
+         }
+      }
+      /* two vectors of frames at a time, kept in registers */
+      for (g = 0; g < F; g += 2 * VW) {
+         q0 = q1 = VZERO;
+         if (p->full == TR) {
+            /* quad = |L^{-1} diff|^2 row by row */
+            for (i = 0; i < D; i++) {
+               row = p->prec + ((size_t) m * D + i) * p->ld;
+               a0 = a1 = VZERO;
+               for (j = 0, dj = diff + g; j <= i; j++, dj += F) {
+                  r = VSET1(row[j]);
+                  a0 = VADD(a0, VMUL(r, VLOAD(dj)));
+                  a1 = VADD(a1, VMUL(r, VLOAD(dj + VW)));
+               }
+               q0 = VADD(q0, VMUL(a0, a0));
+               q1 = VADD(q1, VMUL(a1, a1));
+            }
+         } else {
+            row = p->prec + (size_t) m * p->ld;
+            for (i = 0; i < D; i++) {
+               r = VSET1(mu[i]);
+               s = VSET1(row[i]);
+               z = VMUL(VSUB(VLOAD(xs + i * F + g), r), s);
+               q0 = VADD(q0, VMUL(z, z));
+               z = VMUL(VSUB(VLOAD(xs + i * F + g + VW), r), s);
+               q1 = VADD(q1, VMUL(z, z));
+            }
+         }
+         VSTORE(q + g, q0);
+         VSTORE(q + g + VW, q1);
+      }
+      for (l = 0; l < F; l++)
+         lwgd[l * ldw + m] = p->lconst[m] - 0.5 * q[l];
+   }
+}
@@ -184,11 +184,15 @@ int main(int argc, char **argv)
 
    alloc_GMM(&gmm, M, L, full);
    load_GMM(&gmm, fgmm);
-   prepareCovInv_GMM(&gmm);
-   prepareGconst_GMM(&gmm);
-
    fclose(fgmm);
 
+   /* a covariance that is not positive definite is only reported, and
+      its mixture is left with gconst LZERO */
+   if (prepare_GMM(&gmm, NULL, NULL) < 0) {
+      fclose(fp);
+      return (1);
+   }
+
    /* Calculate and output log-probability */
    T = 0;
    ave_logp = 0.0;
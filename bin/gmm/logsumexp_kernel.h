@@ -0,0 +1,70 @@
+/*--------------------------------------------------------------------------*/
+/*  Kernel of log_sum_exp() (see _logsumexp.c)                              */
+/*                                                                          */
+/*  This file is included once per instruction set with the macros          */
+/*    VW                  : number of lanes in a vector                     */
+/*    VEC                 : vector type                                     */
+/*    VLOAD, VSTORE       : unaligned load and store                        */
+/*    VSET1, VZERO        : broadcast and zero                              */
+/*    VADD, VSUB, VMUL    : arithmetic                                      */
+/*    VMAX                : lane-wise maximum                               */
+/*    VMASKGE(v, x, y)    : v where x >= y, 0 elsewhere                     */
+/*    VPOW2(t)            : 2^k for t = k + LSE_MAGIC, built in the         */
+/*                          exponent bits                                   */
+/*    KNAME(name)         : name of the kernel for this instruction set     */
+/*    KATTR               : function attributes                             */
+/*--------------------------------------------------------------------------*/
+
+/* exp(x) for x <= 0; x below LSE_XMIN gives 0, as in lse_exp() */
+KATTR static VEC KNAME(vexp) (VEC x) {
+   VEC c, t, k, r, p;
+
+   c = VMAX(x, VSET1(LSE_XMIN));  /* keeps 2^k a normal number */
+   t = VADD(VMUL(c, VSET1(LSE_LOG2E)), VSET1(LSE_MAGIC));
+   k = VSUB(t, VSET1(LSE_MAGIC));
+   r = VSUB(VSUB(c, VMUL(k, VSET1(LSE_LN2HI))), VMUL(k, VSET1(LSE_LN2LO)));
+
+   /* Taylor series to r^13 / 13!, |r| <= log(2) / 2 */
+   p = VSET1(1.0 / 6227020800.0);
+   p = VADD(VMUL(p, r), VSET1(1.0 / 479001600.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 39916800.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 3628800.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 362880.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 40320.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 5040.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 720.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 120.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 24.0));
+   p = VADD(VMUL(p, r), VSET1(1.0 / 6.0));
+   p = VADD(VMUL(p, r), VSET1(0.5));
+   p = VADD(VMUL(p, r), VSET1(1.0));
+   p = VADD(VMUL(p, r), VSET1(1.0));
+
+   return (VMASKGE(VMUL(p, VPOW2(t)), x, VSET1(LSE_XMIN)));
+}
+
+/* sum of exp(x[i] - max), each term stored to e unless NULL */
+KATTR static double KNAME(sum_exp) (const double *x, const int n,
+                                    const double max, double *e) {
+   int i, k;
+   double buf[VW], sum = 0.0, d;
+   VEC vmax = VSET1(max), acc = VZERO, v;
+
+   for (i = 0; i + VW <= n; i += VW) {
+      v = KNAME(vexp) (VSUB(VLOAD(x + i), vmax));
+      if (e != NULL)
+         VSTORE(e + i, v);
+      acc = VADD(acc, v);
+   }
+   VSTORE(buf, acc);
+   for (k = 0; k < VW; k++)
+      sum += buf[k];
+   for (; i < n; i++) {
+      d = lse_exp(x[i] - max);
+      if (e != NULL)
+         e[i] = d;
+      sum += d;
+   }
+
+   return (sum);
+}
@@ -52,6 +52,8 @@
 *      real   x[];   real part                                   *
 *      real   y[];   imaginary part                              *
 *      int    m;     size of FFT                                 *
+*                                                                *
+*      int   ifftf(x, y, m)   single precision version           *
 *****************************************************************/
 
 #include <stdio.h>
@@ -76,3 +78,18 @@ int ifft(double *x, double *y, const int m)
 
    return (0);
 }
+
+int ifftf(float *x, float *y, const int m)
+{
+   int i;
+
+   if (fftf(y, x, m) == -1)
+      return (-1);
+
+   for (i = m; --i >= 0; ++x, ++y) {
+      *x /= m;
+      *y /= m;
+   }
+
+   return (0);
+}
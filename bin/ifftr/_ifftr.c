@@ -53,6 +53,10 @@
     double *y : working area
     int     l : number of data(radix 2)
 
+    int ifftrf(x, y, l)
+
+    float  *x, *y : single precision version
+
 ***************************************************************/
 
 #include <stdio.h>
@@ -80,3 +84,22 @@ int ifftr(double *x, double *y, const int l)
 
    return (0);
 }
+
+int ifftrf(float *x, float *y, const int l)
+{
+   int i;
+   float *xp, *yp;
+
+   if (fftrf(x, y, l) == -1)
+      return (-1);
+
+   xp = x;
+   yp = y;
+   i = l;
+   while (i--) {
+      *xp++ /= l;
+      *yp++ /= -l;
+   }
+
+   return (0);
+}
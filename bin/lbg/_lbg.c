@@ -49,6 +49,9 @@
     LBG Algorithm for Vector Quantizer Design
 
        void lbg(x, l, tnum, icb, icbsize, cb, ecbsize, iter, mintnum, seed, centup, delta, end)
+       int lbg_r(w, x, l, tnum, icb, icbsize, cb, ecbsize, iter, mintnum, seed, centup, delta, end)
+
+       LBGWORK *w     :   working area allocated by alloc_LBGWORK()
 
        double *x      :   training vector
        double l       :   length of vector
@@ -64,6 +67,9 @@
        double delta   :   splitting factor
        double end     :   end condition
 
+       return value   :   0 -> completed normally (lbg_r only)
+                          -1-> working area is too small
+
 ***********************************************************************************************/
 
 #include <stdio.h>
@@ -79,42 +85,54 @@
 #define SEED 1
 #define abs(x) ( (x<0) ? (-(x)) : (x) )
 
-void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
-         double *cb, const int ecbsize, const int iter, const int mintnum,
-         const int seed, const int centup, const double delta, const double end)
+int alloc_LBGWORK(LBGWORK * w, const int l, const int tnum, const int ecbsize)
+{
+   w->l = l;
+   w->tnum = tnum;
+   w->ecbsize = ecbsize;
+   w->cb1 = dgetmem(ecbsize * l);
+   w->tindex = (int *) getmem((size_t) tnum, sizeof(int));
+   w->cntcb = (int *) getmem((size_t) ecbsize, sizeof(int));
+
+   return (0);
+}
+
+int free_LBGWORK(LBGWORK * w)
+{
+   free(w->cb1);
+   free(w->tindex);
+   free(w->cntcb);
+   w->l = 0;
+   w->tnum = 0;
+   w->ecbsize = 0;
+   w->cb1 = NULL;
+   w->tindex = NULL;
+   w->cntcb = NULL;
+
+   return (0);
+}
+
+int lbg_r(LBGWORK * w, double *x, const int l, const int tnum, double *icb,
+          int icbsize, double *cb, const int ecbsize, const int iter,
+          const int mintnum, const int seed, const int centup,
+          const double delta, const double end)
 {
    int i, j, k, it, maxindex, tnum1, tnum2;
-   static int *cntcb, *tindex, size, sizex, sizecb;
+   int *cntcb, *tindex, sw = 0;
    unsigned long next = SEED;
-   double d0, d1, dl, err, tmp, rand;
-   static double *cb1 = NULL;
+   double d0, d1, dl, err, tmp, rand, nr;
+   double *cb1;
    double *p, *q, *r;
 
-   if (cb1 == NULL) {
-      cb1 = dgetmem(ecbsize * l);
-      tindex = (int *) dgetmem(tnum);
-      cntcb = (int *) dgetmem(ecbsize);
-      size = l;
-      sizex = tnum;
-      sizecb = ecbsize;
-   }
-   if (l > size) {
-      free(cb1);
-      cb1 = dgetmem(ecbsize * l);
-      size = l;
-   }
-   if (tnum > sizex) {
-      free(tindex);
-      tindex = (int *) dgetmem(tnum);
-      sizex = tnum;
-   }
-   if (sizecb > ecbsize) {
-      free(cb1);
-      free(cntcb);
-      cb1 = dgetmem(ecbsize * l);
-      cntcb = (int *) dgetmem(ecbsize);
+   if (l > w->l || tnum > w->tnum || ecbsize > w->ecbsize) {
+      fprintf(stderr, "lbg : working area is too small!\n");
+      return (-1);
    }
 
+   cb1 = w->cb1;
+   tindex = w->tindex;
+   cntcb = w->cntcb;
+
    movem(icb, cb, sizeof(*icb), icbsize * l);
 
    if (seed != 1)
@@ -125,7 +143,7 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
       r = cb + icbsize * l;
       for (i = 0; i < icbsize; i++) {
          for (j = 0; j < l; j++) {
-            dl = delta * nrandom(&next);
+            dl = delta * nrandom_r(&next, &sw, &nr);
             *r = *q - dl;
             r++;
             *q = *q + dl;
@@ -182,7 +200,7 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
                if (centup == 1) {
                   p = cb + maxindex * l;
                   for (j = 0; j < l; j++) {
-                     rand = nrandom(&next);
+                     rand = nrandom_r(&next, &sw, &nr);
                      q[j] = p[j] + delta * rand;
                      p[j] = p[j] - delta * rand;
                   }
@@ -193,7 +211,7 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
                      tnum2 = cntcb[i + icbsize / 2];
                      for (j = 0; j < l; j++) {
                         tmp = (tnum2 * q[j] + tnum1 * p[j]) / (tnum1 + tnum2);
-                        rand = nrandom(&next);
+                        rand = nrandom_r(&next, &sw, &nr);
                         q[j] = tmp + delta * rand;
                         p[j] = tmp - delta * rand;
                      }
@@ -203,7 +221,7 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
                      tnum2 = cntcb[i - icbsize / 2];
                      for (j = 0; j < l; j++) {
                         tmp = (tnum2 * q[j] + tnum1 * p[j]) / (tnum1 + tnum2);
-                        rand = nrandom(&next);
+                        rand = nrandom_r(&next, &sw, &nr);
                         q[j] = tmp + delta * rand;
                         p[j] = tmp - delta * rand;
                      }
@@ -215,5 +233,27 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
          break;
    }
 
+   return (0);
+}
+
+void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
+         double *cb, const int ecbsize, const int iter, const int mintnum,
+         const int seed, const int centup, const double delta, const double end)
+{
+   static LBGWORK w;
+   int size, sizex, sizecb;
+
+   if (w.cb1 == NULL || l > w.l || tnum > w.tnum || ecbsize > w.ecbsize) {
+      size = (l > w.l) ? l : w.l;
+      sizex = (tnum > w.tnum) ? tnum : w.tnum;
+      sizecb = (ecbsize > w.ecbsize) ? ecbsize : w.ecbsize;
+      if (w.cb1 != NULL)
+         free_LBGWORK(&w);
+      alloc_LBGWORK(&w, size, sizex, sizecb);
+   }
+
+   lbg_r(&w, x, l, tnum, icb, icbsize, cb, ecbsize, iter, mintnum, seed, centup,
+         delta, end);
+
    return;
 }
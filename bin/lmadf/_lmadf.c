@@ -69,17 +69,9 @@
 #include <SPTK.h>
 #endif
 
-static double pade[] = { 1.0,
-   1.0, 0.0,
-   1.0, 0.0, 0.0,
-   1.0, 0.0, 0.0, 0.0,
-   1.0, 0.4999273, 0.1067005, 0.01170221, 0.0005656279,
-   1.0, 0.4999391, 0.1107098, 0.01369984, 0.0009564853, 0.00003041721,
-   1.0, 0.500000157834843, 0.113600112846183, 0.015133367945131, 0.001258740956606, 0.000062701416552, 0.000001481891776,
-   1.0, 0.499802889651314, 0.115274789205577, 0.015997611632083, 0.001452640362652, 0.000087007832645, 0.000003213962732, 0.000000057148619
-};
-
-static double *ppade;
+extern const double mlsadf_pade[];
+
+static const double *ppade;
 
 /****************************************************************
 
@@ -110,7 +102,7 @@ static double lmafir(double x, double *c, const int m, double *d, const int m1,
 
 double lmadf(double x, double *c, const int m, const int pd, double *d)
 {
-   ppade = &pade[pd * (pd + 1) / 2];
+   ppade = &mlsadf_pade[pd * (pd + 1) / 2];
 
    x = lmadf1(x, c, m, d, pd, 1, 1);    /* D1(z) */
    x = lmadf1(x, c, m, &d[(m + 1) * pd], pd, 2, m);     /* D2(z) */
@@ -122,7 +114,7 @@ double cascade_lmadf(double x, double *c, const int m, const int pd, double *d,
                      const int block_num, int *block_size)
 {
    int i, block_start = 1, block_end = 0;
-   ppade = &pade[pd * (pd + 1) / 2];
+   ppade = &mlsadf_pade[pd * (pd + 1) / 2];
 
    for (i = 0; i < block_num; i++) {
       block_end += abs(block_size[i]);
@@ -235,7 +227,7 @@ double lmadft(double x, double *c, const int m, const int pd, double *d,
               int block_num, int *block_size)
 {
    int i, block_start = 2, block_end = 1;
-   ppade = &pade[pd * (pd + 1) / 2];
+   ppade = &mlsadf_pade[pd * (pd + 1) / 2];
 
    x = lmadf1t(x, c, pd, d);
 
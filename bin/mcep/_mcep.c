@@ -49,6 +49,11 @@
     Mel-Cepstral Analysis
 
         int mcep(xw, flng, mc, m, a, itr1, itr2, dd, etype, e, f, itype);
+        int mcep_r(w, xw, flng, mc, m, a, itr1, itr2, dd, etype, e, f, itype);
+        int mcep_batch(pool, w, frames, nframes, stride, flng, mc, m, a,
+                       itr1, itr2, dd, etype, e, f, itype, status);
+
+        MCEPWORK *w    : working area allocated by alloc_MCEPWORK()
 
         double   *xw   : input sequence
         int      flng  : frame length
@@ -73,6 +78,22 @@
                             2 -> invalid itype
                             3 -> failed to compute mel-cepstrum
                             4 -> zero(s) are found in periodogram
+                            5 -> working area is too small
+
+        THREADPOOL *pool    : threads to use (NULL: calling thread only)
+        MCEPWORK *w         : one working area per thread of pool (one
+                              if pool is NULL), allocated by
+                              alloc_MCEPWORK() for at least flng and m
+        double   *frames    : nframes input sequences, frame t starts
+                              at frames + t * stride
+        double   *mc        : nframes mel cepstra of m+1 coefficients
+        int      *status    : return value of mcep_r() for each frame
+
+        mcep_batch() analyzes the frames in parallel with one working
+        area per thread and reports errors only through status, not
+        on stderr.  The working areas may be kept for later calls, so
+        that the warping matrices are built once.  It returns the
+        number of frames whose status is positive.
 
 *****************************************************************/
 
@@ -86,23 +107,73 @@
 #include <SPTK.h>
 #endif
 
-int mcep(double *xw, const int flng, double *mc, const int m, const double a,
-         const int itr1, const int itr2, const double dd, const int etype,
-         const double e, const double f, const int itype)
+int alloc_MCEPWORK(MCEPWORK * w, const int flng, const int m)
+{
+   int wsize;
+
+   wsize = (flng / 2 > m + m) ? flng / 2 : m + m;
+   wsize += wsize + 2;
+
+   w->flng = flng;
+   w->m = m;
+   w->x = dgetmem(3 * flng + 3 * (m + 1) + wsize + THEQ_WORKSIZE(m + 1));
+   w->y = w->x + flng;
+   w->c = w->y + flng;
+   w->d = w->c + flng;
+   w->al = w->d + (m + 1);
+   w->b = w->al + (m + 1);
+   w->wk = w->b + (m + 1);
+   w->tq = w->wk + wsize;
+   w->fw.mat = w->rw.mat = NULL;
+   w->quiet = FA;
+
+   return (0);
+}
+
+int free_MCEPWORK(MCEPWORK * w)
+{
+   free(w->x);
+   w->flng = 0;
+   w->m = 0;
+   w->x = w->y = w->c = NULL;
+   w->d = w->al = w->b = NULL;
+   w->wk = w->tq = NULL;
+   free_WARPMAT(&w->fw);
+   free_WARPMAT(&w->rw);
+   w->quiet = FA;
+
+   return (0);
+}
+
+/* rebuild a warping operator only when (m1, m2, a) has changed */
+static void update_warp(WARPMAT * wm, const WarpType type, const int m1,
+                        const int m2, const double a)
+{
+   if (wm->mat != NULL && wm->m1 == m1 && wm->m2 == m2 && wm->a == a)
+      return;
+   free_WARPMAT(wm);
+   alloc_WARPMAT(wm, type, m1, m2, a);
+}
+
+int mcep_r(MCEPWORK * w, const double *xw, const int flng, double *mc,
+           const int m, const double a, const int itr1, const int itr2,
+           const double dd, const int etype, const double e, const double f,
+           const int itype)
 {
    int i, j;
    int flag = 0, f2, m2;
    double t, s, eps = 0.0, min, max;
-   static double *x = NULL, *y, *c, *d, *al, *b;
-   static int size_x, size_d;
+   double *x, *y, *c, *d, *al, *b;
 
    if (etype == 1 && e < 0.0) {
-      fprintf(stderr, "mcep : value of e must be e>=0!\n");
+      if (!w->quiet)
+         fprintf(stderr, "mcep : value of e must be e>=0!\n");
       return 1;
    }
 
    if (etype == 2 && e >= 0.0) {
-      fprintf(stderr, "mcep : value of E must be E<0!\n");
+      if (!w->quiet)
+         fprintf(stderr, "mcep : value of E must be E<0!\n");
       return 1;
    }
 
@@ -110,36 +181,24 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
       eps = e;
    }
 
-   if (x == NULL) {
-      x = dgetmem(3 * flng);
-      y = x + flng;
-      c = y + flng;
-      size_x = flng;
-
-      d = dgetmem(3 * m + 3);
-      al = d + (m + 1);
-      b = al + (m + 1);
-      size_d = m;
-   }
-   if (flng > size_x) {
-      free(x);
-      x = dgetmem(3 * flng);
-      y = x + flng;
-      c = y + flng;
-      size_x = flng;
-   }
-   if (m > size_d) {
-      free(d);
-      d = dgetmem(3 * m + 3);
-      al = d + (m + 1);
-      b = al + (m + 1);
-      size_d = m;
+   if (flng > w->flng || m > w->m) {
+      if (!w->quiet)
+         fprintf(stderr, "mcep : working area is too small!\n");
+      return 5;
    }
 
+   x = w->x;
+   y = w->y;
+   c = w->c;
+   d = w->d;
+   al = w->al;
+   b = w->b;
+
    f2 = flng / 2;
    m2 = m + m;
 
-   movem(xw, x, sizeof(*x), flng);
+   for (i = 0; i < flng; i++)
+      x[i] = xw[i];
 
    switch (itype) {
    case 0:                     /* windowed data sequence */
@@ -171,7 +230,9 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
       }
       break;
    default:
-      fprintf(stderr, "mcep : input type %d is not supported!\n", itype);
+      if (!w->quiet)
+         fprintf(stderr, "mcep : input type %d is not supported!\n",
+                 itype);
       return 2;
    }
    if (itype > 0) {
@@ -196,8 +257,9 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
 
    for (i = 0; i < flng; i++) {
       if (x[i] <= 0.0) {
-         fprintf(stderr,
-                 "mcep : periodogram has '0', use '-e' option to floor it!\n");
+         if (!w->quiet)
+            fprintf(stderr,
+                    "mcep : periodogram has '0', use '-e' option to floor it!\n");
          return 4;
       }
       c[i] = log(x[i]);
@@ -213,18 +275,23 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
 
    c[0] /= 2.0;
    c[f2] /= 2.0;
-   freqt(c, f2, mc, m, a);      /*  mc : mel cep.  */
+   freqt_r(c, f2, mc, m, a, w->wk);     /*  mc : mel cep.  */
    s = c[0];
 
+   /*  warping of the Newton loop as matrices, kept across calls  */
+   update_warp(&w->fw, WARP_FREQT, m, f2, -a);
+   update_warp(&w->rw, WARP_FRQTR, f2, m2, a);
+
    /*  Newton Raphson method  */
    for (j = 1; j <= itr2; j++) {
       fillz(c, sizeof(*c), flng);
-      freqt(mc, m, c, f2, -a);  /*  mc : mel cep.  */
+      warpmat(&w->fw, mc, c);   /*  mc : mel cep.  */
       fftr(c, y, flng);         /*  c, y : FFT[mc]  */
       for (i = 0; i < flng; i++)
          c[i] = x[i] / exp(c[i] + c[i]);
       ifftr(c, y, flng);
-      frqtr(c, f2, c, m2, a);   /*  c : r(k)  */
+      warpmat(&w->rw, c, w->wk);        /*  c : r(k)  */
+      movem(w->wk, c, sizeof(*c), m2 + 1);
 
       t = c[0];
       if (j >= itr1) {
@@ -245,8 +312,10 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
          c[i] += c[0];
       c[0] += c[0];
 
-      if (theq(c, y, d, b, m + 1, f)) {
-         fprintf(stderr, "mcep : Error in theq() at %dth iteration !\n", j);
+      if (theq_r(c, y, d, b, m + 1, f, w->tq)) {
+         if (!w->quiet)
+            fprintf(stderr, "mcep : Error in theq() at %dth iteration !\n",
+                    j);
          return 3;
       }
 
@@ -261,38 +330,115 @@ int mcep(double *xw, const int flng, double *mc, const int m, const double a,
 
 }
 
+int mcep(double *xw, const int flng, double *mc, const int m, const double a,
+         const int itr1, const int itr2, const double dd, const int etype,
+         const double e, const double f, const int itype)
+{
+   static MCEPWORK w;
+   int size_x, size_d;
+
+   if (w.x == NULL || flng > w.flng || m > w.m) {
+      size_x = (flng > w.flng) ? flng : w.flng;
+      size_d = (m > w.m) ? m : w.m;
+      if (w.x != NULL)
+         free_MCEPWORK(&w);
+      alloc_MCEPWORK(&w, size_x, size_d);
+   }
+
+   return (mcep_r(&w, xw, flng, mc, m, a, itr1, itr2, dd, etype, e, f, itype));
+}
+
+/* arguments shared by the jobs of mcep_batch() */
+typedef struct _MCEPBATCH {
+   MCEPWORK *w;                 /* one working area per thread */
+   const double *frames;
+   size_t stride;
+   int flng, m, itr1, itr2, etype, itype;
+   double a, dd, e, f;
+   double *mc;
+   int *status;
+} MCEPBATCH;
+
+static void mcep_batch_job(void *arg, const int thread, const int job)
+{
+   MCEPBATCH *b = (MCEPBATCH *) arg;
+
+   b->status[job] =
+       mcep_r(&b->w[thread], b->frames + job * b->stride,
+              b->flng, b->mc + job * (b->m + 1), b->m, b->a, b->itr1,
+              b->itr2, b->dd, b->etype, b->e, b->f, b->itype);
+}
+
+int mcep_batch(THREADPOOL * pool, MCEPWORK * w, const double *frames,
+               const size_t nframes, const size_t stride, const int flng,
+               double *mc, const int m, const double a, const int itr1,
+               const int itr2, const double dd, const int etype,
+               const double e, const double f, const int itype, int *status)
+{
+   int i, nthread, nfail = 0;
+   Boolean *quiet;
+   MCEPBATCH b;
+
+   nthread = (pool != NULL && pool->nthread > 0) ? pool->nthread : 1;
+
+   quiet = (Boolean *) getmem(nthread, sizeof(Boolean));
+   for (i = 0; i < nthread; i++) {
+      quiet[i] = w[i].quiet;
+      w[i].quiet = TR;
+   }
+   b.w = w;
+   b.frames = frames;
+   b.stride = stride;
+   b.flng = flng;
+   b.m = m;
+   b.a = a;
+   b.itr1 = itr1;
+   b.itr2 = itr2;
+   b.dd = dd;
+   b.etype = etype;
+   b.e = e;
+   b.f = f;
+   b.itype = itype;
+   b.mc = mc;
+   b.status = status;
+
+   run_THREADPOOL(pool, (int) nframes, mcep_batch_job, &b);
+
+   for (i = 0; i < nthread; i++)
+      w[i].quiet = quiet[i];
+   free(quiet);
+
+   for (i = 0; i < (int) nframes; i++)
+      if (status[i] > 0)
+         nfail++;
+
+   return (nfail);
+}
+
 /***************************************************************
 
     Frequency Transformation for Calculating Coefficients
 
         void frqtr(c1, m1, c2, m2, a)
+        void frqtr_r(c1, m1, c2, m2, a, wk)
 
         double *c1   : minimum phase sequence
         int m1       : order of minimum phase sequence
         double *c2   : warped sequence
         int m2       : order of warped sequence
         double a     : all-pass constant
+        double *wk   : working area of 2*m2+2 doubles
 
 ***************************************************************/
 
-void frqtr(double *c1, int m1, double *c2, int m2, const double a)
+void frqtr_r(double *c1, int m1, double *c2, int m2, const double a,
+             double *wk)
 {
    int i, j;
-   static double *d = NULL, *g;
-   static int size;
+   double *d, *g;
 
-   if (d == NULL) {
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
-
-   if (m2 > size) {
-      free(d);
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
+   d = wk;
+   g = d + m2 + 1;
 
    fillz(g, sizeof(*g), m2 + 1);
 
@@ -309,3 +455,24 @@ void frqtr(double *c1, int m1, double *c2, int m2, const double a)
 
    return;
 }
+
+void frqtr(double *c1, int m1, double *c2, int m2, const double a)
+{
+   static double *d = NULL;
+   static int size;
+
+   if (d == NULL) {
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+
+   if (m2 > size) {
+      free(d);
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+
+   frqtr_r(c1, m1, c2, m2, a, d);
+
+   return;
+}
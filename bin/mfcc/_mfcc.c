@@ -50,6 +50,10 @@
 
         void mfcc(in, mc, sampleFreq, alpha, eps, wlng, flng
                   m, n, ceplift, dftmode, usehamming);
+        int mfcc_r(w, in, mc, sampleFreq, alpha, eps, wlng, flng
+                   m, n, ceplift, dftmode, usehamming);
+
+        MFCCWORK *w        : working area allocated by alloc_MFCCWORK()
 
         double  *in        : input sequence
         double  *mc        : mel-frequency cepstral coefficients
@@ -64,6 +68,9 @@
         Boolean dftmode    : use dft
         Boolean usehamming : use hamming window
 
+        return  value      : 0 -> completed normally (mfcc_r only)
+                             -1-> working area does not match the parameters
+
 ******************************************************************/
 
 #include <stdio.h>
@@ -123,36 +130,37 @@ void pre_emph(double *x, double *y, const double alpha, const int leng)
       y[k] = x[k] - x[k - 1] * alpha;
 }
 
-void spec(double *x, double *sp, const int leng)
+static void spec_r(double *x, double *sp, const int leng, double *y,
+                   double *mag)
 {
    int k, no;
-   double *y, *mag;
 
    no = leng / 2;
 
-   y = dgetmem(leng + no);
-   mag = y + leng;
-
    fftr(x, y, leng);
    for (k = 1; k < no; k++) {
       mag[k] = x[k] * x[k] + y[k] * y[k];
       sp[k] = sqrt(mag[k]);
    }
+}
+
+void spec(double *x, double *sp, const int leng)
+{
+   double *y;
+
+   y = dgetmem(leng + leng / 2);
+   spec_r(x, sp, leng, y, y + leng);
    free(y);
 }
 
-void fbank(double *x, double *fb, const double eps, const double fs,
-           const int leng, const int n)
+static void fbank_r(double *x, double *fb, const double eps, const double fs,
+                    const int leng, const int n, int *noMel,
+                    double *countMel, double *w)
 {
    int k, fnum, no, chanNum = 0;
-   int *noMel;
-   double *w, *countMel;
    double maxMel, kMel;
 
    no = leng / 2;
-   noMel = (int *) getmem((size_t) no, sizeof(int));
-   countMel = dgetmem(n + 1 + no);
-   w = countMel + n + 1;
    maxMel = freq_mel(fs / 2.0);
 
    for (k = 0; k <= n; k++)
@@ -178,9 +186,6 @@ void fbank(double *x, double *fb, const double eps, const double fs,
          fb[fnum + 1] += (1 - w[k]) * x[k];
    }
 
-   free(noMel);
-   free(countMel);
-
    for (k = 1; k <= n; k++) {
       if (fb[k] < eps)
          fb[k] = eps;
@@ -188,6 +193,22 @@ void fbank(double *x, double *fb, const double eps, const double fs,
    }
 }
 
+void fbank(double *x, double *fb, const double eps, const double fs,
+           const int leng, const int n)
+{
+   int no, *noMel;
+   double *countMel;
+
+   no = leng / 2;
+   noMel = (int *) getmem((size_t) no, sizeof(int));
+   countMel = dgetmem(n + 1 + no);
+
+   fbank_r(x, fb, eps, fs, leng, n, noMel, countMel, countMel + n + 1);
+
+   free(noMel);
+   free(countMel);
+}
+
 
 
 void lifter(double *x, double *y, const int m, const int leng)
@@ -200,34 +221,85 @@ void lifter(double *x, double *y, const int m, const int leng)
    }
 }
 
-void mfcc(double *in, double *mc, const double sampleFreq, const double alpha,
-          const double eps, const int wlng, const int flng, const int m,
-          const int n, const int ceplift, const Boolean dftmode,
-          const Boolean usehamming)
+int alloc_MFCCWORK(MFCCWORK * w, const int wlng, const int flng, const int m,
+                   const int n, const Boolean dftmode)
+{
+   int k, no;
+   double arg;
+
+   no = flng / 2;
+
+   w->wlng = wlng;
+   w->flng = flng;
+   w->m = m;
+   w->n = n;
+   w->dftmode = dftmode;
+   w->x = dgetmem(wlng + wlng + flng + flng + n * 2 + 1 + m * 2 + wlng
+                  + flng + no + n + 1 + no);
+   w->px = w->x + wlng;
+   w->wx = w->px + wlng;
+   w->sp = w->wx + flng;
+   w->fb = w->sp + flng;
+   w->dc = w->fb + n * 2 + 1;
+   w->hw = w->dc + m * 2;
+   w->y = w->hw + wlng;
+   w->mag = w->y + flng;
+   w->countMel = w->mag + no;
+   w->w = w->countMel + n + 1;
+   w->noMel = (int *) getmem((size_t) no, sizeof(int));
+
+   /* hamming window */
+   arg = M_2PI / (wlng - 1);
+   for (k = 0; k < wlng; k++)
+      w->hw[k] = 0.54 - 0.46 * cos(k * arg);
+
+   alloc_DCTWORK(&w->dct, n, dftmode);
+
+   return (0);
+}
+
+int free_MFCCWORK(MFCCWORK * w)
+{
+   free(w->x);
+   free(w->noMel);
+   free_DCTWORK(&w->dct);
+   w->wlng = 0;
+   w->flng = 0;
+   w->m = 0;
+   w->n = 0;
+   w->dftmode = FA;
+   w->x = w->px = w->wx = w->sp = w->fb = w->dc = NULL;
+   w->hw = w->y = w->mag = w->countMel = w->w = NULL;
+   w->noMel = NULL;
+
+   return (0);
+}
+
+int mfcc_r(MFCCWORK * w, double *in, double *mc, const double sampleFreq,
+           const double alpha, const double eps, const int wlng,
+           const int flng, const int m, const int n, const int ceplift,
+           const Boolean dftmode, const Boolean usehamming)
 {
-   static double *x = NULL, *px, *wx, *sp, *fb, *dc;
+   double *x, *px, *wx, *sp, *fb, *dc;
    double energy = 0.0, c0 = 0.0;
    int k;
 
-   int memory_size = wlng + wlng + flng + flng + n * 2 + 1 + m * 2;
-   if (x == NULL) {
-      x = dgetmem(memory_size);
-      px = x + wlng;
-      wx = px + wlng;
-      sp = wx + flng;
-      fb = sp + flng;
-      dc = fb + n * 2 + 1;
-   } else {
-      free(x);
-      x = dgetmem(memory_size);
-      px = x + wlng;
-      wx = px + wlng;
-      sp = wx + flng;
-      fb = sp + flng;
-      dc = fb + n * 2 + 1;
+   if (wlng != w->wlng || flng != w->flng || m != w->m || n != w->n
+       || dftmode != w->dftmode) {
+      fprintf(stderr, "mfcc : working area does not match the parameters!\n");
+      return (-1);
    }
+
+   x = w->x;
+   px = w->px;
+   wx = w->wx;
+   sp = w->sp;
+   fb = w->fb;
+   dc = w->dc;
+
    /* need to intizlize dct workspace to zeros */
-   fillz(fb + 1, n * 2 + m * 2, sizeof(double));
+   fillz(fb, sizeof(*fb), n * 2 + 1 + m * 2);
+   fillz(wx, sizeof(*wx), flng);
 
    movem(in, x, sizeof(*in), wlng);
    /* calculate energy */
@@ -235,16 +307,17 @@ void mfcc(double *in, double *mc, const double sampleFreq, const double alpha,
    pre_emph(x, px, alpha, wlng);
    /* apply hamming window */
    if (usehamming)
-      window(HAMMING, px, wlng, 0);
+      for (k = 0; k < wlng; k++)
+         px[k] *= w->hw[k];
    for (k = 0; k < wlng; k++)
       wx[k] = px[k];
-   spec(wx, sp, flng);
-   fbank(sp, fb, eps, sampleFreq, flng, n);
+   spec_r(wx, sp, flng, w->y, w->mag);
+   fbank_r(sp, fb, eps, sampleFreq, flng, n, w->noMel, w->countMel, w->w);
    /* calculate 0'th coefficient */
    for (k = 1; k <= n; k++)
       c0 += fb[k];
    c0 *= sqrt(2.0 / (double) n);
-   dct(fb + 1, dc, n, m, dftmode, 0);
+   dct_r(&w->dct, fb + 1, dc, n, m, 0);
 
    /* liftering */
    if (ceplift > 0)
@@ -257,4 +330,23 @@ void mfcc(double *in, double *mc, const double sampleFreq, const double alpha,
    mc[m - 1] = c0;
    mc[m] = energy;
 
+   return (0);
+}
+
+void mfcc(double *in, double *mc, const double sampleFreq, const double alpha,
+          const double eps, const int wlng, const int flng, const int m,
+          const int n, const int ceplift, const Boolean dftmode,
+          const Boolean usehamming)
+{
+   static MFCCWORK w;
+
+   if (w.x == NULL || wlng != w.wlng || flng != w.flng || m != w.m
+       || n != w.n || dftmode != w.dftmode) {
+      if (w.x != NULL)
+         free_MFCCWORK(&w);
+      alloc_MFCCWORK(&w, wlng, flng, m, n, dftmode);
+   }
+
+   mfcc_r(&w, in, mc, sampleFreq, alpha, eps, wlng, flng, m, n, ceplift,
+          dftmode, usehamming);
 }
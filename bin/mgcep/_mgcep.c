@@ -49,6 +49,10 @@
    Mel-Generalized Cepstral Analysis
 
        int mgcep(xw, flng, b, m, a, g, n, itr1, itr2, dd, etype, e, f, itype);
+       int mgcep_r(w, xw, flng, b, m, a, g, n, itr1, itr2, dd, etype, e, f,
+                   itype);
+
+       MGCEPWORK *w   : working area allocated by alloc_MGCEPWORK()
 
        double   *xw   : input sequence
        int      flng  : frame length
@@ -74,6 +78,7 @@
                         1 -> invalid etype
                         2 -> invalid itype
                         3 -> failed to compute mel-generalized cepstrum
+                        5 -> working area is too small
 
 *****************************************************************/
 
@@ -102,24 +107,13 @@ static double gain(double *er, double *c, int m, double g)
 }
 
 /*  b'(m) to c(m)  */
-void b2c(double *b, int m1, double *c, int m2, double a)
+void b2c_r(double *b, int m1, double *c, int m2, double a, double *wk)
 {
    int i, j;
-   static double *d = NULL, *g;
-   static int size;
-   double k;
+   double k, *d, *g;
 
-   if (d == NULL) {
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
-   if (m2 > size) {
-      free(d);
-      size = m2;
-      d = dgetmem(size + size + 2);
-      g = d + size + 1;
-   }
+   d = wk;
+   g = d + m2 + 1;
 
    k = 1 - a * a;
 
@@ -140,6 +134,26 @@ void b2c(double *b, int m1, double *c, int m2, double a)
    return;
 }
 
+void b2c(double *b, int m1, double *c, int m2, double a)
+{
+   static double *d = NULL;
+   static int size;
+
+   if (d == NULL) {
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+   if (m2 > size) {
+      free(d);
+      size = m2;
+      d = dgetmem(size + size + 2);
+   }
+
+   b2c_r(b, m1, c, m2, a, d);
+
+   return;
+}
+
 /*  recursion for p(m)  */
 static void ptrans(double *p, int m, double a)
 {
@@ -175,14 +189,53 @@ static void qtrans(double *q, int m, double a)
    return;
 }
 
-int mgcep(double *xw, int flng, double *b, const int m, const double a,
-          const double g, const int n, const int itr1, const int itr2,
-          const double dd, const int etype, const double e, const double f,
-          const int itype)
+int alloc_MGCEPWORK(MGCEPWORK * w, const int flng, const int m, const int n)
+{
+   int wsize;
+
+   wsize = (n > m + m) ? n : m + m;
+   wsize += wsize + 2;
+
+   w->flng = flng;
+   w->m = m;
+   w->n = n;
+   w->x = dgetmem(9 * flng + 2 * (m + 1) + wsize + THEQ_WORKSIZE(m));
+   w->y = w->x + flng;
+   w->cr = w->y + flng;
+   w->ci = w->cr + flng;
+   w->pr = w->ci + flng;
+   w->qr = w->pr + flng;
+   w->qi = w->qr + flng;
+   w->rr = w->qi + flng;
+   w->ri = w->rr + flng;
+   w->d = w->ri + flng;
+   w->b = w->d + (m + 1);
+   w->wk = w->b + (m + 1);
+   w->tq = w->wk + wsize;
+
+   return (0);
+}
+
+int free_MGCEPWORK(MGCEPWORK * w)
+{
+   free(w->x);
+   w->flng = 0;
+   w->m = 0;
+   w->n = 0;
+   w->x = w->y = w->d = NULL;
+   w->cr = w->ci = w->pr = w->qr = w->qi = w->rr = w->ri = w->b = NULL;
+   w->wk = w->tq = NULL;
+
+   return (0);
+}
+
+int mgcep_r(MGCEPWORK * w, double *xw, int flng, double *b, const int m,
+            const double a, const double g, const int n, const int itr1,
+            const int itr2, const double dd, const int etype, const double e,
+            const double f, const int itype)
 {
    int i, j, flag = 0;
-   static double *x = NULL, *y, *d;
-   static int size_x, size_c;
+   double *x, *y, *d;
    double ep, epo, eps = 0.0, min, max;
 
    if (etype == 1 && e < 0.0) {
@@ -199,25 +252,15 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
       eps = e;
    }
 
-   if (x == NULL) {
-      x = dgetmem(flng + flng);
-      y = x + flng;
-      size_x = flng;
-      d = dgetmem(m + 1);
-      size_c = m;
-   }
-   if (flng > size_x) {
-      free(x);
-      x = dgetmem(flng + flng);
-      y = x + flng;
-      size_x = flng;
-   }
-   if (m > size_c) {
-      free(d);
-      d = dgetmem(m + 1);
-      size_c = m;
+   if (flng > w->flng || m > w->m || n > w->n) {
+      fprintf(stderr, "mgcep : working area is too small!\n");
+      return 5;
    }
 
+   x = w->x;
+   y = w->y;
+   d = w->d;
+
    movem(xw, x, sizeof(*x), flng);
 
    switch (itype) {
@@ -275,7 +318,7 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
 
    /* initial value */
    fillz(b, sizeof(*b), m + 1);
-   ep = newton(x, flng, b, m, a, -1.0, n, 0, f);
+   ep = newton_r(w, x, flng, b, m, a, -1.0, n, 0, f);
 
    if (g != -1.0) {
       if (a != 0.0) {
@@ -285,7 +328,7 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
       } else
          movem(b, d, sizeof(*b), m + 1);
 
-      gc2gc(d, m, -1.0, b, m, g);       /*  K~, c~'r(m)  -> K~, c~'r'(m)  */
+      gc2gc_r(d, m, -1.0, b, m, g, w->wk); /* K~, c~'r(m) -> K~, c~'r'(m) */
 
       if (a != 0.0) {
          ignorm(b, b, m, g);    /*  K~, c~'r'(m) -> c~r(m)        */
@@ -298,7 +341,7 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
    if (g != -1.0) {
       for (j = 1; j <= itr2; j++) {
          epo = ep;
-         ep = newton(x, flng, b, m, a, g, n, j, f);
+         ep = newton_r(w, x, flng, b, m, a, g, n, j, f);
          if (ep == -1) {
              return 3;
          }
@@ -317,43 +360,43 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
       return (-1);
 }
 
-double newton(double *x, const int flng, double *c, const int m, const double a,
-              const double g, const int n, const int j, const double f)
+int mgcep(double *xw, int flng, double *b, const int m, const double a,
+          const double g, const int n, const int itr1, const int itr2,
+          const double dd, const int etype, const double e, const double f,
+          const int itype)
+{
+   static MGCEPWORK w;
+   int size_x, size_c, size_n;
+
+   if (w.x == NULL || flng > w.flng || m > w.m || n > w.n) {
+      size_x = (flng > w.flng) ? flng : w.flng;
+      size_c = (m > w.m) ? m : w.m;
+      size_n = (n > w.n) ? n : w.n;
+      if (w.x != NULL)
+         free_MGCEPWORK(&w);
+      alloc_MGCEPWORK(&w, size_x, size_c, size_n);
+   }
+
+   return (mgcep_r(&w, xw, flng, b, m, a, g, n, itr1, itr2, dd, etype, e, f,
+                   itype));
+}
+
+double newton_r(MGCEPWORK * w, double *x, const int flng, double *c,
+                const int m, const double a, const double g, const int n,
+                const int j, const double f)
 {
    int i, m2;
    double t = 0, s, tr, ti, trr, tii;
-   static double *cr = NULL, *ci, *pr, *qr, *qi, *rr, *ri, *b;
-   static int size_cr, size_b;
-
-   if (cr == NULL) {
-      cr = dgetmem(7 * flng);
-      ci = cr + flng;
-      pr = ci + flng;
-      qr = pr + flng;
-      qi = qr + flng;
-      rr = qi + flng;
-      ri = rr + flng;
-      size_cr = flng;
-
-      b = dgetmem(m + 1);
-      size_b = m;
-   }
-   if (flng > size_cr) {
-      free(cr);
-      cr = dgetmem(7 * flng);
-      ci = cr + flng;
-      pr = ci + flng;
-      qr = pr + flng;
-      qi = qr + flng;
-      rr = qi + flng;
-      ri = rr + flng;
-      size_cr = flng;
-   }
-   if (m > size_b) {
-      free(b);
-      b = dgetmem(m + 1);
-      size_b = m;
-   }
+   double *cr, *ci, *pr, *qr, *qi, *rr, *ri, *b;
+
+   cr = w->cr;
+   ci = w->ci;
+   pr = w->pr;
+   qr = w->qr;
+   qi = w->qi;
+   rr = w->rr;
+   ri = w->ri;
+   b = w->b;
 
    m2 = m + m;
 
@@ -361,7 +404,7 @@ double newton(double *x, const int flng, double *c, const int m, const double a,
    movem(&c[1], &cr[1], sizeof(*c), m);
 
    if (a != 0.0)
-      b2c(cr, m, cr, n, -a);
+      b2c_r(cr, m, cr, n, -a, w->wk);
 
    fftr(cr, ci, flng);          /* cr +j ci : FFT[c]  */
 
@@ -388,7 +431,7 @@ double newton(double *x, const int flng, double *c, const int m, const double a,
    ifftr(pr, ci, flng);
 
    if (a != 0.0)
-      b2c(pr, n, pr, m2, a);
+      b2c_r(pr, n, pr, m2, a, w->wk);
 
    if (g == 0.0 || g == -1.0) {
       movem(pr, qr, sizeof(*pr), m2 + 1);
@@ -398,8 +441,8 @@ double newton(double *x, const int flng, double *c, const int m, const double a,
       ifft(rr, ri, flng);
 
       if (a != 0.0) {
-         b2c(qr, n, qr, n, a);
-         b2c(rr, n, rr, m, a);
+         b2c_r(qr, n, qr, n, a, w->wk);
+         b2c_r(rr, n, rr, m, a, w->wk);
       }
    }
 
@@ -418,7 +461,7 @@ double newton(double *x, const int flng, double *c, const int m, const double a,
       for (i = 2; i <= m2; i++)
          qr[i] *= 1.0 + g;
 
-   if (theq(pr, &qr[2], &b[1], &rr[1], m, f)) {
+   if (theq_r(pr, &qr[2], &b[1], &rr[1], m, f, w->tq)) {
       fprintf(stderr, "mgcep : Error in theq() at %dth iteration!\n", j);
       return -1;
    }
@@ -432,3 +475,21 @@ double newton(double *x, const int flng, double *c, const int m, const double a,
 
    return (log(t));
 }
+
+double newton(double *x, const int flng, double *c, const int m, const double a,
+              const double g, const int n, const int j, const double f)
+{
+   static MGCEPWORK w;
+   int size_x, size_c, size_n;
+
+   if (w.x == NULL || flng > w.flng || m > w.m || n > w.n) {
+      size_x = (flng > w.flng) ? flng : w.flng;
+      size_c = (m > w.m) ? m : w.m;
+      size_n = (n > w.n) ? n : w.n;
+      if (w.x != NULL)
+         free_MGCEPWORK(&w);
+      alloc_MGCEPWORK(&w, size_x, size_c, size_n);
+   }
+
+   return (newton_r(&w, x, flng, c, m, a, g, n, j, f));
+}
@@ -0,0 +1,298 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/****************************************************************
+
+    $Id$
+
+    Streaming MLPG with bounded look-ahead
+
+        int alloc_MLPGSTREAM(s, window, dim, delay)
+        int free_MLPGSTREAM(s)
+        int reset_MLPGSTREAM(s)
+        int mlpgstream_push(s, mean, vari, out)
+        int mlpgstream_flush(s, out)
+
+        MLPGSTREAM  *s      : state
+        DELTAWINDOW *window : dynamic windows, kept by pointer
+        int         dim     : length of static feature vector
+        int         delay   : look-ahead in frames
+        double      *mean   : mean of one frame,
+                              [win_size * dim] as in vc()
+        double      *vari   : diagonal variance of the frame
+        double      *out    : generated static feature vector
+
+        return value of mlpgstream_push() and mlpgstream_flush() :
+                    1 -> out holds the next frame
+                    0 -> no frame is ready (push) or left (flush)
+
+        After frame t has been pushed, frame t - delay is generated
+        by solving the MLPG problem for frames 0, ..., t as if the
+        utterance ended at t.  The LDL factorization and the
+        forward substitution are carried over from push to push:
+        only the last 2 * win_max_width rows, which depend on the
+        provisional end, are redone, and the backward substitution
+        runs over delay frames.  mlpgstream_flush() emits the
+        remaining frames once the input has ended; they are exact,
+        so with delay not less than the number of frames the result
+        equals that of vc() without GV.  GV is not supported since
+        it needs the statistics of the whole utterance.
+
+*****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+/* inverse of variance, as HTS_finv() of hts_engine API */
+static double finv(const double x)
+{
+   if (x >= 1.0e+19)
+      return 0.0;
+   if (x <= -1.0e+19)
+      return 0.0;
+   if (x <= 1.0e-19 && x >= 0)
+      return 1.0e+38;
+   if (x >= -1.0e-19 && x < 0)
+      return -1.0e+38;
+
+   return (1.0 / x);
+}
+
+int alloc_MLPGSTREAM(MLPGSTREAM * s, const DELTAWINDOW * window,
+                     const int dim, const int delay)
+{
+   const int mw = (int) window->win_max_width;
+   const int k = (int) window->win_size;
+
+   if (dim <= 0 || delay < 0) {
+      fprintf(stderr, "mlpgstream : invalid dimension or delay!\n");
+      return (-1);
+   }
+
+   s->window = window;
+   s->dim = dim;
+   s->delay = delay;
+   s->width = 2 * mw + 1;
+   s->size = delay + 4 * mw + 2;
+   s->mean = dgetmem(s->size * (2 * k + s->width + 3) * dim);
+   s->ivar = s->mean + s->size * k * dim;
+   s->wuw = s->ivar + s->size * k * dim;
+   s->wum = s->wuw + s->size * s->width * dim;
+   s->g = s->wum + s->size * dim;
+   s->par = s->g + s->size * dim;
+
+   return (reset_MLPGSTREAM(s));
+}
+
+int free_MLPGSTREAM(MLPGSTREAM * s)
+{
+   free(s->mean);
+   s->mean = s->ivar = s->wuw = s->wum = s->g = s->par = NULL;
+   s->window = NULL;
+   s->dim = s->delay = s->width = s->size = 0;
+
+   return (0);
+}
+
+int reset_MLPGSTREAM(MLPGSTREAM * s)
+{
+   s->nin = s->nout = s->nfinal = 0;
+   s->flushed = FA;
+
+   return (0);
+}
+
+/* row t of W'U^{-1}W and W'U^{-1}M for an utterance of length frames,
+   then its LDL factorization and forward substitution */
+static void solve_row(MLPGSTREAM * s, const long t, const long length)
+{
+   const DELTAWINDOW *win = s->window;
+   const int dim = s->dim, W = s->width, size = s->size;
+   const int k = (int) win->win_size;
+   int i, j, m, shift, sh;
+   long tau;
+   double c, wu, *wuw, *wum, *g, *q, *iv, *mu;
+   Boolean not_bound;
+
+   wuw = &s->wuw[(t % size) * W * dim];
+   wum = &s->wum[(t % size) * dim];
+   g = &s->g[(t % size) * dim];
+
+   /* calc WUW & WUM */
+   for (m = 0; m < dim; m++)
+      wum[m] = 0.0;
+   for (i = 0; i < W * dim; i++)
+      wuw[i] = 0.0;
+
+   for (i = 0; i < k; i++)
+      for (shift = win->win_l_width[i]; shift <= win->win_r_width[i]; shift++)
+         if ((t + shift >= 0) && (t + shift < length)
+             && (win->win_coefficient[i][-shift] != 0.0)) {
+            tau = t + shift;
+
+            /* dynamic features whose window leaves the utterance get
+               zero precision */
+            not_bound = TR;
+            for (sh = win->win_l_width[i]; sh <= win->win_r_width[i]; sh++)
+               if (tau + sh < 0 || length <= tau + sh) {
+                  not_bound = FA;
+                  break;
+               }
+
+            iv = &s->ivar[((tau % size) * k + i) * dim];
+            mu = &s->mean[((tau % size) * k + i) * dim];
+            c = win->win_coefficient[i][-shift];
+            for (m = 0; m < dim; m++) {
+               wu = c * ((not_bound || i == 0) ? iv[m] : 0.0);
+               wum[m] += wu * mu[m];
+               for (j = 0; (j < W) && (t + j < length); j++)
+                  if ((j <= win->win_r_width[i] + shift)
+                      && (win->win_coefficient[i][j - shift] != 0.0))
+                     wuw[j * dim + m] += wu * win->win_coefficient[i][j - shift];
+            }
+         }
+
+   /* LDL factorization */
+   for (i = 1; (i < W) && (t >= i); i++) {
+      q = &s->wuw[((t - i) % size) * W * dim];
+      for (m = 0; m < dim; m++)
+         wuw[m] -= q[i * dim + m] * q[i * dim + m] * q[m];
+   }
+   for (i = 1; i < W; i++) {
+      for (j = 1; (i + j < W) && (t >= j); j++) {
+         q = &s->wuw[((t - j) % size) * W * dim];
+         for (m = 0; m < dim; m++)
+            wuw[i * dim + m] -= q[j * dim + m] * q[(i + j) * dim + m] * q[m];
+      }
+      for (m = 0; m < dim; m++)
+         wuw[i * dim + m] /= wuw[m];
+   }
+
+   /* forward substitution */
+   for (m = 0; m < dim; m++)
+      g[m] = wum[m];
+   for (i = 1; (i < W) && (t >= i); i++) {
+      q = &s->wuw[(((t - i) % size) * W + i) * dim];
+      for (m = 0; m < dim; m++)
+         g[m] -= q[m] * s->g[((t - i) % size) * dim + m];
+   }
+}
+
+/* backward substitution from the last frame down to frame first */
+static void backward(MLPGSTREAM * s, const long first)
+{
+   const int dim = s->dim, W = s->width, size = s->size;
+   int i, m;
+   long t;
+   double *p, *q, *g;
+
+   for (t = s->nin - 1; t >= first; t--) {
+      p = &s->par[(t % size) * dim];
+      q = &s->wuw[(t % size) * W * dim];
+      g = &s->g[(t % size) * dim];
+      for (m = 0; m < dim; m++)
+         p[m] = g[m] / q[m];
+      for (i = 1; (i < W) && (t + i < s->nin); i++)
+         for (m = 0; m < dim; m++)
+            p[m] -= q[i * dim + m] * s->par[((t + i) % size) * dim + m];
+   }
+}
+
+int mlpgstream_push(MLPGSTREAM * s, const double *mean, const double *vari,
+                    double *out)
+{
+   const int dim = s->dim, k = (int) s->window->win_size;
+   const int mw = (int) s->window->win_max_width;
+   int i;
+   long t, slot;
+
+   if (s->flushed) {
+      fprintf(stderr, "mlpgstream : push after flush, reset first!\n");
+      return (0);
+   }
+
+   slot = s->nin % s->size;
+   for (i = 0; i < k * dim; i++) {
+      s->mean[slot * k * dim + i] = mean[i];
+      s->ivar[slot * k * dim + i] = finv(vari[i]);
+   }
+   s->nin++;
+
+   /* rows up to nin - 1 - 2 * mw no longer depend on the end */
+   for (t = s->nfinal; t < s->nin; t++)
+      solve_row(s, t, s->nin);
+   if (s->nin - 2 * mw > s->nfinal)
+      s->nfinal = s->nin - 2 * mw;
+
+   if (s->nin - 1 - s->delay < s->nout)
+      return (0);
+
+   backward(s, s->nout);
+   movem(&s->par[(s->nout % s->size) * dim], out, sizeof(*out), dim);
+   s->nout++;
+
+   return (1);
+}
+
+int mlpgstream_flush(MLPGSTREAM * s, double *out)
+{
+   if (s->nout >= s->nin)
+      return (0);
+
+   /* the rows were solved for this end by the last push */
+   if (!s->flushed) {
+      backward(s, s->nout);
+      s->flushed = TR;
+   }
+   movem(&s->par[(s->nout % s->size) * s->dim], out, sizeof(*out), s->dim);
+   s->nout++;
+
+   return (1);
+}
@@ -0,0 +1,314 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/****************************************************************
+
+    $Id$
+
+    Lane-parallel MLSA, MGLSA and LMA Digital Filters
+
+        int mlsadf_lanes(x, b, m, a, pd, d, nlane)
+        int mglsadf_lanes(x, b, m, a, n, d, nlane)
+        int lmadf_lanes(x, c, m, pd, d, nlane)
+
+        double *x    : input of each stream, overwritten by
+                       the filtered data
+        double *b    : MLSA or MGLSA filter coefficients
+        double *c    : cepstrum
+        int    m     : order of cepstrum
+        double a     : all-pass constant
+        int    pd    : order of Pade approximation
+        int    n     : number of stages
+        double *d    : delay
+        int    nlane : number of streams, multiple of FILTER_LANES
+
+        return value : 0 on success, -1 if nlane is not a
+                       multiple of FILTER_LANES or pd is not
+                       in 0-7
+
+        One sample of nlane independent streams (e.g. utterances
+        synthesized in parallel) is filtered per call, each
+        stream in a SIMD lane.  The streams share m, a, pd and n
+        but have their own coefficients and delays, stored as
+        structure of arrays: element k of stream l is at
+        b[k * nlane + l] and likewise for c and d.  The delay
+        of each stream has the same length as that of the
+        scalar filter, i.e. d needs
+
+            mlsadf_lanes  : (3 * (pd + 1) + pd * (m + 2)) * nlane
+            mglsadf_lanes : n * (m + 1) * nlane
+            lmadf_lanes   : 2 * pd * (m + 1) * nlane
+
+        elements, cleared before the first call.  Each stream
+        gives the same output as mlsadf(), mglsadf() and
+        lmadf() bit for bit; AVX2 runs four streams per
+        instruction, SSE2 and NEON two.
+
+*****************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define LANES_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define LANES_NEON
+#include <arm_neon.h>
+#endif
+
+extern const double mlsadf_pade[];
+
+/* scalar kernels, one stream at a time */
+#define VW 1
+#define VEC double
+#define VLOAD(p) (*(p))
+#define VSTORE(p, v) (*(p) = (v))
+#define VSET1(s) (s)
+#define VZERO 0.0
+#define VADD(x, y) ((x) + (y))
+#define VSUB(x, y) ((x) - (y))
+#define VMUL(x, y) ((x) * (y))
+#define KNAME(name) name##_scalar
+#define KATTR
+#include "lanes_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+
+#if defined(LANES_X86)
+#define VW 2
+#define VEC __m128d
+#define VLOAD(p) _mm_loadu_pd(p)
+#define VSTORE(p, v) _mm_storeu_pd((p), (v))
+#define VSET1(s) _mm_set1_pd(s)
+#define VZERO _mm_setzero_pd()
+#define VADD(x, y) _mm_add_pd((x), (y))
+#define VSUB(x, y) _mm_sub_pd((x), (y))
+#define VMUL(x, y) _mm_mul_pd((x), (y))
+#define KNAME(name) name##_sse2
+#define KATTR TARGET_SSE2
+#include "lanes_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+
+#define VW 4
+#define VEC __m256d
+#define VLOAD(p) _mm256_loadu_pd(p)
+#define VSTORE(p, v) _mm256_storeu_pd((p), (v))
+#define VSET1(s) _mm256_set1_pd(s)
+#define VZERO _mm256_setzero_pd()
+#define VADD(x, y) _mm256_add_pd((x), (y))
+#define VSUB(x, y) _mm256_sub_pd((x), (y))
+#define VMUL(x, y) _mm256_mul_pd((x), (y))
+#define KNAME(name) name##_avx2
+#define KATTR TARGET_AVX2
+#include "lanes_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+#elif defined(LANES_NEON)
+#define VW 2
+#define VEC float64x2_t
+#define VLOAD(p) vld1q_f64(p)
+#define VSTORE(p, v) vst1q_f64((p), (v))
+#define VSET1(s) vdupq_n_f64(s)
+#define VZERO vdupq_n_f64(0.0)
+#define VADD(x, y) vaddq_f64((x), (y))
+#define VSUB(x, y) vsubq_f64((x), (y))
+#define VMUL(x, y) vmulq_f64((x), (y))
+#define KNAME(name) name##_neon
+#define KATTR
+#include "lanes_kernel.h"
+#undef VW
+#undef VEC
+#undef VLOAD
+#undef VSTORE
+#undef VSET1
+#undef VZERO
+#undef VADD
+#undef VSUB
+#undef VMUL
+#undef KNAME
+#undef KATTR
+#endif
+
+static int check_lanes(const char *name, const int nlane)
+{
+   if (nlane <= 0 || nlane % FILTER_LANES != 0) {
+      fprintf(stderr, "%s : number of lanes must be a multiple of %d!\n",
+              name, FILTER_LANES);
+      return (-1);
+   }
+   return (0);
+}
+
+static int check_pade(const char *name, const int pd)
+{
+   if (pd < 0 || pd > 7) {
+      fprintf(stderr, "%s : order of Pade approximation must be 0-7!\n",
+              name);
+      return (-1);
+   }
+   return (0);
+}
+
+int mlsadf_lanes(double *x, double *b, const int m, const double a,
+                 const int pd, double *d, const int nlane)
+{
+   const double *ppade;
+
+   if (check_lanes("mlsadf_lanes", nlane) != 0
+       || check_pade("mlsadf_lanes", pd) != 0)
+      return (-1);
+   ppade = &mlsadf_pade[pd * (pd + 1) / 2];
+
+#if defined(LANES_X86)
+   if (fftsimd_level() == SPTK_SIMD_AVX2) {
+      mlsadf_lanes_avx2(x, b, m, a, pd, d, nlane, ppade);
+      return (0);
+   }
+   if (fftsimd_level() == SPTK_SIMD_SSE2) {
+      mlsadf_lanes_sse2(x, b, m, a, pd, d, nlane, ppade);
+      return (0);
+   }
+#elif defined(LANES_NEON)
+   mlsadf_lanes_neon(x, b, m, a, pd, d, nlane, ppade);
+   return (0);
+#endif
+   mlsadf_lanes_scalar(x, b, m, a, pd, d, nlane, ppade);
+
+   return (0);
+}
+
+int mglsadf_lanes(double *x, double *b, const int m, const double a,
+                  const int n, double *d, const int nlane)
+{
+   if (check_lanes("mglsadf_lanes", nlane) != 0)
+      return (-1);
+
+#if defined(LANES_X86)
+   if (fftsimd_level() == SPTK_SIMD_AVX2) {
+      mglsadf_lanes_avx2(x, b, m, a, n, d, nlane);
+      return (0);
+   }
+   if (fftsimd_level() == SPTK_SIMD_SSE2) {
+      mglsadf_lanes_sse2(x, b, m, a, n, d, nlane);
+      return (0);
+   }
+#elif defined(LANES_NEON)
+   mglsadf_lanes_neon(x, b, m, a, n, d, nlane);
+   return (0);
+#endif
+   mglsadf_lanes_scalar(x, b, m, a, n, d, nlane);
+
+   return (0);
+}
+
+int lmadf_lanes(double *x, double *c, const int m, const int pd, double *d,
+                const int nlane)
+{
+   const double *ppade;
+
+   if (check_lanes("lmadf_lanes", nlane) != 0
+       || check_pade("lmadf_lanes", pd) != 0)
+      return (-1);
+   ppade = &mlsadf_pade[pd * (pd + 1) / 2];
+
+#if defined(LANES_X86)
+   if (fftsimd_level() == SPTK_SIMD_AVX2) {
+      lmadf_lanes_avx2(x, c, m, pd, d, nlane, ppade);
+      return (0);
+   }
+   if (fftsimd_level() == SPTK_SIMD_SSE2) {
+      lmadf_lanes_sse2(x, c, m, pd, d, nlane, ppade);
+      return (0);
+   }
+#elif defined(LANES_NEON)
+   lmadf_lanes_neon(x, c, m, pd, d, nlane, ppade);
+   return (0);
+#endif
+   lmadf_lanes_scalar(x, c, m, pd, d, nlane, ppade);
+
+   return (0);
+}
@@ -59,9 +59,27 @@
 
         return value : filtered data
 
+        int mlsadf_block(s, x, y, n, b0, b1)
+
+        MLSADFSTATE *s : filter state allocated by
+                         alloc_MLSADFSTATE(s, m, a, pd)
+        double *x      : input of n samples
+        double *y      : output of n samples (may be x)
+        int    n       : number of samples
+        double *b0     : MLSA filter coefficients at the first sample
+        double *b1     : MLSA filter coefficients after the last
+                         sample, b is interpolated linearly from b0
+                         to b1 sample by sample (NULL: b0 throughout)
+
+        x is multiplied by exp(b[0]) unless s->ngain is TR.  The
+        delay of s has the same layout as d of mlsadf(), and
+        reset_MLSADFSTATE() clears it.
+
 *****************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 
 #if defined(WIN32)
 #include "SPTK.h"
@@ -69,7 +87,9 @@
 #include <SPTK.h>
 #endif
 
-static double pade[] = { 1.0,
+/* Pade approximants of exp, the coefficients of order pd from
+   pd * (pd + 1) / 2; shared with _lanes.c and lmadf */
+const double mlsadf_pade[] = { 1.0,
    1.0, 0.0,
    1.0, 0.0, 0.0,
    1.0, 0.0, 0.0, 0.0,
@@ -79,12 +99,10 @@ static double pade[] = { 1.0,
    1.0, 0.499802889651314, 0.115274789205577, 0.015997611632083, 0.001452640362652, 0.000087007832645, 0.000003213962732, 0.000000057148619
 };
 
-static double *ppade;
-
 static double mlsafir(double x, double *b, const int m, const double a,
                       double *d)
 {
-   double y = 0.0, aa;
+   double y = 0.0, aa, prev, cur;
    int i;
 
    aa = 1 - a * a;
@@ -92,19 +110,21 @@ static double mlsafir(double x, double *b, const int m, const double a,
    d[0] = x;
    d[1] = aa * d[0] + a * d[1];
 
+   /* update d[i] and shift it to d[i+1] in one pass */
+   prev = d[1];
    for (i = 2; i <= m; i++) {
-      d[i] = d[i] + a * (d[i + 1] - d[i - 1]);
-      y += d[i] * b[i];
+      cur = d[i] + a * (d[i + 1] - prev);
+      y += cur * b[i];
+      d[i] = prev;
+      prev = cur;
    }
-
-   for (i = m + 1; i > 1; i--)
-      d[i] = d[i - 1];
+   d[m + 1] = prev;
 
    return (y);
 }
 
 static double mlsadf1(double x, double *b, const double a,
-                      const int pd, double *d)
+                      const int pd, double *d, const double *ppade)
 {
    double v, out = 0.0, *pt, aa;
    int i;
@@ -128,7 +148,7 @@ static double mlsadf1(double x, double *b, const double a,
 }
 
 static double mlsadf2(double x, double *b, const int m, const double a,
-                      const int pd, double *d)
+                      const int pd, double *d, const double *ppade)
 {
    double v, out = 0.0, *pt;
    int i;
@@ -152,14 +172,77 @@ static double mlsadf2(double x, double *b, const int m, const double a,
 double mlsadf(double x, double *b, const int m, const double a, const int pd,
               double *d)
 {
-   ppade = &pade[pd * (pd + 1) / 2];
+   const double *ppade = &mlsadf_pade[pd * (pd + 1) / 2];
 
-   x = mlsadf1(x, b, a, pd, d);
-   x = mlsadf2(x, b, m, a, pd, &d[2 * (pd + 1)]);
+   x = mlsadf1(x, b, a, pd, d, ppade);
+   x = mlsadf2(x, b, m, a, pd, &d[2 * (pd + 1)], ppade);
 
    return (x);
 }
 
+int alloc_MLSADFSTATE(MLSADFSTATE * s, const int m, const double a,
+                      const int pd)
+{
+   if (pd < 0 || pd > 7) {
+      fprintf(stderr, "mlsadf : order of Pade approximation must be 0-7!\n");
+      return (-1);
+   }
+
+   s->m = m;
+   s->a = a;
+   s->pd = pd;
+   s->ngain = FA;
+   s->d = dgetmem(3 * (pd + 1) + pd * (m + 2) + 2 * (m + 1));
+   s->b = s->d + 3 * (pd + 1) + pd * (m + 2);
+   s->inc = s->b + m + 1;
+
+   return (0);
+}
+
+int free_MLSADFSTATE(MLSADFSTATE * s)
+{
+   free(s->d);
+   s->m = s->pd = 0;
+   s->a = 0.0;
+   s->d = s->b = s->inc = NULL;
+
+   return (0);
+}
+
+int reset_MLSADFSTATE(MLSADFSTATE * s)
+{
+   fillz(s->d, sizeof(*s->d), 3 * (s->pd + 1) + s->pd * (s->m + 2));
+
+   return (0);
+}
+
+int mlsadf_block(MLSADFSTATE * s, const double *x, double *y, const int n,
+                 const double *b0, const double *b1)
+{
+   int i, k;
+   const int m = s->m, pd = s->pd;
+   const double a = s->a, *ppade = &mlsadf_pade[pd * (pd + 1) / 2];
+   double *b = s->b, *inc = s->inc, *d = s->d, *d2, v;
+
+   d2 = &d[2 * (pd + 1)];
+
+   for (k = 0; k <= m; k++) {
+      b[k] = b0[k];
+      inc[k] = (b1 != NULL) ? (b1[k] - b0[k]) / (double) n : 0.0;
+   }
+
+   for (i = 0; i < n; i++) {
+      v = (s->ngain) ? x[i] : x[i] * exp(b[0]);
+      v = mlsadf1(v, b, a, pd, d, ppade);
+      y[i] = mlsadf2(v, b, m, a, pd, d2, ppade);
+
+      for (k = 0; k <= m; k++)
+         b[k] += inc[k];
+   }
+
+   return (0);
+}
+
 
 static double mlsafirt(double x, double *b, const int m, const double a,
                        double *d)
@@ -181,7 +264,7 @@ static double mlsafirt(double x, double *b, const int m, const double a,
 }
 
 static double mlsadf2t(double x, double *b, const int m, const double a,
-                       const int pd, double *d)
+                       const int pd, double *d, const double *ppade)
 {
    double v, out = 0.0, *pt;
    int i;
@@ -205,10 +288,10 @@ static double mlsadf2t(double x, double *b, const int m, const double a,
 double mlsadft(double x, double *b, const int m, const double a, const int pd,
                double *d)
 {
-   ppade = &pade[pd * (pd + 1) / 2];
+   const double *ppade = &mlsadf_pade[pd * (pd + 1) / 2];
 
-   x = mlsadf1(x, b, a, pd, d);
-   x = mlsadf2t(x, b, m, a, pd, &d[2 * (pd + 1)]);
+   x = mlsadf1(x, b, a, pd, d, ppade);
+   x = mlsadf2t(x, b, m, a, pd, &d[2 * (pd + 1)], ppade);
 
    return (x);
 }
@@ -0,0 +1,160 @@
+/*--------------------------------------------------------------------------*/
+/*  Lane-parallel kernels of mlsadf, mglsadf and lmadf (see _lanes.c)       */
+/*                                                                          */
+/*  This file is included once per instruction set with the macros          */
+/*    VW                  : number of lanes in a vector                     */
+/*    VEC                 : vector type                                     */
+/*    VLOAD, VSTORE       : unaligned load and store                        */
+/*    VSET1, VZERO        : broadcast and zero                              */
+/*    VADD, VSUB, VMUL    : arithmetic                                      */
+/*    KNAME(name)         : name of the kernel for this instruction set     */
+/*    KATTR               : function attributes                             */
+/*  Element e of lane l of a delay or coefficient vector is at e * L + l.   */
+/*--------------------------------------------------------------------------*/
+
+KATTR static void KNAME(mlsadf_lanes) (double *x, const double *b,
+                                       const int m, const double a,
+                                       const int pd, double *d, const int L,
+                                       const double *ppade) {
+   int g, i, k;
+   double *dg, *d2, *df, *pt;
+   VEC va, vaa, vx, out, v, b1, in, prev, cur, y;
+
+   va = VSET1(a);
+   vaa = VSET1(1 - a * a);
+
+   for (g = 0; g < L; g += VW) {
+      vx = VLOAD(x + g);
+      b1 = VLOAD(b + L + g);
+      dg = d + g;
+
+      /* mlsadf1 */
+      pt = dg + (pd + 1) * L;
+      out = VZERO;
+      for (i = pd; i >= 1; i--) {
+         v = VADD(VMUL(vaa, VLOAD(pt + (i - 1) * L)),
+                  VMUL(va, VLOAD(dg + i * L)));
+         VSTORE(dg + i * L, v);
+         v = VMUL(v, b1);
+         VSTORE(pt + i * L, v);
+         v = VMUL(v, VSET1(ppade[i]));
+         vx = (1 & i) ? VADD(vx, v) : VSUB(vx, v);
+         out = VADD(out, v);
+      }
+      VSTORE(pt, vx);
+      vx = VADD(out, vx);
+
+      /* mlsadf2 */
+      d2 = dg + 2 * (pd + 1) * L;
+      pt = d2 + pd * (m + 2) * L;
+      out = VZERO;
+      for (i = pd; i >= 1; i--) {
+         df = d2 + (i - 1) * (m + 2) * L;
+
+         /* mlsafir */
+         in = VLOAD(pt + (i - 1) * L);
+         VSTORE(df, in);
+         prev = VADD(VMUL(vaa, in), VMUL(va, VLOAD(df + L)));
+         VSTORE(df + L, prev);
+         y = VZERO;
+         for (k = 2; k <= m; k++) {
+            cur = VADD(VLOAD(df + k * L),
+                       VMUL(va, VSUB(VLOAD(df + (k + 1) * L), prev)));
+            y = VADD(y, VMUL(cur, VLOAD(b + k * L + g)));
+            VSTORE(df + k * L, prev);
+            prev = cur;
+         }
+         VSTORE(df + (m + 1) * L, prev);
+
+         VSTORE(pt + i * L, y);
+         v = VMUL(y, VSET1(ppade[i]));
+         vx = (1 & i) ? VADD(vx, v) : VSUB(vx, v);
+         out = VADD(out, v);
+      }
+      VSTORE(pt, vx);
+      VSTORE(x + g, VADD(out, vx));
+   }
+}
+
+KATTR static void KNAME(mglsadf_lanes) (double *x, const double *b,
+                                        const int m, const double a,
+                                        const int n, double *d, const int L) {
+   int g, i, k;
+   double *df;
+   VEC va, vaa, vx, d0, prev, cur, y;
+
+   va = VSET1(a);
+   vaa = VSET1(1 - a * a);
+
+   for (g = 0; g < L; g += VW) {
+      vx = VLOAD(x + g);
+
+      for (i = 0; i < n; i++) {
+         df = d + i * (m + 1) * L + g;
+
+         /* mglsadff */
+         d0 = prev = VLOAD(df);
+         y = VMUL(d0, VLOAD(b + L + g));
+         for (k = 1; k < m; k++) {
+            cur = VADD(VLOAD(df + k * L),
+                       VMUL(va, VSUB(VLOAD(df + (k + 1) * L), prev)));
+            y = VADD(y, VMUL(cur, VLOAD(b + (k + 1) * L + g)));
+            VSTORE(df + k * L, prev);
+            prev = cur;
+         }
+         VSTORE(df + m * L, prev);
+         vx = VSUB(vx, y);
+         VSTORE(df, VADD(VMUL(va, d0), VMUL(vaa, vx)));
+      }
+
+      VSTORE(x + g, vx);
+   }
+}
+
+/* one cascade of lmadf1() with the FIR of orders m1 to m2 */
+KATTR static VEC KNAME(lmadf1_lanes) (VEC vx, const double *c, const int m,
+                                      double *d, const int pd, const int m1,
+                                      const int m2, const int L,
+                                      const double *ppade) {
+   int i, k;
+   double *pt, *df;
+   VEC t, y;
+
+   pt = d + pd * m * L;
+   y = VZERO;
+   for (i = pd; i >= 1; i--) {
+      df = d + (i - 1) * m * L;
+
+      /* lmafir, d[m2..m-1] are never read and are not shifted */
+      for (k = m2 - 1; k >= 1; k--)
+         VSTORE(df + k * L, VLOAD(df + (k - 1) * L));
+      VSTORE(df, VLOAD(pt + (i - 1) * L));
+      t = VZERO;
+      for (k = m1; k <= m2; k++)
+         t = VADD(t, VMUL(VLOAD(c + k * L), VLOAD(df + (k - 1) * L)));
+
+      if (i < pd)
+         VSTORE(pt + i * L, t);
+      t = VMUL(t, VSET1(ppade[i]));
+      y = (i == pd) ? t : VADD(y, t);
+      vx = (1 & i) ? VADD(vx, t) : VSUB(vx, t);
+   }
+   VSTORE(pt, vx);
+
+   return (VADD(y, vx));
+}
+
+KATTR static void KNAME(lmadf_lanes) (double *x, const double *c,
+                                      const int m, const int pd, double *d,
+                                      const int L, const double *ppade) {
+   int g;
+   VEC vx;
+
+   for (g = 0; g < L; g += VW) {
+      vx = VLOAD(x + g);
+      vx = KNAME(lmadf1_lanes) (vx, c + g, m, d + g, pd, 1, 1, L, ppade);
+      vx = KNAME(lmadf1_lanes) (vx, c + g, m, d + (m + 1) * pd * L + g, pd,
+                                2, m, L, ppade);
+      VSTORE(x + g, vx);
+   }
+}
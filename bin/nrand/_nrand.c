@@ -52,6 +52,13 @@
         int    leng   :  length
         int    seed   :  seed of random value
 
+    Reentrant Normal Random Value
+        x = nrandom_r(next, sw, r)
+
+        unsigned long *next : state of the uniform generator
+        int    *sw    :  0 before the first call
+        double *r     :  second value of the current pair
+
 ****************************************************************/
 
 #include <stdio.h>
@@ -89,13 +96,12 @@ int nrand(double *p, const int leng, const int seed)
    return (0);
 }
 
-double nrandom(unsigned long *next)
+double nrandom_r(unsigned long *next, int *sw, double *r)
 {
-   static int sw = 0;
-   static double r1, r2, s;
+   double r1, r2, s;
 
-   if (sw == 0) {
-      sw = 1;
+   if (*sw == 0) {
+      *sw = 1;
       do {
          r1 = 2 * rnd(next) - 1;
          r2 = 2 * rnd(next) - 1;
@@ -103,13 +109,22 @@ double nrandom(unsigned long *next)
       }
       while (s > 1 || s == 0);
       s = sqrt(-2 * log(s) / s);
+      *r = r2 * s;
       return (r1 * s);
    } else {
-      sw = 0;
-      return (r2 * s);
+      *sw = 0;
+      return (*r);
    }
 }
 
+double nrandom(unsigned long *next)
+{
+   static int sw = 0;
+   static double r;
+
+   return (nrandom_r(next, &sw, &r));
+}
+
 unsigned long srnd(const unsigned int seed)
 {
    return (seed);
@@ -88,23 +88,26 @@ int	    debug_level = 0;
 static int check_f0_params(F0_params *par, double sample_freq);
 static void get_cand(Cross* cross, float *peak,int *loc,int nlags,int *ncand,
        float cand_thresh);
-static int downsamp(float *in, float *out, int samples, int *outsamps,
-       int state_idx, int decimate, int ncoef, float *fc, int init);
-static void do_ffir(register float *buf, register int in_samps,
+static int downsamp(RAPT_STATE *s, float *in, float *out, int samples,
+       int *outsamps, int state_idx, int decimate, int ncoef, float *fc,
+       int init);
+static void do_ffir(RAPT_STATE *s, register float *buf, register int in_samps,
        register float *bufo, register int *out_samps, int idx,
        register int ncoef, float *fc, register int invert, register int skip,
        register int init);
 static int lc_lin_fir(register float fc, int *nf, float *coef);
 static void peak(float *y, float *xp, float *yp);
 
-static Stat* get_stationarity(float *fdata, double freq, int buff_size,
-       int  nframes, int frame_step, int first_time);
-static int save_windstat(float *rho, int order, float err, float rms);
-static int retrieve_windstat(float *rho, int order, float *err, float *rms);
-static float get_similarity(int order, int size, float *pdata, float *cdata,
-       float *rmsa, float *rms_ratio, float pre, float stab, int w_type,
-       int init);
-static void free_dp_f0(void);
+static Stat* get_stationarity(RAPT_STATE *s, float *fdata, double freq,
+       int buff_size, int nframes, int frame_step, int first_time);
+static int save_windstat(RAPT_STATE *s, float *rho, int order, float err,
+       float rms);
+static int retrieve_windstat(RAPT_STATE *s, float *rho, int order, float *err,
+       float *rms);
+static float get_similarity(RAPT_STATE *s, int order, int size, float *pdata,
+       float *cdata, float *rmsa, float *rms_ratio, float pre, float stab,
+       int w_type, int init);
+static void free_dp_f0(RAPT_STATE *s);
 
 
 /*
@@ -141,7 +144,8 @@ check_f0_params(F0_params *par, double sample_freq)
 void get_fast_cands(float *fdata, float *fdsdata, int ind, int step, int size,
                     int dec, int start, int nlags, float *engref, int *maxloc,
                     float *maxval, Cross *cp, float *peaks, int *locs,
-                    int *ncand, F0_params *par)
+                    int *ncand, F0_params *par,
+                    Sigproc_work *w)
 {
   int decind, decstart, decnlags, decsize, i, j, *lp;
   float *corp, xp, yp, lag_wt;
@@ -155,7 +159,7 @@ void get_fast_cands(float *fdata, float *fdsdata, int ind, int step, int size,
   corp = cp->correl;
 
   crossf(fdsdata + decind, decsize, decstart, decnlags, engref, maxloc,
-	maxval, corp);
+	maxval, corp, w);
   cp->maxloc = *maxloc;	/* location of maximum in correlation */
   cp->maxval = *maxval;	/* max. correlation value (found at maxloc) */
   cp->rms = (float) sqrt(*engref/size); /* rms in reference window */
@@ -191,7 +195,7 @@ void get_fast_cands(float *fdata, float *fdsdata, int ind, int step, int size,
     *ncand = par->n_cands-1;  /* leave room for the unvoiced hypothesis */
   }
   crossfi(fdata + (ind * step), size, start, nlags, 7, engref, maxloc,
-	  maxval, corp, locs, *ncand);
+	  maxval, corp, locs, *ncand, w);
 
   cp->maxloc = *maxloc;	/* location of maximum in correlation */
   cp->maxval = *maxval;	/* max. correlation value (found at maxloc) */
@@ -220,13 +224,10 @@ void get_fast_cands(float *fdata, float *fdsdata, int ind, int step, int size,
 }
 
 /* ----------------------------------------------------------------------- */
-float *downsample(float *input, int samsin, int state_idx, double freq,
+float *downsample(RAPT_STATE *s, float *input, int samsin, int state_idx, double freq,
                   int *samsout, int decimate, int first_time, int last_time)
 {
-  static float	b[2048];
-  static float *foutput = NULL;
   float	beta = 0.0f;
-  static int	ncoeff = 127, ncoefft = 0;
   int init;
 
   if(input && (samsin > 0) && (decimate > 0) && *samsout) {
@@ -235,29 +236,29 @@ float *downsample(float *input, int samsin, int state_idx, double freq,
     }
 
     if(first_time){
-      int nbuff = (samsin/decimate) + (2*ncoeff);
+      int nbuff = (samsin/decimate) + (2*s->ncoeff);
 
-      ncoeff = ((int)(freq * .005)) | 1;
+      s->ncoeff = ((int)(freq * .005)) | 1;
       beta = .5f/decimate;
-      foutput =
-          (float *) realloc((void *) foutput, sizeof(float) * nbuff);
+      s->foutput =
+          (float *) realloc((void *) s->foutput, sizeof(float) * nbuff);
       for( ; nbuff > 0 ;)
-	foutput[--nbuff] = 0.0;
+	s->foutput[--nbuff] = 0.0;
 
-      if( !lc_lin_fir(beta,&ncoeff,b)) {
+      if( !lc_lin_fir(beta,&s->ncoeff,s->ds_b)) {
 	fprintf(stderr,"\nProblems computing interpolation filter\n");
-	free((void *) foutput);
+	free((void *) s->foutput);
 	return(NULL);
       }
-      ncoefft = (ncoeff/2) + 1;
+      s->ncoefft = (s->ncoeff/2) + 1;
     }		    /*  endif new coefficients need to be computed */
 
     if(first_time) init = 1;
     else if (last_time) init = 2;
     else init = 0;
 
-    if(downsamp(input,foutput,samsin,samsout,state_idx,decimate,ncoefft,b,init)) {
-      return(foutput);
+    if(downsamp(s,input,s->foutput,samsin,samsout,state_idx,decimate,s->ncoefft,s->ds_b,init)) {
+      return(s->foutput);
     } else
       Fprintf(stderr,"Problems in downsamp() in downsample()\n");
   }
@@ -309,14 +310,15 @@ static void get_cand(Cross *cross, float *peak, int *loc, int nlags, int *ncand,
 /* ----------------------------------------------------------------------- */
 /* buffer-to-buffer downsample operation */
 /* This is STRICTLY a decimator! (no upsample) */
-static int downsamp(in, out, samples, outsamps, state_idx, decimate, ncoef, fc, init)
+static int downsamp(s, in, out, samples, outsamps, state_idx, decimate, ncoef, fc, init)
+     RAPT_STATE *s;
      float *in, *out;
      int samples, *outsamps, decimate, ncoef, state_idx;
      float fc[];
      int init;
 {
   if(in && out) {
-    do_ffir(in, samples, out, outsamps, state_idx, ncoef, fc, 0, decimate, init);
+    do_ffir(s, in, samples, out, outsamps, state_idx, ncoef, fc, 0, decimate, init);
     return(TRUE);
   } else
     printf("Bad signal(s) passed to downsamp()\n");
@@ -324,43 +326,41 @@ static int downsamp(in, out, samples, outsamps, state_idx, decimate, ncoef, fc,
 }
 
 /*      ----------------------------------------------------------      */
-static void do_ffir(buf,in_samps,bufo,out_samps,idx, ncoef,fc,invert,skip,init)
+static void do_ffir(s,buf,in_samps,bufo,out_samps,idx, ncoef,fc,invert,skip,init)
 /* fc contains 1/2 the coefficients of a symmetric FIR filter with unity
     passband gain.  This filter is convolved with the signal in buf.
     The output is placed in buf2.  If(invert), the filter magnitude
     response will be inverted.  If(init&1), beginning of signal is in buf;
     if(init&2), end of signal is in buf.  out_samps is set to the number of
     output points placed in bufo. */
+RAPT_STATE *s;
 register float	*buf, *bufo;
 float *fc;
 register int in_samps, ncoef, invert, skip, init, *out_samps;
 int idx;
 {
   register float *dp1, *dp2, *dp3, sum, integral;
-  static float *co=NULL, *mem=NULL;
-  static float state[1000];
-  static int fsize=0, resid=0;
   register int i, j, k, l;
   register float *sp;
   register float *buf1;
 
   buf1 = buf;
-  if(ncoef > fsize) {/*allocate memory for full coeff. array and filter memory */    fsize = 0;
+  if(ncoef > s->ffir_fsize) {/*allocate memory for full coeff. array and filter memory */    s->ffir_fsize = 0;
     i = (ncoef+1)*2;
-    if (!((co = (float *) realloc((void *) co, sizeof(float) * i))
-       && (mem = (float *) realloc((void *) mem, sizeof(float) * i)))) {
+    if (!((s->ffir_co = (float *) realloc((void *) s->ffir_co, sizeof(float) * i))
+       && (s->ffir_mem = (float *) realloc((void *) s->ffir_mem, sizeof(float) * i)))) {
       fprintf(stderr,"allocation problems in do_fir()\n");
       return;
     }
-    fsize = ncoef;
+    s->ffir_fsize = ncoef;
   }
 
   /* fill 2nd half with data */
-  for(i=ncoef, dp1=mem+ncoef-1; i-- > 0; )  *dp1++ = *buf++;
+  for(i=ncoef, dp1=s->ffir_mem+ncoef-1; i-- > 0; )  *dp1++ = *buf++;
 
   if(init & 1) {	/* Is the beginning of the signal in buf? */
     /* Copy the half-filter and its mirror image into the coefficient array. */
-    for(i=ncoef-1, dp3=fc+ncoef-1, dp2=co, dp1 = co+((ncoef-1)*2),
+    for(i=ncoef-1, dp3=fc+ncoef-1, dp2=s->ffir_co, dp1 = s->ffir_co+((ncoef-1)*2),
 	integral = 0.0; i-- > 0; )
       if(!invert) *dp1-- = *dp2++ = *dp3--;
       else {
@@ -374,13 +374,13 @@ int idx;
       *dp1 = integral - *dp3;
     }
 
-    for(i=ncoef-1, dp1=mem; i-- > 0; ) *dp1++ = 0;
+    for(i=ncoef-1, dp1=s->ffir_mem; i-- > 0; ) *dp1++ = 0;
   }
   else
-    for(i=ncoef-1, dp1=mem, sp=state; i-- > 0; ) *dp1++ = *sp++;
+    for(i=ncoef-1, dp1=s->ffir_mem, sp=s->ffir_state; i-- > 0; ) *dp1++ = *sp++;
 
   i = in_samps;
-  resid = 0;
+  s->ffir_resid = 0;
 
   k = (ncoef << 1) -1;	/* inner-product loop limit */
 
@@ -389,7 +389,7 @@ int idx;
   else {			/* skip points (e.g. for downsampling) */
     /* the buffer end is padded with (ncoef-1) data points */
     for( l=0 ; l < *out_samps; l++ ) {
-      for(j=k-skip, dp1=mem, dp2=co, dp3=mem+skip, sum=0.0; j-- >0;
+      for(j=k-skip, dp1=s->ffir_mem, dp2=s->ffir_co, dp3=s->ffir_mem+skip, sum=0.0; j-- >0;
 	  *dp1++ = *dp3++)
 	sum += *dp2++ * *dp1;
       for(j=skip; j-- >0; *dp1++ = *buf++) /* new data to memory */
@@ -397,9 +397,9 @@ int idx;
       *bufo++ = (sum<0.0) ? sum -0.5f : sum +0.5f;
     }
     if(init & 2){
-      resid = in_samps - *out_samps * skip;
-      for(l=resid/skip; l-- >0; ){
-	for(j=k-skip, dp1=mem, dp2=co, dp3=mem+skip, sum=0.0; j-- >0;
+      s->ffir_resid = in_samps - *out_samps * skip;
+      for(l=s->ffir_resid/skip; l-- >0; ){
+	for(j=k-skip, dp1=s->ffir_mem, dp2=s->ffir_co, dp3=s->ffir_mem+skip, sum=0.0; j-- >0;
 	    *dp1++ = *dp3++)
 	    sum += *dp2++ * *dp1;
 	for(j=skip; j-- >0; *dp1++ = 0.0)
@@ -409,7 +409,7 @@ int idx;
       }
     }
     else
-      for(dp3=buf1+idx-ncoef+1, l=ncoef-1, sp=state; l-- >0; ) *sp++ = *dp3++;
+      for(dp3=buf1+idx-ncoef+1, l=ncoef-1, sp=s->ffir_state; l-- >0; ) *sp++ = *dp3++;
   }
 }
 
@@ -522,37 +522,9 @@ static void peak(float *y, float *xp, float *yp)
 #define STAT_WSIZE 0.030
 #define STAT_AINT 0.020
 
-/*
- * headF points to current frame in the circular buffer,
- * tailF points to the frame where tracks start
- * cmpthF points to starting frame of converged path to backtrack
- */
-
-static Frame *headF = NULL, *tailF = NULL, *cmpthF = NULL;
-
-static  int *pcands = NULL;	/* array for backtracking in convergence check */
-static int cir_buff_growth_count = 0;
-
-static int size_cir_buffer,	/* # of frames in circular DP buffer */
-           size_frame_hist,	/* # of frames required before convergence test */
-           size_frame_out,	/* # of frames before forcing output */
-           num_active_frames,	/* # of frames from tailF to headF */
-           output_buf_size;	/* # of frames allocated to output buffers */
-
-/*
- * DP parameters
- */
-static float tcost, tfact_a, tfact_s, frame_int, vbias, fdouble, wdur, ln2,
-             freqwt, lagwt;
-static int step, size, nlags, start, stop, ncomp, *locs = NULL;
-static short maxpeaks;
-
-static int wReuse = 0;  /* number of windows seen before resued */
-static Windstat *windstat = NULL;
-
-static float *f0p = NULL, *vuvp = NULL, *rms_speech = NULL,
-             *acpkp = NULL, *peaks = NULL;
-static int first_time = 1, pad;
+/* The state of the tracker, which used to live in file-scope statics,
+   is kept in a RAPT_STATE (see jkGetF0.h), so that any number of
+   trackers can run at once, each in one thread at a time. */
 
 
 /*--------------------------------------------------------------------*/
@@ -566,7 +538,7 @@ int get_Nframes(long buffsize, int pad, int step)
 
 
 /*--------------------------------------------------------------------*/
-int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep)
+int init_dp_f0(RAPT_STATE *s, double freq, F0_params *par, long *buffsize, long *sdstep)
 {
   int nframes;
   int i;
@@ -576,26 +548,26 @@ int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep)
  * reassigning some constants
  */
 
-  tcost = par->trans_cost;
-  tfact_a = par->trans_amp;
-  tfact_s = par->trans_spec;
-  vbias = par->voice_bias;
-  fdouble = par->double_cost;
-  frame_int = par->frame_step;
-
-  step = eround(frame_int * freq);
-  size = eround(par->wind_dur * freq);
-  frame_int = (float)(((float)step)/freq);
-  wdur = (float)(((float)size)/freq);
-  start = eround(freq / par->max_f0);
-  stop = eround(freq / par->min_f0);
-  nlags = stop - start + 1;
-  ncomp = size + stop + 1; /* # of samples required by xcorr
+  s->tcost = par->trans_cost;
+  s->tfact_a = par->trans_amp;
+  s->tfact_s = par->trans_spec;
+  s->vbias = par->voice_bias;
+  s->fdouble = par->double_cost;
+  s->frame_int = par->frame_step;
+
+  s->step = eround(s->frame_int * freq);
+  s->size = eround(par->wind_dur * freq);
+  s->frame_int = (float)(((float)s->step)/freq);
+  s->wdur = (float)(((float)s->size)/freq);
+  s->start = eround(freq / par->max_f0);
+  s->stop = eround(freq / par->min_f0);
+  s->nlags = s->stop - s->start + 1;
+  s->ncomp = s->size + s->stop + 1; /* # of samples required by xcorr
 			      comp. per fr. */
-  maxpeaks = 2 + (nlags/2);	/* maximum number of "peaks" findable in ccf */
-  ln2 = (float)log(2.0);
-  size_frame_hist = (int) (DP_HIST / frame_int);
-  size_frame_out = (int) (DP_LIMIT / frame_int);
+  s->maxpeaks = 2 + (s->nlags/2);	/* maximum number of "peaks" findable in ccf */
+  s->ln2 = (float)log(2.0);
+  s->size_frame_hist = (int) (DP_HIST / s->frame_int);
+  s->size_frame_out = (int) (DP_LIMIT / s->frame_int);
 
 /*
  * SET UP THE D.P. WEIGHTING FACTORS:
@@ -604,14 +576,14 @@ int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep)
  */
 
   /* Lag-dependent weighting factor to emphasize early peaks (higher freqs)*/
-  lagwt = par->lag_weight/stop;
+  s->lagwt = par->lag_weight/s->stop;
 
   /* Penalty for a frequency skip in F0 per frame */
-  freqwt = par->freq_weight/frame_int;
+  s->freqwt = par->freq_weight/s->frame_int;
 
   i = (int) (READ_SIZE *freq);
-  if(ncomp >= step) nframes = ((i-ncomp)/step ) + 1;
-  else nframes = i / step;
+  if(s->ncomp >= s->step) nframes = ((i-s->ncomp)/s->step ) + 1;
+  else nframes = i / s->step;
 
   /* *buffsize is the number of samples needed to make F0 computation
      of nframes DP frames possible.  The last DP frame is patched with
@@ -640,55 +612,69 @@ int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep)
   agap = (int) (STAT_AINT * freq);
   ind = ( agap - stat_wsize ) / 2;
   i = stat_wsize + ind;
-  pad = downpatch + ((i>ncomp) ? i:ncomp);
-  *buffsize = nframes * step + pad;
-  *sdstep = nframes * step;
+  s->pad = downpatch + ((i>s->ncomp) ? i:s->ncomp);
+
+  /* With a latency set for streaming, what the pad leaves of it is split
+     between one input block (a third) and the DP history (the rest), and
+     output is forced once that many frames wait; see rapt_latency(). */
+  if (s->latency > 0.0) {
+    int avail = ((int) (s->latency * freq) - s->pad - 1) / s->step;
+
+    if (avail / 3 < nframes)
+      nframes = (avail / 3 < 1) ? 1 : avail / 3;
+    if (avail - nframes + 1 < s->size_frame_out)
+      s->size_frame_out = (avail - nframes < 0) ? 1 : avail - nframes + 1;
+    if (s->size_frame_hist > s->size_frame_out / 2)
+      s->size_frame_hist = (s->size_frame_out < 2) ? 1 : s->size_frame_out / 2;
+  }
+  *buffsize = nframes * s->step + s->pad;
+  *sdstep = nframes * s->step;
 
   /* Allocate space for the DP storage circularly linked data structure */
 
-  size_cir_buffer = (int) (DP_CIRCULAR / frame_int);
+  s->size_cir_buffer = (int) (DP_CIRCULAR / s->frame_int);
 
   /* creating circularly linked data structures */
-  tailF = alloc_frame(nlags, par->n_cands);
-  headF = tailF;
+  s->tailF = alloc_frame(s->nlags, par->n_cands);
+  s->headF = s->tailF;
 
   /* link them up */
-  for(i=1; i<size_cir_buffer; i++){
-    headF->next = alloc_frame(nlags, par->n_cands);
-    headF->next->prev = headF;
-    headF = headF->next;
+  for(i=1; i<s->size_cir_buffer; i++){
+    s->headF->next = alloc_frame(s->nlags, par->n_cands);
+    s->headF->next->prev = s->headF;
+    s->headF = s->headF->next;
   }
-  headF->next = tailF;
-  tailF->prev = headF;
+  s->headF->next = s->tailF;
+  s->tailF->prev = s->headF;
 
-  headF = tailF;
+  s->headF = s->tailF;
 
   /* Allocate sscratch array to use during backtrack convergence test. */
-  if( ! pcands ) {
-    pcands = (int *) malloc(par->n_cands * sizeof(int));
+  if( ! s->pcands ) {
+    s->pcands = (int *) malloc(par->n_cands * sizeof(int));
   }
 
   /* Allocate arrays to return F0 and related signals. */
 
   /* Note: remember to compare *vecsize with size_frame_out, because
      size_cir_buffer is not constant */
-  output_buf_size = size_cir_buffer;
-    rms_speech = (float *) fgetmem(output_buf_size);
-    f0p = (float *) fgetmem(output_buf_size);
-    vuvp = (float *) fgetmem(output_buf_size);
-    acpkp = (float *) fgetmem(output_buf_size);
+  s->output_buf_size = s->size_cir_buffer;
+    s->rms_speech = (float *) fgetmem(s->output_buf_size);
+    s->f0p = (float *) fgetmem(s->output_buf_size);
+    s->vuvp = (float *) fgetmem(s->output_buf_size);
+    s->acpkp = (float *) fgetmem(s->output_buf_size);
 
     /* Allocate space for peak location and amplitude scratch arrays. */
-    peaks = (float *) fgetmem(maxpeaks);
-    locs = (int *) malloc(sizeof(int) * maxpeaks);
+    s->peaks = (float *) fgetmem(s->maxpeaks);
+    s->locs = (int *) malloc(sizeof(int) * s->maxpeaks);
 
     /* Initialise the retrieval/saving scheme of window statistic measures */
-    wReuse = agap / step;
-    if (wReuse) {
-      windstat = (Windstat *) malloc(wReuse * sizeof(Windstat));
-      for(i=0; i<wReuse; i++){
-	  windstat[i].err = 0;
-	  windstat[i].rms = 0;
+    s->wReuse = agap / s->step;
+    if (s->wReuse) {
+      s->windstat = (Windstat *) malloc(s->wReuse * sizeof(Windstat));
+      for(i=0; i<s->wReuse; i++){
+	  s->windstat[i].err = 0;
+	  s->windstat[i].rms = 0;
       }
   }
 
@@ -696,18 +682,18 @@ int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep)
     Fprintf(stderr, "done with initialization:\n");
     Fprintf(stderr,
 	    " size_cir_buffer:%d  xcorr frame size:%d start lag:%d nlags:%d\n",
-	    size_cir_buffer, size, start, nlags);
+	    s->size_cir_buffer, s->size, s->start, s->nlags);
   }
 
-  num_active_frames = 0;
-  first_time = 1;
+  s->num_active_frames = 0;
+  s->first_time = 1;
 
   return(0);
 }
 
 
 /*--------------------------------------------------------------------*/
-int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
+int dp_f0(RAPT_STATE *s, float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
           float **f0p_pt, float **vuvp_pt, float **rms_speech_pt,
           float **acpkp_pt, int *vecsize, int last_time)
 {
@@ -719,7 +705,7 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
 
   Stat *stat = NULL;
 
-  nframes = get_Nframes((long) buff_size, pad, step); /* # of whole frames */
+  nframes = get_Nframes((long) buff_size, s->pad, s->step); /* # of whole frames */
 
   if(debug_level)
     Fprintf(stderr,
@@ -731,13 +717,13 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
   if (decimate <= 1)
     dsdata = fdata;
   else {
-    samsds = ((nframes-1) * step + ncomp) / decimate;
+    samsds = ((nframes-1) * s->step + s->ncomp) / decimate;
 #if 1 /* skip final frame if it is too small */
     if(samsds < 1)
       return 1;
 #endif
-    dsdata = downsample(fdata, buff_size, sdstep, freq, &samsds, decimate,
-			first_time, last_time);
+    dsdata = downsample(s, fdata, buff_size, sdstep, freq, &samsds, decimate,
+			s->first_time, last_time);
     if (!dsdata) {
       Fprintf(stderr, "can't get downsampled data.\n");
       return 1;
@@ -746,7 +732,7 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
 
   /* Get a function of the "stationarity" of the speech signal. */
 
-  stat = get_stationarity(fdata, freq, buff_size, nframes, step, first_time);
+  stat = get_stationarity(s, fdata, freq, buff_size, nframes, s->step, s->first_time);
   if (!stat) {
     Fprintf(stderr, "can't get stationarity\n");
     return(1);
@@ -757,7 +743,7 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
   /***********************************************************************/
   /* MAIN FUNDAMENTAL FREQUENCY ESTIMATION LOOP */
   /***********************************************************************/
-  if(!first_time && nframes > 0) headF = headF->next;
+  if(!s->first_time && nframes > 0) s->headF = s->headF->next;
 
   for(i = 0; i < nframes; i++) {
 
@@ -766,33 +752,33 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
        tested.  My tests and analysis suggest it is completely
        superfluous. DT 9/5/96 */
     /* Dynamically allocating more space for the circular buffer */
-    if(headF == tailF->prev){
+    if(s->headF == s->tailF->prev){
       Frame *frm;
 
-      if(cir_buff_growth_count > 5){
+      if(s->cir_buff_growth_count > 5){
 	Fprintf(stderr,
-		"too many requests (%d) for dynamically allocating space.\n   There may be a problem in finding converged path.\n",cir_buff_growth_count);
+		"too many requests (%d) for dynamically allocating space.\n   There may be a problem in finding converged path.\n",s->cir_buff_growth_count);
 	return(1);
       }
       if(debug_level)
-	Fprintf(stderr, "allocating %d more frames for DP circ. buffer.\n", size_cir_buffer);
-      frm = alloc_frame(nlags, par->n_cands);
-      headF->next = frm;
-      frm->prev = headF;
-      for(k=1; k<size_cir_buffer; k++){
-	frm->next = alloc_frame(nlags, par->n_cands);
+	Fprintf(stderr, "allocating %d more frames for DP circ. buffer.\n", s->size_cir_buffer);
+      frm = alloc_frame(s->nlags, par->n_cands);
+      s->headF->next = frm;
+      frm->prev = s->headF;
+      for(k=1; k<s->size_cir_buffer; k++){
+	frm->next = alloc_frame(s->nlags, par->n_cands);
 	frm->next->prev = frm;
 	frm = frm->next;
       }
-      frm->next = tailF;
-      tailF->prev = frm;
-      cir_buff_growth_count++;
+      frm->next = s->tailF;
+      s->tailF->prev = frm;
+      s->cir_buff_growth_count++;
     }
 
-    headF->rms = stat->rms[i];
-    get_fast_cands(fdata, dsdata, i, step, size, decimate, start,
-		   nlags, &engref, &maxloc,
-		   &maxval, headF->cp, peaks, locs, &ncand, par);
+    s->headF->rms = stat->rms[i];
+    get_fast_cands(fdata, dsdata, i, s->step, s->size, decimate, s->start,
+		   s->nlags, &engref, &maxloc,
+		   &maxval, s->headF->cp, s->peaks, s->locs, &ncand, par, &s->sp);
 
     /*    Move the peak value and location arrays into the dp structure */
     {
@@ -800,53 +786,53 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
       register short *sp1;
       register int *sp2;
 
-      for(ftp1 = headF->dp->pvals, ftp2 = peaks,
-	  sp1 = headF->dp->locs, sp2 = locs, j=ncand; j--; ) {
+      for(ftp1 = s->headF->dp->pvals, ftp2 = s->peaks,
+	  sp1 = s->headF->dp->locs, sp2 = s->locs, j=ncand; j--; ) {
 	*ftp1++ = *ftp2++;
 	*sp1++ = *sp2++;
       }
       *sp1 = -1;		/* distinguish the UNVOICED candidate */
       *ftp1 = maxval;
-      headF->dp->mpvals[ncand] = vbias+maxval; /* (high cost if cor. is high)*/
+      s->headF->dp->mpvals[ncand] = s->vbias+maxval; /* (high cost if cor. is high)*/
     }
 
     /* Apply a lag-dependent weight to the peaks to encourage the selection
        of the first major peak.  Translate the modified peak values into
        costs (high peak ==> low cost). */
     for(j=0; j < ncand; j++){
-      ftemp = 1.0f - ((float)locs[j] * lagwt);
-      headF->dp->mpvals[j] = 1.0f - (peaks[j] * ftemp);
+      ftemp = 1.0f - ((float)s->locs[j] * s->lagwt);
+      s->headF->dp->mpvals[j] = 1.0f - (s->peaks[j] * ftemp);
     }
     ncand++;			/* include the unvoiced candidate */
-    headF->dp->ncands = ncand;
+    s->headF->dp->ncands = ncand;
 
     /*********************************************************************/
     /*    COMPUTE THE DISTANCE MEASURES AND ACCUMULATE THE COSTS.       */
     /*********************************************************************/
 
-    ncandp = headF->prev->dp->ncands;
+    ncandp = s->headF->prev->dp->ncands;
     for(k=0; k<ncand; k++){	/* for each of the current candidates... */
       minloc = 0;
       errmin = FLT_MAX;
-      if((loc2 = headF->dp->locs[k]) > 0) { /* current cand. is voiced */
+      if((loc2 = s->headF->dp->locs[k]) > 0) { /* current cand. is voiced */
 	for(j=0; j<ncandp; j++){ /* for each PREVIOUS candidate... */
 	  /*    Get cost due to inter-frame period change. */
-	  loc1 = headF->prev->dp->locs[j];
+	  loc1 = s->headF->prev->dp->locs[j];
 	  if (loc1 > 0) { /* prev. was voiced */
 	    ftemp = (float) log(((double) loc2) / loc1);
 	    ttemp = (float) fabs(ftemp);
-	    ft1 = (float) (fdouble + fabs(ftemp + ln2));
+	    ft1 = (float) (s->fdouble + fabs(ftemp + s->ln2));
 	    if (ttemp > ft1)
 	      ttemp = ft1;
-	    ft1 = (float) (fdouble + fabs(ftemp - ln2));
+	    ft1 = (float) (s->fdouble + fabs(ftemp - s->ln2));
 	    if (ttemp > ft1)
 	      ttemp = ft1;
-	    ferr = ttemp * freqwt;
+	    ferr = ttemp * s->freqwt;
 	  } else {		/* prev. was unvoiced */
-	    ferr = tcost + (tfact_s * sta[i]) + (tfact_a / rms_ratio[i]);
+	    ferr = s->tcost + (s->tfact_s * sta[i]) + (s->tfact_a / rms_ratio[i]);
 	  }
 	  /*    Add in cumulative cost associated with previous peak. */
-	  err = ferr + headF->prev->dp->dpvals[j];
+	  err = ferr + s->headF->prev->dp->dpvals[j];
 	  if(err < errmin){	/* find min. cost */
 	    errmin = err;
 	    minloc = j;
@@ -856,13 +842,13 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
 	for(j=0; j<ncandp; j++){ /* for each PREVIOUS candidate... */
 
 	  /*    Get voicing transition cost. */
-	  if (headF->prev->dp->locs[j] > 0) { /* previous was voiced */
-	    ferr = tcost + (tfact_s * sta[i]) + (tfact_a * rms_ratio[i]);
+	  if (s->headF->prev->dp->locs[j] > 0) { /* previous was voiced */
+	    ferr = s->tcost + (s->tfact_s * sta[i]) + (s->tfact_a * rms_ratio[i]);
 	  }
 	  else
 	    ferr = 0.0;
 	  /*    Add in cumulative cost associated with previous peak. */
-	  err = ferr + headF->prev->dp->dpvals[j];
+	  err = ferr + s->headF->prev->dp->dpvals[j];
 	  if(err < errmin){	/* find min. cost */
 	    errmin = err;
 	    minloc = j;
@@ -870,17 +856,17 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
 	}
       }
       /* Now have found the best path from this cand. to prev. frame */
-      if (first_time && i==0) {		/* this is the first frame */
-	headF->dp->dpvals[k] = headF->dp->mpvals[k];
-	headF->dp->prept[k] = 0;
+      if (s->first_time && i==0) {		/* this is the first frame */
+	s->headF->dp->dpvals[k] = s->headF->dp->mpvals[k];
+	s->headF->dp->prept[k] = 0;
       } else {
-	headF->dp->dpvals[k] = errmin + headF->dp->mpvals[k];
-	headF->dp->prept[k] = minloc;
+	s->headF->dp->dpvals[k] = errmin + s->headF->dp->mpvals[k];
+	s->headF->dp->prept[k] = minloc;
       }
     } /*    END OF THIS DP FRAME */
 
     if (i < nframes - 1)
-      headF = headF->next;
+      s->headF = s->headF->next;
 
     if (debug_level >= 2) {
       Fprintf(stderr,"%d engref:%10.0f max:%7.5f loc:%4d\n",
@@ -896,34 +882,34 @@ int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
 
   *vecsize = 0;			/* # of output frames returned */
 
-  num_active_frames += nframes;
+  s->num_active_frames += nframes;
 
-  if( num_active_frames >= size_frame_hist  || last_time ){
+  if( s->num_active_frames >= s->size_frame_hist  || last_time ){
     Frame *frm;
     int  num_paths, best_cand, frmcnt, checkpath_done = 1;
     float patherrmin;
 
     if(debug_level)
       Fprintf(stderr, "available frames for backtracking: %d\n",
-num_active_frames);
+s->num_active_frames);
 
     patherrmin = FLT_MAX;
     best_cand = 0;
-    num_paths = headF->dp->ncands;
+    num_paths = s->headF->dp->ncands;
 
     /* Get the best candidate for the final frame and initialize the
        paths' backpointers. */
-    frm = headF;
+    frm = s->headF;
     for(k=0; k < num_paths; k++) {
-      if (patherrmin > headF->dp->dpvals[k]){
-	patherrmin = headF->dp->dpvals[k];
+      if (patherrmin > s->headF->dp->dpvals[k]){
+	patherrmin = s->headF->dp->dpvals[k];
 	best_cand = k;	/* index indicating the best candidate at a path */
       }
-      pcands[k] = frm->dp->prept[k];
+      s->pcands[k] = frm->dp->prept[k];
     }
 
     if(last_time){     /* Input data was exhausted. force final outputs. */
-      cmpthF = headF;		/* Use the current frame as starting point. */
+      s->cmpthF = s->headF;		/* Use the current frame as starting point. */
     } else {
       /* Starting from the most recent frame, trace back each candidate's
 	 best path until reaching a common candidate at some past frame. */
@@ -933,28 +919,29 @@ num_active_frames);
 	frmcnt++;
 	checkpath_done = 1;
 	for(k=1; k < num_paths; k++){ /* Check for convergence. */
-	  if(pcands[0] != pcands[k])
+	  if(s->pcands[0] != s->pcands[k])
 	    checkpath_done = 0;
 	}
 	if( ! checkpath_done) { /* Prepare for checking at prev. frame. */
 	  for(k=0; k < num_paths; k++){
-	    pcands[k] = frm->dp->prept[pcands[k]];
+	    s->pcands[k] = frm->dp->prept[s->pcands[k]];
 	  }
 	} else {	/* All paths have converged. */
-	  cmpthF = frm;
-	  best_cand = pcands[0];
+	  s->cmpthF = frm;
+	  best_cand = s->pcands[0];
 	  if(debug_level)
 	    Fprintf(stderr,
 		    "paths went back %d frames before converging\n",frmcnt);
 	  break;
 	}
-	if(frm == tailF){	/* Used all available data? */
-	  if( num_active_frames < size_frame_out) { /* Delay some more? */
+	if(frm == s->tailF	/* Used all available data? */
+	   || (s->latency > 0.0 && frmcnt >= s->size_frame_out - 1)){
+	  if( s->num_active_frames < s->size_frame_out) { /* Delay some more? */
 	    checkpath_done = 0; /* Yes, don't backtrack at this time. */
-	    cmpthF = NULL;
+	    s->cmpthF = NULL;
 	  } else {		/* No more delay! Force best-guess output. */
 	    checkpath_done = 1;
-	    cmpthF = headF;
+	    s->cmpthF = s->headF;
 	    /*	    Fprintf(stderr,
 		    "WARNING: no converging path found after going back %d frames, will use the lowest cost path\n",num_active_frames);*/
 	  }
@@ -967,37 +954,37 @@ num_active_frames);
     /* BACKTRACKING FROM cmpthF (best_cand) ALL THE WAY TO tailF    */
     /*************************************************************/
     i = 0;
-    frm = cmpthF;	/* Start where convergence was found (or faked). */
-    while( frm != tailF->prev && checkpath_done){
-      if( i == output_buf_size ){ /* Need more room for outputs? */
-	output_buf_size *= 2;
+    frm = s->cmpthF;	/* Start where convergence was found (or faked). */
+    while( frm != s->tailF->prev && checkpath_done){
+      if( i == s->output_buf_size ){ /* Need more room for outputs? */
+	s->output_buf_size *= 2;
 	if(debug_level)
 	  Fprintf(stderr,
 		  "reallocating space for output frames: %d\n",
-		  output_buf_size);
-    rms_speech = (float *)
-        realloc((void *) rms_speech,
-                sizeof(float) * output_buf_size);
-    f0p = (float *) realloc((void *) f0p,
-                            sizeof(float) * output_buf_size);
-    vuvp =
-        (float *) realloc((void *) vuvp,
-                          sizeof(float) * output_buf_size);
-    acpkp =
-        (float *) realloc((void *) acpkp,
-                          sizeof(float) * output_buf_size);
+		  s->output_buf_size);
+    s->rms_speech = (float *)
+        realloc((void *) s->rms_speech,
+                sizeof(float) * s->output_buf_size);
+    s->f0p = (float *) realloc((void *) s->f0p,
+                            sizeof(float) * s->output_buf_size);
+    s->vuvp =
+        (float *) realloc((void *) s->vuvp,
+                          sizeof(float) * s->output_buf_size);
+    s->acpkp =
+        (float *) realloc((void *) s->acpkp,
+                          sizeof(float) * s->output_buf_size);
       }
-      rms_speech[i] = frm->rms;
-      acpkp[i] =  frm->dp->pvals[best_cand];
+      s->rms_speech[i] = frm->rms;
+      s->acpkp[i] =  frm->dp->pvals[best_cand];
       loc1 = frm->dp->locs[best_cand];
-      vuvp[i] = 1.0;
+      s->vuvp[i] = 1.0;
       best_cand = frm->dp->prept[best_cand];
       ftemp = (float) loc1;
       if(loc1 > 0) {		/* Was f0 actually estimated for this frame? */
-	if (loc1 > start && loc1 < stop) { /* loc1 must be a local maximum. */
+	if (loc1 > s->start && loc1 < s->stop) { /* loc1 must be a local maximum. */
 	  float cormax, cprev, cnext, den;
 
-	  j = loc1 - start;
+	  j = loc1 - s->start;
 	  cormax = frm->cp->correl[j];
 	  cprev = frm->cp->correl[j+1];
 	  cnext = frm->cp->correl[j-1];
@@ -1010,36 +997,36 @@ num_active_frames);
 	  if (fabs(den) > 0.000001)
 	    ftemp += 2.0f - ((((5.0f*cprev)+(3.0f*cnext)-(8.0f*cormax))/den));
 	}
-	f0p[i] = (float) (freq/ftemp);
+	s->f0p[i] = (float) (freq/ftemp);
       } else {		/* No valid estimate; just fake some arbitrary F0. */
-	f0p[i] = 0;
-	vuvp[i] = 0.0;
+	s->f0p[i] = 0;
+	s->vuvp[i] = 0.0;
       }
       frm = frm->prev;
 
       if (debug_level >= 2)
-	Fprintf(stderr," i:%4d%8.1f%8.1f\n",i,f0p[i],vuvp[i]);
+	Fprintf(stderr," i:%4d%8.1f%8.1f\n",i,s->f0p[i],s->vuvp[i]);
       /* f0p[i] starts from the most recent one */
       /* Need to reverse the order in the calling function */
       i++;
     } /* end while() */
     if (checkpath_done){
       *vecsize = i;
-      tailF = cmpthF->next;
-      num_active_frames -= *vecsize;
+      s->tailF = s->cmpthF->next;
+      s->num_active_frames -= *vecsize;
     }
   } /* end if() */
 
   if (debug_level)
     Fprintf(stderr, "writing out %d frames.\n", *vecsize);
 
-  *f0p_pt = f0p;
-  *vuvp_pt = vuvp;
-  *acpkp_pt = acpkp;
-  *rms_speech_pt = rms_speech;
+  *f0p_pt = s->f0p;
+  *vuvp_pt = s->vuvp;
+  *acpkp_pt = s->acpkp;
+  *rms_speech_pt = s->rms_speech;
   /*  *acpkp_pt = acpkp;*/
 
-  if(first_time) first_time = 0;
+  if(s->first_time) s->first_time = 0;
   return(0);
 }
 
@@ -1073,24 +1060,24 @@ Frame *alloc_frame(int nlags, int ncands)
 /* push window stat to stack, and pop the oldest one */
 
 static int
-save_windstat(float *rho, int order, float err, float rms)
+save_windstat(RAPT_STATE *s, float *rho, int order, float err, float rms)
 {
     int i,j;
 
-    if(wReuse > 1){               /* push down the stack */
-	for(j=1; j<wReuse; j++){
-	    for(i=0;i<=order; i++) windstat[j-1].rho[i] = windstat[j].rho[i];
-	    windstat[j-1].err = windstat[j].err;
-	    windstat[j-1].rms = windstat[j].rms;
+    if(s->wReuse > 1){               /* push down the stack */
+	for(j=1; j<s->wReuse; j++){
+	    for(i=0;i<=order; i++) s->windstat[j-1].rho[i] = s->windstat[j].rho[i];
+	    s->windstat[j-1].err = s->windstat[j].err;
+	    s->windstat[j-1].rms = s->windstat[j].rms;
 	}
-	for(i=0;i<=order; i++) windstat[wReuse-1].rho[i] = rho[i]; /*save*/
-	windstat[wReuse-1].err = (float) err;
-	windstat[wReuse-1].rms = (float) rms;
+	for(i=0;i<=order; i++) s->windstat[s->wReuse-1].rho[i] = rho[i]; /*save*/
+	s->windstat[s->wReuse-1].err = (float) err;
+	s->windstat[s->wReuse-1].rms = (float) rms;
 	return 1;
-    } else if (wReuse == 1) {
-	for(i=0;i<=order; i++) windstat[0].rho[i] = rho[i];  /* save */
-	windstat[0].err = (float) err;
-	windstat[0].rms = (float) rms;
+    } else if (s->wReuse == 1) {
+	for(i=0;i<=order; i++) s->windstat[0].rho[i] = rho[i];  /* save */
+	s->windstat[0].err = (float) err;
+	s->windstat[0].rms = (float) rms;
 	return 1;
     } else
 	return 0;
@@ -1099,13 +1086,13 @@ save_windstat(float *rho, int order, float err, float rms)
 
 /*--------------------------------------------------------------------*/
 static int
-retrieve_windstat(float *rho, int order, float *err, float *rms)
+retrieve_windstat(RAPT_STATE *s, float *rho, int order, float *err, float *rms)
 {
     Windstat wstat;
     int i;
 
-    if(wReuse){
-	wstat = windstat[0];
+    if(s->wReuse){
+	wstat = s->windstat[0];
 	for(i=0; i<=order; i++) rho[i] = wstat.rho[i];
 	*err = wstat.err;
 	*rms = wstat.rms;
@@ -1116,9 +1103,9 @@ retrieve_windstat(float *rho, int order, float *err, float *rms)
 
 
 /*--------------------------------------------------------------------*/
-static float get_similarity(int order, int size, float *pdata, float *cdata,
-       float *rmsa, float *rms_ratio, float pre, float stab, int w_type,
-       int init)
+static float get_similarity(RAPT_STATE *s, int order, int size, float *pdata,
+       float *cdata, float *rmsa, float *rms_ratio, float pre, float stab,
+       int w_type, int init)
 {
   float rho3[BIGSORD+1], err3, rms3, rmsd3, b0, t, a2[BIGSORD+1],
       rho1[BIGSORD+1], a1[BIGSORD+1], b[BIGSORD+1], err1, rms1, rmsd1;
@@ -1130,15 +1117,15 @@ static float get_similarity(int order, int size, float *pdata, float *cdata,
 
   /* get current window stat */
   xlpc(order, stab, size-1, cdata,
-      a2, rho3, (float *) NULL, &err3, &rmsd3, pre, w_type);
-  rms3 = wind_energy(cdata, size, w_type);
+      a2, rho3, (float *) NULL, &err3, &rmsd3, pre, w_type, &s->sp);
+  rms3 = wind_energy(cdata, size, w_type, &s->sp);
 
   if(!init) {
       /* get previous window stat */
-      if( !retrieve_windstat(rho1, order, &err1, &rms1)){
+      if( !retrieve_windstat(s, rho1, order, &err1, &rms1)){
 	  xlpc(order, stab, size-1, pdata,
-	      a1, rho1, (float *) NULL, &err1, &rmsd1, pre, w_type);
-	  rms1 = wind_energy(pdata, size, w_type);
+	      a1, rho1, (float *) NULL, &err1, &rmsd1, pre, w_type, &s->sp);
+	  rms1 = wind_energy(pdata, size, w_type, &s->sp);
       }
       xa_to_aca(a2+1,b,&b0,order);
       t = xitakura(order,b,&b0,rho1+1,&err1) - .8f;
@@ -1154,7 +1141,7 @@ static float get_similarity(int order, int size, float *pdata, float *cdata,
       t = 10.0;
   }
   *rmsa = rms3;
-  save_windstat( rho3, order, err3, rms3);
+  save_windstat(s, rho3, order, err3, rms3);
   return((float)(0.2/t));
 }
 
@@ -1190,13 +1177,9 @@ static float get_similarity(int order, int size, float *pdata, float *cdata,
 
 */
 
-static Stat *stat = NULL;
-static float *mem = NULL;
-
-static Stat* get_stationarity(float *fdata, double freq, int buff_size,
-       int  nframes, int frame_step, int first_time)
+static Stat* get_stationarity(RAPT_STATE *s, float *fdata, double freq,
+       int buff_size, int  nframes, int frame_step, int first_time)
 {
-  static int nframes_old = 0, memsize;
   float preemp = 0.4f, stab = 30.0f;
   float *p, *q, *r, *datend;
   int ind, i, j, m, size, order, agap, w_type = 3;
@@ -1205,26 +1188,26 @@ static Stat* get_stationarity(float *fdata, double freq, int buff_size,
   size = (int) (STAT_WSIZE * freq);
   ind = (agap - size) / 2;
 
-  if( nframes_old < nframes || !stat || first_time){
+  if( s->nframes_old < nframes || !s->stat || first_time){
     /* move this to init_dp_f0() later */
-    nframes_old = nframes;
-    if(stat){
-        free((char *) stat->stat);
-        free((char *) stat->rms);
-        free((char *) stat->rms_ratio);
-        free((char *) stat);
+    s->nframes_old = nframes;
+    if(s->stat){
+        free((char *) s->stat->stat);
+        free((char *) s->stat->rms);
+        free((char *) s->stat->rms_ratio);
+        free((char *) s->stat);
     }
-    if (mem) free((void *) mem);
-    stat = (Stat *) malloc(sizeof(Stat));
-    stat->stat = (float *) malloc(sizeof(float) * nframes);
-    stat->rms = (float *) malloc(sizeof(float) * nframes);
-    stat->rms_ratio = (float *) malloc(sizeof(float) * nframes);
-    memsize = (int) (STAT_WSIZE * freq) + (int) (STAT_AINT * freq);
-    mem = (float *) malloc(sizeof(float) * memsize);
-    for(j=0; j<memsize; j++) mem[j] = 0;
+    if (s->stat_mem) free((void *) s->stat_mem);
+    s->stat = (Stat *) malloc(sizeof(Stat));
+    s->stat->stat = (float *) malloc(sizeof(float) * nframes);
+    s->stat->rms = (float *) malloc(sizeof(float) * nframes);
+    s->stat->rms_ratio = (float *) malloc(sizeof(float) * nframes);
+    s->memsize = (int) (STAT_WSIZE * freq) + (int) (STAT_AINT * freq);
+    s->stat_mem = (float *) malloc(sizeof(float) * s->memsize);
+    for(j=0; j<s->memsize; j++) s->stat_mem[j] = 0;
   }
 
-  if(nframes == 0) return(stat);
+  if(nframes == 0) return(s->stat);
 
   q = fdata + ind;
   datend = fdata + buff_size;
@@ -1236,42 +1219,42 @@ static Stat* get_stationarity(float *fdata, double freq, int buff_size,
   }
 
   /* prepare for the first frame */
-  for(j=memsize/2, i=0; j<memsize; j++, i++) mem[j] = fdata[i];
+  for(j=s->memsize/2, i=0; j<s->memsize; j++, i++) s->stat_mem[j] = fdata[i];
 
   /* never run over end of frame, should already taken care of when read */
 
   for(j=0, p = q - agap; j < nframes; j++, p += frame_step, q += frame_step){
       if( (p >= fdata) && (q >= fdata) && ( q + size <= datend) )
-	  stat->stat[j] = get_similarity(order,size, p, q,
-					     &(stat->rms[j]),
-					     &(stat->rms_ratio[j]),preemp,
+	  s->stat->stat[j] = get_similarity(s, order,size, p, q,
+					     &(s->stat->rms[j]),
+					     &(s->stat->rms_ratio[j]),preemp,
 					     stab,w_type, 0);
       else {
 	  if(first_time) {
 	      if( (p < fdata) && (q >= fdata) && (q+size <=datend) )
-		  stat->stat[j] = get_similarity(order,size, NULL, q,
-						     &(stat->rms[j]),
-						     &(stat->rms_ratio[j]),
+		  s->stat->stat[j] = get_similarity(s, order,size, NULL, q,
+						     &(s->stat->rms[j]),
+						     &(s->stat->rms_ratio[j]),
 						     preemp,stab,w_type, 1);
 	      else{
-		  stat->rms[j] = 0.0;
-		  stat->stat[j] = 0.01f * 0.2f;   /* a big transition */
-		  stat->rms_ratio[j] = 1.0;   /* no amplitude change */
+		  s->stat->rms[j] = 0.0;
+		  s->stat->stat[j] = 0.01f * 0.2f;   /* a big transition */
+		  s->stat->rms_ratio[j] = 1.0;   /* no amplitude change */
 	      }
 	  } else {
 	      if( (p<fdata) && (q+size <=datend) ){
-		  stat->stat[j] = get_similarity(order,size, mem,
-						     mem + (memsize/2) + ind,
-						     &(stat->rms[j]),
-						     &(stat->rms_ratio[j]),
+		  s->stat->stat[j] = get_similarity(s, order,size, s->stat_mem,
+						     s->stat_mem + (s->memsize/2) + ind,
+						     &(s->stat->rms[j]),
+						     &(s->stat->rms_ratio[j]),
 						     preemp, stab,w_type, 0);
 		  /* prepare for the next frame_step if needed */
 		  if(p + frame_step < fdata ){
-		      for( m=0; m<(memsize-frame_step); m++)
-			  mem[m] = mem[m+frame_step];
+		      for( m=0; m<(s->memsize-frame_step); m++)
+			  s->stat_mem[m] = s->stat_mem[m+frame_step];
 		      r = q + size;
 		      for( m=0; m<frame_step; m++)
-			  mem[memsize-frame_step+m] = *r++;
+			  s->stat_mem[s->memsize-frame_step+m] = *r++;
 		  }
 	      }
 	  }
@@ -1279,9 +1262,9 @@ static Stat* get_stationarity(float *fdata, double freq, int buff_size,
   }
 
   /* last frame, prepare for next call */
-  for(j=(memsize/2)-1, p=fdata + (nframes * frame_step)-1; j>=0 && p>=fdata; j--)
-    mem[j] = *p--;
-  return(stat);
+  for(j=(s->memsize/2)-1, p=fdata + (nframes * frame_step)-1; j>=0 && p>=fdata; j--)
+    s->stat_mem[j] = *p--;
+  return(s->stat);
 }
 
 
@@ -1293,40 +1276,39 @@ int eround(double flnum)
   return((flnum >= 0.0) ? (int)(flnum + 0.5) : (int)(flnum - 0.5));
 }
 
-static void free_dp_f0()
+static void free_dp_f0(RAPT_STATE *s)
 {
-  int i;
   Frame *frm, *next;
-    free((void *) pcands);
-    pcands = NULL;
+    free((void *) s->pcands);
+    s->pcands = NULL;
 
-    free((void *) rms_speech);
-    rms_speech = NULL;
+    free((void *) s->rms_speech);
+    s->rms_speech = NULL;
 
-    free((void *) f0p);
-    f0p = NULL;
+    free((void *) s->f0p);
+    s->f0p = NULL;
 
-    free((void *) vuvp);
-    vuvp = NULL;
+    free((void *) s->vuvp);
+    s->vuvp = NULL;
 
-    free((void *) acpkp);
-    acpkp = NULL;
+    free((void *) s->acpkp);
+    s->acpkp = NULL;
 
-    free((void *) peaks);
-    peaks = NULL;
+    free((void *) s->peaks);
+    s->peaks = NULL;
 
-    free((void *) locs);
-    locs = NULL;
+    free((void *) s->locs);
+    s->locs = NULL;
 
-    if (wReuse) {
-        free((void *) windstat);
-        windstat = NULL;
+    if (s->wReuse) {
+        free((void *) s->windstat);
+        s->windstat = NULL;
     }
 
-    frm = headF;
-
-    for (i = 0; i < size_cir_buffer; i++) {
-        next = frm->next;
+    /* the whole ring, including frames added by dp_f0() */
+    frm = s->headF;
+    while (frm != NULL) {
+        next = (frm->next != s->headF) ? frm->next : NULL;
         free((void *) frm->cp->correl);
         free((void *) frm->dp->locs);
         free((void *) frm->dp->pvals);
@@ -1338,72 +1320,45 @@ static void free_dp_f0()
         free((void *) frm);
         frm = next;
     }
-    headF = NULL;
-    tailF = NULL;
+    s->headF = NULL;
+    s->tailF = NULL;
 
-    free((void *) stat->stat);
-    free((void *) stat->rms);
-    free((void *) stat->rms_ratio);
+    if (s->stat) {
+        free((void *) s->stat->stat);
+        free((void *) s->stat->rms);
+        free((void *) s->stat->rms_ratio);
 
-    free((void *) stat);
-    stat = NULL;
+        free((void *) s->stat);
+        s->stat = NULL;
+    }
 
-    free((void *) mem);
-    mem = NULL;
-}
+    free((void *) s->stat_mem);
+    s->stat_mem = NULL;
 
-int rapt(float *input, float *output, int length, double sample_freq, int frame_shift, double minF0, double maxF0, double voice_bias, int otype)
-{
-  int fnum = 0;
-  float *fdata;
-  int padded_length = 0;
-  int done;
-  long buff_size, actsize;
-  double sf;
-  F0_params *par;
-  float *f0p, *vuvp, *rms_speech, *acpkp;
-  int i, vecsize;
-  static int framestep = -1;
-  long sdstep = 0, total_samps;
-  int ndone = 0;
-  float *tmp, *unvoiced, *padded_input;
-  int count = 0;
-  int startpos = 0, endpos = -1;
-  long max;
-  double p, fsp, alpha, beta;
-  unsigned long next = 1;
-  double nrandom(unsigned long *next);
-
-  /* Compute padded length */
-  fnum = (int) (ceil((double) length / (double) frame_shift));
-  fsp = sample_freq * (10.0 / (double) frame_shift);
-  alpha = (int) (0.00275 * fsp + 0.5);
-  beta = (int) ((9600.0 / minF0 - 168.0) * fsp / 96000.0 + 0.5);
-  if (beta < 0) {
-     beta = 0;
-  }
-  padded_length = length + (alpha + beta + 3) * frame_shift;
+    free((void *) s->foutput);
+    s->foutput = NULL;
+    free((void *) s->ffir_co);
+    s->ffir_co = NULL;
+    free((void *) s->ffir_mem);
+    s->ffir_mem = NULL;
+    s->ffir_fsize = 0;
 
-  /* Allocate memory for padded input */
-  padded_input = (float *) malloc(sizeof(float)*padded_length);
+    free_sigproc_work(&s->sp);
 
-  for (i = 0; i < length; i++) {
-      p = (double) nrandom(&next);
-      padded_input[i] = input[i] + (float) (p * 50.0);
-  }
-  for (i = length; i < padded_length; i++) {
-      p = (double) nrandom(&next);
-      padded_input[i] = (float) (p * 50.0);
-  }
-
-  par = (F0_params *) malloc(sizeof(F0_params));
-  tmp = (float *) malloc(sizeof(float) * padded_length);
-  unvoiced = (float *) malloc(sizeof(float) * padded_length);
+    free((void *) s->inbuf);
+    s->inbuf = NULL;
+    free((void *) s->obuf);
+    s->obuf = NULL;
+}
 
-  for (i = 0; i < padded_length; i++) {
-      tmp[i] = 0.0;
-      unvoiced[i] = 0.0;
-  }
+/* fill in the parameters and allocate the DP structures of s, which
+   must be zeroed; returns 0, 1 for bad parameters or 3 if the DP
+   structures cannot be set up */
+static int rapt_init(RAPT_STATE *s, double sample_freq, int frame_shift,
+                     double minF0, double maxF0, double voice_bias,
+                     double latency)
+{
+  F0_params *par = &s->par;
 
   par->cand_thresh = 0.3f;
   par->lag_weight = 0.3f;
@@ -1423,84 +1378,212 @@ int rapt(float *input, float *output, int length, double sample_freq, int frame_
   par->conditioning = 0;       /* unused */
   par->voice_bias = voice_bias; /* overwrite U/V threshold for pitch command */
 
-    if (startpos < 0) startpos = 0;
-    if (endpos >= (length - 1) || endpos == -1) {
-        endpos = length - 1;
-    }
-    sf = (double) sample_freq;
+  s->sample_freq = sample_freq;
+  s->frame_shift = frame_shift;
+  s->min_f0 = minF0;
+  s->latency = latency;
+  s->ncoeff = 127;
+  s->sp.xcorr = SIGPROC_XCORR_BLOCK;
 
-    if (framestep > 0)          /* If a value was specified with -S, use it. */
-        par->frame_step = (float) (framestep / sf);
+  if (check_f0_params(par, sample_freq)) {
+     fprintf(stderr, "invalid/inconsistent parameters -- exiting.\n");
+     return 1;
+  }
 
-    if (check_f0_params(par, sf)) {
-       fprintf(stderr, "invalid/inconsistent parameters -- exiting.\n");
-       return 1;
-    }
+  if (init_dp_f0(s, sample_freq, par, &s->buff_size, &s->sdstep)
+      || s->buff_size > INT_MAX || s->sdstep > INT_MAX) {
+     fprintf(stderr, "problem in init_dp_f0().\n");
+     return 3;
+  }
 
-    total_samps = endpos - startpos + 1;
+  /* one block of input plus the sample that shows it is not the last */
+  s->inbuf = (float *) malloc(sizeof(float) * (s->buff_size + 1));
+  s->obuf_size = s->output_buf_size;
+  s->obuf = (float *) malloc(sizeof(float) * s->obuf_size);
 
-    if (total_samps < ((par->frame_step * 2.0) + par->wind_dur) * sf) {
-       fprintf(stderr, "input range too small for analysis by get_f0.\n");
-       return 2;
-    }
+  return 0;
+}
 
-    if (init_dp_f0(sf, par, &buff_size, &sdstep)
-        || buff_size > INT_MAX || sdstep > INT_MAX) {
-       fprintf(stderr, "problem in init_dp_f0().\n");
-       return 3;
-    }
+/* run the DP on the buffered block and queue the frames it finalizes */
+static int rapt_block(RAPT_STATE *s, int actsize, int done)
+{
+  float *f0p, *vuvp, *rms_speech, *acpkp;
+  int i, vecsize;
 
-  if (buff_size > total_samps)
-    buff_size = total_samps;
+  if (dp_f0(s, s->inbuf, actsize, (int) s->sdstep, s->sample_freq, &s->par,
+            &f0p, &vuvp, &rms_speech, &acpkp, &vecsize, done)) {
+    s->stopped = 1;  /* skip final frame if it is too small */
+    return 1;
+  }
 
-  max = buff_size > sdstep ? buff_size : sdstep;
-  actsize = buff_size < length ? buff_size : length;
-  fdata = (float *) malloc(sizeof(float) * max);
-  ndone = startpos;
+  if (s->obuf_pos > 0) {
+    memmove(s->obuf, s->obuf + s->obuf_pos,
+            sizeof(float) * (s->obuf_len - s->obuf_pos));
+    s->obuf_len -= s->obuf_pos;
+    s->obuf_pos = 0;
+  }
+  if (s->obuf_len + vecsize > s->obuf_size) {
+    s->obuf_size = 2 * (s->obuf_len + vecsize);
+    s->obuf = (float *) realloc((void *) s->obuf,
+                                sizeof(float) * s->obuf_size);
+  }
+  for (i = vecsize - 1; i >= 0; i--)
+    s->obuf[s->obuf_len++] = f0p[i];
 
-    while (1) {
-        done = (actsize < buff_size) || (total_samps == buff_size);
-        for (i = 0; i < actsize; i++) {
-            fdata[i] = padded_input[i + ndone];
-        }
-        if (dp_f0(fdata, (int) actsize, (int) sdstep, sf, par,
-                  &f0p, &vuvp, &rms_speech, &acpkp, &vecsize, done)) {
-            break;  /* skip final frame if it is too small */
-        }
+  return 0;
+}
 
-        for (i = vecsize - 1; i >= 0; i--) {
-            tmp[count] = f0p[i];
-            unvoiced[count] = vuvp[i];
-            count++;
-        }
+void rapt_reset(RAPT_STATE *s)
+{
+  int i;
 
+  s->headF = s->tailF;
+  s->cmpthF = NULL;
+  s->num_active_frames = 0;
+  s->cir_buff_growth_count = 0;
+  s->first_time = 1;
+  for (i = 0; i < s->wReuse; i++) {
+    s->windstat[i].err = 0;
+    s->windstat[i].rms = 0;
+  }
 
-    if (done) break;
+  s->ninbuf = 0;
+  s->nsamples = 0;
+  s->obuf_len = s->obuf_pos = 0;
+  s->stopped = 0;
+  s->next = 1;
+  s->nsw = 0;
+}
+
+RAPT_STATE *rapt_create(double sample_freq, int frame_shift, double minF0,
+                        double maxF0, double voice_bias, double latency)
+{
+  RAPT_STATE *s;
+
+  if (!(s = (RAPT_STATE *) calloc(1, sizeof(RAPT_STATE)))) {
+    fprintf(stderr, "Cannot allocate memory!\n");
+    return NULL;
+  }
+  if (rapt_init(s, sample_freq, frame_shift, minF0, maxF0, voice_bias,
+                latency)) {
+    if (s->headF)
+      free_dp_f0(s);
+    free((void *) s);
+    return NULL;
+  }
+  rapt_reset(s);
+
+  return s;
+}
+
+void rapt_destroy(RAPT_STATE *s)
+{
+  if (s) {
+    free_dp_f0(s);
+    free((void *) s);
+  }
+}
+
+int rapt_set_xcorr(RAPT_STATE *s, int method)
+{
+  switch (method) {
+  case 0:
+    s->sp.xcorr = SIGPROC_XCORR_DIRECT;
+    break;
+  case 1:
+    s->sp.xcorr = SIGPROC_XCORR_BLOCK;
+    break;
+  case 2:
+    s->sp.xcorr = SIGPROC_XCORR_FFT;
+    break;
+  default:
+    fprintf(stderr, "rapt_set_xcorr : unknown correlation engine %d!\n",
+            method);
+    return 1;
+  }
+
+  return 0;
+}
+
+int rapt_latency(RAPT_STATE *s)
+{
+  return (s->size_frame_out + (int) (s->sdstep / s->step) - 1) * s->step
+      + s->pad + 1;
+}
+
+int rapt_push(RAPT_STATE *s, float *input, int length)
+{
+  int i, n;
+  double nrandom_r(unsigned long *next, int *sw, double *r);
+
+  while (length > 0 && !s->stopped) {
+    n = (int) s->buff_size + 1 - s->ninbuf;
+    if (n > length)
+      n = length;
+    for (i = 0; i < n; i++)
+      s->inbuf[s->ninbuf++] = input[i]
+          + (float) (nrandom_r(&s->next, &s->nsw, &s->nr) * 50.0);
+    input += n;
+    length -= n;
+    s->nsamples += n;
+
+    /* a full block followed by more input is not the last one */
+    if (s->ninbuf > s->buff_size) {
+      if (rapt_block(s, (int) s->buff_size, 0))
+        break;
+      s->ninbuf -= (int) s->sdstep;
+      memmove(s->inbuf, s->inbuf + s->sdstep, sizeof(float) * s->ninbuf);
+    }
+  }
+
+  return s->stopped;
+}
 
-    ndone += sdstep;
-    actsize = buff_size < (length - ndone)
-        ? buff_size : (length - ndone);
-    total_samps -= sdstep;
+int rapt_finish(RAPT_STATE *s)
+{
+  F0_params *par = &s->par;
+
+  if (s->stopped)
+    return 0;
 
-    if (actsize > total_samps)
-      actsize = total_samps;
+  /* a block has been tracked already if some input has been consumed */
+  if (s->nsamples == s->ninbuf
+      && s->nsamples < ((par->frame_step * 2.0) + par->wind_dur)
+      * s->sample_freq) {
+    fprintf(stderr, "input range too small for analysis by get_f0.\n");
+    return 2;
   }
+  rapt_block(s, s->ninbuf, 1);
+  s->ninbuf = 0;
+  s->stopped = 1;
+
+  return 0;
+}
+
+int rapt_pull(RAPT_STATE *s, float *output, int length, int otype)
+{
+  int i;
+  float f0;
+
+  if (length > s->obuf_len - s->obuf_pos)
+    length = s->obuf_len - s->obuf_pos;
 
-  for (i = 0; i < fnum; i++) {
+  for (i = 0; i < length; i++) {
+      f0 = s->obuf[s->obuf_pos++];
       switch (otype) {
       case 1:                   /* f0 */
-          output[i] = tmp[i];
+          output[i] = f0;
           break;
       case 2:                   /* log(f0) */
-          if (tmp[i] != 0.0) {
-              output[i] = log(tmp[i]);
+          if (f0 != 0.0) {
+              output[i] = log(f0);
           } else {
               output[i] = -1.0E10;
           }
           break;
       default:                  /* pitch */
-          if (tmp[i] != 0.0) {
-              output[i] = sample_freq / tmp[i];
+          if (f0 != 0.0) {
+              output[i] = s->sample_freq / f0;
           } else {
               output[i] = 0.0;
 	  }
@@ -1508,14 +1591,41 @@ int rapt(float *input, float *output, int length, double sample_freq, int frame_
       }
   }
 
-  free((void *) fdata);
-  free((void *) padded_input);
-  free((void *) par);
-  free((void *) tmp);
-  free((void *) unvoiced);
+  return length;
+}
+
+int rapt_process(RAPT_STATE *s, float *input, float *output, int length,
+                 int otype)
+{
+  int i, n, fnum, ret;
+
+  fnum = (int) (ceil((double) length / (double) s->frame_shift));
 
+  rapt_reset(s);
+  rapt_push(s, input, length);
+  if ((ret = rapt_finish(s)) != 0)
+    return ret;
 
-  free_dp_f0();
+  n = rapt_pull(s, output, fnum, otype);
+  for (i = n; i < fnum; i++)
+    output[i] = (otype == 2) ? -1.0E10 : 0.0;
 
   return 0;
 }
+
+int rapt(float *input, float *output, int length, double sample_freq, int frame_shift, double minF0, double maxF0, double voice_bias, int otype)
+{
+  RAPT_STATE *s;
+  int ret;
+
+  if (!(s = (RAPT_STATE *) calloc(1, sizeof(RAPT_STATE)))) {
+    fprintf(stderr, "Cannot allocate memory!\n");
+    return 3;
+  }
+  if ((ret = rapt_init(s, sample_freq, frame_shift, minF0, maxF0,
+                       voice_bias, 0.0)) == 0)
+    ret = rapt_process(s, input, output, length, otype);
+  rapt_destroy(s);
+
+  return ret;
+}
@@ -144,19 +144,88 @@ typedef struct frame_rec {
   struct frame_rec *prev;
 } Frame;
 
+/* The state of one pitch tracker */
+typedef struct _RAPT_STATE {
+  F0_params par;
+  double sample_freq, min_f0;
+  int frame_shift;
+  long buff_size, sdstep;
+
+  /*
+   * headF points to current frame in the circular buffer,
+   * tailF points to the frame where tracks start
+   * cmpthF points to starting frame of converged path to backtrack
+   */
+  Frame *headF, *tailF, *cmpthF;
+
+  int *pcands;          /* array for backtracking in convergence check */
+  int cir_buff_growth_count;
+
+  int size_cir_buffer,  /* # of frames in circular DP buffer */
+      size_frame_hist,  /* # of frames required before convergence test */
+      size_frame_out,   /* # of frames before forcing output */
+      num_active_frames,  /* # of frames from tailF to headF */
+      output_buf_size;  /* # of frames allocated to output buffers */
+
+  /* DP parameters */
+  float tcost, tfact_a, tfact_s, frame_int, vbias, fdouble, wdur, ln2,
+      freqwt, lagwt;
+  int step, size, nlags, start, stop, ncomp, *locs;
+  short maxpeaks;
+
+  int wReuse;           /* number of windows seen before resued */
+  Windstat *windstat;
+
+  float *f0p, *vuvp, *rms_speech, *acpkp, *peaks;
+  int first_time, pad;
+
+  /* downsample() */
+  float ds_b[2048];
+  float *foutput;
+  int ncoeff, ncoefft;
+
+  /* do_ffir() */
+  float *ffir_co, *ffir_mem;
+  float ffir_state[1000];
+  int ffir_fsize, ffir_resid;
+
+  /* get_stationarity() */
+  Stat *stat;
+  float *stat_mem;
+  int nframes_old, memsize;
+
+  /* windows and buffers of sigproc.c */
+  Sigproc_work sp;
+
+  /* streaming */
+  double latency;       /* bound on the output delay (sec), 0 for none */
+  float *inbuf;         /* dithered input of the current block */
+  int ninbuf;           /* # of samples in inbuf */
+  long nsamples;        /* # of samples pushed since the reset */
+  float *obuf;          /* F0 of finalized frames not yet pulled */
+  int obuf_size, obuf_len, obuf_pos;
+  int stopped;          /* no more input is taken */
+  unsigned long next;   /* state of the dither noise */
+  int nsw;
+  double nr;
+} RAPT_STATE;
+
 /* Function prototypes */
 void get_fast_cands(float *fdata, float *fdsdata, int ind, int step, int size,
                     int dec, int start, int nlags, float *engref, int *maxloc,
                     float *maxval, Cross *cp, float *peaks, int *locs,
-                    int *ncand, F0_params *par);
-float *downsample(float *input, int samsin, int state_idx, double freq,
-                  int *samsout, int decimate, int first_time, int last_time);
+                    int *ncand, F0_params *par, Sigproc_work *w);
+float *downsample(RAPT_STATE *s, float *input, int samsin, int state_idx,
+                  double freq, int *samsout, int decimate, int first_time,
+                  int last_time);
 
 int get_Nframes(long buffsize, int pad, int step);
-int init_dp_f0(double freq, F0_params *par, long *buffsize, long *sdstep);
-int dp_f0(float *fdata, int buff_size, int sdstep, double freq, F0_params *par,
-          float **f0p_pt, float **vuvp_pt, float **rms_speech_pt,
-          float **acpkp_pt, int *vecsize, int last_time);
+int init_dp_f0(RAPT_STATE *s, double freq, F0_params *par, long *buffsize,
+               long *sdstep);
+int dp_f0(RAPT_STATE *s, float *fdata, int buff_size, int sdstep, double freq,
+          F0_params *par, float **f0p_pt, float **vuvp_pt,
+          float **rms_speech_pt, float **acpkp_pt, int *vecsize,
+          int last_time);
 
 Frame *alloc_frame(int nlags, int ncands);
 
@@ -166,5 +235,16 @@ int eround(double finum);
 int rapt(float *input, float *output, int length, double sample_freq,
          int frame_shift, double minF0, double maxF0, double voice_bias,
          int otype);
+RAPT_STATE *rapt_create(double sample_freq, int frame_shift, double minF0,
+                        double maxF0, double voice_bias, double latency);
+int rapt_process(RAPT_STATE *s, float *input, float *output, int length,
+                 int otype);
+void rapt_destroy(RAPT_STATE *s);
+void rapt_reset(RAPT_STATE *s);
+int rapt_push(RAPT_STATE *s, float *input, int length);
+int rapt_finish(RAPT_STATE *s);
+int rapt_pull(RAPT_STATE *s, float *output, int length, int otype);
+int rapt_latency(RAPT_STATE *s);
+int rapt_set_xcorr(RAPT_STATE *s, int method);
 
 #endif /* JK_GET_F0_H_ */
@@ -68,6 +68,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifndef TRUE
 # define TRUE 1
 # define FALSE 0
@@ -75,33 +76,55 @@
 
 #include "sigproc.h"
 
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define XCORR_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define XCORR_NEON
+#include <arm_neon.h>
+#endif
+
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Return a time-weighting window of type type and length n in dout.
  * Dout is assumed to be at least n elements long.  Type is decoded in
  * the switch statement below.
  */
-int xget_window(register float *dout, register int n, register int type)
+int xget_window(register float *dout, register int n, register int type,
+                Sigproc_work *w)
 {
-  static float *din = NULL;
-  static int n0 = 0;
   float preemp = 0.0;
 
-  if(n > n0) {
+  if(n > w->n0) {
     register float *p;
     register int i;
 
-    if (din) free((void *) din);
-    din = NULL;
-    if (!(din = (float *) malloc(sizeof(float) * n))) {
+    if (w->din) free((void *) w->din);
+    w->din = NULL;
+    w->n0 = 0;
+    if (!(w->din = (float *) malloc(sizeof(float) * n))) {
         Fprintf(stderr, "Allocation problems in xget_window()\n");
         return (FALSE);
     }
 
-    for(i=0, p=din; i++ < n; ) *p++ = 1;
-    n0 = n;
+    for(i=0, p=w->din; i++ < n; ) *p++ = 1;
+    w->n0 = n;
   }
-  return(sigproc_window(din, dout, n, preemp, type));
+  return(sigproc_window(w->din, dout, n, preemp, type, w));
 }
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -125,23 +148,21 @@ void xrwindow(register float *din, register float *dout, register int n,
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Generate a cos^4 window, if one does not already exist. */
 void xcwindow(register float *din, register float *dout, register int n,
-              register float preemp)
+              register float preemp, Sigproc_work *w)
 {
   register int i;
   register float *p;
-  static int wsize = 0;
-  static float *wind=NULL;
   register float *q, co;
 
-  if(wsize != n) {		/* Need to create a new cos**4 window? */
+  if(w->cwind_size != n) {		/* Need to create a new cos**4 window? */
     register double arg, half=0.5;
 
-    if (wind)
-        wind = (float *) realloc((void *) wind, n * sizeof(float));
+    if (w->cwind)
+        w->cwind = (float *) realloc((void *) w->cwind, n * sizeof(float));
     else
-        wind = (float *) malloc(n * sizeof(float));
-    wsize = n;
-    for(i=0, arg=3.1415927*2.0/(wsize), q=wind; i < n; ) {
+        w->cwind = (float *) malloc(n * sizeof(float));
+    w->cwind_size = n;
+    for(i=0, arg=3.1415927*2.0/(w->cwind_size), q=w->cwind; i < n; ) {
       co = (float) (half*(1.0 - cos((half + (double)i++) * arg)));
       *q++ = co * co * co * co;
     }
@@ -149,10 +170,10 @@ void xcwindow(register float *din, register float *dout, register int n,
 /* If preemphasis is to be performed,  this assumes that there are n+1 valid
    samples in the input buffer (din). */
   if(preemp != 0.0) {
-    for(i=n, p=din+1, q=wind; i--; )
+    for(i=n, p=din+1, q=w->cwind; i--; )
       *dout++ = (float) (*q++ * ((float)(*p++) - (preemp * *din++)));
   } else {
-    for(i=n, q=wind; i--; )
+    for(i=n, q=w->cwind; i--; )
       *dout++ = *q++ * *din++;
   }
 }
@@ -160,32 +181,30 @@ void xcwindow(register float *din, register float *dout, register int n,
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Generate a Hamming window, if one does not already exist. */
 void xhwindow(register float *din, register float *dout, register int n,
-              register float preemp)
+              register float preemp, Sigproc_work *w)
 {
   register int i;
   register float *p;
-  static int wsize = 0;
-  static float *wind=NULL;
   register float *q;
 
-  if(wsize != n) {		/* Need to create a new Hamming window? */
+  if(w->hwind_size != n) {		/* Need to create a new Hamming window? */
     register double arg, half=0.5;
 
-    if (wind)
-        wind = (float *) realloc((void *) wind, n * sizeof(float));
+    if (w->hwind)
+        w->hwind = (float *) realloc((void *) w->hwind, n * sizeof(float));
     else
-        wind = (float *) malloc(n * sizeof(float));
-    wsize = n;
-    for(i=0, arg=3.1415927*2.0/(wsize), q=wind; i < n; )
+        w->hwind = (float *) malloc(n * sizeof(float));
+    w->hwind_size = n;
+    for(i=0, arg=3.1415927*2.0/(w->hwind_size), q=w->hwind; i < n; )
       *q++ = (float) (.54 - .46 * cos((half + (double)i++) * arg));
   }
 /* If preemphasis is to be performed,  this assumes that there are n+1 valid
    samples in the input buffer (din). */
   if(preemp != 0.0) {
-    for(i=n, p=din+1, q=wind; i--; )
+    for(i=n, p=din+1, q=w->hwind; i--; )
       *dout++ = (float) (*q++ * ((float)(*p++) - (preemp * *din++)));
   } else {
-    for(i=n, q=wind; i--; )
+    for(i=n, q=w->hwind; i--; )
       *dout++ = *q++ * *din++;
   }
 }
@@ -193,32 +212,30 @@ void xhwindow(register float *din, register float *dout, register int n,
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Generate a Hanning window, if one does not already exist. */
 void xhnwindow(register float *din, register float *dout, register int n,
-               register float preemp)
+               register float preemp, Sigproc_work *w)
 {
   register int i;
   register float *p;
-  static int wsize = 0;
-  static float *wind=NULL;
   register float *q;
 
-  if(wsize != n) {		/* Need to create a new Hanning window? */
+  if(w->hnwind_size != n) {		/* Need to create a new Hanning window? */
     register double arg, half=0.5;
 
-    if (wind)
-        wind = (float *) realloc((void *) wind, n * sizeof(float));
+    if (w->hnwind)
+        w->hnwind = (float *) realloc((void *) w->hnwind, n * sizeof(float));
     else
-        wind = (float *) malloc(n * sizeof(float));
-    wsize = n;
-    for(i=0, arg=3.1415927*2.0/(wsize), q=wind; i < n; )
+        w->hnwind = (float *) malloc(n * sizeof(float));
+    w->hnwind_size = n;
+    for(i=0, arg=3.1415927*2.0/(w->hnwind_size), q=w->hnwind; i < n; )
       *q++ = (float) (half - half * cos((half + (double)i++) * arg));
   }
 /* If preemphasis is to be performed,  this assumes that there are n+1 valid
    samples in the input buffer (din). */
   if(preemp != 0.0) {
-    for(i=n, p=din+1, q=wind; i--; )
+    for(i=n, p=din+1, q=w->hnwind; i--; )
       *dout++ = (float) (*q++ * ((float)(*p++) - (preemp * *din++)));
   } else {
-    for(i=n, q=wind; i--; )
+    for(i=n, q=w->hnwind; i--; )
       *dout++ = *q++ * *din++;
   }
 }
@@ -229,20 +246,20 @@ void xhnwindow(register float *din, register float *dout, register int n,
  * is non-zero, apply preemphasis to tha data as it is windowed.
  */
 int sigproc_window(register float *din, register float *dout, register int n,
-                   register float preemp, int type)
+                   register float preemp, int type, Sigproc_work *w)
 {
   switch(type) {
   case 0:			/* rectangular */
     xrwindow(din, dout, n, preemp);
     break;
   case 1:			/* Hamming */
-    xhwindow(din, dout, n, preemp);
+    xhwindow(din, dout, n, preemp, w);
     break;
   case 2:			/* cos^4 */
-    xcwindow(din, dout, n, preemp);
+    xcwindow(din, dout, n, preemp, w);
     break;
   case 3:			/* Hanning */
-    xhnwindow(din, dout, n, preemp);
+    xhnwindow(din, dout, n, preemp, w);
     break;
   default:
     Fprintf(stderr,"Unknown window type (%d) requested in window()\n",type);
@@ -251,6 +268,271 @@ int sigproc_window(register float *din, register float *dout, register int n,
   return(TRUE);
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Make room for n doubles in w->xre and w->xim and n floats in w->xpad.
+ * Returns FALSE on allocation failure.
+ */
+static int xcorr_alloc(int n, Sigproc_work *w)
+{
+  if(n <= w->xsize)
+    return(TRUE);
+  free((void *) w->xre);
+  free((void *) w->xim);
+  free((void *) w->xpad);
+  w->xre = (double *) malloc(sizeof(double) * n);
+  w->xim = (double *) malloc(sizeof(double) * n);
+  w->xpad = (float *) malloc(sizeof(float) * n);
+  if(!w->xre || !w->xim || !w->xpad) {
+    Fprintf(stderr, "Allocation failure in xcorr_alloc()\n");
+    free((void *) w->xre);
+    free((void *) w->xim);
+    free((void *) w->xpad);
+    w->xre = w->xim = NULL;
+    w->xpad = NULL;
+    w->xsize = 0;
+    return(FALSE);
+  }
+  w->xsize = n;
+  return(TRUE);
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Correlations by one fft and one inverse fft of the pair (x, y) packed
+ * as real and imaginary parts; y is zero beyond ylen samples.
+ */
+static int xcorr_fft(float *x, int size, float *y, int ylen, int nlags,
+                     Sigproc_work *w)
+{
+  register int i, k, n;
+  register double *re, *im;
+  double xr, xi, yr, yi, rr, ri;
+  int fft(double *x, double *y, const int m);
+  int ifft(double *x, double *y, const int m);
+
+  for(n = 8; n < size + nlags - 1; n <<= 1);
+  if(!xcorr_alloc(n, w))
+    return(FALSE);
+  re = w->xre;
+  im = w->xim;
+  for(i = 0; i < size; i++) re[i] = x[i];
+  for( ; i < n; i++) re[i] = 0.0;
+  for(i = 0; i < ylen; i++) im[i] = y[i];
+  for( ; i < n; i++) im[i] = 0.0;
+
+  fft(re, im, n);
+
+  /* Split Z = X + jY into the spectra of x and y, and form conj(X)Y,
+     whose bins k and n-k are conjugate. */
+  for(i = 0; i <= n/2; i++) {
+    k = (n - i) & (n - 1);
+    xr = 0.5 * (re[i] + re[k]);
+    xi = 0.5 * (im[i] - im[k]);
+    yr = 0.5 * (im[i] + im[k]);
+    yi = -0.5 * (re[i] - re[k]);
+    rr = xr * yr + xi * yi;
+    ri = xr * yi - xi * yr;
+    re[i] = re[k] = rr;
+    im[i] = ri;
+    im[k] = -ri;
+  }
+
+  ifft(re, im, n);
+
+  return(TRUE);
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Kernels of the blocked engine: c[k] = sum x[j]*y[j+k], j = 0..size-1,
+ * for the nlags lags rounded up to the kernel's block (16 lags at most),
+ * with one lag per vector lane so that several lags share each x[j].  Every
+ * lane adds its products in the order of the lag-by-lag loop, in single
+ * precision and without fused multiply-add, so the sums are the same.
+ */
+static void xcorr_lanes_scalar(float *x, int size, float *y, int nlags,
+                               float *c)
+{
+  register int j, l, k;
+  register float xj, *yl;
+  float s[8];
+
+  for(l = 0; l < nlags; l += 8) {
+    for(k = 0; k < 8; k++) s[k] = 0.0;
+    for(j = 0, yl = y + l; j < size; j++, yl++) {
+      xj = x[j];
+      for(k = 0; k < 8; k++) s[k] += xj * yl[k];
+    }
+    for(k = 0; k < 8; k++) c[l+k] = s[k];
+  }
+}
+
+#if defined(XCORR_X86)
+TARGET_AVX2 static void xcorr_lanes_avx2(float *x, int size, float *y,
+                                         int nlags, float *c)
+{
+  int j, l;
+  __m256 xj, s0, s1, s2, s3;
+
+  for(l = 0; l + 32 <= nlags; l += 32) {
+    s0 = s1 = s2 = s3 = _mm256_setzero_ps();
+    for(j = 0; j < size; j++) {
+      xj = _mm256_set1_ps(x[j]);
+      s0 = _mm256_add_ps(s0, _mm256_mul_ps(xj, _mm256_loadu_ps(y+l+j)));
+      s1 = _mm256_add_ps(s1, _mm256_mul_ps(xj, _mm256_loadu_ps(y+l+j+8)));
+      s2 = _mm256_add_ps(s2, _mm256_mul_ps(xj, _mm256_loadu_ps(y+l+j+16)));
+      s3 = _mm256_add_ps(s3, _mm256_mul_ps(xj, _mm256_loadu_ps(y+l+j+24)));
+    }
+    _mm256_storeu_ps(c+l, s0);
+    _mm256_storeu_ps(c+l+8, s1);
+    _mm256_storeu_ps(c+l+16, s2);
+    _mm256_storeu_ps(c+l+24, s3);
+  }
+  for( ; l < nlags; l += 8) {
+    s0 = _mm256_setzero_ps();
+    for(j = 0; j < size; j++)
+      s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_set1_ps(x[j]),
+                                           _mm256_loadu_ps(y+l+j)));
+    _mm256_storeu_ps(c+l, s0);
+  }
+}
+
+TARGET_SSE2 static void xcorr_lanes_sse2(float *x, int size, float *y,
+                                         int nlags, float *c)
+{
+  int j, l;
+  __m128 xj, s0, s1, s2, s3;
+
+  for(l = 0; l < nlags; l += 16) {
+    s0 = s1 = s2 = s3 = _mm_setzero_ps();
+    for(j = 0; j < size; j++) {
+      xj = _mm_set1_ps(x[j]);
+      s0 = _mm_add_ps(s0, _mm_mul_ps(xj, _mm_loadu_ps(y+l+j)));
+      s1 = _mm_add_ps(s1, _mm_mul_ps(xj, _mm_loadu_ps(y+l+j+4)));
+      s2 = _mm_add_ps(s2, _mm_mul_ps(xj, _mm_loadu_ps(y+l+j+8)));
+      s3 = _mm_add_ps(s3, _mm_mul_ps(xj, _mm_loadu_ps(y+l+j+12)));
+    }
+    _mm_storeu_ps(c+l, s0);
+    _mm_storeu_ps(c+l+4, s1);
+    _mm_storeu_ps(c+l+8, s2);
+    _mm_storeu_ps(c+l+12, s3);
+  }
+}
+#elif defined(XCORR_NEON)
+static void xcorr_lanes_neon(float *x, int size, float *y, int nlags,
+                             float *c)
+{
+  int j, l;
+  float32x4_t xj, s0, s1, s2, s3;
+
+  for(l = 0; l < nlags; l += 16) {
+    s0 = s1 = s2 = s3 = vdupq_n_f32(0.0f);
+    for(j = 0; j < size; j++) {
+      xj = vdupq_n_f32(x[j]);
+      s0 = vaddq_f32(s0, vmulq_f32(xj, vld1q_f32(y+l+j)));
+      s1 = vaddq_f32(s1, vmulq_f32(xj, vld1q_f32(y+l+j+4)));
+      s2 = vaddq_f32(s2, vmulq_f32(xj, vld1q_f32(y+l+j+8)));
+      s3 = vaddq_f32(s3, vmulq_f32(xj, vld1q_f32(y+l+j+12)));
+    }
+    vst1q_f32(c+l, s0);
+    vst1q_f32(c+l+4, s1);
+    vst1q_f32(c+l+8, s2);
+    vst1q_f32(c+l+12, s3);
+  }
+}
+#endif
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Correlations by the blocked engine; y is copied with zeros beyond
+ * ylen samples so that the kernels may run past the last lag.
+ */
+static int xcorr_block(float *x, int size, float *y, int ylen, int nlags,
+                       Sigproc_work *w)
+{
+  register int j, n;
+  float *c;
+
+  n = size + nlags + 16;
+  if(!xcorr_alloc(n, w))
+    return(FALSE);
+  for(j = 0; j < ylen; j++) w->xpad[j] = y[j];
+  for( ; j < n; j++) w->xpad[j] = 0.0;
+  y = w->xpad;
+  c = (float *) w->xim;         /* n doubles hold the rounded-up lags */
+
+#if defined(XCORR_X86)
+  switch(fftsimd_level()) {
+  case SPTK_SIMD_AVX2:
+    xcorr_lanes_avx2(x, size, y, nlags, c);
+    break;
+  case SPTK_SIMD_SSE2:
+    xcorr_lanes_sse2(x, size, y, nlags, c);
+    break;
+  default:
+    xcorr_lanes_scalar(x, size, y, nlags, c);
+    break;
+  }
+#elif defined(XCORR_NEON)
+  xcorr_lanes_neon(x, size, y, nlags, c);
+#else
+  xcorr_lanes_scalar(x, size, y, nlags, c);
+#endif
+
+  for(j = 0; j < nlags; j++)
+    w->xre[j] = c[j];
+
+  return(TRUE);
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Compute the nlags correlations c[l] = sum x[j]*y[j+l], j = 0..size-1,
+ * all at once with the engine selected in w, taking y as zero beyond
+ * ylen samples.  Returns the sums (valid until the next call), or NULL
+ * for the lag-by-lag engine or when the buffers cannot be allocated, in
+ * which case the caller computes the lags itself.
+ */
+static double *xcorr_lags(float *x, int size, float *y, int ylen, int nlags,
+                          Sigproc_work *w)
+{
+  if(ylen > size + nlags - 1)
+    ylen = size + nlags - 1;
+  switch(w->xcorr) {
+  case SIGPROC_XCORR_BLOCK:
+    return(xcorr_block(x, size, y, ylen, nlags, w) ? w->xre : NULL);
+  case SIGPROC_XCORR_FFT:
+    return(xcorr_fft(x, size, y, ylen, nlags, w) ? w->xre : NULL);
+  default:
+    return(NULL);
+  }
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* xautoc() with the lags from xcorr_lags(); used by xlpc() unless w
+ * selects the lag-by-lag engine.
+ */
+static void xautoc_lags(int windowsize, float *s, int p, float *r, float *e,
+                        Sigproc_work *w)
+{
+  register int i;
+  register float sum0;
+  double *c;
+
+  if(!(c = xcorr_lags(s, windowsize, s, windowsize, p + 1, w))) {
+    xautoc(windowsize, s, p, r, e);
+    return;
+  }
+  *r = 1.;
+  if((sum0 = (float) c[0]) <= 0.0) {
+    *e = 1.;
+    for ( i=1; i<=p; i++){
+      r[i] = 0.;
+    }
+    return;
+  }
+  *e = (float) sqrt((double)(sum0/windowsize));
+  sum0 = (float) (1.0/sum0);
+  for( i=1; i <= p; i++)
+    r[i] = ((float) c[i])*sum0;
+}
+
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Compute the pp+1 autocorrelation lags of the windowsize samples in s.
  * Return the normalized autocorrelation coefficients in r.
@@ -368,28 +650,31 @@ float xitakura(register int p, register float *b, register float *c,
  * is weighted by a window of type w_type before RMS computation.  w_type
  * is decoded above in window().
  */
-float wind_energy(register float *data, register int size, register int w_type)
+float wind_energy(register float *data, register int size, register int w_type,
+                  Sigproc_work *w)
 {
-  static int nwind = 0;
-  static float *dwind = NULL;
   register float *dp, sum, f;
   register int i;
 
-  if(nwind < size) {
-    if (dwind)
-        dwind = (float *) realloc((void *) dwind, size * sizeof(float));
+  if(w->ewind_size < size) {
+    if (w->ewind)
+        w->ewind = (float *) realloc((void *) w->ewind, size * sizeof(float));
     else
-        dwind = (float *) malloc(size * sizeof(float));
-    if(!dwind) {
+        w->ewind = (float *) malloc(size * sizeof(float));
+    if(!w->ewind) {
       Fprintf(stderr,"Can't allocate scratch memory in wind_energy()\n");
+      w->ewind_size = 0;
       return(0.0);
     }
+    w->ewind_size = size;
+    w->ewind_type = -1;
   }
-  if(nwind != size) {
-    xget_window(dwind, size, w_type);
-    nwind = size;
+  if(w->ewind_n != size || w->ewind_type != w_type) {
+    xget_window(w->ewind, size, w_type, w);
+    w->ewind_n = size;
+    w->ewind_type = w_type;
   }
-  for(i=size, dp = dwind, sum = 0.0; i-- > 0; ) {
+  for(i=size, dp = w->ewind, sum = 0.0; i-- > 0; ) {
     f = *dp++ * (float)(*data++);
     sum += f*f;
   }
@@ -402,31 +687,33 @@ float wind_energy(register float *data, register int size, register int w_type)
  */
 int xlpc(int lpc_ord, float lpc_stabl, int wsize, float *data, float *lpca,
          float *ar, float *lpck, float *normerr, float *rms, float preemp,
-         int type)
+         int type, Sigproc_work *w)
 {
-  static float *dwind=NULL;
-  static int nwind=0;
   float rho[BIGSORD+1], k[BIGSORD], a[BIGSORD+1],*r,*kp,*ap,en,er,wfact=1.0;
 
   if((wsize <= 0) || (!data) || (lpc_ord > BIGSORD)) return(FALSE);
 
-  if(nwind != wsize) {
-    if (dwind)
-        dwind = (float *) realloc((void *) dwind, wsize * sizeof(float));
+  if(w->lwind_size != wsize) {
+    if (w->lwind)
+        w->lwind = (float *) realloc((void *) w->lwind, wsize * sizeof(float));
     else
-        dwind = (float *) malloc(wsize * sizeof(float));
-    if(!dwind) {
+        w->lwind = (float *) malloc(wsize * sizeof(float));
+    if(!w->lwind) {
       Fprintf(stderr,"Can't allocate scratch memory in lpc()\n");
+      w->lwind_size = 0;
       return(FALSE);
     }
-    nwind = wsize;
+    w->lwind_size = wsize;
   }
 
-  sigproc_window(data, dwind, wsize, preemp, type);
+  sigproc_window(data, w->lwind, wsize, preemp, type, w);
   if(!(r = ar)) r = rho;	/* Permit optional return of the various */
   if(!(kp = lpck)) kp = k;	/* coefficients and intermediate results. */
   if(!(ap = lpca)) ap = a;
-  xautoc( wsize, dwind, lpc_ord, r, &en );
+  if(w->xcorr != SIGPROC_XCORR_DIRECT)
+    xautoc_lags( wsize, w->lwind, lpc_ord, r, &en, w );
+  else
+    xautoc( wsize, w->lwind, lpc_ord, r, &en );
   if(lpc_stabl > 1.0) {	/* add a little to the diagonal for stability */
     int i;
     float ffact;
@@ -474,37 +761,37 @@ int xlpc(int lpc_ord, float lpc_stabl, int wsize, float *data, float *lpca,
  *
  */
 void crossf(float *data, int size, int start, int nlags, float *engref,
-            int *maxloc, float *maxval, float *correl)
+            int *maxloc, float *maxval, float *correl,
+            Sigproc_work *w)
 {
-  static float *dbdata=NULL;
-  static int dbsize = 0;
   register float *dp, *ds, sum, st;
   register int j;
   register  float *dq, t, *p, engr, *dds, amax;
   register  double engc;
   int i, iloc, total;
+  double *xc;
 
   /* Compute mean in reference window and subtract this from the
      entire sequence.  This doesn't do too much damage to the data
      sequenced for the purposes of F0 estimation and removes the need for
      more principled (and costly) low-cut filtering. */
-  if((total = size+start+nlags) > dbsize) {
-    if(dbdata)
-      free((void *)dbdata);
-    dbdata = NULL;
-    dbsize = 0;
-    if(!(dbdata = (float*)malloc(sizeof(float)*total))) {
+  if((total = size+start+nlags) > w->dbdata_size) {
+    if(w->dbdata)
+      free((void *)w->dbdata);
+    w->dbdata = NULL;
+    w->dbdata_size = 0;
+    if(!(w->dbdata = (float*)malloc(sizeof(float)*total))) {
       Fprintf(stderr,"Allocation failure in crossf()\n");
       return;/*exit(-1);*/
     }
-    dbsize = total;
+    w->dbdata_size = total;
   }
   for(engr=0.0, j=size, p=data; j--; ) engr += *p++;
   engr /= size;
-  for(j=size+nlags+start, dq = dbdata, p=data; j--; )  *dq++ = *p++ - engr;
+  for(j=size+nlags+start, dq = w->dbdata, p=data; j--; )  *dq++ = *p++ - engr;
 
   /* Compute energy in reference window. */
-  for(j=size, dp=dbdata, sum=0.0; j--; ) {
+  for(j=size, dp=w->dbdata, sum=0.0; j--; ) {
     st = *dp++;
     sum += st * st;
   }
@@ -512,16 +799,24 @@ void crossf(float *data, int size, int start, int nlags, float *engref,
   *engref = engr = sum;
   if(engr > 0.0) {    /* If there is any signal energy to work with... */
     /* Compute energy at the first requested lag. */
-    for(j=size, dp=dbdata+start, sum=0.0; j--; ) {
+    for(j=size, dp=w->dbdata+start, sum=0.0; j--; ) {
       st = *dp++;
       sum += st * st;
     }
     engc = sum;
 
+    /* Get the products at all lags at once, unless done lag by lag. */
+    xc = xcorr_lags(w->dbdata, size, w->dbdata+start, size+nlags-1, nlags, w);
+
     /* COMPUTE CORRELATIONS AT ALL OTHER REQUESTED LAGS. */
     for(i=0, dq=correl, amax=0.0, iloc = -1; i < nlags; i++) {
-      for(j=size, sum=0.0, dp=dbdata, dds = ds = dbdata+i+start; j--; )
-	sum += *dp++ * *ds++;
+      dds = ds = w->dbdata+i+start;
+      if(xc) {
+	sum = (float) xc[i];
+	ds += size;
+      } else
+	for(j=size, sum=0.0, dp=w->dbdata; j--; )
+	  sum += *dp++ * *ds++;
       *dq++ = t = (float) (sum/sqrt((double)(engc*engr))); /* output norm. CC */
       engc -= (double)(*dds * *dds); /* adjust norm. energy for next lag */
       if((engc += (double)(*ds * *ds)) < 1.0)
@@ -565,37 +860,36 @@ void crossf(float *data, int size, int start, int nlags, float *engref,
  */
 void crossfi(float *data, int size, int start0, int nlags0, int nlags,
              float *engref, int *maxloc, float *maxval, float *correl,
-             int *locs, int nlocs)
+             int *locs, int nlocs, Sigproc_work *w)
 {
-  static float *dbdata=NULL;
-  static int dbsize = 0;
   register float *dp, *ds, sum, st;
   register int j;
   register  float *dq, t, *p, engr, *dds, amax;
   register  double engc;
-  int i, iloc, start, total;
+  int i, iloc, start, total, lo, hi;
+  double *xc;
 
   /* Compute mean in reference window and subtract this from the
      entire sequence. */
-  if((total = size+start0+nlags0) > dbsize) {
-    if (dbdata)
-        free((void *) dbdata);
-    dbdata = NULL;
-    dbsize = 0;
-    if (!(dbdata = (float *) malloc(sizeof(float) * total))) {
+  if((total = size+start0+nlags0) > w->dbdatai_size) {
+    if (w->dbdatai)
+        free((void *) w->dbdatai);
+    w->dbdatai = NULL;
+    w->dbdatai_size = 0;
+    if (!(w->dbdatai = (float *) malloc(sizeof(float) * total))) {
         Fprintf(stderr, "Allocation failure in crossf()\n");
         return;             /*exit(-1); */
     }
-    dbsize = total;
+    w->dbdatai_size = total;
   }
   for(engr=0.0, j=size, p=data; j--; ) engr += *p++;
   engr /= size;
-/*  for(j=size+nlags0+start0, t = -2.1, amax = 2.1, dq = dbdata, p=data; j--; ) {
+/*  for(j=size+nlags0+start0, t = -2.1, amax = 2.1, dq = w->dbdatai, p=data; j--; ) {
     if(((smax = *p++ - engr) > t) && (smax < amax))
       smax = 0.0;
     *dq++ = smax;
   } */
-  for(j=size+nlags0+start0, dq = dbdata, p=data; j--; ) {
+  for(j=size+nlags0+start0, dq = w->dbdatai, p=data; j--; ) {
     *dq++ = *p++ - engr;
   }
 
@@ -605,7 +899,7 @@ void crossfi(float *data, int size, int start0, int nlags0, int nlags,
     *p++ = 0.0;
 
   /* compute energy in reference window */
-  for(j=size, dp=dbdata, sum=0.0; j--; ) {
+  for(j=size, dp=w->dbdatai, sum=0.0; j--; ) {
     st = *dp++;
     sum += st * st;
   }
@@ -614,13 +908,31 @@ void crossfi(float *data, int size, int start0, int nlags0, int nlags,
    amax=0.0;
   iloc = -1;
   if(engr > 0.0) {
+    /* The fft engine gets the products over the span of all the
+       patches at once, the blocked one patch by patch below. */
+    xc = NULL;
+    lo = 0;
+    if(w->xcorr == SIGPROC_XCORR_FFT && nlocs > 0) {
+      for(i=0, lo=total, hi=0; i < nlocs; i++) {
+	if((start = locs[i] - (nlags>>1)) < start0)
+	  start = start0;
+	if(start < lo) lo = start;
+	if(start + nlags > hi) hi = start + nlags;
+      }
+      xc = xcorr_lags(w->dbdatai, size, w->dbdatai+lo, total-lo, hi-lo, w);
+    }
     for( ; nlocs > 0; nlocs--, locs++ ) {
       start = *locs - (nlags>>1);
       if(start < start0)
 	start = start0;
       dq = correl + start - start0;
+      if(w->xcorr == SIGPROC_XCORR_BLOCK) {
+	xc = xcorr_lags(w->dbdatai, size, w->dbdatai+start, total-start,
+			nlags, w);
+	lo = start;
+      }
       /* compute energy at first requested lag */
-      for(j=size, dp=dbdata+start, sum=0.0; j--; ) {
+      for(j=size, dp=w->dbdatai+start, sum=0.0; j--; ) {
 	st = *dp++;
 	sum += st * st;
       }
@@ -628,8 +940,13 @@ void crossfi(float *data, int size, int start0, int nlags0, int nlags,
 
       /* COMPUTE CORRELATIONS AT ALL REQUESTED LAGS */
       for(i=0; i < nlags; i++) {
-	for(j=size, sum=0.0, dp=dbdata, dds = ds = dbdata+i+start; j--; )
-	  sum += *dp++ * *ds++;
+	dds = ds = w->dbdatai+i+start;
+	if(xc) {
+	  sum = (float) xc[i+start-lo];
+	  ds += size;
+	} else
+	  for(j=size, sum=0.0, dp=w->dbdatai; j--; )
+	    sum += *dp++ * *ds++;
 	if(engc < 1.0)
 	  engc = 1.0;		/* in case of roundoff error */
 	*dq++ = t = (float) (sum/sqrt((double)(10000.0 + (engc*engr))));
@@ -648,3 +965,27 @@ void crossfi(float *data, int size, int start0, int nlags0, int nlags,
     *maxval = 0.0;
   }
 }
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Release the scratch memory and cached windows held in w, which is
+ * left ready for reuse with the same correlation engine.
+ */
+void free_sigproc_work(Sigproc_work *w)
+{
+  int xcorr;
+
+  free((void *) w->din);
+  free((void *) w->cwind);
+  free((void *) w->hwind);
+  free((void *) w->hnwind);
+  free((void *) w->ewind);
+  free((void *) w->lwind);
+  free((void *) w->dbdata);
+  free((void *) w->dbdatai);
+  free((void *) w->xre);
+  free((void *) w->xim);
+  free((void *) w->xpad);
+  xcorr = w->xcorr;
+  memset((void *) w, 0, sizeof(*w));
+  w->xcorr = xcorr;
+}
@@ -5,17 +5,51 @@
 
 #define Fprintf (void) fprintf
 
-int xget_window(register float *dout, register int n, register int type);
+/* scratch memory and cached windows of the functions below, so that
+   each caller (e.g. each pitch tracker) has its own; zero it before
+   the first use and release it with free_sigproc_work() */
+typedef struct sigproc_work {
+  float *din;           /* unit data for xget_window() */
+  int n0;
+  float *cwind;         /* cos^4 window of xcwindow() */
+  int cwind_size;
+  float *hwind;         /* Hamming window of xhwindow() */
+  int hwind_size;
+  float *hnwind;        /* Hanning window of xhnwindow() */
+  int hnwind_size;
+  float *ewind;         /* window of wind_energy() */
+  int ewind_size, ewind_n, ewind_type;
+  float *lwind;         /* windowed data of xlpc() */
+  int lwind_size;
+  float *dbdata;        /* mean-removed data of crossf() */
+  int dbdata_size;
+  float *dbdatai;       /* mean-removed data of crossfi() */
+  int dbdatai_size;
+  int xcorr;            /* correlation engine: SIGPROC_XCORR_* */
+  double *xre, *xim;    /* sums of xcorr_lags(), and fft buffers */
+  float *xpad;          /* zero-padded data of the blocked engine */
+  int xsize;
+} Sigproc_work;
+
+/* Correlation engines of xlpc(), crossf() and crossfi(): lag by lag,
+   several lags per SIMD vector with the same sums, or all lags at once
+   by fft in double precision */
+#define SIGPROC_XCORR_DIRECT 0
+#define SIGPROC_XCORR_BLOCK 1
+#define SIGPROC_XCORR_FFT 2
+
+int xget_window(register float *dout, register int n, register int type,
+                Sigproc_work *w);
 void xrwindow(register float *din, register float *dout, register int n,
               register float preemp);
 void xcwindow(register float *din, register float *dout, register int n,
-              register float preemp);
+              register float preemp, Sigproc_work *w);
 void xhwindow(register float *din, register float *dout, register int n,
-              register float preemp);
+              register float preemp, Sigproc_work *w);
 void xhnwindow(register float *din, register float *dout, register int n,
-               register float preemp);
+               register float preemp, Sigproc_work *w);
 int sigproc_window(register float *din, register float *dout, register int n,
-                   register float preemp, int type);
+                   register float preemp, int type, Sigproc_work *w);
 void xautoc(register int windowsize, register float *s, register int p,
             register float *r, register float *e);
 void xdurbin(register float *r, register float *k, register float *a,
@@ -23,14 +57,16 @@ void xdurbin(register float *r, register float *k, register float *a,
 void xa_to_aca(float *a, float *b, float *c, register int p);
 float xitakura(register int p, register float *b, register float *c,
                register float *r, register float *gain);
-float wind_energy(register float *data, register int size, register int w_type);
+float wind_energy(register float *data, register int size, register int w_type,
+                  Sigproc_work *w);
 int xlpc(int lpc_ord, float lpc_stabl, int wsize, float *data, float *lpca,
          float *ar, float *lpck, float *normerr, float *rms, float preemp,
-         int type);
+         int type, Sigproc_work *w);
 void crossf(float *data, int size, int start, int nlags, float *engref,
-            int *maxloc, float *maxval, float *correl);
+            int *maxloc, float *maxval, float *correl, Sigproc_work *w);
 void crossfi(float *data, int size, int start0, int nlags0, int nlags,
              float *engref, int *maxloc, float *maxval, float *correl,
-             int *locs, int nlocs);
+             int *locs, int nlocs, Sigproc_work *w);
+void free_sigproc_work(Sigproc_work *w);
 
 #endif /* SIGPROC_H_ */
@@ -77,6 +77,12 @@
 
 #include "../../dllexport.h"
 
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
 #if 0
 #include <fftw3.h>   /* http://www.fftw.org/ */
 #include <sndfile.h> /* http://www.mega-nerd.com/libsndfile/ */
@@ -84,6 +90,22 @@
 
 #include "vector.h"  /* comes with release */
 
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) \
+    || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#define SWIPE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SWIPE_NEON
+#include <arm_neon.h>
+#endif
+
 #define NOK      0
 
 #define DERBS    .1
@@ -142,149 +164,205 @@ double fixnan(double x) {
     return(isnan(x) ? 0. : x);
 }
 
-#if 1
-typedef double out_complex[2];
-typedef struct _float_list {
-    float f;
-    struct _float_list *next;
-} float_list;
-int fftr(double *x, double *y, const int m);
-int fwritef(double *ptr, const size_t size, const int nitems, FILE * fp);
-#endif
+/* the per-window-size part of the analysis, built once by swipe_create() */
+typedef struct {
+    int w;               /* window size */
+    int w2;              /* hop size, w / 2 */
+    vector hann;         /* the Hann[ing] window */
+    vector f;            /* frequency of each fft bin */
+    /* the part of spline() on f that does not depend on the spectrum */
+    vector dx;           /* f[i + 1] - f[i] */
+    vector dxx;          /* f[i + 1] - f[i - 1] */
+    vector sig;
+    vector p;
+    vector y2;           /* y2 before the backsubstitution */
+    double qd;           /* denominator of the right boundary */
+    /* the part of splinv() at each ERB that does not depend on the spectrum */
+    intvector hi;
+    vector ca, cb;       /* linear weights */
+    vector ca3, cb3;     /* cubic weights */
+    vector ch;           /* squared knot interval */
+    TWIDDLE* tw[2];      /* the tables fftr() uses for w, held while alive */
+} swipe_window;
 
-/* a helper function for loudness() for individual fft slices */
-#if 0
-void La(matrix L, vector f, vector fERBs, fftw_plan plan,
-                            fftw_complex* fo, int w2, int hi, int i) {
-    int j;
-    fftw_execute(plan);
-#else
-void La(matrix L, vector f, vector fERBs,
-	out_complex* fo, int w2, int hi, int i, double* fi) {
-    int j;
-
-    double* fi_tmp = malloc(sizeof(double) * w2*2);
-    double* fo_tmp = malloc(sizeof(double) * w2*2);
-    vector a, a2;
-    for(j=0;j<w2 * 2;j++){
-      fi_tmp[j] = fi[j];
-    }
-    fftr(fi_tmp,fo_tmp,w2*2);
-    for(j=0;j<w2*2;j++){
-      fo[j][0] = fi_tmp[j];
-      fo[j][1] = fo_tmp[j];
+struct _SWIPE_STATE {
+    int samplerate;
+    int frame_shift;
+    double st;
+    double dt;
+    double nyquist;
+    double nyquist2;
+    intvector ws;        /* window sizes */
+    intvector ps;        /* prime harmonics */
+    vector pc;           /* pitch candidates */
+    vector d;            /* log2 distance of each candidate to ws */
+    vector fERBs;        /* ERB-spaced frequencies */
+    matrix K;            /* kernel bank, see kernels() */
+    swipe_window* win;   /* one for each of ws */
+};
+
+/* precomputes the window, the fft tables and the spline setup for w */
+static void init_window(swipe_window* sw, vector fERBs, double nyquist,
+                        int w) {
+    int i, j, lo, hi;
+    int w2 = w / 2;
+    double td = nyquist / w2; /* this is equivalent to fstep */
+    double h, a, b;
+    sw->w = w;
+    sw->w2 = w2;
+    sw->hann = makev(w); /* this defines the Hann[ing] window */
+    for (i = 0; i < w; i++)
+        sw->hann.v[i] = .5 - (.5 * cos(2. * M_PI * ((double) i / w)));
+    sw->f = makev(w2);
+    for (i = 0; i < w2; i++)
+        sw->f.v[i] = i * td;
+    sw->dx = makev(w2);
+    sw->dxx = makev(w2);
+    sw->sig = makev(w2);
+    sw->p = makev(w2);
+    sw->y2 = makev(w2);
+    for (i = 0; i < w2 - 1; i++)
+        sw->dx.v[i] = sw->f.v[i + 1] - sw->f.v[i];
+    sw->y2.v[0] = -.5; /* left boundary */
+    for (i = 1; i < w2 - 1; i++) { /* decomp loop, as in spline() */
+        sw->dxx.v[i] = sw->f.v[i + 1] - sw->f.v[i - 1];
+        sw->sig.v[i] = (sw->f.v[i] - sw->f.v[i - 1]) / sw->dxx.v[i];
+        sw->p.v[i] = sw->sig.v[i] * sw->y2.v[i - 1] + 2.;
+        sw->y2.v[i] = (sw->sig.v[i] - 1.) / sw->p.v[i];
     }
-    free(fi_tmp);
-    free(fo_tmp);
-#endif
-    a = makev(w2);
-    for (j = 0; j < w2; j++) /* this iterates over only the first half */
-        a.v[j] = sqrt(fo[j][0] * fo[j][0] + fo[j][1] * fo[j][1]);
-    a2 = spline(f, a); /* a2 is now the result of the cubic spline */
-    L.m[i][0] = fixnan(sqrt(splinv(f, a, a2, fERBs.v[0], hi)));
-    for (j = 1; j < L.y; j++) { /* perform a bisection query at ERB intvls */
-        hi = bilookv(f, fERBs.v[j], hi);
-        L.m[i][j] = fixnan(sqrt(splinv(f, a, a2, fERBs.v[j], hi)));
+    sw->qd = .5 * sw->y2.v[w2 - 2] + 1.;
+    sw->hi = makeiv(fERBs.x);
+    sw->ca = makev(fERBs.x);
+    sw->cb = makev(fERBs.x);
+    sw->ca3 = makev(fERBs.x);
+    sw->cb3 = makev(fERBs.x);
+    sw->ch = makev(fERBs.x);
+    hi = bisectv(sw->f, fERBs.v[0]);
+    for (j = 0; j < fERBs.x; j++) { /* perform a bisection query at ERB intvls */
+        if (j > 0)
+            hi = bilookv(sw->f, fERBs.v[j], hi);
+        if (hi > w2 - 1) /* extrapolate from the last interval */
+            hi = w2 - 1;
+        lo = hi - 1;
+        h = sw->f.v[hi] - sw->f.v[lo];
+        a = (sw->f.v[hi] - fERBs.v[j]) / h;
+        b = (fERBs.v[j] - sw->f.v[lo]) / h;
+        sw->hi.v[j] = hi;
+        sw->ca.v[j] = a;
+        sw->cb.v[j] = b;
+        sw->ca3.v[j] = a * a * a - a;
+        sw->cb3.v[j] = b * b * b - b;
+        sw->ch.v[j] = h * h;
     }
-    freev(a);
-    freev(a2);
+    sw->tw[0] = acquire_TWIDDLE(TWIDDLE_FFT, w);
+    sw->tw[1] = acquire_TWIDDLE(TWIDDLE_FFT, w2);
 }
 
-/* a function for populating the loudness matrix with a signal x */
-matrix loudness(vector x, vector fERBs, double nyquist, int w, int w2) {
-    int i, j, hi;
-    int offset = 0;
-    double td = nyquist / w2; /* this is equivalent to fstep */
-    /* testing showed this configuration of fftw to be fastest */
-#if 0
-    double* fi = fftw_malloc(sizeof(double) * w);
-    fftw_complex* fo = fftw_malloc(sizeof(fftw_complex) * w);
-    fftw_plan plan = fftw_plan_dft_r2c_1d(w, fi, fo, FFTW_ESTIMATE);
-#else
-    double* fi = malloc(sizeof(double) * w);
-    out_complex* fo = malloc(sizeof(out_complex) * w);
-    vector hann, f;
+static void free_window(swipe_window* sw) {
+    freev(sw->hann);
+    freev(sw->f);
+    freev(sw->dx);
+    freev(sw->dxx);
+    freev(sw->sig);
+    freev(sw->p);
+    freev(sw->y2);
+    freeiv(sw->hi);
+    freev(sw->ca);
+    freev(sw->cb);
+    freev(sw->ca3);
+    freev(sw->cb3);
+    freev(sw->ch);
+    release_TWIDDLE(sw->tw[0]);
+    release_TWIDDLE(sw->tw[1]);
+}
+
+/* arguments of La(), shared by all columns of one loudness matrix */
+typedef struct {
+    const swipe_window* sw;
+    vector x;
+    vector fERBs;
     matrix L;
-#endif
-    hann = makev(w); /* this defines the Hann[ing] window */
-    for (i = 0; i < w; i++)
-        hann.v[i] = .5 - (.5 * cos(2. * M_PI * ((double) i / w)));
-    f = makev(w2);
-    for (i = 0; i < w2; i++)
-        f.v[i] = i * td;
-    hi = bisectv(f, fERBs.v[0]); /* all calls to La() will begin here */
-    L = makem(ceil((double) x.x / w2) + 1, fERBs.x);
-    for (j = 0; j < w2; j++) /* left boundary case */
-        fi[j] = 0.; /* more explicitly, 0. * hann.v[j] */
-    for (/* j = w2 */; j < w; j++)
-        fi[j] = x.v[j - w2] * hann.v[j];
-#if 0
-    La(L, f, fERBs, plan, fo, w2, hi, 0);
-#else
-    La(L, f, fERBs, fo, w2, hi, 0, fi);
-#endif
-    for (i = 1; i < L.x - 2; i++) {
-        for (j = 0; j < w; j++)
-            fi[j] = x.v[j + offset] * hann.v[j];
-#if 0
-        La(L, f, fERBs, plan, fo, w2, hi, i);
-#else
-	La(L, f, fERBs, fo, w2, hi, i, fi);
-#endif
-        offset += w2;
+    double* work;        /* WORKSIZE(w) values for each thread */
+} loudness_job;
+
+#define WORKSIZE(w)    ((w) * 2 + ((w) / 2) * 3)
+
+/* a helper function for loudness() for individual fft slices; column i
+ * only reads x and the window, so the columns may run in any order */
+static void La(void* arg, const int thread, const int i) {
+    loudness_job* job = (loudness_job*) arg;
+    const swipe_window* sw = job->sw;
+    matrix L = job->L;
+    int j, k, lo, hi;
+    int w = sw->w;
+    int w2 = sw->w2;
+    int offset = (i - 1) * w2; /* the first column is centered on 0 */
+    double td;
+    double* fi = job->work + thread * WORKSIZE(job->sw->w);
+    double* fo = fi + w;
+    double* a = fo + w;
+    double* u = a + w2;
+    double* y2 = u + w2;
+    for (j = 0; j < w; j++) { /* zero outside x, i.e. 0. * hann.v[j] */
+        k = j + offset;
+        fi[j] = (k >= 0 && k < job->x.x) ? job->x.v[k] * sw->hann.v[j] : 0.;
     }
-    for (/* i = L.x - 2; */; i < L.x; i++) { /* right two boundary cases */
-        for (j = 0; j < x.x - offset; j++) /* this dies at x.x + w2 */
-            fi[j] = x.v[j + offset] * hann.v[j];
-        for (/* j = x.x - offset */; j < w; j++)
-            fi[j] = 0.; /* once again, 0. * hann.v[j] */
-#if 0
-        La(L, f, fERBs, plan, fo, w2, hi, i);
-#else
-	La(L, f, fERBs, fo, w2, hi, i, fi);
-#endif
-        offset += w2;
-    } /* now L is fully valued */
-    freev(hann);
-    freev(f);
-    /* L must now be normalized */
-    for (i = 0; i < L.x; i++) {
-        td = 0.; /* td is the value of the normalization factor */
-        for (j = 0; j < L.y; j++)
-            td += L.m[i][j] * L.m[i][j];
-        if (td != 0.) { /* catches zero-division */
-            td = sqrt(td);
-            for (j = 0; j < L.y; j++)
-                L.m[i][j] /= td;
-        } /* otherwise, it is already 0. */
+    fftr(fi, fo, w);
+    for (j = 0; j < w2; j++) /* this iterates over only the first half */
+        a[j] = sqrt(fi[j] * fi[j] + fo[j] * fo[j]);
+    /* the cubic spline of a, as spline() with the setup precomputed */
+    u[0] = (3. / sw->dx.v[0]) * ((a[1] - a[0]) / sw->dx.v[0] - YP1);
+    for (j = 1; j < w2 - 1; j++) {
+        u[j] = (a[j + 1] - a[j]) / sw->dx.v[j] -
+               (a[j] - a[j - 1]) / sw->dx.v[j - 1];
+        u[j] = (6 * u[j] / sw->dxx.v[j] - sw->sig.v[j] * u[j - 1]) /
+               sw->p.v[j];
     }
-#if 0
-    fftw_destroy_plan(plan);
-    fftw_free(fi);
-    fftw_free(fo);
-#else
-    free(fi);
-    free(fo);
-#endif
-    return(L);
+    y2[w2 - 1] = ((3. / sw->dx.v[w2 - 2]) * (YPN - (a[w2 - 1] - a[w2 - 2]) /
+                  sw->dx.v[w2 - 2]) - .5 * u[w2 - 2]) / sw->qd;
+    for (j = w2 - 2; j >= 0; j--) /* backsubstitution loop */
+        y2[j] = sw->y2.v[j] * y2[j + 1] + u[j];
+    td = 0.; /* td is the value of the normalization factor */
+    for (j = 0; j < L.y; j++) { /* query the spline, as splinv() */
+        hi = sw->hi.v[j];
+        lo = hi - 1;
+        L.m[i][j] = fixnan(sqrt(sw->ca.v[j] * a[lo] + sw->cb.v[j] * a[hi] +
+                                (sw->ca3.v[j] * y2[lo] * sw->cb3.v[j] *
+                                 y2[hi]) * sw->ch.v[j] / 6.));
+        td += L.m[i][j] * L.m[i][j];
+    }
+    if (td != 0.) { /* catches zero-division */
+        td = sqrt(td);
+        for (j = 0; j < L.y; j++)
+            L.m[i][j] /= td;
+    } /* otherwise, it is already 0. */
 }
 
-/* populates the strength matrix using the loudness matrix */
-void Sadd(matrix S, matrix L, vector fERBs, vector pci, vector mu,
-                                            intvector ps, double dt,
-                                            double nyquist2, int lo,
-                                            int psz, int w2) {
+/* a function for populating the loudness matrix with a signal x */
+matrix loudness(const swipe_window* sw, vector x, vector fERBs,
+                double* work, THREADPOOL* pool) {
+    loudness_job job;
+    job.sw = sw;
+    job.x = x;
+    job.fERBs = fERBs;
+    job.L = makem(ceil((double) x.x / sw->w2) + 1, fERBs.x);
+    job.work = work;
+    run_THREADPOOL(pool, job.L.x, La, &job);
+    return(job.L); /* now L is fully valued and normalized */
+}
+
+/* builds the kernel bank: column i of K is the normalized kernel of the
+ * pitch candidate pc.v[i], stored by ERB so that the kernels of four
+ * neighboring candidates are contiguous */
+static matrix kernels(vector pc, vector fERBs, intvector ps) {
     int i, j, k;
-    double t = 0.;
-    double tp = 0.;
     double td;
-    double dtp = w2 / nyquist2;
-    vector q, kernel;
-    matrix Slocal = zerom(psz, L.x);
-    for (i = 0; i < Slocal.x; i++) {
-        q = makev(fERBs.x);
-        for (j = 0; j < q.x; j++) q.v[j] = fERBs.v[j] / pci.v[i];
-        kernel = zerov(fERBs.x); /* a zero-filled kernel vector */
+    vector q = makev(fERBs.x);
+    vector kernel = makev(fERBs.x);
+    matrix K = makem(fERBs.x, pc.x);
+    for (i = 0; i < pc.x; i++) {
+        for (j = 0; j < q.x; j++) q.v[j] = fERBs.v[j] / pc.v[i];
+        for (j = 0; j < kernel.x; j++) kernel.v[j] = 0.;
         for (j = 0; j < ps.x; j++) {
             if PRIME(ps.v[j]) {
                 for (k = 0; k < kernel.x; k++) {
@@ -296,7 +374,6 @@ void Sadd(matrix S, matrix L, vector fERBs, vector pci, vector mu,
                 }
             }
         }
-        freev(q);
         td = 0.;
         for (j = 0; j < kernel.x; j++) {
             kernel.v[j] *= sqrt(1. / fERBs.v[j]); /* applying the envelope */
@@ -305,13 +382,204 @@ void Sadd(matrix S, matrix L, vector fERBs, vector pci, vector mu,
         }
         td = sqrt(td); /* now, td is the p=2 norm factor */
         for (j = 0; j < kernel.x; j++) /* normalize the kernel */
-            kernel.v[j] /= td;
-        for (j = 0; j < L.x; j++) {
-            for (k = 0; k < L.y; k++)
-                Slocal.m[i][j] += kernel.v[k] * L.m[j][k]; /* i.e, kernel' * L */
+            K.m[j][i] = kernel.v[j] / td;
+    }
+    freev(q);
+    freev(kernel);
+    return(K);
+}
+
+#define SPANEL    64 /* columns of Slocal for one job of Spanel() */
+#define STILE     8  /* candidates of the widest tile */
+
+/* arguments of Spanel(), shared by all panels of one Slocal */
+typedef struct {
+    matrix Slocal;
+    matrix K;
+    matrix L;
+    int lo;
+} strength_job;
+
+/* tiles of Slocal = K' * L: s[jj * STILE + ii] is the product of the
+ * kernel of candidate c + ii and column jj of l, for nc candidates and 4
+ * columns; each candidate takes one vector lane, and every lane adds its
+ * products over the ERBs in order, without fused multiply-add, so the
+ * sums are the same as in the plain triple loop */
+static void Stile_scalar(matrix K, int c, int nc, double** l, double* s) {
+    int k, ii, jj;
+    const double* kt;
+    double b[4];
+    for (jj = 0; jj < 4; jj++)
+        for (ii = 0; ii < nc; ii++)
+            s[jj * STILE + ii] = 0.;
+    for (k = 0; k < K.x; k++) {
+        kt = K.m[k] + c;
+        for (jj = 0; jj < 4; jj++)
+            b[jj] = l[jj][k];
+        for (jj = 0; jj < 4; jj++)
+            for (ii = 0; ii < nc; ii++)
+                s[jj * STILE + ii] += kt[ii] * b[jj];
+    }
+}
+
+#if defined(SWIPE_X86)
+TARGET_AVX2 static void Stile_avx2(matrix K, int c, double** l, double* s) {
+    int k;
+    __m256d k0, k1, b;
+    __m256d s00, s01, s10, s11, s20, s21, s30, s31;
+    s00 = s01 = s10 = s11 = s20 = s21 = s30 = s31 = _mm256_setzero_pd();
+    for (k = 0; k < K.x; k++) {
+        k0 = _mm256_loadu_pd(K.m[k] + c);
+        k1 = _mm256_loadu_pd(K.m[k] + c + 4);
+        b = _mm256_set1_pd(l[0][k]);
+        s00 = _mm256_add_pd(s00, _mm256_mul_pd(k0, b));
+        s01 = _mm256_add_pd(s01, _mm256_mul_pd(k1, b));
+        b = _mm256_set1_pd(l[1][k]);
+        s10 = _mm256_add_pd(s10, _mm256_mul_pd(k0, b));
+        s11 = _mm256_add_pd(s11, _mm256_mul_pd(k1, b));
+        b = _mm256_set1_pd(l[2][k]);
+        s20 = _mm256_add_pd(s20, _mm256_mul_pd(k0, b));
+        s21 = _mm256_add_pd(s21, _mm256_mul_pd(k1, b));
+        b = _mm256_set1_pd(l[3][k]);
+        s30 = _mm256_add_pd(s30, _mm256_mul_pd(k0, b));
+        s31 = _mm256_add_pd(s31, _mm256_mul_pd(k1, b));
+    }
+    _mm256_storeu_pd(s, s00);
+    _mm256_storeu_pd(s + 4, s01);
+    _mm256_storeu_pd(s + STILE, s10);
+    _mm256_storeu_pd(s + STILE + 4, s11);
+    _mm256_storeu_pd(s + 2 * STILE, s20);
+    _mm256_storeu_pd(s + 2 * STILE + 4, s21);
+    _mm256_storeu_pd(s + 3 * STILE, s30);
+    _mm256_storeu_pd(s + 3 * STILE + 4, s31);
+}
+
+TARGET_SSE2 static void Stile_sse2(matrix K, int c, double** l, double* s) {
+    int k;
+    __m128d k0, k1, b;
+    __m128d s00, s01, s10, s11, s20, s21, s30, s31;
+    s00 = s01 = s10 = s11 = s20 = s21 = s30 = s31 = _mm_setzero_pd();
+    for (k = 0; k < K.x; k++) {
+        k0 = _mm_loadu_pd(K.m[k] + c);
+        k1 = _mm_loadu_pd(K.m[k] + c + 2);
+        b = _mm_set1_pd(l[0][k]);
+        s00 = _mm_add_pd(s00, _mm_mul_pd(k0, b));
+        s01 = _mm_add_pd(s01, _mm_mul_pd(k1, b));
+        b = _mm_set1_pd(l[1][k]);
+        s10 = _mm_add_pd(s10, _mm_mul_pd(k0, b));
+        s11 = _mm_add_pd(s11, _mm_mul_pd(k1, b));
+        b = _mm_set1_pd(l[2][k]);
+        s20 = _mm_add_pd(s20, _mm_mul_pd(k0, b));
+        s21 = _mm_add_pd(s21, _mm_mul_pd(k1, b));
+        b = _mm_set1_pd(l[3][k]);
+        s30 = _mm_add_pd(s30, _mm_mul_pd(k0, b));
+        s31 = _mm_add_pd(s31, _mm_mul_pd(k1, b));
+    }
+    _mm_storeu_pd(s, s00);
+    _mm_storeu_pd(s + 2, s01);
+    _mm_storeu_pd(s + STILE, s10);
+    _mm_storeu_pd(s + STILE + 2, s11);
+    _mm_storeu_pd(s + 2 * STILE, s20);
+    _mm_storeu_pd(s + 2 * STILE + 2, s21);
+    _mm_storeu_pd(s + 3 * STILE, s30);
+    _mm_storeu_pd(s + 3 * STILE + 2, s31);
+}
+#elif defined(SWIPE_NEON)
+static void Stile_neon(matrix K, int c, double** l, double* s) {
+    int k;
+    float64x2_t k0, k1, b;
+    float64x2_t s00, s01, s10, s11, s20, s21, s30, s31;
+    s00 = s01 = s10 = s11 = s20 = s21 = s30 = s31 = vdupq_n_f64(0.);
+    for (k = 0; k < K.x; k++) {
+        k0 = vld1q_f64(K.m[k] + c);
+        k1 = vld1q_f64(K.m[k] + c + 2);
+        b = vdupq_n_f64(l[0][k]);
+        s00 = vaddq_f64(s00, vmulq_f64(k0, b));
+        s01 = vaddq_f64(s01, vmulq_f64(k1, b));
+        b = vdupq_n_f64(l[1][k]);
+        s10 = vaddq_f64(s10, vmulq_f64(k0, b));
+        s11 = vaddq_f64(s11, vmulq_f64(k1, b));
+        b = vdupq_n_f64(l[2][k]);
+        s20 = vaddq_f64(s20, vmulq_f64(k0, b));
+        s21 = vaddq_f64(s21, vmulq_f64(k1, b));
+        b = vdupq_n_f64(l[3][k]);
+        s30 = vaddq_f64(s30, vmulq_f64(k0, b));
+        s31 = vaddq_f64(s31, vmulq_f64(k1, b));
+    }
+    vst1q_f64(s, s00);
+    vst1q_f64(s + 2, s01);
+    vst1q_f64(s + STILE, s10);
+    vst1q_f64(s + STILE + 2, s11);
+    vst1q_f64(s + 2 * STILE, s20);
+    vst1q_f64(s + 2 * STILE + 2, s21);
+    vst1q_f64(s + 3 * STILE, s30);
+    vst1q_f64(s + 3 * STILE + 2, s31);
+}
+#endif
+
+/* one panel of SPANEL columns of Slocal for candidates lo, lo + 1, ... */
+static void Spanel(void* arg, const int thread, const int panel) {
+    strength_job* job = (strength_job*) arg;
+    matrix Slocal = job->Slocal;
+    matrix K = job->K;
+    matrix L = job->L;
+    int i, j, ii, jj, ni, nj, nt;
+    int j0 = panel * SPANEL;
+    int j1 = (j0 + SPANEL < L.x) ? j0 + SPANEL : L.x;
+    double s[4 * STILE];
+    double* l[4];
+#if defined(SWIPE_X86)
+    int level = fftsimd_level();
+    nt = (level == SPTK_SIMD_AVX2) ? 8 : 4;
+#else
+    nt = 4;
+#endif
+    for (i = 0; i < Slocal.x; i += nt) {
+        ni = (Slocal.x - i < nt) ? Slocal.x - i : nt;
+        for (j = j0; j < j1; j += 4) {
+            nj = (j1 - j < 4) ? j1 - j : 4;
+            for (jj = 0; jj < 4; jj++) /* repeat the last column at the edge */
+                l[jj] = L.m[(jj < nj) ? j + jj : j];
+            if (ni < nt)
+                Stile_scalar(K, job->lo + i, ni, l, s);
+            else
+#if defined(SWIPE_X86)
+            if (level == SPTK_SIMD_AVX2)
+                Stile_avx2(K, job->lo + i, l, s);
+            else if (level == SPTK_SIMD_SSE2)
+                Stile_sse2(K, job->lo + i, l, s);
+            else
+                Stile_scalar(K, job->lo + i, ni, l, s);
+#elif defined(SWIPE_NEON)
+                Stile_neon(K, job->lo + i, l, s);
+#else
+                Stile_scalar(K, job->lo + i, ni, l, s);
+#endif
+            for (jj = 0; jj < nj; jj++)
+                for (ii = 0; ii < ni; ii++)
+                    Slocal.m[i + ii][j + jj] = s[jj * STILE + ii];
         }
-        freev(kernel);
-    } /* Slocal is filled out; time to interpolate */
+    }
+}
+
+/* populates the strength matrix using the loudness matrix */
+void Sadd(matrix S, matrix L, matrix K, vector mu, double dt,
+          double nyquist2, int lo, int psz, int w2, THREADPOOL* pool) {
+    int i, j, k;
+    double t = 0.;
+    double tp = 0.;
+    double td;
+    double dtp = w2 / nyquist2;
+    double* si;
+    vector tdv = makev(S.y);
+    intvector kv = makeiv(S.y);
+    strength_job job;
+    job.Slocal = makem(psz, L.x);
+    job.K = K;
+    job.L = L;
+    job.lo = lo;
+    run_THREADPOOL(pool, (L.x + SPANEL - 1) / SPANEL, Spanel, &job);
+    /* Slocal is filled out; time to interpolate */
     k = 0;
     for (j = 0; j < S.y; j++) { /* determine the interpolation params */
         td = t - tp;
@@ -320,85 +588,73 @@ void Sadd(matrix S, matrix L, vector fERBs, vector pci, vector mu,
             tp += dtp;
             td -= dtp;
         } /* td now equals the time difference */
-        for (i = 0; i < psz; i++) {
-            S.m[lo + i][j] += (Slocal.m[i][k] + (td * (Slocal.m[i][k] -
-                                    Slocal.m[i][k - 1])) / dtp) * mu.v[i];
-        }
+        kv.v[j] = k;
+        tdv.v[j] = td;
         t += dt;
     }
-    freem(Slocal);
+    for (i = 0; i < psz; i++) { /* one candidate at a time, along the rows */
+        si = job.Slocal.m[i];
+        for (j = 0; j < S.y; j++) {
+            k = kv.v[j];
+            S.m[lo + i][j] += (si[k] + (tdv.v[j] * (si[k] - si[k - 1])) /
+                               dtp) * mu.v[i];
+        }
+    }
+    freev(tdv);
+    freeiv(kv);
+    freem(job.Slocal);
 }
 
 /* helper function for populating the strength matrix on left boundary */
-void Sfirst(matrix S, vector x, vector pc, vector fERBs, vector d,
-                                           intvector ws, intvector ps,
-                                           double nyquist, double nyquist2,
-                                           double dt, int n) {
+void Sfirst(matrix S, matrix L, matrix K, vector d, intvector ws,
+            double nyquist2, double dt, int n, THREADPOOL* pool) {
     int i;
     int w2 = ws.v[n] / 2;
-    matrix L = loudness(x, fERBs, nyquist, ws.v[n], w2);
     int lo = 0; /* the start of Sfirst-specific code */
     int hi = bisectv(d, 2.);
     int psz = hi - lo;
     vector mu = makev(psz);
-    vector pci = makev(psz);
-    for (i = 0; i < hi; i++) {
-        pci.v[i] = pc.v[i];
+    for (i = 0; i < hi; i++)
         mu.v[i] = 1. - fabs(d.v[i] - 1.);
-    } /* end of Sfirst-specific code */
-    Sadd(S, L, fERBs, pci, mu, ps, dt, nyquist2, lo, psz, w2);
-    freem(L);
+    /* end of Sfirst-specific code */
+    Sadd(S, L, K, mu, dt, nyquist2, lo, psz, w2, pool);
     freev(mu);
-    freev(pci);
 }
 
 /* generic helper function for populating the strength matrix */
-void Snth(matrix S, vector x, vector pc, vector fERBs, vector d,
-                              intvector ws, intvector ps, double nyquist,
-                              double nyquist2, double dt, int n) {
+void Snth(matrix S, matrix L, matrix K, vector d, intvector ws,
+          double nyquist2, double dt, int n, THREADPOOL* pool) {
     int i;
     int w2 = ws.v[n] / 2;
-    matrix L = loudness(x, fERBs, nyquist, ws.v[n], w2);
     int lo = bisectv(d, n); /* start of Snth-specific code */
     int hi = bisectv(d, n + 2);
     int psz = hi - lo;
     vector mu = makev(psz);
-    vector pci = makev(psz);
     int ti = 0;
     for (i = lo; i < hi; i++) {
-        pci.v[ti] = pc.v[i];
         mu.v[ti] = 1. - fabs(d.v[i] - (n + 1));
         ti++;
     } /* end of Snth-specific code */
-    Sadd(S, L, fERBs, pci, mu, ps, dt, nyquist2, lo, psz, w2);
-    freem(L);
+    Sadd(S, L, K, mu, dt, nyquist2, lo, psz, w2, pool);
     freev(mu);
-    freev(pci);
 }
 
 /* helper function for populating the strength matrix from the right boundary */
-void Slast(matrix S, vector x, vector pc, vector fERBs, vector d,
-                                          intvector ws, intvector ps,
-                                          double nyquist, double nyquist2,
-                                          double dt, int n) {
+void Slast(matrix S, matrix L, matrix K, vector d, intvector ws,
+           double nyquist2, double dt, int n, THREADPOOL* pool) {
     int i;
     int w2 = ws.v[n] / 2;
-    matrix L = loudness(x, fERBs, nyquist, ws.v[n], w2);
     int lo = bisectv(d, n); /* start of Slast-specific code */
     int hi = d.x;
     int psz = hi - lo;
     vector mu = makev(psz);
-    vector pci = makev(psz);
     int ti = 0;
     for (i = lo; i < hi; i++) {
-        pci.v[ti] = pc.v[i];
         mu.v[ti] = 1. - fabs(d.v[i] - (n + 1));
         ti++;
     } /* end of Slast-specific code */
-    Sadd(S, L, fERBs, pci, mu, ps, dt, nyquist2, lo, psz, w2);
-    freem(L);
+    Sadd(S, L, K, mu, dt, nyquist2, lo, psz, w2, pool);
     freev(mu);
-    freev(pci);
 }
 
 /* performs polynomial tuning on the strength matrix to determine the pitch */
@@ -457,93 +713,113 @@ vector pitch(matrix S, vector pc, double st) {
     return(p);
 }
 
-/* primary utility function for each pitch extraction */
-#if 0
-vector swipe(int fid, double min, double max, double st, double dt) {
-#else
-DLLEXPORT void swipe(double *input, double* output, int length, int samplerate, int frame_shift, double min, double max, double st, int otype) {
-#endif
+/* builds the analysis for one sampling rate and pitch range */
+SWIPE_STATE* swipe_create(int samplerate, int frame_shift, double min,
+                          double max, double st) {
     int i;
     double td = 0.;
-    intvector ws, ps;
-    vector pc, d, x, fERBs, p;
-    matrix S;
-#if 0
-    SF_INFO info;
-    SNDFILE* source = sf_open_fd(fid, SFM_READ, &info, true);
-    if (source == NULL || info.sections < 1)
-        return(makev(0));
-    double nyquist = info.samplerate / 2.;
-    double nyquist2 = info.samplerate;
-    double nyquist16 = info.samplerate * 8.;
-#else
-    double dt = (double) frame_shift / (double) samplerate;
+    SWIPE_STATE* s;
     double nyquist = samplerate / 2.;
-    double nyquist2 = (double)samplerate;
     double nyquist16 = samplerate * 8.;
-#endif
+    double dt = (double) frame_shift / (double) samplerate;
     if (max > nyquist) {
         max = nyquist;
         fprintf(stderr, "Max pitch exceeds Nyquist frequency...");
         fprintf(stderr, "max pitch set to %.2f Hz.\n", max);
     }
-    if (dt > nyquist2) {
-        dt = nyquist2;
-        fprintf(stderr, "Timestep > SR...timestep set to %f.\n", nyquist2);
+    if (samplerate <= 0 || frame_shift <= 0 || min <= 0. || max <= min) {
+        fprintf(stderr, "swipe : invalid parameters!\n");
+        return(NULL);
+    }
+    if (dt > samplerate) {
+        dt = samplerate;
+        fprintf(stderr, "Timestep > SR...timestep set to %f.\n",
+                (double) samplerate);
     }
-    ws = makeiv(round(swipe_log2((nyquist16) / min) -
+    s = malloc(sizeof(SWIPE_STATE));
+    s->samplerate = samplerate;
+    s->frame_shift = frame_shift;
+    s->st = st;
+    s->dt = dt;
+    s->nyquist = nyquist;
+    s->nyquist2 = (double) samplerate;
+    s->ws = makeiv(round(swipe_log2((nyquist16) / min) -
                                 swipe_log2((nyquist16) / max)) + 1);
-    for (i = 0; i < ws.x; i++)
-        ws.v[i] = pow(2, round(swipe_log2(nyquist16 / min))) / pow(2, i);
-    pc = makev(ceil((swipe_log2(max) - swipe_log2(min)) / DLOG2P));
-    d = makev(pc.x);
-    for (i = pc.x - 1; i >= 0; i--) {
+    for (i = 0; i < s->ws.x; i++)
+        s->ws.v[i] = pow(2, round(swipe_log2(nyquist16 / min))) / pow(2, i);
+    s->pc = makev(ceil((swipe_log2(max) - swipe_log2(min)) / DLOG2P));
+    s->d = makev(s->pc.x);
+    for (i = s->pc.x - 1; i >= 0; i--) {
         td = swipe_log2(min) + (i * DLOG2P);
-        pc.v[i] = pow(2, td);
-        d.v[i] = 1. + td - swipe_log2(nyquist16 / ws.v[0]);
+        s->pc.v[i] = pow(2, td);
+        s->d.v[i] = 1. + td - swipe_log2(nyquist16 / s->ws.v[0]);
     } /* td now equals swipe_log2(min) */
-#if 0
-    x = makev((int) info.frames); /* read in the signal */
-    sf_read_double(source, x.v, x.x);
-    sf_close(source); /* takes wavf with it, too */
-#else
+    s->fERBs = makev(ceil((hz2erb(nyquist) -
+                               hz2erb(pow(2, td) / 4)) / DERBS));
+    td = hz2erb(min / 4.);
+    for (i = 0; i < s->fERBs.x; i++)
+        s->fERBs.v[i] = erb2hz(td + (i * DERBS));
+    s->ps = onesiv(floor(s->fERBs.v[s->fERBs.x - 1] / s->pc.v[0] - .75));
+    sieve(s->ps);
+    s->ps.v[0] = PR; /* hack to make 1 "act" prime...don't ask */
+    s->K = kernels(s->pc, s->fERBs, s->ps);
+    s->win = malloc(sizeof(swipe_window) * s->ws.x);
+    for (i = 0; i < s->ws.x; i++)
+        init_window(&s->win[i], s->fERBs, nyquist, s->ws.v[i]);
+    return(s);
+}
+
+void swipe_destroy(SWIPE_STATE* s) {
+    int i;
+    if (s == NULL)
+        return;
+    for (i = 0; i < s->ws.x; i++)
+        free_window(&s->win[i]);
+    free(s->win);
+    freeiv(s->ws);
+    freeiv(s->ps);
+    freev(s->pc);
+    freev(s->d);
+    freev(s->fERBs);
+    freem(s->K);
+    free(s);
+}
+
+/* tracks the pitch of input; the state is only read, so that one state
+ * may serve several threads at once */
+int swipe_process(SWIPE_STATE* s, double* input, double* output, int length,
+                  int otype, THREADPOOL* pool) {
+    int i;
+    int nthread = (pool == NULL) ? 1 : pool->nthread;
+    double* work;
+    vector x, p;
+    matrix S, L;
     x = makev(length);
     for (i = 0; i < length; i++)
       x.v[i] = input[i] / 32768.0; /* normalized by max_short */
-#endif
-    fERBs = makev(ceil((hz2erb(nyquist) -
-                               hz2erb(pow(2, td) / 4)) / DERBS));
-    td = hz2erb(min / 4.);
-    for (i = 0; i < fERBs.x; i++)
-        fERBs.v[i] = erb2hz(td + (i * DERBS));
-    ps = onesiv(floor(fERBs.v[fERBs.x - 1] / pc.v[0] - .75));
-    sieve(ps);
-    ps.v[0] = PR; /* hack to make 1 "act" prime...don't ask */
-#if 0
-    S = zerom(pc.x, ceil(((double) x.x / nyquist2) / dt));
-#else
-    if(dt >= nyquist2){
-      S = zerom(pc.x, ceil(((double) x.x / nyquist2) / dt));
+    if(s->dt >= s->nyquist2){
+      S = zerom(s->pc.x, ceil(((double) x.x / s->nyquist2) / s->dt));
     }else{
-      S = zerom(pc.x, ceil((double) x.x / frame_shift));
+      S = zerom(s->pc.x, ceil((double) x.x / s->frame_shift));
+    }
+    /* the largest window comes first */
+    work = malloc(sizeof(double) * WORKSIZE(s->ws.v[0]) * nthread);
+    L = loudness(&s->win[0], x, s->fERBs, work, pool);
+    Sfirst(S, L, s->K, s->d, s->ws, s->nyquist2, s->dt, 0, pool);
+    freem(L);
+    for (i = 1; i < s->ws.x - 1; i++) { /* S is updated inline here */
+        L = loudness(&s->win[i], x, s->fERBs, work, pool);
+        Snth(S, L, s->K, s->d, s->ws, s->nyquist2, s->dt, i, pool);
+        freem(L);
     }
-#endif
-    Sfirst(S, x, pc, fERBs, d, ws, ps, nyquist, nyquist2, dt, 0);
-    for (i = 1; i < ws.x - 1; i++) /* S is updated inline here */
-        Snth(S, x, pc, fERBs, d, ws, ps, nyquist, nyquist2, dt, i);
     /* i is now (ws.x - 1) */
-    Slast(S, x, pc, fERBs, d, ws, ps, nyquist, nyquist2, dt, i);
-    freev(fERBs);
-    freeiv(ws);
-    freeiv(ps);
-    freev(d);
+    L = loudness(&s->win[i], x, s->fERBs, work, pool);
+    Slast(S, L, s->K, s->d, s->ws, s->nyquist2, s->dt, i, pool);
+    freem(L);
+    free(work);
     freev(x);
-    p = pitch(S, pc, st); /* find pitch using strength matrix */
-    freev(pc);
+    p = pitch(S, s->pc, s->st); /* find pitch using strength matrix */
     freem(S);
-#if 0
-    return(p);
-#else
     for (i = 0; i < p.x; i++) {
       switch(otype) {
       case 1:      /* f0 */
@@ -559,7 +835,7 @@ DLLEXPORT void swipe(double *input, double* output, int length, int samplerate,
 	break;
       default:     /* pitch */
 	if (p.v[i] != 0.0) {
-	  p.v[i] = samplerate / p.v[i];
+	  p.v[i] = s->samplerate / p.v[i];
 	} else {
 	  p.v[i] = 0.0;
 	}
@@ -568,7 +844,16 @@ DLLEXPORT void swipe(double *input, double* output, int length, int samplerate,
       }
     }
     freev(p);
-#endif
+    return(0);
+}
+
+/* primary utility function for each pitch extraction */
+DLLEXPORT void swipe(double *input, double* output, int length, int samplerate, int frame_shift, double min, double max, double st, int otype) {
+    SWIPE_STATE* s = swipe_create(samplerate, frame_shift, min, max, st);
+    if (s == NULL)
+        return;
+    swipe_process(s, input, output, length, otype, NULL);
+    swipe_destroy(s);
 }
 
 #if 0
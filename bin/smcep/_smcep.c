@@ -50,6 +50,10 @@
 
         int smcep(xw, flng, mc, m, fftsz, a, t, itr1, itr2, dd, 
                   etype, e, f, itype);
+        int smcep_r(w, xw, flng, mc, m, fftsz, a, t, itr1, itr2, dd,
+                    etype, e, f, itype);
+
+        SMCEPWORK *w   : working area allocated by alloc_SMCEPWORK()
 
         double   *xw   : input sequence
         int      flng  : frame length
@@ -71,6 +75,11 @@
         
         return   value :  0 -> completed by end condition
                           -1-> completed by maximum iteration
+                          1 -> invalid etype (smcep_r only)
+                          2 -> invalid itype (smcep_r only)
+                          3 -> failed to compute mel-cepstrum (smcep_r only)
+                          5 -> working area does not match the parameters
+                               (smcep_r only)
 
 *****************************************************************/
 
@@ -130,13 +139,13 @@ static double derivw(const double w, const double a, const double t)
 
 /***************************************************************
 
-  No.1  frqt_a    static : *l, size1
+  No.1  frqt_a
 
   Frequency Transformation of "al" (second term of dE/dc)
 
-      void frqt_a(al, m, fftsz, a, t)
+      void frqt_a(l, m, fftsz, a, t)
 
-      double *al   : sequence which will be warped
+      double *l    : warped sequence
       int m        : order of warped sequence
       int fftsz    : ifft size
       double a     : all-pass constant
@@ -144,90 +153,66 @@ static double derivw(const double w, const double a, const double t)
 
 ***************************************************************/
 
-static void frqt_a(double *al, const int m, const int fftsz, const double a,
+static void frqt_a(double *l, const int m, const int fftsz, const double a,
                    const double t)
 {
    int i, j;
    double w, b, *ww, *f, *re, *im, *pf, *pl, *next;
-   int size_l, size_f, fftsz2;
-   static double *l = NULL;
-   static int size1, flag_l = 1;
+   int size_f, fftsz2;
 
    b = M_2PI / (double) fftsz;
 
-   size_l = m + 1;
-
-   if (l == NULL) {
-      flag_l = 0;
-      size1 = size_l;
-      l = dgetmem(size1);
-   } else if (size_l != size1) {
-      free(l);
-      flag_l = 0;
-      size1 = size_l;
-      l = dgetmem(size1);
-   }
-
-   /*-------  if "l" is not defined  ----------*/
-
-   if (flag_l == 0) {
-
-      ww = dgetmem(fftsz);
+   ww = dgetmem(fftsz);
 
-      for (j = 0, w = 0.0; j < fftsz; j++, w += b)
-         ww[j] = warp(w, a, t);
+   for (j = 0, w = 0.0; j < fftsz; j++, w += b)
+      ww[j] = warp(w, a, t);
 
-      fftsz2 = fftsz + fftsz;   /* size of (re + im) */
-      size_f = (m + 1) * fftsz2;        /* size of array "f" */
-      f = dgetmem(size_f);
+   fftsz2 = fftsz + fftsz;      /* size of (re + im) */
+   size_f = (m + 1) * fftsz2;   /* size of array "f" */
+   f = dgetmem(size_f);
 
-      for (i = 0, re = f, im = f + fftsz; i <= m; i++) {
+   for (i = 0, re = f, im = f + fftsz; i <= m; i++) {
 
-         for (j = 0; j < fftsz; j++)
-            *(re++) = cos(ww[j] * i);
-         for (j = 0; j < fftsz; j++)
-            *(im++) = -sin(ww[j] * i);
+      for (j = 0; j < fftsz; j++)
+         *(re++) = cos(ww[j] * i);
+      for (j = 0; j < fftsz; j++)
+         *(im++) = -sin(ww[j] * i);
 
-         re -= fftsz;
-         im -= fftsz;
+      re -= fftsz;
+      im -= fftsz;
 
-         ifft(re, im, fftsz);
+      ifft(re, im, fftsz);
 
-         re += fftsz2;
-         im += fftsz2;
-      }
+      re += fftsz2;
+      im += fftsz2;
+   }
 
-      free(ww);
+   free(ww);
 
 
-      /*-------  copy "f" to "l" ----------*/
+   /*-------  copy "f" to "l" ----------*/
 
-      for (i = 0, next = f, pf = f, pl = l; i <= m; i++) {
-         *(pl++) = *pf;
-         next += fftsz2;
-         pf = next;
-      }
-
-      free(f);
-      flag_l = 1;
+   for (i = 0, next = f, pf = f, pl = l; i <= m; i++) {
+      *(pl++) = *pf;
+      next += fftsz2;
+      pf = next;
    }
 
-   movem(l, al, sizeof(*al), m + 1);
+   free(f);
 
    return;
 }
 
 /***************************************************************
 
-  No.2  freqt2    static : *g, size2
+  No.2  freqt2
 
-  Frequency Transformation
+  Transform Matrix of Frequency Transformation
 
-      void freqt2(c1, m1, c2, m2, fftsz, a, t)
+      void freqt2(g, m1, m2, fftsz, a, t)
 
-      double *c1   : minimum phase sequence
+      double *g    : transform matrix ((m2+1) x (m1+1))
       int    m1    : order of minimum phase sequence
-      double *c2   : warped sequence
       int    m2    : order of warped sequence
       int    fftsz : ifft size
       double a     : all-pass constant
@@ -235,91 +220,67 @@ static void frqt_a(double *al, const int m, const int fftsz, const double a,
 
 ***************************************************************/
 
-static void freqt2(double *c1, const int m1, double *c2, const int m2,
-                   const int fftsz, const double a, const double t)
+static void freqt2(double *g, const int m1, const int m2, const int fftsz,
+                   const double a, const double t)
 {
    int i, j;
    double w, b, *ww, *dw, *f, *re, *im, *pf, *pg, *next;
-   int size_g, size_f, fftsz2;
-   static double *g = NULL;
-   static int size2, flag_g = 1;
+   int size_f, fftsz2;
 
    b = M_2PI / (double) fftsz;
 
-   size_g = (m2 + 1) * (m1 + 1);
-
-   if (g == NULL) {
-      flag_g = 0;
-      size2 = size_g;
-      g = dgetmem(size2);
-   } else if (size_g != size2) {
-      free(g);
-      flag_g = 0;
-      size2 = size_g;
-      g = dgetmem(size2);
-   }
-
-   /*-------  if "g" is not defined  ----------*/
-
-   if (flag_g == 0) {
-      ww = dgetmem(fftsz);
-      dw = dgetmem(fftsz);
-
-      for (j = 0, w = 0.0; j < fftsz; j++, w += b)
-         ww[j] = warp(w, a, t);
+   ww = dgetmem(fftsz);
+   dw = dgetmem(fftsz);
 
-      for (j = 0, w = 0.0; j < fftsz; j++, w += b)
-         dw[j] = derivw(w, a, t);
+   for (j = 0, w = 0.0; j < fftsz; j++, w += b)
+      ww[j] = warp(w, a, t);
 
+   for (j = 0, w = 0.0; j < fftsz; j++, w += b)
+      dw[j] = derivw(w, a, t);
 
-      fftsz2 = fftsz + fftsz;   /* size of (re + im) */
-      size_f = (m2 + 1) * fftsz2;       /* size of array "f" */
-      f = dgetmem(size_f);
 
-      for (i = 0, re = f, im = f + fftsz; i <= m2; i++) {
+   fftsz2 = fftsz + fftsz;      /* size of (re + im) */
+   size_f = (m2 + 1) * fftsz2;  /* size of array "f" */
+   f = dgetmem(size_f);
 
-         for (j = 0; j < fftsz; j++)
-            *(re++) = cos(ww[j] * i) * dw[j];
-         for (j = 0; j < fftsz; j++)
-            *(im++) = -sin(ww[j] * i) * dw[j];
+   for (i = 0, re = f, im = f + fftsz; i <= m2; i++) {
 
-         re -= fftsz;
-         im -= fftsz;
+      for (j = 0; j < fftsz; j++)
+         *(re++) = cos(ww[j] * i) * dw[j];
+      for (j = 0; j < fftsz; j++)
+         *(im++) = -sin(ww[j] * i) * dw[j];
 
-         ifft(re, im, fftsz);
+      re -= fftsz;
+      im -= fftsz;
 
-         for (j = 1; j <= m1; j++)
-            re[j] += re[fftsz - j];
-
-         re += fftsz2;
-         im += fftsz2;
-      }
+      ifft(re, im, fftsz);
 
-      free(ww);
-      free(dw);
+      for (j = 1; j <= m1; j++)
+         re[j] += re[fftsz - j];
 
+      re += fftsz2;
+      im += fftsz2;
+   }
 
-      /*-------  copy "f" to "g" ----------*/
+   free(ww);
+   free(dw);
 
-      for (i = 0, next = f, pf = f, pg = g; i <= m2; i++) {
-         for (j = 0; j <= m1; j++)
-            *(pg++) = *(pf++);
-         next += fftsz2;
-         pf = next;
-      }
-      free(f);
-      flag_g = 1;
 
-      for (j = 1; j <= m1; j++)
-         g[j] *= 0.5;
+   /*-------  copy "f" to "g" ----------*/
 
-      for (i = 1; i <= m2; i++)
-         g[i * (m1 + 1)] *= 2.0;
+   for (i = 0, next = f, pf = f, pg = g; i <= m2; i++) {
+      for (j = 0; j <= m1; j++)
+         *(pg++) = *(pf++);
+      next += fftsz2;
+      pf = next;
    }
+   free(f);
+
+   for (j = 1; j <= m1; j++)
+      g[j] *= 0.5;
 
-   for (i = 0, pg = g; i <= m2; i++)
-      for (j = 0, c2[i] = 0.0; j <= m1; j++)
-         c2[i] += *(pg++) * c1[j];
+   for (i = 1; i <= m2; i++)
+      g[i * (m1 + 1)] *= 2.0;
 
    return;
 }
@@ -328,15 +289,14 @@ static void freqt2(double *c1, const int m1, double *c2, const int m2,
 
 /***************************************************************
 
-  No.3  ifreqt2    static : *h, size3
+  No.3  ifreqt2
 
-  Inverse Frequency Transformation
+  Transform Matrix of Inverse Frequency Transformation
 
-      void ifreqt2(c1, m1, c2, m2, fftsz, a, t)
+      void ifreqt2(h, m1, m2, fftsz, a, t)
 
-      double *c1   : minimum phase sequence
+      double *h    : transform matrix ((m2+1) x (m1+1))
       int    m1    : order of minimum phase sequence
-      double *c2   : warped sequence
       int    m2    : order of warped sequence
       int    fftsz : ifft size
       double a     : all-pass constant
@@ -344,106 +304,81 @@ static void freqt2(double *c1, const int m1, double *c2, const int m2,
 
 ***************************************************************/
 
-static void ifreqt2(double *c1, int m1, double *c2, int m2, int fftsz, double a,
-                    double t)
+static void ifreqt2(double *h, int m1, int m2, int fftsz, double a, double t)
 {
    int i, j;
-   double w, b, *ww, *f, *re, *im, *pl, *pr, *plnxt, *prnxt, *pf, *ph, *next;
-   int size_h, size_f, fftsz2, m12, m11;
-   static double *h = NULL;
-   static int size3, flag_h = 1;
+   double w, b, *ww, *f, *re, *im, *pl, *pr, *plnxt, *prnxt, *pf, *next;
+   int size_f, fftsz2, m12, m11;
 
    b = M_2PI / (double) fftsz;
 
-   size_h = (m2 + 1) * (m1 + 1);
-
-   if (h == NULL) {
-      flag_h = 0;
-      size3 = size_h;
-      h = dgetmem(size3);
-   } else if (size_h != size3) {
-      free(h);
-      flag_h = 0;
-      size3 = size_h;
-      h = dgetmem(size3);
-   }
-
-   /*-------  if "h" is not defined  ----------*/
-
-   if (flag_h == 0) {
-      ww = dgetmem(fftsz);
-
-      for (j = 0, w = 0.0; j < fftsz; j++, w += b)
-         ww[j] = warp(w, a, t);
-
-      fftsz2 = fftsz + fftsz;   /* size of (re + im) */
+   ww = dgetmem(fftsz);
 
-      m12 = m1 + m1 + 1;
-      size_f = m12 * fftsz2;    /* size of array "f" */
-      f = dgetmem(size_f);
+   for (j = 0, w = 0.0; j < fftsz; j++, w += b)
+      ww[j] = warp(w, a, t);
 
-      for (i = -m1, re = f, im = f + fftsz; i <= m1; i++) {
+   fftsz2 = fftsz + fftsz;      /* size of (re + im) */
 
-         for (j = 0; j < fftsz; j++)
-            *(re++) = cos(ww[j] * i);
+   m12 = m1 + m1 + 1;
+   size_f = m12 * fftsz2;       /* size of array "f" */
+   f = dgetmem(size_f);
 
-         for (j = 0; j < fftsz; j++)
-            *(im++) = -sin(ww[j] * i);
+   for (i = -m1, re = f, im = f + fftsz; i <= m1; i++) {
 
-         re -= fftsz;
-         im -= fftsz;
+      for (j = 0; j < fftsz; j++)
+         *(re++) = cos(ww[j] * i);
 
-         ifft(re, im, fftsz);
+      for (j = 0; j < fftsz; j++)
+         *(im++) = -sin(ww[j] * i);
 
-         re += fftsz2;
-         im += fftsz2;
-      }
+      re -= fftsz;
+      im -= fftsz;
 
-      free(ww);
+      ifft(re, im, fftsz);
 
-      /*------- b'(n,m)=b(n,m)+b(n,-m) ----------*/
+      re += fftsz2;
+      im += fftsz2;
+   }
 
-      pl = f;
-      pr = f + (m12 - 1) * fftsz2;
+   free(ww);
 
-      for (i = 0, plnxt = pl, prnxt = pr; i < m1; i++) {
-         plnxt += fftsz2;
-         prnxt -= fftsz2;
+   /*------- b'(n,m)=b(n,m)+b(n,-m) ----------*/
 
-         for (j = 0; j <= m2; j++)
-            *(pr++) += *(pl++);
+   pl = f;
+   pr = f + (m12 - 1) * fftsz2;
 
-         pl = plnxt;
-         pr = prnxt;
-      }
+   for (i = 0, plnxt = pl, prnxt = pr; i < m1; i++) {
+      plnxt += fftsz2;
+      prnxt -= fftsz2;
 
-      /*-------  copy "f" to "h" ----------*/
+      for (j = 0; j <= m2; j++)
+         *(pr++) += *(pl++);
 
-      m11 = m1 + 1;
-      pf = f + m1 * fftsz2;
+      pl = plnxt;
+      pr = prnxt;
+   }
 
-      for (j = 0, next = pf; j <= m1; j++) {
+   /*-------  copy "f" to "h" ----------*/
 
-         next += fftsz2;
+   m11 = m1 + 1;
+   pf = f + m1 * fftsz2;
 
-         for (i = 0; i <= m2; i++)
-            h[m11 * i + j] = *(pf++);
+   for (j = 0, next = pf; j <= m1; j++) {
 
-         pf = next;
-      }
-      free(f);
-      flag_h = 1;
+      next += fftsz2;
 
-      for (j = 1; j <= m1; j++)
-         h[j] *= 0.5;
+      for (i = 0; i <= m2; i++)
+         h[m11 * i + j] = *(pf++);
 
-      for (i = 1; i <= m2; i++)
-         h[i * m11] *= 2.0;
+      pf = next;
    }
+   free(f);
+
+   for (j = 1; j <= m1; j++)
+      h[j] *= 0.5;
 
-   for (i = 0, ph = h; i <= m2; i++)
-      for (j = 0, c2[i] = 0.0; j <= m1; j++)
-         c2[i] += *(ph++) * c1[j];
+   for (i = 1; i <= m2; i++)
+      h[i * m11] *= 2.0;
 
    return;
 }
@@ -452,15 +387,15 @@ static void ifreqt2(double *c1, int m1, double *c2, int m2, int fftsz, double a,
 
 /***************************************************************
 
-  No.4  frqtr2    static : *k, size4
+  No.4  frqtr2
 
-  Frequency Transformation for Calculating Coefficients
+  Transform Matrix of Frequency Transformation
+  for Calculating Coefficients
 
-      void frqtr2(c1, m1, c2, m2, fftsz, a, t)
+      void frqtr2(k, m1, m2, fftsz, a, t)
 
-      double *c1   : minimum phase sequence
+      double *k    : transform matrix ((m2+1) x (m1+1))
       int    m1    : order of minimum phase sequence
-      double *c2   : warped sequence
       int    m2    : order of warped sequence
       int    fftsz : frame length (fft size)
       double a     : all-pass constant
@@ -468,110 +403,157 @@ static void ifreqt2(double *c1, int m1, double *c2, int m2, int fftsz, double a,
 
 ***************************************************************/
 
-static void frqtr2(double *c1, int m1, double *c2, int m2, int fftsz, double a,
-                   double t)
+static void frqtr2(double *k, int m1, int m2, int fftsz, double a, double t)
 {
    int i, j;
-   double w, b, *ww, *f, *tc2, *re, *im, *pf, *pk, *next;
-   int size_k, size_f, fftsz2;
-   static double *k = NULL;
-   static int size4, flag_k = 1;
+   double w, b, *ww, *f, *re, *im, *pf, *pk, *next;
+   int size_f, fftsz2;
 
    b = M_2PI / (double) fftsz;
 
-   size_k = (m2 + 1) * (m1 + 1);
-
-   if (k == NULL) {
-      flag_k = 0;
-      size4 = size_k;
-      k = dgetmem(size4);
-   } else if (size_k != size4) {
-      free(k);
-      flag_k = 0;
-      size4 = size_k;
-      k = dgetmem(size4);
-   }
+   ww = dgetmem(fftsz);
 
-   /*-------  if "k" is not defined  ----------*/
+   for (j = 0, w = 0.0; j < fftsz; j++, w += b)
+      ww[j] = warp(w, a, t);
 
-   if (flag_k == 0) {
+   fftsz2 = fftsz + fftsz;      /* size of (re + im) */
+   size_f = (m2 + 1) * fftsz2;  /* size of array "f" */
+   f = dgetmem(size_f);
 
-      ww = dgetmem(fftsz);
+   for (i = 0, re = f, im = f + fftsz; i <= m2; i++) {
 
-      for (j = 0, w = 0.0; j < fftsz; j++, w += b)
-         ww[j] = warp(w, a, t);
+      for (j = 0; j < fftsz; j++)
+         *(re++) = cos(ww[j] * i);
+      for (j = 0; j < fftsz; j++)
+         *(im++) = -sin(ww[j] * i);
 
-      fftsz2 = fftsz + fftsz;   /* size of (re + im) */
-      size_f = (m2 + 1) * fftsz2;       /* size of array "f" */
-      f = dgetmem(size_f);
+      re -= fftsz;
+      im -= fftsz;
 
-      for (i = 0, re = f, im = f + fftsz; i <= m2; i++) {
+      ifft(re, im, fftsz);
 
-         for (j = 0; j < fftsz; j++)
-            *(re++) = cos(ww[j] * i);
-         for (j = 0; j < fftsz; j++)
-            *(im++) = -sin(ww[j] * i);
+      for (j = 1; j <= m1; j++)
+         re[j] += re[fftsz - j];
 
-         re -= fftsz;
-         im -= fftsz;
+      re += fftsz2;
+      im += fftsz2;
+   }
 
-         ifft(re, im, fftsz);
+   free(ww);
 
-         for (j = 1; j <= m1; j++)
-            re[j] += re[fftsz - j];
 
-         re += fftsz2;
-         im += fftsz2;
-      }
+   /*-------  copy "f" to "k" ----------*/
 
-      free(ww);
+   for (i = 0, next = f, pf = f, pk = k; i <= m2; i++) {
+      for (j = 0; j <= m1; j++)
+         *(pk++) = *(pf++);
+      next += fftsz2;
+      pf = next;
+   }
+   free(f);
 
+   return;
+}
 
-      /*-------  copy "f" to "k" ----------*/
+/***************************************************************
 
-      for (i = 0, next = f, pf = f, pk = k; i <= m2; i++) {
-         for (j = 0; j <= m1; j++)
-            *(pk++) = *(pf++);
-         next += fftsz2;
-         pf = next;
-      }
-      free(f);
-      flag_k = 1;
-   }
+  Apply Transform Matrix
+
+      void trnsfm(tbl, c1, m1, c2, m2, tmp)
+
+      double *tbl  : transform matrix ((m2+1) x (m1+1))
+      double *c1   : input sequence
+      int    m1    : order of input sequence
+      double *c2   : output sequence (may be the same as c1)
+      int    m2    : order of output sequence
+      double *tmp  : working area of m2+1 doubles
 
-   tc2 = dgetmem(m2 + 1);       /*  tmp of c2  */
+***************************************************************/
 
-   for (i = 0, pk = k; i <= m2; i++)
-      for (j = 0, tc2[i] = 0.0; j <= m1; j++)
-         tc2[i] += *(pk++) * c1[j];
+static void trnsfm(double *tbl, double *c1, const int m1, double *c2,
+                   const int m2, double *tmp)
+{
+   int i, j;
+   double *pt;
 
-   movem(tc2, c2, sizeof(*c2), m2 + 1);
+   for (i = 0, pt = tbl; i <= m2; i++)
+      for (j = 0, tmp[i] = 0.0; j <= m1; j++)
+         tmp[i] += *(pt++) * c1[j];
 
-   free(tc2);
+   movem(tmp, c2, sizeof(*c2), m2 + 1);
 
    return;
 }
 
+int alloc_SMCEPWORK(SMCEPWORK * w, const int flng, const int m,
+                    const int fftsz, const double a, const double t)
+{
+   int f2, m2;
 
-int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
-          const double a, const double t, const int itr1, const int itr2,
-          const double dd, const int etype, const double e, const double f,
-          const int itype)
+   f2 = flng / 2;
+   m2 = m + m;
+
+   w->flng = flng;
+   w->m = m;
+   w->fftsz = fftsz;
+   w->a = a;
+   w->t = t;
+   w->x = dgetmem(3 * flng + 4 * (m + 1) + (f2 + 1) * (m + 1) * 2
+                  + (m2 + 1) * (f2 + 2) + THEQ_WORKSIZE(m + 1));
+   w->y = w->x + flng;
+   w->c = w->y + flng;
+   w->d = w->c + flng;
+   w->al = w->d + (m + 1);
+   w->b = w->al + (m + 1);
+   w->l = w->b + (m + 1);
+   w->g = w->l + (m + 1);
+   w->h = w->g + (f2 + 1) * (m + 1);
+   w->k = w->h + (f2 + 1) * (m + 1);
+   w->tc2 = w->k + (m2 + 1) * (f2 + 1);
+   w->tq = w->tc2 + (m2 + 1);
+
+   frqt_a(w->l, m, fftsz, a, t);
+   freqt2(w->g, f2, m, fftsz, a, t);
+   ifreqt2(w->h, m, f2, fftsz, a, t);
+   frqtr2(w->k, f2, m2, fftsz, a, t);
+
+   return (0);
+}
+
+int free_SMCEPWORK(SMCEPWORK * w)
+{
+   free(w->x);
+   w->flng = 0;
+   w->m = 0;
+   w->fftsz = 0;
+   w->a = 0.0;
+   w->t = 0.0;
+   w->x = w->y = w->c = NULL;
+   w->d = w->al = w->b = NULL;
+   w->l = w->g = w->h = w->k = NULL;
+   w->tc2 = w->tq = NULL;
+
+   return (0);
+}
+
+int smcep_r(SMCEPWORK * w, double *xw, const int flng, double *mc,
+            const int m, const int fftsz, const double a, const double t,
+            const int itr1, const int itr2, const double dd, const int etype,
+            const double e, const double f, const int itype)
 {
    int i, j;
    int flag = 0, f2, m2;
    double u, s, eps = 0.0, min, max;
-   static double *x = NULL, *y, *c, *d, *al, *b;
-   static int size_x, size_d;
+   double *x, *y, *c, *d, *al, *b;
 
    if (etype == 1 && e < 0.0) {
       fprintf(stderr, "smcep : value of e must be e>=0!\n");
-      exit(1);
+      return 1;
    }
 
    if (etype == 2 && e >= 0.0) {
       fprintf(stderr, "smcep : value of E must be E<0!\n");
-      exit(1);
+      return 1;
    }
 
    if (etype == 1) {
@@ -579,32 +561,19 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
    }
 
 
-   if (x == NULL) {
-      x = dgetmem(3 * flng);
-      y = x + flng;
-      c = y + flng;
-      size_x = flng;
-
-      d = dgetmem(3 * m + 3);
-      al = d + (m + 1);
-      b = al + (m + 1);
-      size_d = m;
-   }
-   if (flng > size_x) {
-      free(x);
-      x = dgetmem(3 * flng);
-      y = x + flng;
-      c = y + flng;
-      size_x = flng;
-   }
-   if (m > size_d) {
-      free(d);
-      d = dgetmem(3 * m + 3);
-      al = d + (m + 1);
-      b = al + (m + 1);
-      size_d = m;
+   if (flng != w->flng || m != w->m || fftsz != w->fftsz || a != w->a
+       || t != w->t) {
+      fprintf(stderr, "smcep : working area does not match the parameters!\n");
+      return 5;
    }
 
+   x = w->x;
+   y = w->y;
+   c = w->c;
+   d = w->d;
+   al = w->al;
+   b = w->b;
+
    f2 = flng / 2.;
    m2 = m + m;
 
@@ -641,7 +610,7 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
       break;
    default:
       fprintf(stderr, "smcep : Input type %d is not supported!\n", itype);
-      exit(1);
+      return 2;
    }
    if (itype > 0) {
       for (i = 1; i < flng / 2; i++)
@@ -668,11 +637,7 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
 
    /*  1, (-a), (-a)^2, ..., (-a)^M  */
 
-   al[0] = 1.0;
-   for (i = 1; i <= m; i++)
-      al[i] = 0.0;
-
-   frqt_a(al, m, fftsz, a, t);
+   movem(w->l, al, sizeof(*al), m + 1);
 
 
    /*  initial value of cepstrum  */
@@ -680,20 +645,20 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
 
    c[0] /= 2.0;
    c[flng / 2] /= 2.0;
-   freqt2(c, f2, mc, m, fftsz, a, t);   /*  mc : mel cep.  */
+   trnsfm(w->g, c, f2, mc, m, w->tc2);  /*  mc : mel cep.  */
 
    s = c[0];
 
    /*  Newton Raphson method  */
    for (j = 1; j <= itr2; j++) {
       fillz(c, sizeof(*c), flng);
-      ifreqt2(mc, m, c, f2, fftsz, a, t);       /*  mc : mel cep.  */
+      trnsfm(w->h, mc, m, c, f2, w->y); /*  mc : mel cep.  */
 
       fftr(c, y, flng);         /*  c, y : FFT[mc]  */
       for (i = 0; i < flng; i++)
          c[i] = x[i] / exp(c[i] + c[i]);
       ifftr(c, y, flng);
-      frqtr2(c, f2, c, m2, fftsz, a, t);        /*  c : r(k)  */
+      trnsfm(w->k, c, f2, c, m2, w->tc2);       /*  c : r(k)  */
 
       u = c[0];
       if (j >= itr1) {
@@ -714,9 +679,9 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
          c[i] += c[0];
       c[0] += c[0];
 
-      if (theq(c, y, d, b, m + 1, f)) {
+      if (theq_r(c, y, d, b, m + 1, f, w->tq)) {
          fprintf(stderr, "smcep : Error in theq() at %dth iteration!\n", j);
-         exit(1);
+         return 3;
       }
 
       for (i = 0; i <= m; i++)
@@ -728,3 +693,26 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
    else
       return (-1);
 }
+
+int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
+          const double a, const double t, const int itr1, const int itr2,
+          const double dd, const int etype, const double e, const double f,
+          const int itype)
+{
+   static SMCEPWORK w;
+   int ret;
+
+   if (w.x == NULL || flng != w.flng || m != w.m || fftsz != w.fftsz
+       || a != w.a || t != w.t) {
+      if (w.x != NULL)
+         free_SMCEPWORK(&w);
+      alloc_SMCEPWORK(&w, flng, m, fftsz, a, t);
+   }
+
+   ret = smcep_r(&w, xw, flng, mc, m, fftsz, a, t, itr1, itr2, dd, etype, e, f,
+                 itype);
+   if (ret > 0)
+      exit(1);
+
+   return (ret);
+}
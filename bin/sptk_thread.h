@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------------*/
+/*  Minimal thread, mutex and condition variable wrapper for the library    */
+/*  (sptk_load_ptr()/sptk_store_ptr(), acquire load and release store of a  */
+/*  pointer, are left undefined where no atomics are known)                 */
+/*--------------------------------------------------------------------------*/
+
+#ifndef SPTK_THREAD_H_
+#define SPTK_THREAD_H_
+
+#if defined(_WIN32)
+#  include <windows.h>
+#  include <process.h>
+typedef SRWLOCK sptk_mutex_t;
+#  define SPTK_MUTEX_INITIALIZER SRWLOCK_INIT
+#  define sptk_mutex_init(m) InitializeSRWLock(m)
+#  define sptk_mutex_lock(m) AcquireSRWLockExclusive(m)
+#  define sptk_mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#  define sptk_mutex_destroy(m)
+typedef CONDITION_VARIABLE sptk_cond_t;
+#  define sptk_cond_init(c) InitializeConditionVariable(c)
+#  define sptk_cond_wait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#  define sptk_cond_signal(c) WakeConditionVariable(c)
+#  define sptk_cond_broadcast(c) WakeAllConditionVariable(c)
+#  define sptk_cond_destroy(c)
+typedef INIT_ONCE sptk_once_t;
+#  define SPTK_ONCE_INIT INIT_ONCE_STATIC_INIT
+#  define SPTK_ONCE_PROC(name) \
+      BOOL CALLBACK name(PINIT_ONCE once, PVOID param, PVOID *context)
+#  define SPTK_ONCE_RETURN return (TRUE)
+#  define sptk_once(o, func) InitOnceExecuteOnce(o, func, NULL, NULL)
+#  define sptk_load_ptr(p) \
+      InterlockedCompareExchangePointer((PVOID volatile *) (p), NULL, NULL)
+#  define sptk_store_ptr(p, v) \
+      InterlockedExchangePointer((PVOID volatile *) (p), (PVOID) (v))
+typedef HANDLE sptk_thread_t;
+#  define SPTK_THREAD_PROC(name, arg) unsigned __stdcall name(void *arg)
+#  define SPTK_THREAD_RETURN return (0)
+#  define sptk_thread_create(t, func, arg) \
+      (((*(t) = (HANDLE) _beginthreadex(NULL, 0, func, arg, 0, NULL)) == 0) \
+       ? -1 : 0)
+#  define sptk_thread_join(t) \
+      (WaitForSingleObject(t, INFINITE), CloseHandle(t))
+#else
+#  include <pthread.h>
+typedef pthread_mutex_t sptk_mutex_t;
+#  define SPTK_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#  define sptk_mutex_init(m) pthread_mutex_init(m, NULL)
+#  define sptk_mutex_lock(m) pthread_mutex_lock(m)
+#  define sptk_mutex_unlock(m) pthread_mutex_unlock(m)
+#  define sptk_mutex_destroy(m) pthread_mutex_destroy(m)
+typedef pthread_cond_t sptk_cond_t;
+#  define sptk_cond_init(c) pthread_cond_init(c, NULL)
+#  define sptk_cond_wait(c, m) pthread_cond_wait(c, m)
+#  define sptk_cond_signal(c) pthread_cond_signal(c)
+#  define sptk_cond_broadcast(c) pthread_cond_broadcast(c)
+#  define sptk_cond_destroy(c) pthread_cond_destroy(c)
+typedef pthread_once_t sptk_once_t;
+#  define SPTK_ONCE_INIT PTHREAD_ONCE_INIT
+#  define SPTK_ONCE_PROC(name) void name(void)
+#  define SPTK_ONCE_RETURN return
+#  define sptk_once(o, func) pthread_once(o, func)
+#  if defined(__GNUC__)
+#    define sptk_load_ptr(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#    define sptk_store_ptr(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#  endif
+typedef pthread_t sptk_thread_t;
+#  define SPTK_THREAD_PROC(name, arg) void *name(void *arg)
+#  define SPTK_THREAD_RETURN return (NULL)
+#  define sptk_thread_create(t, func, arg) \
+      ((pthread_create(t, NULL, func, arg) != 0) ? -1 : 0)
+#  define sptk_thread_join(t) pthread_join(t, NULL)
+#endif
+
+#endif  /* SPTK_THREAD_H_ */
@@ -49,6 +49,9 @@
     Unbiased Estimation of Log Spectrum
 
         int uels(xw, flng, c, m, itr1, itr2, dd, etype, e, itype);
+        int uels_r(w, xw, flng, c, m, itr1, itr2, dd, etype, e, itype);
+
+        UELSWORK *w    : working area allocated by alloc_UELSWORK()
 
         double   *xw   : input sequence
         int      flng  : frame length
@@ -69,6 +72,7 @@
                           1 -> invalid etype
                           2 -> invalid itype
                           3 -> zero(s) are found in periodogram
+                          5 -> working area is too small
 
 *****************************************************************/
 
@@ -83,25 +87,11 @@
 #endif
 
 /* Fast Algorithm for Linear Prediction with Linear Phase */
-static void lplp(double *r, double *c, const int m)
+static void lplp(double *r, double *c, const int m, double *p, double *pp)
 {
    int k, n;
    double pn, alpha, beta, gamma, tz = r[0] / 2, rtz = 1 / tz, to = r[1], rttz =
        0, tto = 1;
-   static double *p = NULL, *pp;
-   static int size;
-
-   if (p == NULL) {
-      p = dgetmem(m + m + 4);
-      pp = p + m + 2;
-      size = m;
-   }
-   if (m > size) {
-      free(p);
-      p = dgetmem(m + m + 2);
-      pp = p + m + 1;
-      size = m;
-   }
 
    c[0] = 1.0 / r[0];
    p[0] = 1.0;
@@ -143,14 +133,39 @@ static void lplp(double *r, double *c, const int m)
    return;
 }
 
-int uels(double *xw, const int flng, double *c, const int m, const int itr1,
-         const int itr2, const double dd, const int etype, const double e,
-         const int itype)
+int alloc_UELSWORK(UELSWORK * w, const int flng, const int m)
+{
+   w->flng = flng;
+   w->m = m;
+   w->x = dgetmem(4 * flng + (m + 1) + (m + m + 4));
+   w->r = w->x + flng;
+   w->cr = w->r + flng;
+   w->y = w->cr + flng;
+   w->a = w->y + flng;
+   w->p = w->a + (m + 1);
+   w->pp = w->p + m + 2;
+
+   return (0);
+}
+
+int free_UELSWORK(UELSWORK * w)
+{
+   free(w->x);
+   w->flng = 0;
+   w->m = 0;
+   w->x = w->r = w->cr = w->y = NULL;
+   w->a = w->p = w->pp = NULL;
+
+   return (0);
+}
+
+int uels_r(UELSWORK * w, double *xw, const int flng, double *c, const int m,
+           const int itr1, const int itr2, const double dd, const int etype,
+           const double e, const int itype)
 {
    int i, j, flag = 0;
    double k, eps = 0.0, min, max;
-   static double *x = NULL, *r, *cr, *y, *a;
-   static int size_x, size_a;
+   double *x, *r, *cr, *y, *a;
 
    if (etype == 1 && e < 0.0) {
       fprintf(stderr, "uels : value of e must be e>=0!\n");
@@ -166,29 +181,17 @@ int uels(double *xw, const int flng, double *c, const int m, const int itr1,
       eps = e;
    }
 
-   if (x == NULL) {
-      x = dgetmem(4 * flng);
-      a = dgetmem(m + 1);
-      r = x + flng;
-      cr = r + flng;
-      y = cr + flng;
-      size_x = flng;
-      size_a = m;
-   }
-   if (flng > size_x) {
-      free(x);
-      x = dgetmem(4 * flng);
-      r = x + flng;
-      cr = r + flng;
-      y = cr + flng;
-      size_x = flng;
-   }
-   if (m > size_a) {
-      free(a);
-      a = dgetmem(m + 1);
-      size_a = m;
+   if (flng > w->flng || m > w->m) {
+      fprintf(stderr, "uels : working area is too small!\n");
+      return 5;
    }
 
+   x = w->x;
+   r = w->r;
+   cr = w->cr;
+   y = w->y;
+   a = w->a;
+
    movem(xw, x, sizeof(*xw), flng);
 
    switch (itype) {
@@ -283,7 +286,7 @@ int uels(double *xw, const int flng, double *c, const int m, const int itr1,
          k = c[0];
       }
 
-      lplp(r, a, m);
+      lplp(r, a, m, w->p, w->pp);
       for (i = 1; i <= m; i++)
          c[i] -= a[i];
    }
@@ -294,3 +297,21 @@ int uels(double *xw, const int flng, double *c, const int m, const int itr1,
    else
       return (-1);
 }
+
+int uels(double *xw, const int flng, double *c, const int m, const int itr1,
+         const int itr2, const double dd, const int etype, const double e,
+         const int itype)
+{
+   static UELSWORK w;
+   int size_x, size_a;
+
+   if (w.x == NULL || flng > w.flng || m > w.m) {
+      size_x = (flng > w.flng) ? flng : w.flng;
+      size_a = (m > w.m) ? m : w.m;
+      if (w.x != NULL)
+         free_UELSWORK(&w);
+      alloc_UELSWORK(&w, size_x, size_a);
+   }
+
+   return (uels_r(&w, xw, flng, c, m, itr1, itr2, dd, etype, e, itype));
+}
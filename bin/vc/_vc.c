@@ -63,212 +63,326 @@
 #include "hts_engine_API/HTS_engine.h"
 #include "hts_engine_API/HTS_hidden.h"
 
-/* perform conversion */
-int vc(const GMM * gmm, const DELTAWINDOW * window, const size_t total_frame,
-       const size_t source_vlen, const size_t target_vlen,
-       const double *gv_mean, const double *gv_vari,
-       const double *source, double *target)
+/* doubles per cache line; each array of VCMODEL starts on one */
+#define VCMODEL_ALIGN 8
+
+static size_t vcmodel_round(const size_t n)
 {
-   size_t t, i, j, k, max_num_mix = 0,
-       src_vlen_dyn = source_vlen * window->win_size,
-       tgt_vlen_dyn = target_vlen * window->win_size;
-   int m, l, shift;
-   double max_post_mix = 0.0, logoutp = LZERO, *input = NULL,
-       *src_with_dyn = NULL, *logwgd = NULL,
-       **cov_xx_inv = NULL, ***cov_yx_xx = NULL, *gv_weight = NULL,
-       ***cond_mean = NULL, ***cond_vari = NULL, **cond_post_mix = NULL;
-   GMM gmm_xx;
-   HTS_SStreamSet sss;
-   HTS_PStreamSet pss;
+   return ((n + VCMODEL_ALIGN - 1) / VCMODEL_ALIGN * VCMODEL_ALIGN);
+}
 
-   /* append dynamic feature */
-   src_with_dyn = dgetmem(total_frame * src_vlen_dyn);
-   for (t = 0; t < total_frame; t++) {
-      for (i = 0; i < window->win_size; i++) {
-         j = window->win_size * source_vlen * t + source_vlen * i;
-         for (shift = window->win_l_width[i];
-              shift <= window->win_r_width[i]; shift++) {
-            l = t + shift;
-            if (l < 0) {
-               l = 0;
-            }
-            if (!(l < (int) total_frame)) {
-               l = total_frame - 1;
-            }
-            for (k = 0; k < source_vlen; k++) {
-               src_with_dyn[j + k] += window->win_coefficient[i][shift]
-                   * source[source_vlen * l + k];
-            }
-         }
-      }
-   }
+/* compile the model dependent part of vc(): source marginal, regression
+   matrices and conditional variances of every mixture; gmm must have
+   full covariances over source and target with dynamic features;
+   returns -1 if it has not or if memory runs out */
+int alloc_VCMODEL(VCMODEL * v, const GMM * gmm, const DELTAWINDOW * window,
+                  const size_t source_vlen, const size_t target_vlen)
+{
+   int m;
+   size_t i, j, k, X, Y, addr;
+   double **cov_xx_inv, *reg, sum;
 
-   /* calculate mean and covariace of conditional distribution
-      given source feature and mixture component */
-   cond_post_mix = ddgetmem(total_frame, gmm->nmix);
-   cond_mean = (double ***) getmem(gmm->nmix, sizeof(*(cond_mean)));
-   for (m = 0; m < gmm->nmix; m++) {
-      cond_mean[m] = ddgetmem(total_frame, tgt_vlen_dyn);
-   }
-   cond_vari = (double ***) getmem(gmm->nmix, sizeof(*(cond_vari)));
-   for (m = 0; m < gmm->nmix; m++) {
-      cond_vari[m] = ddgetmem(tgt_vlen_dyn, tgt_vlen_dyn);
+   X = source_vlen * window->win_size;
+   Y = target_vlen * window->win_size;
+   if (gmm->full != TR || (size_t) gmm->dim != X + Y) {
+      fprintf(stderr, "vc : GMM must have full covariances of dimension %d!\n",
+              (int) (X + Y));
+      return (-1);
    }
-   cov_xx_inv = ddgetmem(src_vlen_dyn, src_vlen_dyn);
-   cov_yx_xx = (double ***) getmem(gmm->nmix, sizeof(*(cov_yx_xx)));
-   for (m = 0; m < gmm->nmix; m++) {
-      cov_yx_xx[m] = ddgetmem(tgt_vlen_dyn, src_vlen_dyn);
+
+   v->window = window;
+   v->gv_solver = VC_GV_GRADIENT;
+   v->nmix = gmm->nmix;
+   v->source_vlen = source_vlen;
+   v->target_vlen = target_vlen;
+   v->src_dim = X;
+   v->tgt_dim = Y;
+
+   /* one block, every array aligned to a cache line */
+   addr = 2 * vcmodel_round(gmm->nmix) + gmm->nmix * (vcmodel_round(X)
+                                                       + vcmodel_round(Y)
+                                                       + X * vcmodel_round(X)
+                                                       + Y * vcmodel_round(X)
+                                                       + vcmodel_round(Y));
+   if ((v->block = adgetmem(NULL, addr + VCMODEL_ALIGN)) == NULL)
+      return (-1);
+   if ((cov_xx_inv = addgetmem(NULL, X, X)) == NULL) {
+      free(v->block);
+      return (-1);
    }
+   addr = (size_t) v->block % (VCMODEL_ALIGN * sizeof(double));
+   v->log_weight = v->block
+       + (addr == 0 ? 0 : VCMODEL_ALIGN - addr / sizeof(double));
+   v->gconst = v->log_weight + vcmodel_round(gmm->nmix);
+   v->mean_x = v->gconst + vcmodel_round(gmm->nmix);
+   v->mean_y = v->mean_x + gmm->nmix * vcmodel_round(X);
+   v->prec = v->mean_y + gmm->nmix * vcmodel_round(Y);
+   v->reg = v->prec + gmm->nmix * X * vcmodel_round(X);
+   v->cond_vari = v->reg + gmm->nmix * Y * vcmodel_round(X);
+   v->ldx = vcmodel_round(X);
+   v->ldy = vcmodel_round(Y);
+
    for (m = 0; m < gmm->nmix; m++) {
-      invert(gmm->gauss[m].cov, cov_xx_inv, src_vlen_dyn);
-      for (i = 0; i < tgt_vlen_dyn; i++) {
-         for (j = 0; j < src_vlen_dyn; j++) {
-            for (k = 0; k < src_vlen_dyn; k++) {
-               cov_yx_xx[m][i][j] += gmm->gauss[m].cov[src_vlen_dyn + i][k]
-                   * cov_xx_inv[k][j];
-            }
+      v->log_weight[m] = log(gmm->weight[m]);
+      for (i = 0; i < X; i++)
+         v->mean_x[m * v->ldx + i] = gmm->gauss[m].mean[i];
+      for (i = 0; i < Y; i++)
+         v->mean_y[m * v->ldy + i] = gmm->gauss[m].mean[X + i];
+
+      /* source marginal */
+      invert(gmm->gauss[m].cov, cov_xx_inv, X);
+      v->gconst[m] = cal_gconstf(gmm->gauss[m].cov, X);
+      for (i = 0; i < X; i++)
+         for (j = 0; j < X; j++)
+            v->prec[(m * X + i) * v->ldx + j] = cov_xx_inv[i][j];
+
+      /* regression matrix cov_yx cov_xx^{-1} and diagonal of
+         conditional covariance cov_yy - cov_yx cov_xx^{-1} cov_xy */
+      for (i = 0; i < Y; i++) {
+         reg = v->reg + (m * Y + i) * v->ldx;
+         for (j = 0; j < X; j++) {
+            for (k = 0, sum = 0.0; k < X; k++)
+               sum += gmm->gauss[m].cov[X + i][k] * cov_xx_inv[k][j];
+            reg[j] = sum;
          }
+         for (k = 0, sum = 0.0; k < X; k++)
+            sum += reg[k] * gmm->gauss[m].cov[k][X + i];
+         v->cond_vari[m * v->ldy + i] = gmm->gauss[m].cov[X + i][X + i] - sum;
       }
    }
-   logwgd = dgetmem(gmm->nmix);
-   input = dgetmem(src_vlen_dyn);
-   alloc_GMM(&gmm_xx, gmm->nmix, src_vlen_dyn, gmm->full);
-   for (i = 0; i < (size_t) gmm_xx.nmix; i++) {
-      gmm_xx.weight[i] = gmm->weight[i];
-      for (j = 0; j < (size_t) gmm_xx.dim; j++) {
-         gmm_xx.gauss[i].mean[j] = gmm->gauss[i].mean[j];
-         if (gmm_xx.full) {
-            for (k = 0; k < (size_t) gmm_xx.dim; k++) {
-               gmm_xx.gauss[i].cov[j][k] = gmm->gauss[i].cov[j][k];
-            }
-         } else {
-            gmm_xx.gauss[i].var[j] = gmm->gauss[i].var[j];
+
+   free(cov_xx_inv[0]);
+   free(cov_xx_inv);
+
+   return (0);
+}
+
+int free_VCMODEL(VCMODEL * v)
+{
+   free(v->block);
+   v->block = NULL;
+
+   return (0);
+}
+
+/* source vector of frame t with dynamic features [win_size][vlen] to x;
+   frame n of an utterance of length frames is at src + (n % size) * vlen */
+static void vc_dyn(const DELTAWINDOW * window, const size_t vlen,
+                   const double *src, const long size, const long t,
+                   const long length, double *x)
+{
+   size_t i, j, k;
+   int shift;
+   long l;
+
+   for (i = 0; i < window->win_size * vlen; i++)
+      x[i] = 0.0;
+   for (i = 0; i < window->win_size; i++) {
+      j = vlen * i;
+      for (shift = window->win_l_width[i];
+           shift <= window->win_r_width[i]; shift++) {
+         l = t + shift;
+         if (l < 0) {
+            l = 0;
+         }
+         if (!(l < length)) {
+            l = length - 1;
+         }
+         for (k = 0; k < vlen; k++) {
+            x[j + k] += window->win_coefficient[i][shift]
+                * src[vlen * (l % size) + k];
          }
       }
    }
-   for (i = 0; i < (size_t) gmm_xx.nmix; i++) {
-      invert(gmm_xx.gauss[i].cov, gmm_xx.gauss[i].inv, src_vlen_dyn);
-      gmm_xx.gauss[i].gconst = cal_gconstf(gmm_xx.gauss[i].cov, src_vlen_dyn);
-   }
-   for (t = 0; t < total_frame; t++) {
-      for (i = 0; i < src_vlen_dyn; i++) {
-         input[i] = src_with_dyn[t * src_vlen_dyn + i];
-      }
-      for (m = 0, logoutp = LZERO; m < gmm->nmix; m++) {
-         logwgd[m] = log_wgd(&gmm_xx, m, 0, src_vlen_dyn, input);
-         logoutp = log_add(logoutp, logwgd[m]);
+}
+
+/* conditional pdf of the target given one source vector x with dynamic
+   features [src_dim], from the mixture component of highest posterior
+   probability; mean and vari receive tgt_dim values, laid out as
+   mlpgstream_push() takes them; work holds src_dim values (NULL:
+   allocated for this call); returns the component, or -1 if memory
+   runs out */
+int vc_model_frame(const VCMODEL * v, const double *x, double *mean,
+                   double *vari, double *work)
+{
+   const size_t X = v->src_dim, Y = v->tgt_dim;
+   size_t i, j;
+   int m, best = 0;
+   double lw, max = 0.0, tmp, sum, *diff = work;
+   const double *prec, *reg;
+
+   if (diff == NULL && (diff = adgetmem(NULL, X)) == NULL)
+      return (-1);
+
+   /* the posterior is highest where the log weighted Gaussian is */
+   for (m = 0; m < v->nmix; m++) {
+      prec = v->prec + m * X * v->ldx;
+      for (i = 0; i < X; i++) {
+         diff[i] = x[i] - v->mean_x[m * v->ldx + i];
       }
-      for (m = 0; m < gmm->nmix; m++) {
-         /* posterior probability of mixture component given source feature */
-         cond_post_mix[t][m] = exp(logwgd[m] - logoutp);
-         for (i = 0; i < tgt_vlen_dyn; i++) {
-            for (j = 0; j < src_vlen_dyn; j++) {
-               cond_mean[m][t][i] += cov_yx_xx[m][i][j]
-                   * (input[j] - gmm->gauss[m].mean[j]);
-            }
-            cond_mean[m][t][i] += gmm->gauss[m].mean[src_vlen_dyn + i];
+      for (i = 0, sum = v->gconst[m]; i < X; i++) {
+         for (j = 0, tmp = 0.0; j < X; j++) {
+            tmp += diff[j] * prec[j * v->ldx + i];
          }
+         sum += tmp * diff[i];
+      }
+      lw = v->log_weight[m] - 0.5 * sum;
+      if (m == 0 || max < lw) {
+         max = lw;
+         best = m;
       }
    }
 
-   for (m = 0; m < gmm->nmix; m++) {
-      for (i = 0; i < tgt_vlen_dyn; i++) {
-         for (j = 0; j < tgt_vlen_dyn; j++) {
-            for (k = 0; k < src_vlen_dyn; k++) {
-               cond_vari[m][i][j] += cov_yx_xx[m][i][k]
-                   * gmm->gauss[m].cov[k][src_vlen_dyn + j];
-            }
-            cond_vari[m][i][j] =
-                gmm->gauss[m].cov[src_vlen_dyn + i][src_vlen_dyn + j]
-                - cond_vari[m][i][j];
-         }
+   reg = v->reg + best * Y * v->ldx;
+   for (i = 0; i < Y; i++) {
+      for (j = 0, sum = 0.0; j < X; j++) {
+         sum += reg[i * v->ldx + j] * (x[j] - v->mean_x[best * v->ldx + j]);
       }
+      mean[i] = sum + v->mean_y[best * v->ldy + i];
+      vari[i] = v->cond_vari[best * v->ldy + i];
    }
 
-   /* initialize parameter set of hts_engine */
-   HTS_PStreamSet_initialize(&pss);
-   sss.nstream = 1;
-   sss.total_state = total_frame;
-   sss.total_frame = total_frame;
-   sss.duration = (size_t *) getmem(total_frame, sizeof(size_t));
+   if (work == NULL)
+      free(diff);
+
+   return (best);
+}
+
+/* set up the state stream of hts_engine for vc_model() in arena a; the
+   buffers go with the arena, so HTS_SStreamSet_clear() must not be called
+   on it; returns -1 if memory runs out */
+static int vc_sstream(HTS_SStreamSet * sss, const DELTAWINDOW * window,
+                      const size_t total_frame, const size_t target_vlen,
+                      const double *gv_mean, const double *gv_vari, ARENA * a)
+{
+   const size_t tgt_vlen_dyn = target_vlen * window->win_size;
+   size_t i;
+   int shift, l, r;
+   HTS_SStream *s;
+
+   sss->nstream = 1;
+   sss->total_state = total_frame;
+   sss->total_frame = total_frame;
+   if ((sss->duration =
+        (size_t *) agetmem(a, total_frame, sizeof(size_t))) == NULL
+       || (sss->sstream = s =
+           (HTS_SStream *) agetmem(a, 1, sizeof(HTS_SStream))) == NULL
+       || (s->mean = addgetmem(a, total_frame, tgt_vlen_dyn)) == NULL
+       || (s->vari = addgetmem(a, total_frame, tgt_vlen_dyn)) == NULL
+       || (s->win_l_width =
+           (int *) agetmem(a, window->win_size, sizeof(int))) == NULL
+       || (s->win_r_width =
+           (int *) agetmem(a, window->win_size, sizeof(int))) == NULL
+       || (s->win_coefficient =
+           (double **) agetmem(a, window->win_size, sizeof(double *))) == NULL
+       || (s->gv_switch =
+           (HTS_Boolean *) agetmem(a, total_frame,
+                                   sizeof(HTS_Boolean))) == NULL)
+      return (-1);
+
    for (i = 0; i < total_frame; i++) {
-      sss.duration[i] = 1;
+      sss->duration[i] = 1;
+      s->gv_switch[i] = TRUE;
    }
-   sss.sstream = (HTS_SStream *) getmem(1, sizeof(HTS_SStream));
-   sss.sstream->vector_length = target_vlen;
-   sss.sstream->mean =
-       (double **) getmem(sss.total_state, sizeof(*(sss.sstream->mean)));
-   sss.sstream->vari =
-       (double **) getmem(sss.total_state, sizeof(*(sss.sstream->vari)));
-   for (i = 0; i < sss.total_state; i++) {
-      sss.sstream->mean[i] = dgetmem(tgt_vlen_dyn);
-      sss.sstream->vari[i] = dgetmem(tgt_vlen_dyn);
-   }
-   sss.sstream->msd = NULL;     /* no MSD */
-   sss.sstream->win_size = window->win_size;
-   sss.sstream->win_l_width =
-       (int *) getmem(window->win_size, sizeof(*(sss.sstream->win_l_width)));
-   sss.sstream->win_r_width =
-       (int *) getmem(window->win_size, sizeof(*(sss.sstream->win_r_width)));
-   sss.sstream->win_coefficient =
-       (double **) getmem(window->win_size,
-                          sizeof(*(sss.sstream->win_coefficient)));
+   s->vector_length = target_vlen;
+   s->msd = NULL;               /* no MSD */
+   s->win_size = window->win_size;
    for (i = 0; i < window->win_size; i++) {
-      sss.sstream->win_l_width[i] = window->win_l_width[i];
-      sss.sstream->win_r_width[i] = window->win_r_width[i];
-      if (sss.sstream->win_l_width[i] + sss.sstream->win_r_width[i] == 0) {
-         sss.sstream->win_coefficient[i] =
-             dgetmem(-2 * sss.sstream->win_l_width[i] + 1);
-      } else {
-         sss.sstream->win_coefficient[i] =
-             dgetmem(-2 * sss.sstream->win_l_width[i]);
-      }
-      sss.sstream->win_coefficient[i] -= sss.sstream->win_l_width[i];
-      for (shift = sss.sstream->win_l_width[i];
-           shift <= sss.sstream->win_r_width[i]; shift++) {
-         sss.sstream->win_coefficient[i][shift] =
-             window->win_coefficient[i][shift];
-      }
+      l = s->win_l_width[i] = window->win_l_width[i];
+      r = s->win_r_width[i] = window->win_r_width[i];
+      if ((s->win_coefficient[i] =
+           adgetmem(a, (l + r == 0) ? -2 * l + 1 : -2 * l)) == NULL)
+         return (-1);
+      s->win_coefficient[i] -= l;
+      for (shift = l; shift <= r; shift++)
+         s->win_coefficient[i][shift] = window->win_coefficient[i][shift];
    }
-   sss.sstream->win_max_width = window->win_max_width;
+   s->win_max_width = window->win_max_width;
+   s->gv_mean = s->gv_vari = NULL;
    if ((gv_mean != NULL) && (gv_vari != NULL)) {        /* set GV parameters */
-      sss.sstream->gv_mean = dgetmem(sss.sstream->vector_length);
-      sss.sstream->gv_vari = dgetmem(sss.sstream->vector_length);
-      for (i = 0; i < sss.sstream->vector_length; i++) {
-         sss.sstream->gv_mean[i] = gv_mean[i];
-         sss.sstream->gv_vari[i] = gv_vari[i];
+      if ((s->gv_mean = adgetmem(a, target_vlen)) == NULL
+          || (s->gv_vari = adgetmem(a, target_vlen)) == NULL)
+         return (-1);
+      for (i = 0; i < target_vlen; i++) {
+         s->gv_mean[i] = gv_mean[i];
+         s->gv_vari[i] = gv_vari[i];
       }
-   } else {
-      sss.sstream->gv_mean = NULL;
-      sss.sstream->gv_vari = NULL;
    }
-   sss.sstream->gv_switch =
-       (HTS_Boolean *) getmem(total_frame, sizeof(HTS_Boolean));
-   for (i = 0; i < total_frame; i++) {
-      sss.sstream->gv_switch[i] = TRUE;
+
+   return (0);
+}
+
+/* convert with a compiled model, taking the working memory from arena
+   (NULL: a temporary arena) and running parameter generation on pool
+   (NULL: serial); GV is considered by v->gv_solver, and the convergence
+   of each static target dimension is stored to gv_stat unless it is
+   NULL (all zero without GV); returns -1 if the arena runs out, while
+   the buffers hts_engine allocates for parameter generation still exit
+   on failure */
+int vc_model(const VCMODEL * v, const size_t total_frame,
+             const double *gv_mean, const double *gv_vari,
+             const double *source, double *target, VCGVSTAT * gv_stat,
+             THREADPOOL * pool, ARENA * arena)
+{
+   const DELTAWINDOW *window = v->window;
+   const size_t source_vlen = v->source_vlen, target_vlen = v->target_vlen,
+       src_vlen_dyn = v->src_dim, tgt_vlen_dyn = v->tgt_dim;
+   size_t t, i, k;
+   double *src_with_dyn = NULL, *diff = NULL, *gv_weight = NULL;
+   Boolean ok;
+   size_t mark;
+   ARENA local, *a = arena;
+   HTS_SStreamSet sss;
+   HTS_PStreamSet pss;
+   const HTS_GVStat *stat;
+
+   if (a == NULL) {
+      alloc_ARENA(&local, 0, NULL, NULL);
+      a = &local;
+   }
+   mark = mark_ARENA(a);
+
+   /* working memory */
+   ok = ((src_with_dyn = adgetmem(a, total_frame * src_vlen_dyn)) != NULL
+         && (diff = adgetmem(a, src_vlen_dyn)) != NULL
+         && (gv_weight = adgetmem(a, tgt_vlen_dyn)) != NULL);
+   if (!ok) {
+      if (arena == NULL)
+         free_ARENA(&local);
+      else
+         rewind_ARENA(a, mark);
+      return (-1);
+   }
+
+   /* append dynamic feature */
+   for (t = 0; t < total_frame; t++)
+      vc_dyn(window, source_vlen, source, (long) total_frame, (long) t,
+             (long) total_frame, src_with_dyn + t * src_vlen_dyn);
+
+   /* initialize parameter set of hts_engine */
+   HTS_PStreamSet_initialize(&pss);
+   if (vc_sstream(&sss, window, total_frame, target_vlen, gv_mean, gv_vari,
+                  a) != 0) {
+      if (arena == NULL)
+         free_ARENA(&local);
+      else
+         rewind_ARENA(a, mark);
+      return (-1);
    }
-   gv_weight = dgetmem(tgt_vlen_dyn);
    for (i = 0; i < tgt_vlen_dyn; i++) {
       gv_weight[i] = 1.0;
    }
 
-   /* initialize pdf sequence */
-   for (t = 0; t < total_frame; t++) {
-      max_post_mix = cond_post_mix[t][0];
-      max_num_mix = 0;
-      for (m = 1; m < gmm->nmix; m++) {
-         if (max_post_mix < cond_post_mix[t][m]) {
-            max_post_mix = cond_post_mix[t][m];
-            max_num_mix = m;
-         }
-      }
-      for (i = 0; i < tgt_vlen_dyn; i++) {
-         sss.sstream->mean[t][i] = cond_mean[max_num_mix][t][i];
-         sss.sstream->vari[t][i] = cond_vari[max_num_mix][i][i];
-      }
-   }
+   /* initialize pdf sequence with the conditional distribution of
+      the mixture component of highest posterior probability */
+   for (t = 0; t < total_frame; t++)
+      vc_model_frame(v, src_with_dyn + t * src_vlen_dyn,
+                     sss.sstream->mean[t], sss.sstream->vari[t], diff);
 
    /* parameter generation by hts_engine API */
+   HTS_PStreamSet_set_thread_pool(&pss, pool);
+   HTS_PStreamSet_set_gv_solver(&pss, (v->gv_solver == VC_GV_LBFGS)
+                                ? HTS_GV_LBFGS : HTS_GV_GRADIENT);
    HTS_PStreamSet_create(&pss, &sss, NULL, gv_weight);
    for (t = 0; t < total_frame; t++) {
       k = t * target_vlen;
@@ -276,30 +390,138 @@ int vc(const GMM * gmm, const DELTAWINDOW * window, const size_t total_frame,
          target[k + i] = pss.pstream->par[t][i];
       }
    }
+   if (gv_stat != NULL) {
+      for (i = 0; i < target_vlen; i++) {
+         if ((stat = HTS_PStreamSet_get_gv_stat(&pss, 0, i)) != NULL) {
+            gv_stat[i].iteration = stat->iteration;
+            gv_stat[i].objective = stat->objective;
+            gv_stat[i].gradient = stat->gradient;
+            gv_stat[i].converged = stat->converged ? TR : FA;
+         } else {
+            gv_stat[i].iteration = 0;
+            gv_stat[i].objective = gv_stat[i].gradient = 0.0;
+            gv_stat[i].converged = FA;
+         }
+      }
+   }
 
    /* release memory */
-   free(src_with_dyn);
-   free(input);
-   free(logwgd);
-   free(cov_xx_inv[0]);
-   free(cov_xx_inv);
-   for (m = 0; m < gmm->nmix; m++) {
-      free(cov_yx_xx[m][0]);
-      free(cov_yx_xx[m]);
-      free(cond_mean[m][0]);
-      free(cond_mean[m]);
-      free(cond_vari[m][0]);
-      free(cond_vari[m]);
-   }
-   free(cov_yx_xx);
-   free(cond_mean);
-   free(cond_vari);
-   free(cond_post_mix[0]);
-   free(cond_post_mix);
-   free(gv_weight);
-   free_GMM(&gmm_xx);
+   if (arena == NULL)
+      free_ARENA(&local);
+   else
+      rewind_ARENA(a, mark);
    HTS_PStreamSet_clear(&pss);
-   HTS_SStreamSet_clear(&sss);
 
    return (0);
 }
+
+/* perform conversion, compiling the model for this call only */
+int vc_r(const GMM * gmm, const DELTAWINDOW * window,
+         const size_t total_frame, const size_t source_vlen,
+         const size_t target_vlen, const double *gv_mean,
+         const double *gv_vari, const double *source, double *target,
+         const VCGVSolver gv_solver, VCGVSTAT * gv_stat, THREADPOOL * pool,
+         ARENA * arena)
+{
+   VCMODEL model;
+   int ret;
+
+   if (alloc_VCMODEL(&model, gmm, window, source_vlen, target_vlen) != 0)
+      return (-1);
+   model.gv_solver = gv_solver;
+   ret = vc_model(&model, total_frame, gv_mean, gv_vari, source, target,
+                  gv_stat, pool, arena);
+   free_VCMODEL(&model);
+
+   return (ret);
+}
+
+int vc(const GMM * gmm, const DELTAWINDOW * window, const size_t total_frame,
+       const size_t source_vlen, const size_t target_vlen,
+       const double *gv_mean, const double *gv_vari,
+       const double *source, double *target)
+{
+   return (vc_r(gmm, window, total_frame, source_vlen, target_vlen, gv_mean,
+                gv_vari, source, target, VC_GV_GRADIENT, NULL, NULL, NULL));
+}
+
+/* streaming conversion with a look-ahead of delay frames for parameter
+   generation (see alloc_MLPGSTREAM()) and win_max_width frames for the
+   dynamic features of the source; GV is not considered */
+int alloc_VCSTREAM(VCSTREAM * s, const VCMODEL * v, const int delay)
+{
+   s->model = v;
+   if (alloc_MLPGSTREAM(&s->mlpg, v->window, (int) v->target_vlen, delay)
+       != 0)
+      return (-1);
+   s->size = 2 * (int) v->window->win_max_width + 1;
+   s->src = dgetmem(s->size * v->source_vlen + 2 * v->src_dim
+                    + 2 * v->tgt_dim);
+   s->x = s->src + s->size * v->source_vlen;
+   s->work = s->x + v->src_dim;
+   s->mean = s->work + v->src_dim;
+   s->vari = s->mean + v->tgt_dim;
+
+   return (reset_VCSTREAM(s));
+}
+
+int free_VCSTREAM(VCSTREAM * s)
+{
+   free_MLPGSTREAM(&s->mlpg);
+   free(s->src);
+   s->src = s->x = s->work = s->mean = s->vari = NULL;
+   s->model = NULL;
+   s->size = 0;
+
+   return (0);
+}
+
+int reset_VCSTREAM(VCSTREAM * s)
+{
+   s->nin = s->nconv = 0;
+
+   return (reset_MLPGSTREAM(&s->mlpg));
+}
+
+/* convert the next frame and push its pdf to the parameter generation;
+   the source is taken to end at the last frame pushed */
+static int vcstream_convert(VCSTREAM * s, double *target)
+{
+   const VCMODEL *v = s->model;
+
+   vc_dyn(v->window, v->source_vlen, s->src, s->size, s->nconv++, s->nin,
+          s->x);
+   vc_model_frame(v, s->x, s->mean, s->vari, s->work);
+
+   return (mlpgstream_push(&s->mlpg, s->mean, s->vari, target));
+}
+
+/* push one static source vector; returns 1 if target holds the next
+   frame, 0 otherwise */
+int vcstream_push(VCSTREAM * s, const double *source, double *target)
+{
+   const size_t vlen = s->model->source_vlen;
+   const int mw = (int) s->model->window->win_max_width;
+   size_t k;
+
+   for (k = 0; k < vlen; k++)
+      s->src[(s->nin % s->size) * vlen + k] = source[k];
+   s->nin++;
+
+   /* frame nin - 1 - mw has all of its dynamic features now */
+   if (s->nin - 1 - mw < 0)
+      return (0);
+
+   return (vcstream_convert(s, target));
+}
+
+/* after the last push, call until it returns 0; returns 1 if target
+   holds the next frame */
+int vcstream_flush(VCSTREAM * s, double *target)
+{
+   while (s->nconv < s->nin)
+      if (vcstream_convert(s, target))
+         return (1);
+
+   return (mlpgstream_flush(&s->mlpg, target));
+}
@@ -216,6 +216,20 @@ typedef struct _HTS_SMatrices {
    double *wum;                 /* W' U^-1 mu */
 } HTS_SMatrices;
 
+/* HTS_GVSolver: algorithm of parameter generation considering GV. */
+typedef enum _HTS_GVSolver {
+   HTS_GV_GRADIENT = 0,         /* fixed number of gradient steps */
+   HTS_GV_LBFGS = 1             /* preconditioned L-BFGS until convergence */
+} HTS_GVSolver;
+
+/* HTS_GVStat: convergence of parameter generation considering GV for one dimension. */
+typedef struct _HTS_GVStat {
+   size_t iteration;            /* number of iterations */
+   double objective;            /* final objective (to be minimized) */
+   double gradient;             /* final gradient norm relative to the initial one (HTS_GV_LBFGS only) */
+   HTS_Boolean converged;       /* tolerance reached (HTS_GV_LBFGS only) */
+} HTS_GVStat;
+
 /* HTS_PStream: individual PDF stream. */
 typedef struct _HTS_PStream {
    size_t vector_length;        /* vector length (static features only) */
@@ -232,6 +246,7 @@ typedef struct _HTS_PStream {
    double *gv_vari;             /* variance vector of GV */
    HTS_Boolean *gv_switch;      /* GV flag sequence */
    size_t gv_length;            /* frame length for GV calculation */
+   HTS_GVStat *gv_stat;         /* convergence of each dimension */
 } HTS_PStream;
 
 /* HTS_PStreamSet: set of PDF streams. */
@@ -239,6 +254,8 @@ typedef struct _HTS_PStreamSet {
    HTS_PStream *pstream;        /* PDF streams */
    size_t nstream;              /* # of PDF streams */
    size_t total_frame;          /* total frame */
+   void *pool;                  /* thread pool (SPTK THREADPOOL) for mlpg */
+   HTS_GVSolver gv_solver;      /* algorithm for GV */
 } HTS_PStreamSet;
 
 /* gstream --------------------------------------------------------- */
@@ -360,10 +360,22 @@ void HTS_SStreamSet_clear(HTS_SStreamSet * sss);
 #define W1       1.0
 #define W2       1.0
 #define GV_MAX_ITERATION 5
+#define GV_LBFGS_HISTORY 5
+#define GV_LBFGS_MAX_ITERATION 50
+#define GV_LBFGS_TOLERANCE 1.0e-4
 
 /* HTS_PStreamSet_initialize: initialize parameter stream set */
 void HTS_PStreamSet_initialize(HTS_PStreamSet * pss);
 
+/* HTS_PStreamSet_set_thread_pool: split mlpg of each stream into dimension groups run on pool (NULL: serial) */
+void HTS_PStreamSet_set_thread_pool(HTS_PStreamSet * pss, void *pool);
+
+/* HTS_PStreamSet_set_gv_solver: select the algorithm of parameter generation considering GV */
+void HTS_PStreamSet_set_gv_solver(HTS_PStreamSet * pss, HTS_GVSolver solver);
+
+/* HTS_PStreamSet_get_gv_stat: get convergence of parameter generation considering GV (NULL: GV not used) */
+const HTS_GVStat *HTS_PStreamSet_get_gv_stat(HTS_PStreamSet * pss, size_t stream_index, size_t vector_index);
+
 /* HTS_PStreamSet_create: parameter generation using GV weight */
 HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, double *msd_threshold, double *gv_weight);
 
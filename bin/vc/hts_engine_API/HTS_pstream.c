@@ -60,6 +60,16 @@ HTS_PSTREAM_C_START;
 /* hts_engine libraries */
 #include "HTS_hidden.h"
 
+/* run_THREADPOOL() of SPTK */
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+/* number of dimensions solved together by HTS_PStream_mlpg_lanes() */
+#define HTS_MLPG_LANES 8
+
 /* HTS_finv: calculate 1.0/variance function */
 static double HTS_finv(const double x)
 {
@@ -243,23 +253,397 @@ static void HTS_PStream_gv_parmgen(HTS_PStream * pst, size_t m)
          prev = obj;
       }
    }
+   if (pst->gv_stat != NULL) {
+      pst->gv_stat[m].iteration = GV_MAX_ITERATION;
+      pst->gv_stat[m].objective = prev;
+      pst->gv_stat[m].gradient = 0.0;
+      pst->gv_stat[m].converged = FALSE;
+   }
+}
+
+/* HTS_PStream_gv_band: calculate W'U^{-1}W of dimension m into flat band r[t * width + i] and W'U^{-1}M into wum */
+static void HTS_PStream_gv_band(HTS_PStream * pst, size_t m, double *r, double *wum)
+{
+   size_t t, i, j;
+   int shift;
+   double wu;
+
+   for (t = 0; t < pst->length; t++) {
+      wum[t] = 0.0;
+      for (i = 0; i < pst->width; i++)
+         r[t * pst->width + i] = 0.0;
+      for (i = 0; i < pst->win_size; i++)
+         for (shift = pst->win_l_width[i]; shift <= pst->win_r_width[i]; shift++)
+            if (((int) t + shift >= 0) && ((int) t + shift < pst->length) && (pst->win_coefficient[i][-shift] != 0.0)) {
+               wu = pst->win_coefficient[i][-shift] * pst->sm.ivar[t + shift][i * pst->vector_length + m];
+               wum[t] += wu * pst->sm.mean[t + shift][i * pst->vector_length + m];
+               for (j = 0; (j < pst->width) && (t + j < pst->length); j++)
+                  if (((int) j <= pst->win_r_width[i] + shift) && (pst->win_coefficient[i][j - shift] != 0.0))
+                     r[t * pst->width + j] += wu * pst->win_coefficient[i][j - shift];
+            }
+   }
+}
+
+/* HTS_PStream_gv_objective: objective -(hmmobj + gvobj) of HTS_PStream_calc_derivative() at c and its exact gradient g (zero on frames without GV) */
+static double HTS_PStream_gv_objective(HTS_PStream * pst, size_t m, const double *r, const double *wum, const double *c, double *g)
+{
+   const size_t T = pst->length, W = pst->width;
+   size_t t, i;
+   double mean = 0.0, vari = 0.0, rc, hmmobj = 0.0, dv;
+   double w = 1.0 / (pst->win_size * pst->length);
+
+   for (t = 0; t < T; t++)
+      if (pst->gv_switch[t])
+         mean += c[t];
+   mean /= pst->gv_length;
+   for (t = 0; t < T; t++)
+      if (pst->gv_switch[t])
+         vari += (c[t] - mean) * (c[t] - mean);
+   vari /= pst->gv_length;
+   dv = 2.0 * W2 * pst->gv_vari[m] * (vari - pst->gv_mean[m]) / pst->gv_length;
+
+   for (t = 0; t < T; t++) {
+      rc = r[t * W] * c[t];
+      for (i = 1; i < W; i++) {
+         if (t + i < T)
+            rc += r[t * W + i] * c[t + i];
+         if (t >= i)
+            rc += r[(t - i) * W + i] * c[t - i];
+      }
+      hmmobj += W1 * w * c[t] * (wum[t] - 0.5 * rc);
+      g[t] = pst->gv_switch[t] ? -W1 * w * (wum[t] - rc) + dv * (c[t] - mean) : 0.0;
+   }
+
+   return -(hmmobj - 0.5 * W2 * vari * pst->gv_vari[m] * (vari - 2.0 * pst->gv_mean[m]));
+}
+
+/* HTS_PStream_gv_precondition: q <- (W1 * w * W'U^{-1}W)^{-1} q using the LDL factor l of the band, masked to frames with GV */
+static void HTS_PStream_gv_precondition(HTS_PStream * pst, const double *l, double *q)
+{
+   const size_t T = pst->length, W = pst->width;
+   size_t rev, t, i;
+   double w = 1.0 / (pst->win_size * pst->length);
+
+   for (t = 0; t < T; t++)
+      for (i = 1; (i < W) && (t >= i); i++)
+         q[t] -= l[(t - i) * W + i] * q[t - i];
+   for (rev = 0; rev < T; rev++) {
+      t = T - 1 - rev;
+      q[t] /= l[t * W];
+      for (i = 1; (i < W) && (t + i < T); i++)
+         q[t] -= l[t * W + i] * q[t + i];
+   }
+   for (t = 0; t < T; t++)
+      q[t] = pst->gv_switch[t] ? q[t] / (W1 * w) : 0.0;
+}
+
+/* HTS_PStream_gv_lbfgs: parameter generation using GV of dimension m by L-BFGS from the GV-scaled ML solution */
+/* the inverse of the HMM term of the Hessian is used as the initial inverse Hessian, so most of the work of */
+/* each iteration is two banded triangular solves; the dimension is independent of the others, and work */
+/* holds length * (2 * width + 6 + 2 * GV_LBFGS_HISTORY) + 2 * GV_LBFGS_HISTORY values */
+static void HTS_PStream_gv_lbfgs(HTS_PStream * pst, size_t m, double *work)
+{
+   const size_t T = pst->length, W = pst->width, H = GV_LBFGS_HISTORY;
+   size_t t, i, j, k, n = 0, iter;
+   double *r = work, *l = r + T * W, *wum = l + T * W, *c = wum + T, *g = c + T;
+   double *cn = g + T, *gn = cn + T, *d = gn + T, *s = d + T, *y = s + H * T, *rho = y + H * T, *alpha = rho + H;
+   double mean, vari, ratio, f, fn, gd, sy, yy, step, g0, gnorm = 0.0, beta;
+   HTS_GVStat *stat = &pst->gv_stat[m];
+
+   /* GV-scaled ML solution */
+   for (t = 0, mean = 0.0; t < T; t++) {
+      c[t] = pst->par[t][m];
+      if (pst->gv_switch[t])
+         mean += c[t];
+   }
+   mean /= pst->gv_length;
+   for (t = 0, vari = 0.0; t < T; t++)
+      if (pst->gv_switch[t])
+         vari += (c[t] - mean) * (c[t] - mean);
+   vari /= pst->gv_length;
+   ratio = sqrt(pst->gv_mean[m] / vari);
+   for (t = 0; t < T; t++)
+      if (pst->gv_switch[t])
+         c[t] = ratio * (c[t] - mean) + mean;
+
+   /* band and its LDL factor */
+   HTS_PStream_gv_band(pst, m, r, wum);
+   for (t = 0; t < T * W; t++)
+      l[t] = r[t];
+   for (t = 0; t < T; t++) {
+      for (i = 1; (i < W) && (t >= i); i++)
+         l[t * W] -= l[(t - i) * W + i] * l[(t - i) * W + i] * l[(t - i) * W];
+      for (i = 1; i < W; i++) {
+         for (j = 1; (i + j < W) && (t >= j); j++)
+            l[t * W + i] -= l[(t - j) * W + j] * l[(t - j) * W + i + j] * l[(t - j) * W];
+         l[t * W + i] /= l[t * W];
+      }
+   }
+
+   f = HTS_PStream_gv_objective(pst, m, r, wum, c, g);
+   for (t = 0, g0 = 0.0; t < T; t++)
+      g0 += g[t] * g[t];
+   g0 = sqrt(g0);
+   stat->converged = (g0 == 0.0) ? TRUE : FALSE;
+
+   for (iter = 0; iter < GV_LBFGS_MAX_ITERATION && !stat->converged; iter++) {
+      /* two-loop recursion over the last n pairs, pair k at slot k % H */
+      for (t = 0; t < T; t++)
+         d[t] = g[t];
+      for (i = 0; i < n; i++) {
+         k = (iter - 1 - i) % H;
+         for (t = 0, alpha[k] = 0.0; t < T; t++)
+            alpha[k] += s[k * T + t] * d[t];
+         alpha[k] *= rho[k];
+         for (t = 0; t < T; t++)
+            d[t] -= alpha[k] * y[k * T + t];
+      }
+      HTS_PStream_gv_precondition(pst, l, d);
+      for (i = n; i > 0; i--) {
+         k = (iter - i) % H;
+         for (t = 0, beta = 0.0; t < T; t++)
+            beta += y[k * T + t] * d[t];
+         beta *= rho[k];
+         for (t = 0; t < T; t++)
+            d[t] += (alpha[k] - beta) * s[k * T + t];
+      }
+      for (t = 0, gd = 0.0; t < T; t++)
+         gd -= g[t] * d[t];
+      if (gd >= 0.0) {          /* not a descent direction: restart from the preconditioned gradient */
+         n = 0;
+         for (t = 0; t < T; t++)
+            d[t] = g[t];
+         HTS_PStream_gv_precondition(pst, l, d);
+         for (t = 0, gd = 0.0; t < T; t++)
+            gd -= g[t] * d[t];
+      }
+
+      /* backtracking line search with the Armijo condition along -d */
+      for (step = 1.0, fn = f, j = 0; j < 30; j++, step *= 0.5) {
+         for (t = 0; t < T; t++)
+            cn[t] = c[t] - step * d[t];
+         fn = HTS_PStream_gv_objective(pst, m, r, wum, cn, gn);
+         if (fn <= f + 1.0e-4 * step * gd)
+            break;
+      }
+      if (j == 30)
+         break;
+
+      /* update history and the current point */
+      k = iter % H;
+      for (t = 0, sy = 0.0, yy = 0.0, gnorm = 0.0; t < T; t++) {
+         s[k * T + t] = cn[t] - c[t];
+         y[k * T + t] = gn[t] - g[t];
+         sy += s[k * T + t] * y[k * T + t];
+         yy += y[k * T + t] * y[k * T + t];
+         c[t] = cn[t];
+         g[t] = gn[t];
+         gnorm += g[t] * g[t];
+      }
+      if (sy > 1.0e-12 * yy) {
+         rho[k] = 1.0 / sy;
+         if (n < H)
+            n++;
+      } else {
+         n = 0;
+      }
+      f = fn;
+      if (sqrt(gnorm) <= GV_LBFGS_TOLERANCE * g0)
+         stat->converged = TRUE;
+   }
+
+   for (t = 0, gnorm = 0.0; t < T; t++) {
+      pst->par[t][m] = c[t];
+      gnorm += g[t] * g[t];
+   }
+   stat->iteration = iter;
+   stat->objective = f;
+   stat->gradient = (g0 > 0.0) ? sqrt(gnorm) / g0 : 0.0;
+}
+
+/* HTS_GVJob: dimensions of one stream handed to the threads */
+typedef struct _HTS_GVJob {
+   HTS_PStream *pst;
+   double *work;                /* working area of each thread */
+   size_t worksize;
+} HTS_GVJob;
+
+static void HTS_PStream_gv_job(void *arg, const int thread, const int job)
+{
+   HTS_GVJob *j = (HTS_GVJob *) arg;
+
+   HTS_PStream_gv_lbfgs(j->pst, (size_t) job, j->work + thread * j->worksize);
+}
+
+/* HTS_PStream_mlpg_lanes: solve dimensions m0, ..., m0+n-1 (n <= HTS_MLPG_LANES) together */
+/* the pdfs of the group are first copied to structure-of-arrays form, x[(t * k + i) * HTS_MLPG_LANES + l] for dimension m0+l, */
+/* so the band structure is walked once for all lanes and the lane loops have a fixed trip count; */
+/* unused lanes solve a dummy problem, and each lane repeats the operations of the functions above exactly */
+static void HTS_PStream_mlpg_lanes(HTS_PStream * pst, size_t m0, size_t n, double *work)
+{
+   const size_t L = HTS_MLPG_LANES, W = pst->width, K = pst->win_size;
+   size_t t, i, j, l, rev;
+   int shift;
+   double c, wu[HTS_MLPG_LANES], acc[HTS_MLPG_LANES], tmp[HTS_MLPG_LANES];
+   double *iv, *mu, *wuw, *wum, *g, *p, *q, *r;
+
+   iv = work;
+   mu = iv + pst->length * K * L;
+   wuw = mu + pst->length * K * L;
+   wum = wuw + pst->length * W * L;
+   g = wum + pst->length * L;
+
+   /* copy pdfs */
+   for (t = 0; t < pst->length; t++)
+      for (i = 0; i < K; i++) {
+         p = &iv[(t * K + i) * L];
+         q = &mu[(t * K + i) * L];
+         for (l = 0; l < L; l++) {
+            p[l] = (l < n) ? pst->sm.ivar[t][i * pst->vector_length + m0 + l] : 1.0;
+            q[l] = (l < n) ? pst->sm.mean[t][i * pst->vector_length + m0 + l] : 0.0;
+         }
+      }
+
+   /* calc WUW & WUM */
+   for (t = 0; t < pst->length; t++) {
+      for (l = 0; l < L; l++)
+         acc[l] = 0.0;
+      for (i = 0; i < W * L; i++)
+         wuw[t * W * L + i] = 0.0;
+
+      for (i = 0; i < K; i++)
+         for (shift = pst->win_l_width[i]; shift <= pst->win_r_width[i]; shift++)
+            if (((int) t + shift >= 0) && ((int) t + shift < pst->length) && (pst->win_coefficient[i][-shift] != 0.0)) {
+               c = pst->win_coefficient[i][-shift];
+               p = &iv[((t + shift) * K + i) * L];
+               q = &mu[((t + shift) * K + i) * L];
+               for (l = 0; l < L; l++) {
+                  wu[l] = c * p[l];
+                  acc[l] += wu[l] * q[l];
+               }
+               for (j = 0; (j < W) && (t + j < pst->length); j++)
+                  if (((int) j <= pst->win_r_width[i] + shift) && (pst->win_coefficient[i][j - shift] != 0.0)) {
+                     c = pst->win_coefficient[i][j - shift];
+                     p = &wuw[(t * W + j) * L];
+                     for (l = 0; l < L; l++)
+                        tmp[l] = p[l] + wu[l] * c;
+                     for (l = 0; l < L; l++)
+                        p[l] = tmp[l];
+                  }
+            }
+      for (l = 0; l < L; l++)
+         wum[t * L + l] = acc[l];
+   }
+
+   /* LDL factorization */
+   for (t = 0; t < pst->length; t++) {
+      p = &wuw[t * W * L];
+      for (l = 0; l < L; l++)
+         acc[l] = p[l];
+      for (i = 1; (i < W) && (t >= i); i++) {
+         q = &wuw[(t - i) * W * L];
+         for (l = 0; l < L; l++)
+            acc[l] -= q[i * L + l] * q[i * L + l] * q[l];
+      }
+      for (l = 0; l < L; l++)
+         p[l] = acc[l];
+      for (i = 1; i < W; i++) {
+         for (l = 0; l < L; l++)
+            tmp[l] = p[i * L + l];
+         for (j = 1; (i + j < W) && (t >= j); j++) {
+            q = &wuw[(t - j) * W * L];
+            for (l = 0; l < L; l++)
+               tmp[l] -= q[j * L + l] * q[(i + j) * L + l] * q[l];
+         }
+         for (l = 0; l < L; l++)
+            p[i * L + l] = tmp[l] / acc[l];
+      }
+   }
+
+   /* forward substitution */
+   for (t = 0; t < pst->length; t++) {
+      for (l = 0; l < L; l++)
+         acc[l] = wum[t * L + l];
+      for (i = 1; (i < W) && (t >= i); i++) {
+         q = &wuw[((t - i) * W + i) * L];
+         r = &g[(t - i) * L];
+         for (l = 0; l < L; l++)
+            acc[l] -= q[l] * r[l];
+      }
+      for (l = 0; l < L; l++)
+         g[t * L + l] = acc[l];
+   }
+
+   /* backward substitution, overwriting g by the parameters */
+   for (rev = 0; rev < pst->length; rev++) {
+      t = pst->length - 1 - rev;
+      q = &wuw[t * W * L];
+      for (l = 0; l < L; l++)
+         acc[l] = g[t * L + l] / q[l];
+      for (i = 1; (i < W) && (t + i < pst->length); i++) {
+         r = &g[(t + i) * L];
+         for (l = 0; l < L; l++)
+            acc[l] -= q[i * L + l] * r[l];
+      }
+      for (l = 0; l < L; l++)
+         g[t * L + l] = acc[l];
+      for (l = 0; l < n; l++)
+         pst->par[t][m0 + l] = acc[l];
+   }
+}
+
+/* HTS_MLPGJob: dimension groups of one stream handed to the threads */
+typedef struct _HTS_MLPGJob {
+   HTS_PStream *pst;
+   double *work;                /* working area of each thread */
+   size_t worksize;
+} HTS_MLPGJob;
+
+static void HTS_PStream_mlpg_job(void *arg, const int thread, const int job)
+{
+   HTS_MLPGJob *j = (HTS_MLPGJob *) arg;
+   const size_t L = HTS_MLPG_LANES, m0 = (size_t) job * L, vl = j->pst->vector_length;
+
+   HTS_PStream_mlpg_lanes(j->pst, m0, (vl - m0 < L) ? vl - m0 : L, j->work + thread * j->worksize);
 }
 
 /* HTS_PStream_mlpg: generate sequence of speech parameter vector maximizing its output probability for given pdf sequence */
-static void HTS_PStream_mlpg(HTS_PStream * pst)
+static void HTS_PStream_mlpg(HTS_PStream * pst, void *pool, HTS_GVSolver solver)
 {
    size_t m;
+   int nthread;
+   HTS_MLPGJob job;
+   HTS_GVJob gvjob;
 
    if (pst->length == 0)
       return;
 
-   for (m = 0; m < pst->vector_length; m++) {
-      HTS_PStream_calc_wuw_and_wum(pst, m);
+   if (pst->vector_length == 1) {
+      HTS_PStream_calc_wuw_and_wum(pst, 0);
       HTS_PStream_ldl_factorization(pst);       /* LDL factorization */
       HTS_PStream_forward_substitution(pst);    /* forward substitution   */
-      HTS_PStream_backward_substitution(pst, m);        /* backward substitution  */
-      if (pst->gv_length > 0)
-         HTS_PStream_gv_parmgen(pst, m);
+      HTS_PStream_backward_substitution(pst, 0);        /* backward substitution  */
+   } else {
+      nthread = (pool != NULL) ? ((THREADPOOL *) pool)->nthread : 1;
+      job.pst = pst;
+      job.worksize = pst->length * (2 * pst->win_size + pst->width + 2) * HTS_MLPG_LANES;
+      job.work = (double *) HTS_calloc(job.worksize * nthread, sizeof(double));
+      run_THREADPOOL((THREADPOOL *) pool, (int) ((pst->vector_length + HTS_MLPG_LANES - 1) / HTS_MLPG_LANES), HTS_PStream_mlpg_job, &job);
+      HTS_free(job.work);
+   }
+
+   if (pst->gv_length > 0) {
+      if (solver == HTS_GV_LBFGS) {
+         nthread = (pool != NULL) ? ((THREADPOOL *) pool)->nthread : 1;
+         gvjob.pst = pst;
+         gvjob.worksize = pst->length * (2 * pst->width + 6 + 2 * GV_LBFGS_HISTORY) + 2 * GV_LBFGS_HISTORY;
+         gvjob.work = (double *) HTS_calloc(gvjob.worksize * nthread, sizeof(double));
+         run_THREADPOOL((THREADPOOL *) pool, (int) pst->vector_length, HTS_PStream_gv_job, &gvjob);
+         HTS_free(gvjob.work);
+      } else {
+         for (m = 0; m < pst->vector_length; m++)
+            HTS_PStream_gv_parmgen(pst, m);
+      }
    }
 }
 
@@ -269,6 +653,20 @@ void HTS_PStreamSet_initialize(HTS_PStreamSet * pss)
    pss->pstream = NULL;
    pss->nstream = 0;
    pss->total_frame = 0;
+   pss->pool = NULL;
+   pss->gv_solver = HTS_GV_GRADIENT;
+}
+
+/* HTS_PStreamSet_set_thread_pool: split mlpg of each stream into dimension groups run on pool (NULL: serial) */
+void HTS_PStreamSet_set_thread_pool(HTS_PStreamSet * pss, void *pool)
+{
+   pss->pool = pool;
+}
+
+/* HTS_PStreamSet_set_gv_solver: select the algorithm of parameter generation considering GV */
+void HTS_PStreamSet_set_gv_solver(HTS_PStreamSet * pss, HTS_GVSolver solver)
+{
+   pss->gv_solver = solver;
 }
 
 /* HTS_PStreamSet_create: parameter generation using GV weight */
@@ -367,7 +765,9 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
          for (j = 0, pst->gv_length = 0; j < pst->length; j++)
             if (pst->gv_switch[j])
                pst->gv_length++;
+         pst->gv_stat = (HTS_GVStat *) HTS_calloc(pst->vector_length, sizeof(HTS_GVStat));
       } else {
+         pst->gv_stat = NULL;
          pst->gv_switch = NULL;
          pst->gv_length = 0;
          pst->gv_mean = NULL;
@@ -424,7 +824,7 @@ HTS_Boolean HTS_PStreamSet_create(HTS_PStreamSet * pss, HTS_SStreamSet * sss, do
          }
       }
       /* parameter generation */
-      HTS_PStream_mlpg(pst);
+      HTS_PStream_mlpg(pst, pss->pool, pss->gv_solver);
    }
 
    return TRUE;
@@ -466,6 +866,14 @@ HTS_Boolean HTS_PStreamSet_get_msd_flag(HTS_PStreamSet * pss, size_t stream_inde
    return pss->pstream[stream_index].msd_flag[frame_index];
 }
 
+/* HTS_PStreamSet_get_gv_stat: get convergence of parameter generation considering GV (NULL: GV not used) */
+const HTS_GVStat *HTS_PStreamSet_get_gv_stat(HTS_PStreamSet * pss, size_t stream_index, size_t vector_index)
+{
+   if (pss->pstream[stream_index].gv_stat == NULL)
+      return NULL;
+   return &pss->pstream[stream_index].gv_stat[vector_index];
+}
+
 /* HTS_PStreamSet_is_msd: get MSD flag */
 HTS_Boolean HTS_PStreamSet_is_msd(HTS_PStreamSet * pss, size_t stream_index)
 {
@@ -477,6 +885,8 @@ void HTS_PStreamSet_clear(HTS_PStreamSet * pss)
 {
    size_t i, j;
    HTS_PStream *pstream;
+   void *pool;
+   HTS_GVSolver solver;
 
    if (pss->pstream) {
       for (i = 0; i < pss->nstream; i++) {
@@ -513,10 +923,16 @@ void HTS_PStreamSet_clear(HTS_PStreamSet * pss)
             HTS_free(pstream->win_r_width);
          if (pstream->gv_switch)
             HTS_free(pstream->gv_switch);
+         if (pstream->gv_stat)
+            HTS_free(pstream->gv_stat);
       }
       HTS_free(pss->pstream);
    }
+   pool = pss->pool;
+   solver = pss->gv_solver;
    HTS_PStreamSet_initialize(pss);
+   pss->pool = pool;
+   pss->gv_solver = solver;
 }
 
 HTS_PSTREAM_C_END;
@@ -116,6 +116,52 @@ typedef struct {
    double im;
 } Complex;
 
+/* simd level of the running cpu (see fftsimd_level) */
+#define SPTK_SIMD_NONE 0
+#define SPTK_SIMD_SSE2 1        /* SSE2 or NEON */
+#define SPTK_SIMD_AVX2 2
+
+/* plan for mixed-radix fft */
+#define FFTPLAN_MAXFACTOR 32
+typedef struct _FFTPLAN {
+   int n;                       /* transform size */
+   int nfactor;                 /* number of factors of n */
+   int factor[2 * FFTPLAN_MAXFACTOR];   /* (radix, remaining length) pairs */
+   int nhfactor;                /* number of factors of n/2 (0 if n is odd) */
+   int hfactor[2 * FFTPLAN_MAXFACTOR];
+   Complex *tw;                 /* twiddle factors exp(-2 pi j k / n) */
+   Complex *in;                 /* working area */
+   Complex *out;
+   Complex *scratch;
+} FFTPLAN;
+
+/* shared twiddle table (see fftcache) */
+typedef enum _TwiddleType { TWIDDLE_FFT, TWIDDLE_DCT } TwiddleType;
+typedef struct _TWIDDLE {
+   TwiddleType type;
+   int size;                    /* transform size */
+   int nref;                    /* number of users */
+   double *table;               /* read only once built */
+   struct _TWIDDLE *next;
+} TWIDDLE;
+
+/* thread pool (see lib/threadpool.c) */
+typedef struct _THREADPOOL {
+   int nthread;
+   void *impl;
+} THREADPOOL;
+
+/* bump allocator (see lib/getmem.c) */
+typedef struct _ARENA {
+   size_t block_size;           /* minimum size of a block in bytes */
+   void *(*alloc) (size_t);     /* allocator of blocks */
+   void (*release) (void *);    /* deallocator of blocks */
+   void *first;                 /* list of blocks */
+   void *cur;                   /* block being filled */
+   size_t used;                 /* bytes used in cur */
+   size_t base;                 /* bytes in the blocks before cur */
+} ARENA;
+
 /* struct for Gaussian distribution */
 typedef struct _Gauss {
    double *mean;
@@ -134,6 +180,68 @@ typedef struct _GMM {
    Gauss *gauss;
 } GMM;
 
+/* GMM packed for batched evaluation (see bin/gmm/_gmmbatch.c); one
+   from load_PGMM() may point into a read-only mapping of the file, so
+   it must not be modified */
+#define PGMM_ALIGN 8            /* row alignment in doubles */
+#define PGMM_FRAMES 8           /* input vectors evaluated together */
+typedef struct _PGMM {
+   int nmix;
+   int dim;
+   int ld;                      /* row stride, dim rounded up to PGMM_ALIGN */
+   Boolean full;
+   double *lconst;              /* log(weight) - gconst / 2, [nmix] */
+   double *mean;                /* [nmix][ld] */
+   double *prec;                /* inverse Cholesky factors, [nmix][dim][ld],
+                                   or 1 / sqrt(var), [nmix][ld] */
+   double *block;               /* storage of all the above */
+   size_t mapped;               /* bytes of the file mapped at block
+                                   (see load_PGMM()), 0: on the heap */
+} PGMM;
+
+/* sufficient statistics of GMM (see bin/gmm/_gmmem.c) */
+typedef struct _GMMSTATS {
+   int nmix;
+   int dim;
+   Boolean full;
+   double loglik;               /* total log-likelihood */
+   double *occ;                 /* occupancies, [nmix] */
+   double *sum;                 /* first order, [nmix][dim] */
+   double *sqr;                 /* second order, [nmix][dim] or lower
+                                   triangles [nmix][dim][dim] */
+} GMMSTATS;
+
+/* EM trainer of GMM */
+typedef struct _GMMEM {
+   int nshard;                  /* number of shards of training data */
+   GMMSTATS *stats;             /* one per shard, summed into stats[0] */
+   double weight_floor;         /* floorWeight_GMM() (<= 0: not applied) */
+   double var_floor;            /* floorVar_GMM() (<= 0: not applied) */
+   const int *dim_list;         /* maskCov_GMM() (NULL: not applied) */
+   int cov_dim;
+   Boolean block_full;
+   Boolean block_corr;
+} GMMEM;
+
+/* state of gmmpost_push() (see bin/gmm/_gmmpost.c) */
+typedef struct _GMMPOST {
+   const PGMM *p;               /* model, owned by the caller */
+   int topk;                    /* posteriors per frame */
+   int nclust;                  /* clusters of components (0: none) */
+   int nsel;                    /* clusters scored per frame */
+   int nlist;                   /* length of prev */
+   long stamp;                  /* frame counter for mark */
+   int *list, *prev;            /* candidates, shortlist of last frame */
+   long *mark;                  /* stamp of the frame a component was listed */
+   double *lw, *z, *diff;       /* scores of candidates, work */
+   double *scale;               /* average precision of each dimension */
+   double *centroid;            /* scaled centroids, [nclust][dim] */
+   double *cdist;               /* distances to centroids */
+   int *cluster;                /* cluster of each component */
+   int *first, *member;         /* members of each cluster */
+   int *csel;                   /* work */
+} GMMPOST;
+
 typedef struct _deltawindow {
    size_t win_size;
    size_t win_max_width;
@@ -142,6 +250,206 @@ typedef struct _deltawindow {
    double **win_coefficient;
 } DELTAWINDOW;
 
+/* state of mlpgstream_push() */
+typedef struct _mlpgstream {
+   const DELTAWINDOW *window;   /* dynamic windows, owned by the caller */
+   int dim;                     /* length of static feature vector */
+   int delay;                   /* look-ahead in frames */
+   int width;                   /* band width of W'U^{-1}W */
+   int size;                    /* number of frames kept */
+   long nin;                    /* frames pushed */
+   long nout;                   /* frames emitted */
+   long nfinal;                 /* first row of the LDL not yet final */
+   Boolean flushed;             /* backward substitution done for the end */
+   double *mean, *ivar;         /* pdfs, [size][win_size][dim] */
+   double *wuw, *wum, *g, *par; /* LDL factors and substitutions */
+} MLPGSTREAM;
+
+/* model dependent part of vc(), see alloc_VCMODEL() */
+/* algorithm of parameter generation considering GV in vc_model() */
+typedef enum _VCGVSolver {
+   VC_GV_GRADIENT,              /* fixed number of gradient steps */
+   VC_GV_LBFGS                  /* preconditioned L-BFGS until convergence */
+} VCGVSolver;
+
+/* convergence of parameter generation considering GV for one dimension */
+typedef struct _VCGVSTAT {
+   size_t iteration;            /* number of iterations */
+   double objective;            /* final objective (to be minimized) */
+   double gradient;             /* final gradient norm relative to the
+                                   initial one (VC_GV_LBFGS only) */
+   Boolean converged;           /* tolerance reached (VC_GV_LBFGS only) */
+} VCGVSTAT;
+
+typedef struct _VCMODEL {
+   const DELTAWINDOW *window;   /* dynamic windows, owned by the caller */
+   VCGVSolver gv_solver;        /* VC_GV_GRADIENT after alloc_VCMODEL() */
+   int nmix;                    /* number of mixture components */
+   size_t source_vlen;          /* length of static source vector */
+   size_t target_vlen;          /* length of static target vector */
+   size_t src_dim, tgt_dim;     /* lengths with dynamic features */
+   size_t ldx, ldy;             /* row strides, src_dim and tgt_dim rounded up */
+   double *log_weight;          /* log mixture weights, [nmix] */
+   double *gconst;              /* gconst of source marginals, [nmix] */
+   double *mean_x, *mean_y;     /* source and target means, [nmix][ldx or ldy] */
+   double *prec;                /* inverse source covariances, [nmix][src_dim][ldx] */
+   double *reg;                 /* cov_yx cov_xx^{-1}, [nmix][tgt_dim][ldx] */
+   double *cond_vari;           /* conditional variances, [nmix][ldy] */
+   double *block;               /* storage of all the above */
+} VCMODEL;
+
+/* state of vcstream_push() */
+typedef struct _vcstream {
+   const VCMODEL *model;        /* compiled model, owned by the caller */
+   MLPGSTREAM mlpg;             /* parameter generation */
+   int size;                    /* source frames kept, 2 * win_max_width + 1 */
+   long nin;                    /* source frames pushed */
+   long nconv;                  /* frames converted */
+   double *src;                 /* last source frames, [size][source_vlen] */
+   double *x, *work;            /* source with dynamic features and scratch,
+                                   [src_dim] each */
+   double *mean, *vari;         /* conditional pdf of a frame, [tgt_dim] */
+} VCSTREAM;
+
+/* size of working area for theq_r() */
+#define THEQ_WORKSIZE(n) (14 * (n))
+
+/* frequency warping operator */
+typedef enum _WarpType { WARP_FREQT, WARP_FRQTR, WARP_B2C } WarpType;
+typedef struct _warpmat {
+   WarpType type;
+   int m1;                      /* order of input */
+   int m2;                      /* order of output */
+   double a;                    /* all-pass constant */
+   double *mat;                 /* (m2+1) x (m1+1), row major */
+} WARPMAT;
+
+/* initial state of mseq_r() */
+#define MSEQ_INIT 0x55555555
+
+/* number of streams of mlsadf_lanes() etc. must be a multiple of this */
+#define FILTER_LANES 4
+
+/* state of mlsadf_block() */
+typedef struct _mlsadfstate {
+   int m;                       /* order of cepstrum */
+   double a;                    /* all-pass constant */
+   int pd;                      /* order of Pade approximation */
+   Boolean ngain;               /* TR: filter without gain exp(b[0]) */
+   double *d;                   /* delay */
+   double *b, *inc;             /* interpolated coefficients */
+} MLSADFSTATE;
+
+/* state of vocoder_push() */
+typedef struct _vocoder {
+   int m;                       /* order of mel-cepstrum */
+   double a;                    /* all-pass constant */
+   int fprd;                    /* frame period */
+   int iprd;                    /* interpolation period of pitch */
+   Boolean gauss;               /* TR: Gaussian noise, FA: M-sequence */
+   int seed;                    /* seed of nrandom_r() */
+   unsigned long next;          /* state of nrandom_r() */
+   int sw;                      /* nonzero while r is pending */
+   double r;                    /* pending value of nrandom_r() */
+   int mseq;                    /* state of mseq_r() */
+   Boolean first;               /* no frame pushed yet */
+   double p1;                   /* pitch of the previous frame */
+   double pc;                   /* phase of the pulse train */
+   double *b0, *b1;             /* MLSA coefficients of previous/current frame */
+   MLSADFSTATE filter;
+} VOCODER;
+
+/* working area for mcep_r() */
+typedef struct _mcepwork {
+   int flng;
+   int m;
+   double *x, *y, *c;
+   double *d, *al, *b;
+   double *wk;
+   double *tq;
+   WARPMAT fw;                  /* freqt(mc -> c) of the Newton loop */
+   WARPMAT rw;                  /* frqtr(c -> r) of the Newton loop */
+   Boolean quiet;               /* TR: do not print errors to stderr */
+} MCEPWORK;
+
+/* working area for mgcep_r() and newton_r() */
+typedef struct _mgcepwork {
+   int flng;
+   int m;
+   int n;
+   double *x, *y, *d;
+   double *cr, *ci, *pr, *qr, *qi, *rr, *ri, *b;
+   double *wk;
+   double *tq;
+} MGCEPWORK;
+
+/* working area for smcep_r() */
+typedef struct _smcepwork {
+   int flng;
+   int m;
+   int fftsz;
+   double a;
+   double t;
+   double *x, *y, *c;
+   double *d, *al, *b;
+   double *l, *g, *h, *k;
+   double *tc2;
+   double *tq;
+} SMCEPWORK;
+
+/* working area for gcep_r() */
+typedef struct _gcepwork {
+   int flng;
+   int m;
+   double *x, *y, *cr, *ci, *rr, *hr, *hi, *er, *ei;
+   double *wk;
+   double *tq;
+} GCEPWORK;
+
+/* working area for uels_r() */
+typedef struct _uelswork {
+   int flng;
+   int m;
+   double *x, *r, *cr, *y;
+   double *a;
+   double *p, *pp;
+} UELSWORK;
+
+/* working area for dct_r() */
+typedef struct _dctwork {
+   int size;
+   Boolean dftmode;
+   TWIDDLE *weight;             /* shared, pWeightReal/Imag point into it */
+   double *pWeightReal, *pWeightImag;
+   double *pLocalReal, *pLocalImag;
+   double *x, *y, *pReal, *pImag;
+} DCTWORK;
+
+/* working area for mfcc_r() */
+typedef struct _mfccwork {
+   int wlng;
+   int flng;
+   int m;
+   int n;
+   Boolean dftmode;
+   double *x, *px, *wx, *sp, *fb, *dc;
+   double *hw;
+   double *y, *mag;
+   double *countMel, *w;
+   int *noMel;
+   DCTWORK dct;
+} MFCCWORK;
+
+/* working area for lbg_r() */
+typedef struct _lbgwork {
+   int l;
+   int tnum;
+   int ecbsize;
+   double *cb1;
+   int *tindex;
+   int *cntcb;
+} LBGWORK;
+
 /* structure for wavsplit and wavjoin */
 typedef struct _wavfile {
    int file_size;               /* file size */
@@ -179,6 +487,10 @@ int fwrite_little_endian(void *ptr, const size_t size,
                          const size_t n, FILE * fp);
 void fillz(void *ptr, const size_t size, const int nitem);
 FILE *getfp(char *name, char *opt);
+int alloc_THREADPOOL(THREADPOOL * pool, const int nthread);
+int free_THREADPOOL(THREADPOOL * pool);
+int run_THREADPOOL(THREADPOOL * pool, const int njob,
+                   void (*func) (void *, const int, const int), void *arg);
 short *sgetmem(const int leng);
 long *lgetmem(const int leng);
 double *dgetmem(const int leng);
@@ -187,16 +499,30 @@ float *fgetmem(const int leng);
 float **ffgetmem(const int leng);
 double **ddgetmem(const int leng1, const int leng2);
 char *getmem(const size_t leng, const size_t size);
+int alloc_ARENA(ARENA * a, const size_t block_size, void *(*alloc) (size_t),
+                void (*release) (void *));
+int free_ARENA(ARENA * a);
+int reset_ARENA(ARENA * a);
+size_t mark_ARENA(const ARENA * a);
+int rewind_ARENA(ARENA * a, const size_t mark);
+char *agetmem(ARENA * a, const size_t leng, const size_t size);
+double *adgetmem(ARENA * a, const size_t leng);
+double **addgetmem(ARENA * a, const size_t leng1, const size_t leng2);
+void afree(ARENA * a, void *p);
 double gexp(const double r, const double x);
 double glog(const double r, const double x);
 int ifftr(double *x, double *y, const int l);
+int ifftrf(float *x, float *y, const int l);
 double invert(double **mat, double **inv, const int n);
 void multim(double x[], const int xx, const int xy, double y[], const int yx,
             const int yy, double a[]);
 void addm(double x[], double y[], const int xx, const int yy, double a[]);
 void movem(void *a, void *b, const size_t size, const int nitem);
 int mseq(void);
+int mseq_r(int *x);
 int theq(double *t, double *h, double *a, double *b, const int n, double eps);
+int theq_r(double *t, double *h, double *a, double *b, const int n, double eps,
+           double *wk);
 int toeplitz(double *t, double *a, double *b, const int n, double eps);
 
 
@@ -231,38 +557,100 @@ int dct_based_on_fft(double *pReal, double *pImag, const double *pInReal,
                      const double *pInImag);
 int dct_based_on_dft(double *pReal, double *pImag, const double *pInReal,
                      const double *pInImag);
+int dct_r(DCTWORK * w, double *in, double *out, const int size, const int m,
+          const Boolean compmode);
+int alloc_DCTWORK(DCTWORK * w, const int size, const Boolean dftmode);
+int free_DCTWORK(DCTWORK * w);
 double df2(const double x, const double sf, const double f0p, const double wbp,
            const double f0z, const double wbz, const int fp, const int fz,
            double *buf, int *bufp);
 double dfs(double x, double *a, int m, double *b, int n, double *buf,
            int *bufp);
 int fft(double *x, double *y, const int m);
+int fftf(float *x, float *y, const int m);
 int fft2(double x[], double y[], const int n);
 void fftcep(double *sp, const int flng, double *c, const int m, int itr,
             double ac);
 int fftr(double *x, double *y, const int m);
+int fftrf(float *x, float *y, const int m);
+int fftsimd_level(void);
+int alloc_FFTPLAN(FFTPLAN * p, const int n);
+int free_FFTPLAN(FFTPLAN * p);
+int fft_plan(FFTPLAN * p, double *x, double *y);
+int ifft_plan(FFTPLAN * p, double *x, double *y);
+int fftr_plan(FFTPLAN * p, double *x, double *y);
+int ifftr_plan(FFTPLAN * p, double *x, double *y);
+TWIDDLE *acquire_TWIDDLE(const TwiddleType type, const int size);
+int release_TWIDDLE(TWIDDLE * t);
+TWIDDLE *shared_TWIDDLE(const int size);
+FFTPLAN *acquire_FFTPLAN(const int n);
+int release_FFTPLAN(FFTPLAN * p);
+int clear_fft_cache(void);
 int fftr2(double x[], double y[], const int n);
 void freqt(double *c1, const int m1, double *c2, const int m2, const double a);
+void freqt_r(double *c1, const int m1, double *c2, const int m2,
+             const double a, double *wk);
+int alloc_WARPMAT(WARPMAT * w, const WarpType type, const int m1,
+                  const int m2, const double a);
+int free_WARPMAT(WARPMAT * w);
+void warpmat(const WARPMAT * w, const double *c1, double *c2);
+void warpmat_batch(const WARPMAT * w, const double *c1, const int stride1,
+                   double *c2, const int stride2, const int n);
 void gc2gc(double *c1, const int m1, const double g1, double *c2, const int m2,
            const double g2);
+void gc2gc_r(double *c1, const int m1, const double g1, double *c2,
+             const int m2, const double g2, double *wk);
 int gcep(double *xw, const int flng, double *gc, const int m, const double g,
          const int itr1, const int itr2, const double d, const int etype,
          const double e, const double f, const int itype);
+int gcep_r(GCEPWORK * w, double *xw, const int flng, double *gc, const int m,
+           const double g, const int itr1, const int itr2, const double d,
+           const int etype, const double e, const double f, const int itype);
+int alloc_GCEPWORK(GCEPWORK * w, const int flng, const int m);
+int free_GCEPWORK(GCEPWORK * w);
 double glsadf(double x, double *c, const int m, const int n, double *d);
 double glsadf1(double x, double *c, const int m, const int n, double *d);
 double glsadft(double x, double *c, const int m, const int n, double *d);
 double glsadf1t(double x, double *c, const int m, const int n, double *d);
 double cal_gconst(double *var, const int D);
 double cal_gconstf(double **var, const int D);
+void cal_inv(double **cov, double **inv, const int L);
+int cal_inv_r(double **cov, double **inv, const int L, ARENA * arena);
 double log_wgd(const GMM * gmm, const int m, const int L1, const int L2,
                const double *dat);
 double log_add(double logx, double logy);
+double log_sum_exp(const double *x, const int n, double *w);
 double log_outp(const GMM * gmm, const int L1, const int L2, const double *dat);
 void fillz_GMM(GMM * gmm);
 int alloc_GMM(GMM * gmm, const int M, const int L, const Boolean full);
 int load_GMM(GMM * gmm, FILE * fp);
 int save_GMM(const GMM * gmm, FILE * fp);
 int free_GMM(GMM * gmm);
+int alloc_PGMM(PGMM * p, const GMM * gmm);
+int free_PGMM(PGMM * p);
+int save_PGMM(const PGMM * p, FILE * fp);
+int load_PGMM(PGMM * p, FILE * fp);
+int log_wgd_batch(const PGMM * p, const double *x, const int T, double *lwgd);
+int log_outp_batch(const PGMM * p, const double *x, const int T, double *out);
+int alloc_GMMSTATS(GMMSTATS * s, const int nmix, const int dim,
+                   const Boolean full);
+int free_GMMSTATS(GMMSTATS * s);
+int reset_GMMSTATS(GMMSTATS * s);
+int accum_GMMSTATS(GMMSTATS * s, const PGMM * p, const double *x,
+                   const int T);
+int add_GMMSTATS(GMMSTATS * s, const GMMSTATS * t);
+int alloc_GMMEM(GMMEM * e, const GMM * gmm, const int nshard);
+int free_GMMEM(GMMEM * e);
+int update_GMM(GMMEM * e, GMM * gmm);
+int em_GMM(GMMEM * e, GMM * gmm, const double *x, const int T,
+           THREADPOOL * pool, double *loglik);
+int alloc_GMMPOST(GMMPOST * g, const PGMM * p, const int topk,
+                  const int nclust, const int nsel);
+int free_GMMPOST(GMMPOST * g);
+int reset_GMMPOST(GMMPOST * g);
+int gmmpost_push(GMMPOST * g, const double *x, int *index, double *post,
+                 double *logp);
+int prepare_GMM(GMM * gmm, double *white, THREADPOOL * pool);
 int prepareCovInv_GMM(GMM * gmm);
 int prepareGconst_GMM(GMM * gmm);
 int floorWeight_GMM(GMM * gmm, double floor);
@@ -272,6 +660,7 @@ void grpdelay(double *x, double *gd, const int size, const int is_arma);
 int histogram(double *x, const int size, const double min, const double max,
               const double step, double *h);
 int ifft(double *x, double *y, const int m);
+int ifftf(float *x, float *y, const int m);
 int ifft2(double x[], double y[], const int n);
 double iglsadf(double x, double *c, const int m, const int n, double *d);
 double iglsadf1(double x, double *c, const int m, const int n, double *d);
@@ -293,6 +682,12 @@ void lbg(double *x, const int l, const int tnum, double *icb, int icbsize,
          double *cb, const int ecbsize, const int iter, const int mintnum,
          const int seed, const int centup, const double delta,
          const double end);
+int lbg_r(LBGWORK * w, double *x, const int l, const int tnum, double *icb,
+          int icbsize, double *cb, const int ecbsize, const int iter,
+          const int mintnum, const int seed, const int centup,
+          const double delta, const double end);
+int alloc_LBGWORK(LBGWORK * w, const int l, const int tnum, const int ecbsize);
+int free_LBGWORK(LBGWORK * w);
 int levdur(double *r, double *a, const int m, double eps);
 double lmadf(double x, double *c, const int m, const int pd, double *d);
 double cascade_lmadf(double x, double *c, const int m, const int pd, double *d,
@@ -303,6 +698,8 @@ double lmadf1(double x, double *c, const int m, double *d, const int pd,
               const int m1, const int m2);
 double lmadf2t(double x, double *b, const int m, const int pd, double *d,
                const int m1, const int m2);
+int lmadf_lanes(double *x, double *c, const int m, const int pd, double *d,
+                const int nlane);
 int lpc(double *x, const int flng, double *a, const int m, const double f);
 void lpc2c(double *a, int m1, double *c, const int m2);
 int lpc2lsp(double *lpc, double *lsp, const int order, const int numsp,
@@ -318,13 +715,33 @@ void mc2b(double *mc, double *b, int m, const double a);
 int mcep(double *xw, const int flng, double *mc, const int m, const double a,
          const int itr1, const int itr2, const double dd, const int etype,
          const double e, const double f, const int itype);
+int mcep_r(MCEPWORK * w, const double *xw, const int flng, double *mc,
+           const int m, const double a, const int itr1, const int itr2,
+           const double dd, const int etype, const double e, const double f,
+           const int itype);
+int alloc_MCEPWORK(MCEPWORK * w, const int flng, const int m);
+int free_MCEPWORK(MCEPWORK * w);
+int mcep_batch(THREADPOOL * pool, MCEPWORK * w, const double *frames,
+               const size_t nframes, const size_t stride, const int flng,
+               double *mc, const int m, const double a, const int itr1,
+               const int itr2, const double dd, const int etype,
+               const double e, const double f, const int itype, int *status);
 void mfcc(double *in, double *mc, const double sampleFreq, const double alpha,
           const double eps, const int wlng, const int flng, const int m,
           const int n, const int ceplift, const Boolean dftmode,
           const Boolean usehamming);
+int mfcc_r(MFCCWORK * w, double *in, double *mc, const double sampleFreq,
+           const double alpha, const double eps, const int wlng,
+           const int flng, const int m, const int n, const int ceplift,
+           const Boolean dftmode, const Boolean usehamming);
+int alloc_MFCCWORK(MFCCWORK * w, const int wlng, const int flng, const int m,
+                   const int n, const Boolean dftmode);
+int free_MFCCWORK(MFCCWORK * w);
 void maskCov_GMM(GMM * gmm, const int *dim_list, const int cov_dim,
                  const Boolean block_full, const Boolean block_corr);
 void frqtr(double *c1, int m1, double *c2, int m2, const double a);
+void frqtr_r(double *c1, int m1, double *c2, int m2, const double a,
+             double *wk);
 void mgc2mgc(double *c1, const int m1, const double a1, const double g1,
              double *c2, const int m2, const double a2, const double g2);
 void mgc2sp(double *mgc, const int m, const double a, const double g, double *x,
@@ -337,6 +754,15 @@ int mgcep(double *xw, int flng, double *b, const int m, const double a,
           const int itype);
 double newton(double *x, const int flng, double *c, const int m, const double a,
               const double g, const int n, const int j, const double f);
+int mgcep_r(MGCEPWORK * w, double *xw, int flng, double *b, const int m,
+            const double a, const double g, const int n, const int itr1,
+            const int itr2, const double dd, const int etype, const double e,
+            const double f, const int itype);
+double newton_r(MGCEPWORK * w, double *x, const int flng, double *c,
+                const int m, const double a, const double g, const int n,
+                const int j, const double f);
+int alloc_MGCEPWORK(MGCEPWORK * w, const int flng, const int m, const int n);
+int free_MGCEPWORK(MGCEPWORK * w);
 double mglsadf(double x, double *b, const int m, const double a, const int n,
                double *d);
 double mglsadf1(double x, double *b, const int m, const double a, const int n,
@@ -345,18 +771,36 @@ double mglsadft(double x, double *b, const int m, const double a, const int n,
                 double *d);
 double mglsadf1t(double x, double *b, const int m, const double a, const int n,
                  double *d);
+int mglsadf_lanes(double *x, double *b, const int m, const double a,
+                  const int n, double *d, const int nlane);
+int alloc_MLPGSTREAM(MLPGSTREAM * s, const DELTAWINDOW * window,
+                     const int dim, const int delay);
+int free_MLPGSTREAM(MLPGSTREAM * s);
+int reset_MLPGSTREAM(MLPGSTREAM * s);
+int mlpgstream_push(MLPGSTREAM * s, const double *mean, const double *vari,
+                    double *out);
+int mlpgstream_flush(MLPGSTREAM * s, double *out);
 int str2darray(char *c, double **x);
 int isfloat(char *c);
 double mlsadf(double x, double *b, const int m, const double a, const int pd,
               double *d);
 double mlsadft(double x, double *b, const int m, const double a, const int pd,
                double *d);
+int alloc_MLSADFSTATE(MLSADFSTATE * s, const int m, const double a,
+                      const int pd);
+int free_MLSADFSTATE(MLSADFSTATE * s);
+int reset_MLSADFSTATE(MLSADFSTATE * s);
+int mlsadf_block(MLSADFSTATE * s, const double *x, double *y, const int n,
+                 const double *b0, const double *b1);
+int mlsadf_lanes(double *x, double *b, const int m, const double a,
+                 const int pd, double *d, const int nlane);
 void msvq(double *x, double *cb, const int l, int *cbsize, const int stage,
           int *index);
 void ndps2c(double *n, const int l, double *c, const int m);
 void norm0(double *x, double *y, int m);
 int nrand(double *p, const int leng, const int seed);
 double nrandom(unsigned long *next);
+double nrandom_r(unsigned long *next, int *sw, double *r);
 unsigned long srnd(const unsigned int seed);
 void par2lpc(double *k, double *a, const int m);
 void phase(double *p, const int mp, double *z, const int mz, double *ph,
@@ -373,15 +817,47 @@ int smcep(double *xw, const int flng, double *mc, const int m, const int fftsz,
           const double a, const double t, const int itr1, const int itr2,
           const double dd, const int etype, const double e, const double f,
           const int itype);
+int smcep_r(SMCEPWORK * w, double *xw, const int flng, double *mc,
+            const int m, const int fftsz, const double a, const double t,
+            const int itr1, const int itr2, const double dd, const int etype,
+            const double e, const double f, const int itype);
+int alloc_SMCEPWORK(SMCEPWORK * w, const int flng, const int m,
+                    const int fftsz, const double a, const double t);
+int free_SMCEPWORK(SMCEPWORK * w);
 int uels(double *xw, const int flng, double *c, const int m, const int itr1,
          const int itr2, const double dd, const int etype, const double e,
          const int itype);
+int uels_r(UELSWORK * w, double *xw, const int flng, double *c, const int m,
+           const int itr1, const int itr2, const double dd, const int etype,
+           const double e, const int itype);
+int alloc_UELSWORK(UELSWORK * w, const int flng, const int m);
+int free_UELSWORK(UELSWORK * w);
 double ulaw_c(const double x, const double max, const double mu);
 double ulaw_d(const double x, const double max, const double mu);
 int vc(const GMM * gmm, const DELTAWINDOW * window, const size_t total_frame,
        const size_t source_vlen, const size_t target_vlen,
        const double *gv_mean, const double *gv_vari,
        const double *source, double *target);
+int vc_r(const GMM * gmm, const DELTAWINDOW * window,
+         const size_t total_frame, const size_t source_vlen,
+         const size_t target_vlen, const double *gv_mean,
+         const double *gv_vari, const double *source, double *target,
+         const VCGVSolver gv_solver, VCGVSTAT * gv_stat, THREADPOOL * pool,
+         ARENA * arena);
+int alloc_VCMODEL(VCMODEL * v, const GMM * gmm, const DELTAWINDOW * window,
+                  const size_t source_vlen, const size_t target_vlen);
+int free_VCMODEL(VCMODEL * v);
+int vc_model(const VCMODEL * v, const size_t total_frame,
+             const double *gv_mean, const double *gv_vari,
+             const double *source, double *target, VCGVSTAT * gv_stat,
+             THREADPOOL * pool, ARENA * arena);
+int vc_model_frame(const VCMODEL * v, const double *x, double *mean,
+                   double *vari, double *work);
+int alloc_VCSTREAM(VCSTREAM * s, const VCMODEL * v, const int delay);
+int free_VCSTREAM(VCSTREAM * s);
+int reset_VCSTREAM(VCSTREAM * s);
+int vcstream_push(VCSTREAM * s, const double *source, double *target);
+int vcstream_flush(VCSTREAM * s, double *target);
 int vq(double *x, double *cb, const int l, const int cbsize);
 double edist(double *x, double *y, const int m);
 double window(Window type, double *x, const int size, const int nflg);
@@ -405,9 +881,29 @@ int search_wav_list(Filelist * filelist, char *key);
 
 /* excitation */
 void excite(double *pitch, int n, double *out, int fprd, int iprd, Boolean gauss, int seed_i);
+int alloc_VOCODER(VOCODER * v, const int m, const double a, const int pd,
+                  const int fprd, const int iprd, const Boolean gauss,
+                  const int seed);
+int free_VOCODER(VOCODER * v);
+int reset_VOCODER(VOCODER * v);
+int vocoder_push(VOCODER * v, const double pitch, const double *mc,
+                 double *y);
 
 DLLEXPORT void swipe(double *input, double *output, int length, int samplerate, int frame_shift, double min, double max, double st, int otype);
 
+/* swipe() with the windows, fft tables and spline setup of each window
+   size and the kernels of all pitch candidates built once, so that one
+   state can be reused for many inputs; the state is only read by
+   swipe_process(), which may be called from several threads at once,
+   and the columns of each loudness and strength matrix are spread over
+   pool (NULL runs them in the calling thread) */
+typedef struct _SWIPE_STATE SWIPE_STATE;
+SWIPE_STATE *swipe_create(int samplerate, int frame_shift, double min,
+                          double max, double st);
+int swipe_process(SWIPE_STATE *s, double *input, double *output, int length,
+                  int otype, THREADPOOL *pool);
+void swipe_destroy(SWIPE_STATE *s);
+
 /****************************************************************
     The RAPT pitch tracker
 
@@ -420,7 +916,42 @@ DLLEXPORT void swipe(double *input, double *output, int length, int samplerate,
 int rapt(float *input, float* output, int length, double sample_freq,
      int frame_shift, double minF0, double maxF0, double voice_bias, int otype);
 
+/* the same tracker with its state kept in an object, so that one state
+   can be reused for many inputs and several states can run in parallel;
+   rapt_process() returns 0 or 2 as above.
+
+   For streaming, push chunks of input with rapt_push() and pull the F0
+   of finalized frames (0 when unvoiced) with rapt_pull(), which returns
+   the number of frames written; rapt_finish() ends the input and
+   releases the remaining frames, rapt_reset() starts a new stream.
+   With latency > 0 (sec) at creation, frame k is ready once
+   k * frame_shift + rapt_latency() samples have been pushed; the bound
+   cannot go below the analysis look-ahead, so check rapt_latency().
+   With latency 0 the frames are released as in rapt(), in blocks of
+   0.2 s and up to 1 s after their paths converge. */
+typedef struct _RAPT_STATE RAPT_STATE;
+RAPT_STATE *rapt_create(double sample_freq, int frame_shift, double minF0,
+                        double maxF0, double voice_bias, double latency);
+int rapt_process(RAPT_STATE *s, float *input, float *output, int length,
+                 int otype);
+void rapt_destroy(RAPT_STATE *s);
+void rapt_reset(RAPT_STATE *s);
+int rapt_push(RAPT_STATE *s, float *input, int length);
+int rapt_finish(RAPT_STATE *s);
+int rapt_pull(RAPT_STATE *s, float *output, int length, int otype);
+int rapt_latency(RAPT_STATE *s);
+
+/* correlation engine of the tracker: lag by lag, several lags per SIMD
+   vector (default; the sums are the same as lag by lag unless the
+   compiler fuses multiply-adds in the scalar loop), or all lags of a
+   frame at once by fft in double precision; returns 0 or 1 if unknown */
+#define RAPT_XCORR_DIRECT 0
+#define RAPT_XCORR_BLOCK 1
+#define RAPT_XCORR_FFT 2
+int rapt_set_xcorr(RAPT_STATE *s, int method);
+
 void b2c(double *b, int m1, double *c, int m2, double a);
+void b2c_r(double *b, int m1, double *c, int m2, double a, double *wk);
 
 #if defined (__cplusplus)
 }
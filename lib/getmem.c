@@ -62,10 +62,46 @@
     size_t leng : data length
     size_t size : size of data type
 
+    getmem() and the functions above terminate the process if
+    memory runs out.  The following ones return NULL instead,
+    and take their memory from an arena if one is given.
+
+    int    alloc_ARENA(a, block_size, alloc, release)
+    int    free_ARENA(a)
+    int    reset_ARENA(a)
+    size_t mark_ARENA(a)
+    int    rewind_ARENA(a, mark)
+    char   *agetmem(a, leng, size)
+    double *adgetmem(a, leng)
+    double **addgetmem(a, leng1, leng2)
+    void   afree(a, p)
+
+    ARENA  *a          : arena (NULL: calloc() and free())
+    size_t block_size  : minimum size of the blocks in bytes
+                         (0: 64 KiB)
+    void   *(*alloc)() : allocator of the blocks (NULL: malloc())
+    void   (*release)(): deallocator of the blocks (NULL: free())
+    size_t mark        : position returned by mark_ARENA()
+    void   *p          : memory from agetmem()
+
+    An arena hands out zero-cleared memory from large blocks and
+    never frees it piecewise: afree() does nothing for an arena.
+    rewind_ARENA() takes back everything allocated after mark,
+    and reset_ARENA() everything, keeping the blocks for reuse,
+    e.g. between utterances.  An arena must not be shared by
+    threads.
+
 **********************************************************************/
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
 
 #ifdef DOUBLE
 #define real double
@@ -77,10 +113,8 @@ char *getmem(const size_t leng, const size_t size)
 {
    char *p = NULL;
 
-   if ((p = (char *) calloc(leng, size)) == NULL) {
-      fprintf(stderr, "Cannot allocate memory!\n");
+   if ((p = agetmem(NULL, leng, size)) == NULL)
       exit(3);
-   }
    return (p);
 }
 
@@ -127,3 +161,153 @@ double **ddgetmem(const int leng1, const int leng2)
 
    return (tmp);
 }
+
+#define ARENA_ALIGN 32
+#define ARENA_DEFAULT_BLOCK 65536
+
+typedef struct _ARENABLOCK {
+   struct _ARENABLOCK *next;
+   size_t size;                 /* bytes available after the header */
+} ARENABLOCK;
+
+/* size of the header, keeping the data aligned */
+#define ARENA_HEADER \
+   ((sizeof(ARENABLOCK) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+int alloc_ARENA(ARENA * a, const size_t block_size, void *(*alloc) (size_t),
+                void (*release) (void *))
+{
+   if ((alloc == NULL) != (release == NULL)) {
+      fprintf(stderr, "arena : alloc and release must be given together!\n");
+      return (-1);
+   }
+   a->block_size = (block_size > 0) ? block_size : ARENA_DEFAULT_BLOCK;
+   a->alloc = (alloc != NULL) ? alloc : malloc;
+   a->release = (release != NULL) ? release : free;
+   a->first = a->cur = NULL;
+   a->used = a->base = 0;
+
+   return (0);
+}
+
+int free_ARENA(ARENA * a)
+{
+   ARENABLOCK *b, *next;
+
+   for (b = (ARENABLOCK *) a->first; b != NULL; b = next) {
+      next = b->next;
+      a->release(b);
+   }
+   a->first = a->cur = NULL;
+   a->used = a->base = 0;
+
+   return (0);
+}
+
+int reset_ARENA(ARENA * a)
+{
+   return (rewind_ARENA(a, 0));
+}
+
+size_t mark_ARENA(const ARENA * a)
+{
+   return (a->base + a->used);
+}
+
+int rewind_ARENA(ARENA * a, const size_t mark)
+{
+   ARENABLOCK *b;
+   size_t base = 0;
+
+   for (b = (ARENABLOCK *) a->first; b != NULL && mark > base + b->size;
+        b = b->next)
+      base += b->size;
+
+   a->cur = b;
+   a->base = base;
+   a->used = (b != NULL) ? mark - base : 0;
+
+   return (0);
+}
+
+char *agetmem(ARENA * a, const size_t leng, const size_t size)
+{
+   ARENABLOCK *b, *nb;
+   size_t bytes;
+   char *p;
+
+   if (a == NULL) {
+      if ((p = (char *) calloc(leng, size)) == NULL)
+         fprintf(stderr, "Cannot allocate memory!\n");
+      return (p);
+   }
+
+   if (size != 0 && leng > ((size_t) - 1 - ARENA_ALIGN) / size) {
+      fprintf(stderr, "Cannot allocate memory!\n");
+      return (NULL);
+   }
+   bytes = (leng * size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+   if (bytes == 0)
+      bytes = ARENA_ALIGN;
+
+   for (;;) {
+      b = (ARENABLOCK *) a->cur;
+      if (b != NULL && a->used + bytes <= b->size) {
+         p = (char *) b + ARENA_HEADER + a->used;
+         a->used += bytes;
+         memset(p, 0, bytes);
+         return (p);
+      }
+
+      /* move on to the next block, making one if there is none */
+      if (b == NULL || b->next == NULL) {
+         size_t bsize = (bytes > a->block_size) ? bytes : a->block_size;
+         if (bsize > (size_t) - 1 - ARENA_HEADER
+             || (nb = (ARENABLOCK *) a->alloc(ARENA_HEADER + bsize)) == NULL) {
+            fprintf(stderr, "Cannot allocate memory!\n");
+            return (NULL);
+         }
+         nb->next = NULL;
+         nb->size = bsize;
+         if (b == NULL) {
+            /* rewind_ARENA() leaves cur NULL only for an empty list */
+            a->first = a->cur = nb;
+            a->used = 0;
+            continue;
+         }
+         b->next = nb;
+      }
+      a->base += b->size;
+      a->cur = b->next;
+      a->used = 0;
+   }
+}
+
+double *adgetmem(ARENA * a, const size_t leng)
+{
+   return ((double *) agetmem(a, leng, sizeof(double)));
+}
+
+double **addgetmem(ARENA * a, const size_t leng1, const size_t leng2)
+{
+   size_t i;
+   double **tmp, *tmp2;
+
+   if ((tmp = (double **) agetmem(a, leng1, sizeof(double *))) == NULL)
+      return (NULL);
+   if ((tmp2 = adgetmem(a, leng1 * leng2)) == NULL) {
+      afree(a, tmp);
+      return (NULL);
+   }
+
+   for (i = 0; i < leng1; i++)
+      tmp[i] = tmp2 + i * leng2;
+
+   return (tmp);
+}
+
+void afree(ARENA * a, void *p)
+{
+   if (a == NULL)
+      free(p);
+}
@@ -48,11 +48,23 @@
     M-Sequence Generator using X**31 + X**28 + 1
 
     int mseq(void)
+    int mseq_r(int *x)
+
+    int *x       : state of the generator, initialized to MSEQ_INIT
 
     return value : M-Sequence
 
+    mseq() keeps its state in a static variable; mseq_r() lets
+    each caller keep its own sequence.
+
 ****************************************************************/
 
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
 #define	B0    0x00000001
 #define	B28   0x10000000
 #define	B31   0x80000000
@@ -61,25 +73,31 @@
 
 int mseq(void)
 {
-   static int x = 0x55555555;
+   static int x = MSEQ_INIT;
+
+   return (mseq_r(&x));
+}
+
+int mseq_r(int *x)
+{
    int x0, x28;
 
-   x >>= 1;
+   *x >>= 1;
 
-   if (x & B0)
+   if (*x & B0)
       x0 = 1;
    else
       x0 = -1;
 
-   if (x & B28)
+   if (*x & B28)
       x28 = 1;
    else
       x28 = -1;
 
    if (x0 + x28)
-      x &= B31_;
+      *x &= B31_;
    else
-      x |= B31;
+      *x |= B31;
 
    return (x0);
 }
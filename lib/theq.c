@@ -51,6 +51,7 @@
 
 
     int	theq(t, h, a, b, n, eps)
+    int	theq_r(t, h, a, b, n, eps, wk)
 
     double  *t : Toeplitz elements -> T(i,j) = t(|i-j|) t[0]..t[n-1]
     double  *h : Hankel elements -> H(i,j) = h(i+j)     h[0]...h[2*n-2]
@@ -58,6 +59,7 @@
     double  *b : known vector  	                       b[0]...b[n-1]
     int      n : system order
     double eps : singular check (eps(if -1.0, 1.0e-6 is assumed))
+    double *wk : working area of THEQ_WORKSIZE(n) doubles
 
     return value :
           0 : normally completed
@@ -69,6 +71,12 @@
 #include <stdlib.h>
 #include <math.h>
 
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
 static void mv_mul(double *t, double *x, double *y)
 {
    t[0] = x[0] * y[0] + x[1] * y[1];
@@ -121,39 +129,21 @@ static void crstrns(double *x, double *y)
    return;
 }
 
-static double **mtrx2(const int a, const int b)
-{
-   int i;
-   double **x;
-
-   if (!(x = (double **) calloc((size_t) a, sizeof(*x)))) {
-      fprintf(stderr, "mtrx2() in theq() : Cannot allocate memory!\n");
-      exit(3);
-   }
-   for (i = 0; i < a; i++)
-      if (!(x[i] = (double *) calloc((size_t) b, sizeof(**x)))) {
-         fprintf(stderr, "mtrx2() in theq() : Cannot allocate memory!\n");
-         exit(3);
-      }
-
-   return (x);
-}
-
-static int cal_p0(double **p, double **r, double *b, const int n,
+static int cal_p0(double *p, double *r, double *b, const int n,
                   const double eps)
 {
    double t[4], s[2];
 
-   if (inverse(t, r[0], eps) == -1)
+   if (inverse(t, r, eps) == -1)
       return (-1);
    s[0] = b[0];
    s[1] = b[n - 1];
-   mv_mul(p[0], t, s);
+   mv_mul(p, t, s);
 
    return (0);
 }
 
-static void cal_ex(double *ex, double **r, double **x, const int i)
+static void cal_ex(double *ex, double *r, double *x, const int i)
 {
    int j;
    double t[4], s[4];
@@ -161,7 +151,7 @@ static void cal_ex(double *ex, double **r, double **x, const int i)
    s[0] = s[1] = s[2] = s[3] = 0.;
 
    for (j = 0; j < i; j++) {
-      mm_mul(t, r[i - j], x[j]);
+      mm_mul(t, &r[4 * (i - j)], &x[4 * j]);
       s[0] += t[0];
       s[1] += t[1];
       s[2] += t[2];
@@ -176,7 +166,7 @@ static void cal_ex(double *ex, double **r, double **x, const int i)
    return;
 }
 
-static void cal_ep(double *ep, double **r, double **p, const int i)
+static void cal_ep(double *ep, double *r, double *p, const int i)
 {
    int j;
    double t[2], s[2];
@@ -184,7 +174,7 @@ static void cal_ep(double *ep, double **r, double **p, const int i)
    s[0] = s[1] = 0.;
 
    for (j = 0; j < i; j++) {
-      mv_mul(t, r[i - j], p[j]);
+      mv_mul(t, &r[4 * (i - j)], &p[2 * j]);
       s[0] += t[0];
       s[1] += t[1];
    }
@@ -206,31 +196,31 @@ static int cal_bx(double *bx, double *vx, double *ex, const double eps)
    return (0);
 }
 
-static void cal_x(double **x, double **xx, double *bx, const int i)
+static void cal_x(double *x, double *xx, double *bx, const int i)
 {
    int j;
    double t[4], s[4];
 
    for (j = 1; j < i; j++) {
-      crstrns(t, xx[i - j]);
+      crstrns(t, &xx[4 * (i - j)]);
       mm_mul(s, t, bx);
-      x[j][0] -= s[0];
-      x[j][1] -= s[1];
-      x[j][2] -= s[2];
-      x[j][3] -= s[3];
+      x[4 * j] -= s[0];
+      x[4 * j + 1] -= s[1];
+      x[4 * j + 2] -= s[2];
+      x[4 * j + 3] -= s[3];
    }
 
    for (j = 1; j < i; j++) {
-      xx[j][0] = x[j][0];
-      xx[j][1] = x[j][1];
-      xx[j][2] = x[j][2];
-      xx[j][3] = x[j][3];
+      xx[4 * j] = x[4 * j];
+      xx[4 * j + 1] = x[4 * j + 1];
+      xx[4 * j + 2] = x[4 * j + 2];
+      xx[4 * j + 3] = x[4 * j + 3];
    }
 
-   x[i][0] = xx[i][0] = -bx[0];
-   x[i][1] = xx[i][1] = -bx[1];
-   x[i][2] = xx[i][2] = -bx[2];
-   x[i][3] = xx[i][3] = -bx[3];
+   x[4 * i] = xx[4 * i] = -bx[0];
+   x[4 * i + 1] = xx[4 * i + 1] = -bx[1];
+   x[4 * i + 2] = xx[4 * i + 2] = -bx[2];
+   x[4 * i + 3] = xx[4 * i + 3] = -bx[3];
 
    return;
 }
@@ -265,76 +255,59 @@ static int cal_g(double *g, double *vx, double *b, double *ep,
    return (0);
 }
 
-static void cal_p(double **p, double **x, double *g, const int i)
+static void cal_p(double *p, double *x, double *g, const int i)
 {
    double t[4], s[2];
    int j;
 
    for (j = 0; j < i; j++) {
-      crstrns(t, x[i - j]);
+      crstrns(t, &x[4 * (i - j)]);
       mv_mul(s, t, g);
-      p[j][0] += s[0];
-      p[j][1] += s[1];
+      p[2 * j] += s[0];
+      p[2 * j + 1] += s[1];
    }
 
-   p[i][0] = g[0];
-   p[i][1] = g[1];
+   p[2 * i] = g[0];
+   p[2 * i + 1] = g[1];
 
    return;
 }
 
-int theq(double *t, double *h, double *a, double *b, const int n, double eps)
+int theq_r(double *t, double *h, double *a, double *b, const int n, double eps,
+           double *wk)
 {
-   static double **r = NULL, **x, **xx, **p;
-   static int size;
+   double *r, *x, *xx, *p;
    double ex[4], ep[2], vx[4], bx[4], g[2];
    int i;
 
-   if (r == NULL) {
-      r = mtrx2(n, 4);
-      x = mtrx2(n, 4);
-      xx = mtrx2(n, 4);
-      p = mtrx2(n, 2);
-      size = n;
-   }
-   if (n > size) {
-      for (i = 0; i < size; i++) {
-         free((char *) r[i]);
-         free((char *) x[i]);
-         free((char *) xx[i]);
-         free((char *) p[i]);
-      }
-      free((char *) r);
-      free((char *) x);
-      free((char *) xx);
-      free((char *) p);
-
-      r = mtrx2(n, 4);
-      x = mtrx2(n, 4);
-      xx = mtrx2(n, 4);
-      p = mtrx2(n, 2);
-      size = n;
-   }
+   r = wk;
+   x = r + 4 * n;
+   xx = x + 4 * n;
+   p = xx + 4 * n;
+
+   fillz(x, sizeof(*x), 4 * n);
+   fillz(xx, sizeof(*xx), 4 * n);
+   fillz(p, sizeof(*p), 2 * n);
 
    if (eps < 0.0)
       eps = 1.0e-6;
 
    /* make r */
    for (i = 0; i < n; i++) {
-      r[i][0] = r[i][3] = t[i];
-      r[i][1] = h[n - 1 + i];
-      r[i][2] = h[n - 1 - i];
+      r[4 * i] = r[4 * i + 3] = t[i];
+      r[4 * i + 1] = h[n - 1 + i];
+      r[4 * i + 2] = h[n - 1 - i];
    }
 
    /* step 1 */
-   x[0][0] = x[0][3] = 1.0;
+   x[0] = x[3] = 1.0;
    if (cal_p0(p, r, b, n, eps) == -1)
       return (-1);
 
-   vx[0] = r[0][0];
-   vx[1] = r[0][1];
-   vx[2] = r[0][2];
-   vx[3] = r[0][3];
+   vx[0] = r[0];
+   vx[1] = r[1];
+   vx[2] = r[2];
+   vx[3] = r[3];
 
    /* step 2 */
    for (i = 1; i < n; i++) {
@@ -351,7 +324,25 @@ int theq(double *t, double *h, double *a, double *b, const int n, double eps)
 
    /* step 3 */
    for (i = 0; i < n; i++)
-      a[i] = p[i][0];
+      a[i] = p[2 * i];
 
    return (0);
 }
+
+int theq(double *t, double *h, double *a, double *b, const int n, double eps)
+{
+   static double *wk = NULL;
+   static int size;
+
+   if (wk == NULL) {
+      wk = dgetmem(THEQ_WORKSIZE(n));
+      size = n;
+   }
+   if (n > size) {
+      free(wk);
+      wk = dgetmem(THEQ_WORKSIZE(n));
+      size = n;
+   }
+
+   return (theq_r(t, h, a, b, n, eps, wk));
+}
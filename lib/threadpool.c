@@ -0,0 +1,256 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/********************************************************************
+    $Id$
+
+    Thread Pool
+
+    int alloc_THREADPOOL(pool, nthread)
+    int free_THREADPOOL(pool)
+    int run_THREADPOOL(pool, njob, func, arg)
+
+    THREADPOOL *pool    : thread pool
+    int        nthread  : number of threads (including the caller)
+    int        njob     : number of jobs
+    void       (*func)(void *arg, int thread, int job)
+                        : job function, thread is 0, ..., nthread-1
+                          and identifies per-thread working areas
+    void       *arg     : argument passed to func
+
+    return value : 0 -> success
+                  -1 -> failed to start threads
+
+    run_THREADPOOL() hands jobs 0, ..., njob-1 to the threads and
+    returns when all of them are done.  The calling thread takes
+    part as thread 0.  A NULL pool runs every job in the calling
+    thread.  Calls on the same pool from several threads are
+    serialized.
+
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+#include "../bin/sptk_thread.h"
+
+typedef struct _POOLSTATE {
+   sptk_mutex_t lock;
+   sptk_mutex_t run_lock;       /* one run_THREADPOOL() at a time */
+   sptk_cond_t start;
+   sptk_cond_t done;
+   sptk_thread_t *threads;
+   int nworker;
+   void (*func) (void *, const int, const int);
+   void *arg;
+   int njob;
+   int next;                    /* next job to hand out */
+   int nbusy;                   /* workers still in the current run */
+   int generation;              /* incremented for each run */
+   int quit;
+} POOLSTATE;
+
+typedef struct _WORKERARG {
+   POOLSTATE *s;
+   int thread;
+} WORKERARG;
+
+static void do_jobs(POOLSTATE * s, const int thread)
+{
+   int job;
+
+   for (;;) {
+      sptk_mutex_lock(&s->lock);
+      job = (s->next < s->njob) ? s->next++ : -1;
+      sptk_mutex_unlock(&s->lock);
+      if (job < 0)
+         break;
+      s->func(s->arg, thread, job);
+   }
+}
+
+static SPTK_THREAD_PROC(worker, varg)
+{
+   WORKERARG *warg = (WORKERARG *) varg;
+   POOLSTATE *s = warg->s;
+   const int thread = warg->thread;
+   int seen = 0;
+
+   free(warg);
+
+   for (;;) {
+      sptk_mutex_lock(&s->lock);
+      while (!s->quit && s->generation == seen)
+         sptk_cond_wait(&s->start, &s->lock);
+      if (s->quit) {
+         sptk_mutex_unlock(&s->lock);
+         break;
+      }
+      seen = s->generation;
+      sptk_mutex_unlock(&s->lock);
+
+      do_jobs(s, thread);
+
+      sptk_mutex_lock(&s->lock);
+      if (--s->nbusy == 0)
+         sptk_cond_signal(&s->done);
+      sptk_mutex_unlock(&s->lock);
+   }
+
+   SPTK_THREAD_RETURN;
+}
+
+static void stop_workers(POOLSTATE * s, const int nstarted)
+{
+   int i;
+
+   sptk_mutex_lock(&s->lock);
+   s->quit = 1;
+   sptk_cond_broadcast(&s->start);
+   sptk_mutex_unlock(&s->lock);
+
+   for (i = 0; i < nstarted; i++)
+      sptk_thread_join(s->threads[i]);
+}
+
+int alloc_THREADPOOL(THREADPOOL * pool, const int nthread)
+{
+   int i;
+   POOLSTATE *s;
+   WORKERARG *warg;
+
+   pool->nthread = (nthread < 1) ? 1 : nthread;
+
+   s = (POOLSTATE *) getmem(1, sizeof(POOLSTATE));
+   sptk_mutex_init(&s->lock);
+   sptk_mutex_init(&s->run_lock);
+   sptk_cond_init(&s->start);
+   sptk_cond_init(&s->done);
+   s->nworker = pool->nthread - 1;
+   s->threads =
+       (sptk_thread_t *) getmem(s->nworker + 1, sizeof(sptk_thread_t));
+
+   for (i = 0; i < s->nworker; i++) {
+      warg = (WORKERARG *) getmem(1, sizeof(WORKERARG));
+      warg->s = s;
+      warg->thread = i + 1;
+      if (sptk_thread_create(&s->threads[i], worker, warg) == -1) {
+         fprintf(stderr, "threadpool : Cannot create thread!\n");
+         free(warg);
+         stop_workers(s, i);
+         free(s->threads);
+         free(s);
+         pool->nthread = 0;
+         pool->impl = NULL;
+         return (-1);
+      }
+   }
+
+   pool->impl = s;
+
+   return (0);
+}
+
+int free_THREADPOOL(THREADPOOL * pool)
+{
+   POOLSTATE *s = (POOLSTATE *) pool->impl;
+
+   if (s != NULL) {
+      stop_workers(s, s->nworker);
+      sptk_cond_destroy(&s->start);
+      sptk_cond_destroy(&s->done);
+      sptk_mutex_destroy(&s->lock);
+      sptk_mutex_destroy(&s->run_lock);
+      free(s->threads);
+      free(s);
+   }
+   pool->nthread = 0;
+   pool->impl = NULL;
+
+   return (0);
+}
+
+int run_THREADPOOL(THREADPOOL * pool, const int njob,
+                   void (*func) (void *, const int, const int), void *arg)
+{
+   int job;
+   POOLSTATE *s;
+
+   if (pool == NULL || pool->impl == NULL) {
+      for (job = 0; job < njob; job++)
+         func(arg, 0, job);
+      return (0);
+   }
+
+   s = (POOLSTATE *) pool->impl;
+
+   sptk_mutex_lock(&s->run_lock);
+
+   sptk_mutex_lock(&s->lock);
+   s->func = func;
+   s->arg = arg;
+   s->njob = njob;
+   s->next = 0;
+   s->nbusy = s->nworker;
+   s->generation++;
+   sptk_cond_broadcast(&s->start);
+   sptk_mutex_unlock(&s->lock);
+
+   do_jobs(s, 0);
+
+   sptk_mutex_lock(&s->lock);
+   while (s->nbusy > 0)
+      sptk_cond_wait(&s->done, &s->lock);
+   sptk_mutex_unlock(&s->lock);
+
+   sptk_mutex_unlock(&s->run_lock);
+
+   return (0);
+}
@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------- */
+/*             The Speech Signal Processing Toolkit (SPTK)           */
+/*             developed by SPTK Working Group                       */
+/*             http://sp-tk.sourceforge.net/                         */
+/* ----------------------------------------------------------------- */
+/*                                                                   */
+/*  Copyright (c) 1984-2007  Tokyo Institute of Technology           */
+/*                           Interdisciplinary Graduate School of    */
+/*                           Science and Engineering                 */
+/*                                                                   */
+/*                1996-2016  Nagoya Institute of Technology          */
+/*                           Department of Computer Science          */
+/*                                                                   */
+/* All rights reserved.                                              */
+/*                                                                   */
+/* Redistribution and use in source and binary forms, with or        */
+/* without modification, are permitted provided that the following   */
+/* conditions are met:                                               */
+/*                                                                   */
+/* - Redistributions of source code must retain the above copyright  */
+/*   notice, this list of conditions and the following disclaimer.   */
+/* - Redistributions in binary form must reproduce the above         */
+/*   copyright notice, this list of conditions and the following     */
+/*   disclaimer in the documentation and/or other materials provided */
+/*   with the distribution.                                          */
+/* - Neither the name of the SPTK working group nor the names of its */
+/*   contributors may be used to endorse or promote products derived */
+/*   from this software without specific prior written permission.   */
+/*                                                                   */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND            */
+/* CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,       */
+/* INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF          */
+/* MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE          */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS */
+/* BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,          */
+/* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED   */
+/* TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,     */
+/* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON */
+/* ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,   */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY    */
+/* OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE           */
+/* POSSIBILITY OF SUCH DAMAGE.                                       */
+/* ----------------------------------------------------------------- */
+
+/********************************************************************
+    $Id$
+
+    Streaming Vocoder (excitation and MLSA filter)
+
+    int alloc_VOCODER(v, m, a, pd, fprd, iprd, gauss, seed)
+    int free_VOCODER(v)
+    int reset_VOCODER(v)
+    int vocoder_push(v, pitch, mc, y)
+
+    VOCODER *v     : vocoder
+    int     m      : order of mel-cepstrum
+    double  a      : all-pass constant
+    int     pd     : order of Pade approximation
+    int     fprd   : frame period
+    int     iprd   : interpolation period of pitch
+    Boolean gauss  : use Gaussian noise (TR) or M-sequence (FA)
+                     for unvoiced frames
+    int     seed   : seed of the Gaussian noise
+    double  pitch  : pitch period of the frame (0: unvoiced)
+    double  *mc    : mel-cepstrum of the frame
+    double  *y     : output of fprd samples
+
+    return value : 0 -> success
+                  -1 -> invalid parameters
+
+    vocoder_push() generates the fprd samples that end at the
+    pushed frame, so each frame is audible as soon as it is
+    pushed.  Pitch is interpolated from the previous frame as
+    in excite(), and the MLSA filter coefficients are
+    interpolated sample by sample as in mlsadf_block().  The
+    first frame is taken to be preceded by itself, so pushing
+    pitch[0], ..., pitch[n-1] gives the same excitation as
+    excite() for pitch[0], pitch[0], pitch[1], ..., pitch[n-1].
+    The phase of the pulse train, the noise generator and the
+    filter delay persist across calls; reset_VOCODER() starts
+    a new utterance.  Each VOCODER is independent, so several
+    utterances can be synthesized concurrently.
+
+**********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#if defined(WIN32)
+#include "SPTK.h"
+#else
+#include <SPTK.h>
+#endif
+
+int alloc_VOCODER(VOCODER * v, const int m, const double a, const int pd,
+                  const int fprd, const int iprd, const Boolean gauss,
+                  const int seed)
+{
+   if (m < 0 || fprd <= 0 || iprd <= 0) {
+      fprintf(stderr, "vocoder : invalid order or period!\n");
+      return (-1);
+   }
+   if (alloc_MLSADFSTATE(&v->filter, m, a, pd) != 0)
+      return (-1);
+
+   v->m = m;
+   v->a = a;
+   v->fprd = fprd;
+   v->iprd = iprd;
+   v->gauss = gauss;
+   v->seed = seed;
+   v->b0 = dgetmem(2 * (m + 1));
+   v->b1 = v->b0 + m + 1;
+
+   return (reset_VOCODER(v));
+}
+
+int free_VOCODER(VOCODER * v)
+{
+   free_MLSADFSTATE(&v->filter);
+   free(v->b0);
+   v->b0 = v->b1 = NULL;
+   v->m = v->fprd = v->iprd = 0;
+
+   return (0);
+}
+
+int reset_VOCODER(VOCODER * v)
+{
+   v->next = v->seed;
+   if (v->gauss & (v->seed != 1))
+      v->next = srnd((unsigned int) v->seed);
+   v->sw = 0;
+   v->mseq = MSEQ_INIT;
+   v->first = TR;
+   v->p1 = v->pc = 0.0;
+
+   return (reset_MLSADFSTATE(&v->filter));
+}
+
+int vocoder_push(VOCODER * v, const double pitch, const double *mc,
+                 double *y)
+{
+   int i, j;
+   const int fprd = v->fprd, iprd = v->iprd;
+   double p1, p2 = pitch, inc, *t;
+
+   /* b1 of the previous frame becomes b0 */
+   t = v->b0;
+   v->b0 = v->b1;
+   v->b1 = t;
+   mc2b((double *) mc, v->b1, v->m, v->a);
+
+   if (v->first) {
+      movem(v->b1, v->b0, sizeof(*v->b0), v->m + 1);
+      v->p1 = v->pc = p2;
+      v->first = FA;
+   }
+
+   /* excitation, as excite() does for one frame */
+   p1 = v->p1;
+   if ((p1 != 0.0) && (p2 != 0.0))
+      inc = (p2 - p1) * (double) iprd / (double) fprd;
+   else {
+      inc = 0.0;
+      v->pc = p2;
+      p1 = 0.0;
+   }
+
+   for (j = 0, i = (iprd + 1) / 2; j < fprd; j++) {
+      if (p1 == 0.0) {
+         if (v->gauss)
+            y[j] = (double) nrandom_r(&v->next, &v->sw, &v->r);
+         else
+            y[j] = mseq_r(&v->mseq);
+      } else {
+         if ((v->pc += 1.0) >= p1) {
+            y[j] = sqrt(p1);
+            v->pc = v->pc - p1;
+         } else
+            y[j] = 0.0;
+      }
+
+      if (!--i) {
+         p1 += inc;
+         i = iprd;
+      }
+   }
+   v->p1 = p2;
+
+   return (mlsadf_block(&v->filter, y, y, fprd, v->b0, v->b1));
+}